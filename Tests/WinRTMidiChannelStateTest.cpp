@@ -0,0 +1,119 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiChannelState.h"
+#include "WinRTMidiTest.h"
+#include <vector>
+
+using namespace WinRT;
+
+typedef std::vector<std::vector<unsigned char>> MessageList;
+
+static MessageList GetAllNotesOff(WinRTMidiChannelState& state)
+{
+    WinRTMidiChannelStateSnapshot snapshot;
+    state.GetSnapshot(snapshot);
+
+    MessageList messages;
+    WinRTMidiChannelState::GetAllNotesOff(snapshot, [&messages](const unsigned char* message, unsigned int nBytes)
+    {
+        messages.push_back(std::vector<unsigned char>(message, message + nBytes));
+    });
+    return messages;
+}
+
+static void Send(WinRTMidiChannelState& state, unsigned char status, unsigned char data1, unsigned char data2)
+{
+    unsigned char message[3] = { status, data1, data2 };
+    state.Update(message, 3);
+}
+
+static void TestActiveNotes()
+{
+    WinRTMidiChannelState state;
+    WINRT_CHECK(GetAllNotesOff(state).empty());
+
+    // notes in all four words of the bitset
+    Send(state, 0x90, 0, 100);
+    Send(state, 0x90, 60, 100);
+    Send(state, 0x93, 127, 1);
+    Send(state, 0x90, 64, 100);
+    Send(state, 0x80, 64, 0);
+
+    MessageList messages = GetAllNotesOff(state);
+    WINRT_CHECK_EQUAL(3, messages.size());
+    WINRT_CHECK(messages[0] == std::vector<unsigned char>({ 0x80, 0, 64 }));
+    WINRT_CHECK(messages[1] == std::vector<unsigned char>({ 0x80, 60, 64 }));
+    WINRT_CHECK(messages[2] == std::vector<unsigned char>({ 0x83, 127, 64 }));
+
+    // a note on with velocity 0 is a note off
+    Send(state, 0x90, 60, 0);
+    WINRT_CHECK_EQUAL(2, GetAllNotesOff(state).size());
+
+    // all notes off
+    Send(state, 0xB0, 123, 0);
+    Send(state, 0xB3, 123, 0);
+    WINRT_CHECK(GetAllNotesOff(state).empty());
+}
+
+static void TestSustain()
+{
+    WinRTMidiChannelState state;
+
+    // a held pedal is released even on a channel without active notes
+    Send(state, 0xB5, 64, 127);
+    MessageList messages = GetAllNotesOff(state);
+    WINRT_CHECK_EQUAL(1, messages.size());
+    WINRT_CHECK(messages[0] == std::vector<unsigned char>({ 0xB5, 64, 0 }));
+
+    // the sustain off comes before the note offs of the channel
+    Send(state, 0x95, 40, 100);
+    messages = GetAllNotesOff(state);
+    WINRT_CHECK_EQUAL(2, messages.size());
+    WINRT_CHECK(messages[0] == std::vector<unsigned char>({ 0xB5, 64, 0 }));
+    WINRT_CHECK(messages[1] == std::vector<unsigned char>({ 0x85, 40, 64 }));
+
+    // reset all controllers releases the pedal
+    Send(state, 0xB5, 121, 0);
+    WINRT_CHECK_EQUAL(1, GetAllNotesOff(state).size());
+}
+
+static void TestSnapshot()
+{
+    WinRTMidiChannelState state;
+    Send(state, 0xC2, 17, 0);
+    Send(state, 0xE2, 0x7F, 0x7F);
+    Send(state, 0xB2, 7, 90);
+
+    WinRTMidiChannelStateSnapshot snapshot;
+    state.GetSnapshot(snapshot);
+    WINRT_CHECK_EQUAL(17, snapshot.programs[2]);
+    WINRT_CHECK_EQUAL(0x3FFF, snapshot.pitchBend[2]);
+    WINRT_CHECK_EQUAL(90, snapshot.controllers[2][7]);
+    WINRT_CHECK_EQUAL(0x2000, snapshot.pitchBend[0]);
+
+    // system reset clears every channel
+    unsigned char reset = 0xFF;
+    state.Update(&reset, 1);
+    state.GetSnapshot(snapshot);
+    WINRT_CHECK_EQUAL(0, snapshot.programs[2]);
+    WINRT_CHECK_EQUAL(0x2000, snapshot.pitchBend[2]);
+    WINRT_CHECK_EQUAL(0, snapshot.controllers[2][7]);
+}
+
+int main()
+{
+    TestActiveNotes();
+    TestSustain();
+    TestSnapshot();
+    return 0;
+}
@@ -0,0 +1,220 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiNetwork.h"
+#include "WinRTMidiTest.h"
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace WinRT;
+
+#define kFirstTestPort 47100
+#define kTestPortCount 100
+
+struct ReceivedMessage
+{
+    long long time;
+    std::vector<unsigned char> data;
+};
+
+// collects the messages a receiver plays out
+class MessageLog
+{
+public:
+    void Add(long long time, const unsigned char* message, unsigned int nBytes)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mMessages.push_back({ time, std::vector<unsigned char>(message, message + nBytes) });
+    }
+
+    std::vector<ReceivedMessage> Get()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mMessages;
+    }
+
+private:
+    std::mutex mMutex;
+    std::vector<ReceivedMessage> mMessages;
+};
+
+static void Sleep(int milliseconds)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+// starts the receiver on the first free port of the test range
+static unsigned short StartReceiver(WinRTMidiNetworkReceiver& receiver)
+{
+    for (unsigned short port = kFirstTestPort; port < kFirstTestPort + kTestPortCount; port++)
+    {
+        if (receiver.Start("127.0.0.1", port) == WINRT_NO_ERROR)
+        {
+            return port;
+        }
+    }
+
+    WINRT_CHECK(!"no free port for the receiver");
+    return 0;
+}
+
+// every message in its own packet, delayed by 2 - 6 ms so packets arrive out of order.
+// The jitter buffer puts them back in order and nothing counts as lost. Packets are sent
+// every 2 ms, so the jitter buffer holds well below kNetworkJitterSlots packets
+static void TestJitterBufferPlayout()
+{
+    WinRTMidiNetworkConfig config = GetDefaultNetworkConfig();
+    config.batchWindow = 0;
+    config.jitterBuffer = 40;
+    config.delay = 2;
+    config.delayJitter = 4;
+
+    MessageLog log;
+    WinRTMidiNetworkReceiver receiver(config, [&log](long long time, const unsigned char* message, unsigned int nBytes)
+    {
+        log.Add(time, message, nBytes);
+    });
+    unsigned short port = StartReceiver(receiver);
+
+    WinRTMidiNetworkSender sender(config);
+    WINRT_CHECK_EQUAL(WINRT_NO_ERROR, sender.Start("127.0.0.1", port));
+
+    // the receiver synchronizes on the first packet that arrives; packets sent before it would
+    // count as late, so the reordered packets follow once it has arrived
+    const unsigned int count = 100;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        unsigned char message[3] = { 0x90, (unsigned char)i, 100 };
+        sender.Send(message, 3);
+        Sleep(i == 0 ? 50 : 2);
+    }
+
+    Sleep(300);
+    sender.Stop();
+    receiver.Stop();
+
+    std::vector<ReceivedMessage> messages = log.Get();
+    WINRT_CHECK_EQUAL(count, messages.size());
+    for (unsigned int i = 0; i < count; i++)
+    {
+        WINRT_CHECK_EQUAL(i, messages[i].data[1]);
+        if (i > 0)
+        {
+            WINRT_CHECK(messages[i].time >= messages[i - 1].time);
+        }
+    }
+
+    WinRTMidiNetworkStats senderStats;
+    WinRTMidiNetworkStats receiverStats;
+    sender.GetStats(senderStats);
+    receiver.GetStats(receiverStats);
+    WINRT_CHECK_EQUAL(count, senderStats.packetsSent);
+    WINRT_CHECK_EQUAL(0, senderStats.packetsInjectedLoss);
+    WINRT_CHECK_EQUAL(count, receiverStats.packetsReceived);
+    WINRT_CHECK_EQUAL(0, receiverStats.packetsLost);
+    WINRT_CHECK_EQUAL(0, receiverStats.packetsLate);
+    WINRT_CHECK_EQUAL(0, receiverStats.journalRecoveries);
+}
+
+static void Send(WinRTMidiNetworkSender& sender, WinRTMidiChannelState& state, unsigned char status, unsigned char data1, unsigned char data2)
+{
+    unsigned char message[3] = { status, data1, data2 };
+    unsigned int nBytes = (status & 0xF0) == 0xC0 ? 2 : 3;
+    state.Update(message, nBytes);
+    sender.Send(message, nBytes);
+}
+
+// a quarter of the packets are dropped. The journals of the packets that arrive repair the
+// receiver's channel state, so it ends up equal to the sender's
+static void TestJournalRecovery()
+{
+    WinRTMidiNetworkConfig config = GetDefaultNetworkConfig();
+    config.batchWindow = 0;
+    config.jitterBuffer = 20;
+    config.lossRate = 0.25;
+
+    WinRTMidiChannelState receiverState;
+    WinRTMidiNetworkReceiver receiver(config, [&receiverState](long long /*time*/, const unsigned char* message, unsigned int nBytes)
+    {
+        receiverState.Update(message, nBytes);
+    });
+    unsigned short port = StartReceiver(receiver);
+
+    WinRTMidiNetworkSender sender(config);
+    WINRT_CHECK_EQUAL(WINRT_NO_ERROR, sender.Start("127.0.0.1", port));
+
+    WinRTMidiChannelState senderState;
+    unsigned int packets = 0;
+    for (unsigned int i = 0; i < 200; i++)
+    {
+        unsigned char channel = i & 3;
+        unsigned char note = 36 + i % 48;
+        Send(sender, senderState, 0x90 | channel, note, 100);
+        Send(sender, senderState, 0xB0 | channel, 1, i & 0x7F);
+        Send(sender, senderState, 0xB0 | channel, 64, (i & 8) ? 127 : 0);
+        Send(sender, senderState, 0xE0 | channel, i & 0x7F, (i >> 3) & 0x7F);
+        Send(sender, senderState, 0x80 | channel, note, 0);
+        packets += 5;
+        if (i % 10 == 0)
+        {
+            Send(sender, senderState, 0xC0 | channel, i & 0x7F, 0);
+            packets++;
+        }
+        Sleep(1);
+    }
+
+    // the same message again and again, so the last loss is followed by a packet with a journal
+    for (unsigned int i = 0; i < 20; i++)
+    {
+        Send(sender, senderState, 0xB0, 7, 100);
+        packets++;
+        Sleep(1);
+    }
+
+    Sleep(200);
+    sender.Stop();
+    receiver.Stop();
+
+    WinRTMidiChannelStateSnapshot expected;
+    WinRTMidiChannelStateSnapshot actual;
+    senderState.GetSnapshot(expected);
+    receiverState.GetSnapshot(actual);
+    WINRT_CHECK(memcmp(expected.activeNotes, actual.activeNotes, sizeof(expected.activeNotes)) == 0);
+    WINRT_CHECK(memcmp(expected.controllers, actual.controllers, sizeof(expected.controllers)) == 0);
+    WINRT_CHECK(memcmp(expected.programs, actual.programs, sizeof(expected.programs)) == 0);
+    WINRT_CHECK(memcmp(expected.pitchBend, actual.pitchBend, sizeof(expected.pitchBend)) == 0);
+
+    WinRTMidiNetworkStats senderStats;
+    WinRTMidiNetworkStats receiverStats;
+    sender.GetStats(senderStats);
+    receiver.GetStats(receiverStats);
+    WINRT_CHECK_EQUAL(packets, senderStats.packetsSent);
+    WINRT_CHECK(senderStats.packetsInjectedLoss > 0);
+    WINRT_CHECK_EQUAL(senderStats.packetsSent - senderStats.packetsInjectedLoss, receiverStats.packetsReceived);
+
+    // packets dropped after the last one that arrived are never noticed
+    WINRT_CHECK(receiverStats.packetsLost > 0);
+    WINRT_CHECK(receiverStats.packetsLost <= senderStats.packetsInjectedLoss);
+    WINRT_CHECK_EQUAL(0, receiverStats.packetsLate);
+    WINRT_CHECK(receiverStats.journalRecoveries > 0);
+    WINRT_CHECK(receiverStats.journalRecoveries <= receiverStats.packetsLost);
+}
+
+int main()
+{
+    TestJitterBufferPlayout();
+    TestJournalRecovery();
+    return 0;
+}
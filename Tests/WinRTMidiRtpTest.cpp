@@ -0,0 +1,245 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiRtp.h"
+#include "WinRTMidiTest.h"
+#include <vector>
+
+using namespace WinRT;
+
+typedef std::vector<unsigned char> Bytes;
+
+struct Command
+{
+    unsigned int delta;
+    Bytes data;
+};
+
+static std::vector<Command> GetCommands(const WinRTMidiRtpPacketInfo& info)
+{
+    std::vector<Command> commands;
+    WINRT_CHECK(WinRTMidiRtpPacket::ForEachCommand(info.commands, info.commandSize, [&commands](unsigned int delta, const unsigned char* message, unsigned int nBytes)
+    {
+        commands.push_back({ delta, Bytes(message, message + nBytes) });
+    }));
+    return commands;
+}
+
+static void TestPacket()
+{
+    WinRTMidiRtpPacket packet;
+    packet.Begin(0x1234, 0x01020304, 0xDEADBEEF);
+    WINRT_CHECK(packet.IsEmpty());
+
+    unsigned char noteOn[3] = { 0x90, 60, 100 };
+    unsigned char controller[3] = { 0xB1, 7, 90 };
+    unsigned char program[2] = { 0xC2, 5 };
+    WINRT_CHECK_EQUAL(3, packet.Add(0, noteOn, 3));
+    WINRT_CHECK_EQUAL(3, packet.Add(300, controller, 3));
+    WINRT_CHECK_EQUAL(2, packet.Add(0x0FFFFFFF, program, 2));
+    WINRT_CHECK(!packet.IsEmpty());
+
+    unsigned int size = packet.Finish(nullptr);
+    WinRTMidiRtpPacketInfo info;
+    WINRT_CHECK(WinRTMidiRtpPacket::Parse(packet.GetData(), size, info));
+    WINRT_CHECK_EQUAL(0x1234, info.sequence);
+    WINRT_CHECK_EQUAL(0x01020304, info.timestamp);
+    WINRT_CHECK_EQUAL(0xDEADBEEF, info.ssrc);
+    WINRT_CHECK(info.journal == nullptr);
+
+    std::vector<Command> commands = GetCommands(info);
+    WINRT_CHECK_EQUAL(3, commands.size());
+    WINRT_CHECK_EQUAL(0, commands[0].delta);
+    WINRT_CHECK(commands[0].data == Bytes(noteOn, noteOn + 3));
+    WINRT_CHECK_EQUAL(300, commands[1].delta);
+    WINRT_CHECK(commands[1].data == Bytes(controller, controller + 3));
+    WINRT_CHECK_EQUAL(0x0FFFFFFF, commands[2].delta);
+    WINRT_CHECK(commands[2].data == Bytes(program, program + 2));
+
+    // not RTP version 2, another payload type, truncated
+    Bytes data(packet.GetData(), packet.GetData() + size);
+    data[0] = 0x40;
+    WINRT_CHECK(!WinRTMidiRtpPacket::Parse(data.data(), size, info));
+    data[0] = 0x80;
+    data[1] = 96;
+    WINRT_CHECK(!WinRTMidiRtpPacket::Parse(data.data(), size, info));
+    WINRT_CHECK(!WinRTMidiRtpPacket::Parse(packet.GetData(), kRtpHeaderSize, info));
+    WINRT_CHECK(!WinRTMidiRtpPacket::Parse(packet.GetData(), size - 1, info));
+
+    // a command cut off in its delta time, its length or its data
+    unsigned char delta[1] = { 0x81 };
+    unsigned char length[2] = { 0x00, 0x85 };
+    unsigned char message[4] = { 0x00, 0x03, 0x90, 60 };
+    auto ignore = [](unsigned int, const unsigned char*, unsigned int) {};
+    WINRT_CHECK(!WinRTMidiRtpPacket::ForEachCommand(delta, sizeof(delta), ignore));
+    WINRT_CHECK(!WinRTMidiRtpPacket::ForEachCommand(length, sizeof(length), ignore));
+    WINRT_CHECK(!WinRTMidiRtpPacket::ForEachCommand(message, sizeof(message), ignore));
+}
+
+static void TestSplit()
+{
+    // a SysEx message larger than a packet is split across packets in order
+    Bytes sysEx(1500);
+    sysEx.front() = 0xF0;
+    for (size_t i = 1; i < sysEx.size() - 1; i++)
+    {
+        sysEx[i] = (unsigned char)(i & 0x7F);
+    }
+    sysEx.back() = 0xF7;
+
+    WinRTMidiRtpPacket packet;
+    Bytes received;
+    unsigned int packets = 0;
+    unsigned int pos = 0;
+    while (pos < sysEx.size())
+    {
+        packet.Begin((unsigned short)packets, 0, 1);
+        unsigned int added = packet.Add(0, sysEx.data() + pos, (unsigned int)sysEx.size() - pos);
+        WINRT_CHECK(added > 0);
+        pos += added;
+        packets++;
+
+        unsigned int size = packet.Finish(nullptr);
+        WINRT_CHECK(size <= kRtpMaxPacketSize);
+
+        WinRTMidiRtpPacketInfo info;
+        WINRT_CHECK(WinRTMidiRtpPacket::Parse(packet.GetData(), size, info));
+        for (const auto& command : GetCommands(info))
+        {
+            received.insert(received.end(), command.data.begin(), command.data.end());
+        }
+    }
+
+    WINRT_CHECK(received == sysEx);
+    WINRT_CHECK_EQUAL((sysEx.size() + kRtpMaxUnsplitSize - 1) / kRtpMaxUnsplitSize, packets);
+
+    // a message that fits an empty packet is not split, it waits for the next packet
+    unsigned char noteOn[3] = { 0x90, 60, 100 };
+    Bytes large(kRtpMaxUnsplitSize, 0);
+    large.front() = 0xF0;
+    large.back() = 0xF7;
+    packet.Begin(0, 0, 1);
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        WINRT_CHECK_EQUAL(3, packet.Add(0, noteOn, 3));
+    }
+    WINRT_CHECK_EQUAL(0, packet.Add(0, large.data(), (unsigned int)large.size()));
+    packet.Begin(0, 0, 1);
+    WINRT_CHECK_EQUAL(large.size(), packet.Add(0, large.data(), (unsigned int)large.size()));
+}
+
+static void TestFeedback()
+{
+    unsigned char data[kRtpFeedbackSize];
+    WinRTMidiRtpPacket::WriteFeedback(data, 0x12345678, 0xABCD);
+
+    unsigned int ssrc;
+    unsigned short sequence;
+    WINRT_CHECK(WinRTMidiRtpPacket::ParseFeedback(data, sizeof(data), ssrc, sequence));
+    WINRT_CHECK_EQUAL(0x12345678, ssrc);
+    WINRT_CHECK_EQUAL(0xABCD, sequence);
+
+    WINRT_CHECK(!WinRTMidiRtpPacket::ParseFeedback(data, sizeof(data) - 1, ssrc, sequence));
+    data[2] = 'X';
+    WINRT_CHECK(!WinRTMidiRtpPacket::ParseFeedback(data, sizeof(data), ssrc, sequence));
+}
+
+static void Update(WinRTMidiRtpJournal& journal, unsigned int seq, unsigned char status, unsigned char data1, unsigned char data2)
+{
+    unsigned char message[3] = { status, data1, data2 };
+    journal.Update(message, (status & 0xF0) == 0xC0 ? 2 : 3, seq);
+}
+
+static void Send(WinRTMidiChannelState& state, unsigned char status, unsigned char data1, unsigned char data2)
+{
+    unsigned char message[3] = { status, data1, data2 };
+    state.Update(message, (status & 0xF0) == 0xC0 ? 2 : 3);
+}
+
+static void TestJournal()
+{
+    WinRTMidiRtpJournal journal;
+    unsigned char data[kRtpMaxPacketSize];
+    WINRT_CHECK_EQUAL(0, journal.Write(data, sizeof(data)));
+
+    // confirmed by the receiver: not in the journal
+    Update(journal, 1, 0x90, 40, 100);
+    Update(journal, 1, 0xB0, 10, 20);
+    journal.SetCheckpoint(1);
+    WINRT_CHECK_EQUAL(0, journal.Write(data, sizeof(data)));
+
+    // the receiver lost packets 2 and 3
+    Update(journal, 2, 0xB0, 7, 90);
+    Update(journal, 2, 0xC0, 12, 0);
+    Update(journal, 3, 0xE0, 0x00, 0x50);
+    Update(journal, 3, 0x80, 40, 0);
+    Update(journal, 3, 0x90, 62, 100);
+
+    unsigned int size = journal.Write(data, sizeof(data));
+    WINRT_CHECK(size > 0);
+    WINRT_CHECK_EQUAL(0, journal.Write(data, 10));
+
+    // the receiver has the state of packet 1
+    WinRTMidiChannelState receiver;
+    Send(receiver, 0x90, 40, 100);
+    Send(receiver, 0xB0, 10, 20);
+    WinRTMidiChannelStateSnapshot snapshot;
+    receiver.GetSnapshot(snapshot);
+
+    std::vector<Bytes> messages;
+    WinRTMidiRtpJournal::Recover(data, size, snapshot, [&messages](const unsigned char* message, unsigned int nBytes)
+    {
+        messages.push_back(Bytes(message, message + nBytes));
+    });
+
+    // controllers first, then program, pitch bend and the released note. Note 62 is not replayed
+    WINRT_CHECK_EQUAL(4, messages.size());
+    WINRT_CHECK(messages[0] == Bytes({ 0xB0, 7, 90 }));
+    WINRT_CHECK(messages[1] == Bytes({ 0xC0, 12 }));
+    WINRT_CHECK(messages[2] == Bytes({ 0xE0, 0x00, 0x50 }));
+    WINRT_CHECK(messages[3] == Bytes({ 0x80, 40, 64 }));
+
+    // a receiver that is up to date needs no repair
+    for (const auto& message : messages)
+    {
+        receiver.Update(message.data(), (unsigned int)message.size());
+    }
+    receiver.GetSnapshot(snapshot);
+    messages.clear();
+    WinRTMidiRtpJournal::Recover(data, size, snapshot, [&messages](const unsigned char* message, unsigned int nBytes)
+    {
+        messages.push_back(Bytes(message, message + nBytes));
+    });
+    WINRT_CHECK(messages.empty());
+
+    // a packet finished with the journal carries it
+    WinRTMidiRtpPacket packet;
+    unsigned char noteOn[3] = { 0x91, 50, 100 };
+    packet.Begin(4, 0, 1);
+    packet.Add(0, noteOn, 3);
+    unsigned int packetSize = packet.Finish(&journal);
+
+    WinRTMidiRtpPacketInfo info;
+    WINRT_CHECK(WinRTMidiRtpPacket::Parse(packet.GetData(), packetSize, info));
+    WINRT_CHECK_EQUAL(1, GetCommands(info).size());
+    WINRT_CHECK(info.journal != nullptr);
+    WINRT_CHECK_EQUAL(size, info.journalSize);
+}
+
+int main()
+{
+    TestPacket();
+    TestSplit();
+    TestFeedback();
+    TestJournal();
+    return 0;
+}
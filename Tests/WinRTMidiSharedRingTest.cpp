@@ -0,0 +1,459 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiSharedMemory.h"
+#include "WinRTMidiSharedRing.h"
+#include "WinRTMidiTest.h"
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace WinRT;
+
+#define kProducers 3
+#define kReaders 2
+#define kMessagesPerProcess 20000
+#define kRingCapacity 4096
+#define kBroadcastWindow 32         // messages the writer may be ahead of the slowest reader
+#define kControlSize 256
+#define kTimeoutSeconds 20
+
+// shared between the processes of a test, in front of the ring
+struct TestControl
+{
+    std::atomic<uint32_t> ready;
+    std::atomic<uint64_t> received[kReaders];
+};
+
+static std::string GetTestName(const char* name)
+{
+    return std::string("Test.") + name + "." + std::to_string(getpid());
+}
+
+// writes message number seq of a process: the process index, seq (4 bytes) and a payload
+// of 1 to 40 bytes. Returns the length
+static unsigned int MakeMessage(unsigned int process, uint32_t seq, unsigned char* message)
+{
+    unsigned int length = 5 + 1 + seq % 40;
+    message[0] = (unsigned char)process;
+    memcpy(message + 1, &seq, sizeof(seq));
+    for (unsigned int i = 5; i < length; i++)
+    {
+        message[i] = (unsigned char)(seq + i);
+    }
+    return length;
+}
+
+static bool CheckMessage(const unsigned char* message, unsigned int nBytes, unsigned int process, uint32_t seq)
+{
+    unsigned char expected[64];
+    unsigned int length = MakeMessage(process, seq, expected);
+    return nBytes == length && memcmp(message, expected, length) == 0;
+}
+
+static bool TimedOut(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::steady_clock::now() - start > std::chrono::seconds(kTimeoutSeconds);
+}
+
+static void WaitForChildren(const std::vector<pid_t>& children)
+{
+    for (pid_t child : children)
+    {
+        int status = 0;
+        WINRT_CHECK(waitpid(child, &status, 0) == child);
+        WINRT_CHECK(WIFEXITED(status));
+        WINRT_CHECK_EQUAL(0, WEXITSTATUS(status));
+    }
+}
+
+static void TestSharedMemory()
+{
+    std::string name = GetTestName("Memory");
+    WinRTMidiSharedMemory owner;
+    WINRT_CHECK_EQUAL(WINRT_NO_ERROR, owner.Create(name, 4096));
+    WINRT_CHECK_EQUAL(4096, owner.GetSize());
+
+    // a live owner keeps the name
+    WinRTMidiSharedMemory other;
+    WINRT_CHECK_EQUAL(WINRT_INVALID_PARAMETER_ERROR, other.Create(name, 4096));
+
+    WinRTMidiSharedMemory client;
+    WINRT_CHECK_EQUAL(WINRT_OPEN_PORT_ERROR, client.Open(name, 8192));
+    WINRT_CHECK_EQUAL(WINRT_NO_ERROR, client.Open(name, 4096));
+    ((unsigned char*)owner.GetData())[100] = 42;
+    WINRT_CHECK_EQUAL(42, ((unsigned char*)client.GetData())[100]);
+    client.Close();
+
+    owner.Close();
+    WINRT_CHECK_EQUAL(WINRT_OPEN_PORT_ERROR, client.Open(name, 4096));
+}
+
+static void TestStaleSharedMemory()
+{
+    std::string name = GetTestName("Stale");
+
+    // the child crashes without closing the block, which leaves the object behind
+    pid_t child = fork();
+    WINRT_CHECK(child >= 0);
+    if (child == 0)
+    {
+        WinRTMidiSharedMemory memory;
+        if (memory.Create(name, 4096) != WINRT_NO_ERROR)
+        {
+            _exit(1);
+        }
+        ((unsigned char*)memory.GetData())[0] = 1;
+        _exit(0);
+    }
+    WaitForChildren({ child });
+
+    WinRTMidiSharedMemory stale;
+    WINRT_CHECK_EQUAL(WINRT_NO_ERROR, stale.Open(name, 4096));
+    stale.Close();
+
+    // the stale object is replaced by a new zero filled one
+    WinRTMidiSharedMemory memory;
+    WINRT_CHECK_EQUAL(WINRT_NO_ERROR, memory.Create(name, 4096));
+    WINRT_CHECK_EQUAL(0, ((unsigned char*)memory.GetData())[0]);
+}
+
+static void* AttachRing(WinRTMidiSharedMemory& memory, const std::string& name, size_t size)
+{
+    if (memory.Open(name, size) != WINRT_NO_ERROR)
+    {
+        _exit(1);
+    }
+    return memory.GetData();
+}
+
+static void TestMpsc()
+{
+    std::string name = GetTestName("Mpsc");
+    size_t size = kControlSize + WinRTMidiSharedRing::GetMemorySize(kRingCapacity);
+    WinRTMidiSharedMemory memory;
+    WINRT_CHECK_EQUAL(WINRT_NO_ERROR, memory.Create(name, size));
+
+    WinRTMidiMpscRing ring;
+    unsigned char* ringMemory = (unsigned char*)memory.GetData() + kControlSize;
+    WINRT_CHECK(ring.Initialize(ringMemory, size - kControlSize, SharedRingMpsc));
+
+    // producers in separate processes write concurrently
+    std::vector<pid_t> children;
+    for (unsigned int producer = 0; producer < kProducers; producer++)
+    {
+        pid_t child = fork();
+        WINRT_CHECK(child >= 0);
+        if (child == 0)
+        {
+            WinRTMidiSharedMemory shared;
+            WinRTMidiMpscRing producerRing;
+            unsigned char* data = (unsigned char*)AttachRing(shared, name, size);
+            if (!producerRing.Attach(data + kControlSize, size - kControlSize, SharedRingMpsc))
+            {
+                _exit(1);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t seq = 0; seq < kMessagesPerProcess; seq++)
+            {
+                unsigned char message[64];
+                unsigned int length = MakeMessage(producer, seq, message);
+                while (!producerRing.Write(seq, message, length))
+                {
+                    if (TimedOut(start))
+                    {
+                        _exit(1);
+                    }
+                    sched_yield();
+                }
+            }
+            _exit(0);
+        }
+        children.push_back(child);
+    }
+
+    // every message arrives once, in the order of its producer
+    uint32_t next[kProducers] = { 0 };
+    unsigned int received = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (received < kProducers * kMessagesPerProcess)
+    {
+        long long time;
+        unsigned int nBytes;
+        const unsigned char* message = ring.Peek(time, nBytes);
+        if (message == nullptr)
+        {
+            WINRT_CHECK(!TimedOut(start));
+            sched_yield();
+            continue;
+        }
+
+        unsigned int producer = message[0];
+        WINRT_CHECK(producer < kProducers);
+        WINRT_CHECK_EQUAL(next[producer], time);
+        WINRT_CHECK(CheckMessage(message, nBytes, producer, next[producer]));
+        next[producer]++;
+        received++;
+        ring.Consume();
+    }
+
+    long long time;
+    unsigned int nBytes;
+    WINRT_CHECK(ring.Peek(time, nBytes) == nullptr);
+    WaitForChildren(children);
+}
+
+static void TestBroadcast()
+{
+    std::string name = GetTestName("Broadcast");
+    size_t size = kControlSize + WinRTMidiSharedRing::GetMemorySize(kRingCapacity);
+    WinRTMidiSharedMemory memory;
+    WINRT_CHECK_EQUAL(WINRT_NO_ERROR, memory.Create(name, size));
+
+    TestControl* control = new (memory.GetData()) TestControl();
+    WinRTMidiBroadcastRing ring;
+    unsigned char* ringMemory = (unsigned char*)memory.GetData() + kControlSize;
+    WINRT_CHECK(ring.Initialize(ringMemory, size - kControlSize, SharedRingBroadcast));
+
+    // every reader process sees every message in order
+    std::vector<pid_t> children;
+    for (unsigned int reader = 0; reader < kReaders; reader++)
+    {
+        pid_t child = fork();
+        WINRT_CHECK(child >= 0);
+        if (child == 0)
+        {
+            WinRTMidiSharedMemory shared;
+            WinRTMidiBroadcastRing readerRing;
+            unsigned char* data = (unsigned char*)AttachRing(shared, name, size);
+            TestControl* readerControl = (TestControl*)data;
+            if (!readerRing.Attach(data + kControlSize, size - kControlSize, SharedRingBroadcast))
+            {
+                _exit(1);
+            }
+
+            WinRTMidiBroadcastRing::Reader position;
+            readerRing.InitReader(position);
+            readerControl->ready++;
+
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t seq = 0; seq < kMessagesPerProcess;)
+            {
+                long long time;
+                unsigned int nBytes;
+                const unsigned char* message = readerRing.Read(position, time, nBytes);
+                if (message == nullptr)
+                {
+                    if (position.lost != 0 || TimedOut(start))
+                    {
+                        _exit(1);
+                    }
+                    sched_yield();
+                    continue;
+                }
+
+                if (time != seq || !CheckMessage(message, nBytes, 0, seq))
+                {
+                    _exit(1);
+                }
+                readerControl->received[reader] = ++seq;
+            }
+            _exit(0);
+        }
+        children.push_back(child);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (control->ready < kReaders)
+    {
+        WINRT_CHECK(!TimedOut(start));
+        sched_yield();
+    }
+
+    // the writer never waits for readers, so the test keeps it within a window of the slowest reader
+    for (uint32_t seq = 0; seq < kMessagesPerProcess; seq++)
+    {
+        for (unsigned int reader = 0; reader < kReaders; reader++)
+        {
+            while (seq - control->received[reader] >= kBroadcastWindow)
+            {
+                WINRT_CHECK(!TimedOut(start));
+                sched_yield();
+            }
+        }
+
+        unsigned char message[64];
+        unsigned int length = MakeMessage(0, seq, message);
+        WINRT_CHECK(ring.Write(seq, message, length));
+    }
+
+    WaitForChildren(children);
+}
+
+static void TestBroadcastOverrun()
+{
+    std::vector<unsigned char> memory(WinRTMidiSharedRing::GetMemorySize(kRingCapacity));
+    WinRTMidiBroadcastRing ring;
+    WINRT_CHECK(ring.Initialize(memory.data(), memory.size(), SharedRingBroadcast));
+
+    WinRTMidiBroadcastRing::Reader reader;
+    ring.InitReader(reader);
+
+    // a reader that falls a ring size behind skips to the newest message
+    unsigned char message[64];
+    for (uint32_t seq = 0; seq < 1000; seq++)
+    {
+        WINRT_CHECK(ring.Write(seq, message, MakeMessage(0, seq, message)));
+    }
+
+    long long time;
+    unsigned int nBytes;
+    WINRT_CHECK(ring.Read(reader, time, nBytes) == nullptr);
+    WINRT_CHECK_EQUAL(1, reader.lost);
+
+    WINRT_CHECK(ring.Write(1000, message, MakeMessage(0, 1000, message)));
+    const unsigned char* data = ring.Read(reader, time, nBytes);
+    WINRT_CHECK(data != nullptr);
+    WINRT_CHECK_EQUAL(1000, time);
+    WINRT_CHECK(CheckMessage(data, nBytes, 0, 1000));
+    WINRT_CHECK(ring.Read(reader, time, nBytes) == nullptr);
+    WINRT_CHECK_EQUAL(1, reader.lost);
+
+    // the copying read skips ahead the same way
+    for (uint32_t seq = 0; seq < 1000; seq++)
+    {
+        WINRT_CHECK(ring.Write(seq, message, MakeMessage(0, seq, message)));
+    }
+
+    std::vector<unsigned char> buffer(ring.GetMaxMessageSize());
+    WINRT_CHECK(!ring.Read(reader, time, buffer.data(), nBytes));
+    WINRT_CHECK_EQUAL(2, reader.lost);
+
+    WINRT_CHECK(ring.Write(1001, message, MakeMessage(0, 1001, message)));
+    WINRT_CHECK(ring.Read(reader, time, buffer.data(), nBytes));
+    WINRT_CHECK_EQUAL(1001, time);
+    WINRT_CHECK(CheckMessage(buffer.data(), nBytes, 0, 1001));
+    WINRT_CHECK(!ring.Read(reader, time, buffer.data(), nBytes));
+
+    // oversized messages are rejected
+    std::vector<unsigned char> large(ring.GetMaxMessageSize() + 1);
+    WINRT_CHECK(!ring.Write(0, large.data(), (unsigned int)large.size()));
+}
+
+// a writer that writes bursts larger than the ring overruns the reader again and again. The copying
+// read drops the messages overwritten while they were copied, so every message it returns is intact
+static void TestBroadcastUnpaced()
+{
+    std::string name = GetTestName("Unpaced");
+    size_t size = kControlSize + WinRTMidiSharedRing::GetMemorySize(kRingCapacity);
+    WinRTMidiSharedMemory memory;
+    WINRT_CHECK_EQUAL(WINRT_NO_ERROR, memory.Create(name, size));
+
+    // ready is set by the reader, received[0] by the writer when it is done
+    TestControl* control = new (memory.GetData()) TestControl();
+    WinRTMidiBroadcastRing ring;
+    WINRT_CHECK(ring.Initialize((unsigned char*)memory.GetData() + kControlSize, size - kControlSize, SharedRingBroadcast));
+
+    pid_t child = fork();
+    WINRT_CHECK(child >= 0);
+    if (child == 0)
+    {
+        WinRTMidiSharedMemory shared;
+        WinRTMidiBroadcastRing writerRing;
+        unsigned char* data = (unsigned char*)AttachRing(shared, name, size);
+        TestControl* writerControl = (TestControl*)data;
+        if (!writerRing.Attach(data + kControlSize, size - kControlSize, SharedRingBroadcast))
+        {
+            _exit(1);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        while (writerControl->ready == 0)
+        {
+            if (TimedOut(start))
+            {
+                _exit(1);
+            }
+            sched_yield();
+        }
+
+        for (uint32_t seq = 0; seq < kMessagesPerProcess * 10; seq++)
+        {
+            unsigned char message[64];
+            writerRing.Write(seq, message, MakeMessage(0, seq, message));
+
+            // the end of every burst is written slowly so the reader catches up
+            if (seq % 500 >= 450)
+            {
+                sched_yield();
+            }
+        }
+        writerControl->received[0] = 1;
+        _exit(0);
+    }
+
+    WinRTMidiBroadcastRing::Reader reader;
+    ring.InitReader(reader);
+    control->ready = 1;
+
+    std::vector<unsigned char> buffer(ring.GetMaxMessageSize());
+    unsigned long long received = 0;
+    long long last = -1;
+    for (;;)
+    {
+        bool done = control->received[0] != 0;
+        long long time;
+        unsigned int nBytes;
+        if (!ring.Read(reader, time, buffer.data(), nBytes))
+        {
+            if (done)
+            {
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+
+        // a slow listener: the writer runs before the message is checked. A message read in place
+        // would be overwritten by then
+        sched_yield();
+
+        uint32_t seq;
+        memcpy(&seq, buffer.data() + 1, sizeof(seq));
+        WINRT_CHECK_EQUAL(seq, time);
+        WINRT_CHECK(CheckMessage(buffer.data(), nBytes, 0, seq));
+        WINRT_CHECK(time > last);
+        last = time;
+        received++;
+    }
+
+    WaitForChildren({ child });
+    WINRT_CHECK(received > 0);
+    WINRT_CHECK(reader.lost > 0);
+}
+
+int main()
+{
+    TestSharedMemory();
+    TestStaleSharedMemory();
+    TestMpsc();
+    TestBroadcast();
+    TestBroadcastOverrun();
+    TestBroadcastUnpaced();
+    return 0;
+}
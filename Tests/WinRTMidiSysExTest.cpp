@@ -0,0 +1,227 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiSysEx.h"
+#include "WinRTMidiTest.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace WinRT;
+
+#define kMaxTestLength 300
+#define kGuardBytes 32
+#define kGuardValue 0xCD
+#define kBenchmarkLength (64 * 1024)
+#define kBenchmarkIterations 2000
+
+// reference versions written bit by bit, independent of the library code
+static std::vector<unsigned char> ReferencePack(const std::vector<unsigned char>& data)
+{
+    std::vector<unsigned char> packed;
+    for (size_t group = 0; group < data.size(); group += 7)
+    {
+        size_t header = packed.size();
+        packed.push_back(0);
+        for (size_t i = group; i < data.size() && i < group + 7; i++)
+        {
+            if (data[i] & 0x80)
+            {
+                packed[header] |= (unsigned char)(1 << (i - group));
+            }
+            packed.push_back(data[i] & 0x7F);
+        }
+    }
+    return packed;
+}
+
+static std::vector<unsigned char> ReferenceUnpack(const std::vector<unsigned char>& packed)
+{
+    std::vector<unsigned char> data;
+    for (size_t group = 0; group < packed.size(); group += 8)
+    {
+        for (size_t i = group + 1; i < packed.size() && i < group + 8; i++)
+        {
+            bool high = ((packed[group] >> (i - group - 1)) & 1) != 0;
+            data.push_back((unsigned char)((packed[i] & 0x7F) | (high ? 0x80 : 0)));
+        }
+    }
+    return data;
+}
+
+static unsigned char ReferenceChecksum(const std::vector<unsigned char>& data)
+{
+    unsigned int sum = 0;
+    for (unsigned char value : data)
+    {
+        sum = (sum + value) % 128;
+    }
+    return (unsigned char)((128 - sum) % 128);
+}
+
+static void CheckGuard(const std::vector<unsigned char>& buffer, size_t offset)
+{
+    for (size_t i = offset; i < buffer.size(); i++)
+    {
+        WINRT_CHECK_EQUAL(kGuardValue, buffer[i]);
+    }
+}
+
+static void TestPack(std::mt19937& random)
+{
+    for (unsigned int length = 0; length <= kMaxTestLength; length++)
+    {
+        // the input is read at every alignment
+        for (unsigned int offset = 0; offset < 4; offset++)
+        {
+            std::vector<unsigned char> input(offset + length);
+            for (auto& value : input)
+            {
+                value = (unsigned char)random();
+            }
+
+            std::vector<unsigned char> data(input.begin() + offset, input.end());
+            std::vector<unsigned char> expected = ReferencePack(data);
+            WINRT_CHECK_EQUAL(expected.size(), SysExPackedSize(length));
+
+            std::vector<unsigned char> packed(expected.size() + kGuardBytes, kGuardValue);
+            WINRT_CHECK_EQUAL(expected.size(), PackSysEx(input.data() + offset, length, packed.data()));
+            WINRT_CHECK(std::equal(expected.begin(), expected.end(), packed.begin()));
+            CheckGuard(packed, expected.size());
+
+            std::vector<unsigned char> scalar(expected.size() + kGuardBytes, kGuardValue);
+            WINRT_CHECK_EQUAL(expected.size(), PackSysExScalar(input.data() + offset, length, scalar.data()));
+            WINRT_CHECK(scalar == packed);
+        }
+    }
+}
+
+static void TestUnpack(std::mt19937& random)
+{
+    // every packed length, including a trailing header without data
+    for (unsigned int length = 0; length <= kMaxTestLength; length++)
+    {
+        for (unsigned int offset = 0; offset < 4; offset++)
+        {
+            std::vector<unsigned char> input(offset + length);
+            for (auto& value : input)
+            {
+                value = (unsigned char)(random() & 0x7F);
+            }
+
+            std::vector<unsigned char> packed(input.begin() + offset, input.end());
+            std::vector<unsigned char> expected = ReferenceUnpack(packed);
+            WINRT_CHECK_EQUAL(expected.size(), SysExUnpackedSize(length));
+
+            std::vector<unsigned char> data(expected.size() + kGuardBytes, kGuardValue);
+            WINRT_CHECK_EQUAL(expected.size(), UnpackSysEx(input.data() + offset, length, data.data()));
+            WINRT_CHECK(std::equal(expected.begin(), expected.end(), data.begin()));
+            CheckGuard(data, expected.size());
+
+            std::vector<unsigned char> scalar(expected.size() + kGuardBytes, kGuardValue);
+            WINRT_CHECK_EQUAL(expected.size(), UnpackSysExScalar(input.data() + offset, length, scalar.data()));
+            WINRT_CHECK(scalar == data);
+        }
+    }
+}
+
+static void TestRoundTrip(std::mt19937& random)
+{
+    for (unsigned int length = 0; length <= kMaxTestLength; length++)
+    {
+        std::vector<unsigned char> data(length);
+        for (auto& value : data)
+        {
+            value = (unsigned char)random();
+        }
+
+        std::vector<unsigned char> packed(SysExPackedSize(length));
+        std::vector<unsigned char> unpacked(length + kGuardBytes, kGuardValue);
+        PackSysEx(data.data(), length, packed.data());
+        WINRT_CHECK_EQUAL(length, UnpackSysEx(packed.data(), (unsigned int)packed.size(), unpacked.data()));
+        WINRT_CHECK(std::equal(data.begin(), data.end(), unpacked.begin()));
+        CheckGuard(unpacked, length);
+    }
+}
+
+static void TestChecksum(std::mt19937& random)
+{
+    for (unsigned int length = 0; length <= kMaxTestLength; length++)
+    {
+        std::vector<unsigned char> data(length);
+        for (auto& value : data)
+        {
+            value = (unsigned char)random();
+        }
+
+        unsigned char expected = ReferenceChecksum(data);
+        WINRT_CHECK_EQUAL(expected, RolandChecksum(data.data(), length));
+        WINRT_CHECK_EQUAL(expected, RolandChecksumScalar(data.data(), length));
+    }
+
+    // the sum of 0xFF bytes overflows 16 bits
+    std::vector<unsigned char> ones(70000, 0xFF);
+    WINRT_CHECK_EQUAL(ReferenceChecksum(ones), RolandChecksum(ones.data(), (unsigned int)ones.size()));
+}
+
+template <typename Func>
+static void Benchmark(const char* name, unsigned int nBytes, Func func)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < kBenchmarkIterations; i++)
+    {
+        func();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%-24s %8.1f MB/s\n", name, (double)nBytes * kBenchmarkIterations / seconds / 1000000.0);
+}
+
+static void RunBenchmarks(std::mt19937& random)
+{
+    std::vector<unsigned char> data(kBenchmarkLength);
+    for (auto& value : data)
+    {
+        value = (unsigned char)random();
+    }
+
+    std::vector<unsigned char> packed(SysExPackedSize(kBenchmarkLength));
+    std::vector<unsigned char> unpacked(kBenchmarkLength);
+    unsigned int nPacked = (unsigned int)packed.size();
+    volatile unsigned char checksum = 0;
+
+    Benchmark("PackSysExScalar", kBenchmarkLength, [&] { PackSysExScalar(data.data(), kBenchmarkLength, packed.data()); });
+    Benchmark("PackSysEx", kBenchmarkLength, [&] { PackSysEx(data.data(), kBenchmarkLength, packed.data()); });
+    Benchmark("UnpackSysExScalar", nPacked, [&] { UnpackSysExScalar(packed.data(), nPacked, unpacked.data()); });
+    Benchmark("UnpackSysEx", nPacked, [&] { UnpackSysEx(packed.data(), nPacked, unpacked.data()); });
+    Benchmark("RolandChecksumScalar", kBenchmarkLength, [&] { checksum = RolandChecksumScalar(data.data(), kBenchmarkLength); });
+    Benchmark("RolandChecksum", kBenchmarkLength, [&] { checksum = RolandChecksum(data.data(), kBenchmarkLength); });
+}
+
+// pass --benchmark to also time the SSE2 and scalar versions
+int main(int argc, char* argv[])
+{
+    std::mt19937 random(1234);
+    TestPack(random);
+    TestUnpack(random);
+    TestRoundTrip(random);
+    TestChecksum(random);
+
+    if (argc > 1 && strcmp(argv[1], "--benchmark") == 0)
+    {
+        RunBenchmarks(random);
+    }
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiTempoMap.h"
+#include "WinRTMidiTest.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace WinRT;
+
+static bool Near(double expected, double actual)
+{
+    return std::fabs(expected - actual) < 1e-6 * std::max(1.0, std::fabs(expected));
+}
+
+static void TestConstantTempo()
+{
+    // 120 bpm at 480 ppq: a quarter note is 500 ms
+    WinRTMidiTempoMap map(480, 120.0);
+    WINRT_CHECK(Near(0.0, map.TickToTime(0)));
+    WINRT_CHECK(Near(500000.0, map.TickToTime(480)));
+    WINRT_CHECK(Near(250000.0, map.TickToTime(240)));
+    WINRT_CHECK(Near(960.0, map.TimeToTick(1000000.0)));
+    WINRT_CHECK(Near(120.0, map.GetTempo(100000)));
+}
+
+static void TestTempoChanges()
+{
+    WinRTMidiTempoMap map(480, 120.0);
+    map.SetTempo(960, 60.0);
+    map.SetTempo(1920, 240.0);
+
+    // 960 ticks at 120 bpm, 960 at 60 bpm, then 480 at 240 bpm
+    WINRT_CHECK(Near(1000000.0, map.TickToTime(960)));
+    WINRT_CHECK(Near(3000000.0, map.TickToTime(1920)));
+    WINRT_CHECK(Near(3250000.0, map.TickToTime(2400)));
+    WINRT_CHECK(Near(120.0, map.GetTempo(959)));
+    WINRT_CHECK(Near(60.0, map.GetTempo(960)));
+    WINRT_CHECK(Near(240.0, map.GetTempo(5000)));
+
+    WINRT_CHECK(Near(960.0, map.TimeToTick(1000000.0)));
+    WINRT_CHECK(Near(1440.0, map.TimeToTick(2000000.0)));
+    WINRT_CHECK(Near(2400.0, map.TimeToTick(3250000.0)));
+
+    // the lookup cursor moves forward and back
+    for (int tick = 3000; tick >= 0; tick -= 7)
+    {
+        WINRT_CHECK(Near(tick, map.TimeToTick(map.TickToTime(tick))));
+    }
+    for (int tick = 0; tick <= 3000; tick += 13)
+    {
+        WINRT_CHECK(Near(tick, map.TimeToTick(map.TickToTime(tick))));
+    }
+}
+
+static void TestEditing()
+{
+    WinRTMidiTempoMap map(480, 120.0);
+    map.SetTempo(960, 60.0);
+    map.SetTempo(1920, 240.0);
+    WINRT_CHECK(Near(3250000.0, map.TickToTime(2400)));
+
+    // replacing a tempo moves the segments after it
+    map.SetTempo(960, 120.0);
+    WINRT_CHECK(Near(2000000.0, map.TickToTime(1920)));
+    WINRT_CHECK(Near(2250000.0, map.TickToTime(2400)));
+
+    // so does changing the tempo at tick 0
+    map.SetTempo(0, 60.0);
+    WINRT_CHECK(Near(2000000.0, map.TickToTime(960)));
+    WINRT_CHECK(Near(3000000.0, map.TickToTime(1920)));
+
+    WINRT_CHECK(!map.RemoveTempo(0));
+    WINRT_CHECK(!map.RemoveTempo(100));
+    WINRT_CHECK(map.RemoveTempo(960));
+    WINRT_CHECK(!map.RemoveTempo(960));
+    WINRT_CHECK(Near(4000000.0, map.TickToTime(1920)));
+    WINRT_CHECK(Near(4250000.0, map.TickToTime(2400)));
+
+    // a tempo change before the last lookup
+    WINRT_CHECK(Near(60.0, map.GetTempo(1000)));
+    map.SetTempo(480, 120.0);
+    WINRT_CHECK(Near(120.0, map.GetTempo(1000)));
+    WINRT_CHECK(Near(2500000.0, map.TickToTime(1920)));
+}
+
+int main()
+{
+    TestConstantTempo();
+    TestTempoChanges();
+    TestEditing();
+    return 0;
+}
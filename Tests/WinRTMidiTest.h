@@ -0,0 +1,40 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+// Minimal checks for the standalone tests of the portable WinRTMidi sources.
+// A failed check prints its location and ends the test with a non-zero exit code
+#define WINRT_CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition); \
+            exit(1); \
+        } \
+    } while (0)
+
+#define WINRT_CHECK_EQUAL(expected, actual) \
+    do \
+    { \
+        long long e = (long long)(expected); \
+        long long a = (long long)(actual); \
+        if (e != a) \
+        { \
+            printf("%s(%d): expected %s == %lld, got %lld\n", __FILE__, __LINE__, #actual, e, a); \
+            exit(1); \
+        } \
+    } while (0)
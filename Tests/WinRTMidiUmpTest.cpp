@@ -0,0 +1,159 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+
+#include "WinRTMidiUmp.h"
+#include "WinRTMidiTest.h"
+
+using namespace WinRT;
+
+// the min-center-max scaling reference of the MIDI 2.0 specification
+static unsigned int ScaleUpReference(unsigned int value, unsigned int srcBits, unsigned int dstBits)
+{
+    unsigned int scaleBits = dstBits - srcBits;
+    unsigned long long result = (unsigned long long)value << scaleBits;
+    unsigned int center = 1u << (srcBits - 1);
+    if (value <= center)
+    {
+        return (unsigned int)result;
+    }
+
+    unsigned int repeatBits = srcBits - 1;
+    unsigned long long repeat = value & ((1u << repeatBits) - 1);
+    if (scaleBits > repeatBits)
+    {
+        repeat <<= scaleBits - repeatBits;
+    }
+    else
+    {
+        repeat >>= repeatBits - scaleBits;
+    }
+
+    while (repeat != 0)
+    {
+        result |= repeat;
+        repeat >>= repeatBits;
+    }
+
+    return (unsigned int)result;
+}
+
+static void TestScaleUp()
+{
+    WINRT_CHECK_EQUAL(0x0000, ScaleUp7To16(0));
+    WINRT_CHECK_EQUAL(0x8000, ScaleUp7To16(0x40));
+    WINRT_CHECK_EQUAL(0xFFFF, ScaleUp7To16(0x7F));
+    WINRT_CHECK_EQUAL(0x00000000u, ScaleUp7To32(0));
+    WINRT_CHECK_EQUAL(0x80000000u, ScaleUp7To32(0x40));
+    WINRT_CHECK_EQUAL(0xFFFFFFFFu, ScaleUp7To32(0x7F));
+    WINRT_CHECK_EQUAL(0x00000000u, ScaleUp14To32(0));
+    WINRT_CHECK_EQUAL(0x80000000u, ScaleUp14To32(0x2000));
+    WINRT_CHECK_EQUAL(0xFFFFFFFFu, ScaleUp14To32(0x3FFF));
+
+    for (unsigned int value = 0; value < 0x80; value++)
+    {
+        WINRT_CHECK_EQUAL(ScaleUpReference(value, 7, 16), ScaleUp7To16(value));
+        WINRT_CHECK_EQUAL(ScaleUpReference(value, 7, 32), ScaleUp7To32(value));
+    }
+
+    for (unsigned int value = 0; value < 0x4000; value++)
+    {
+        WINRT_CHECK_EQUAL(ScaleUpReference(value, 14, 32), ScaleUp14To32(value));
+    }
+}
+
+static unsigned int Pack(unsigned int status, unsigned int data1, unsigned int data2)
+{
+    return status | (data1 << 8) | (data2 << 16);
+}
+
+static void TestMidi1ToUmp64()
+{
+    unsigned int words[2];
+
+    // note on, channel 3, group 1
+    Midi1ToUmp64(Pack(0x93, 60, 0x7F), 1, words);
+    WINRT_CHECK_EQUAL(0x41933C00u, words[0]);
+    WINRT_CHECK_EQUAL(0xFFFF0000u, words[1]);
+
+    // a note on with velocity 0 becomes a note off with velocity 0x8000
+    Midi1ToUmp64(Pack(0x93, 60, 0), 1, words);
+    WINRT_CHECK_EQUAL(0x41833C00u, words[0]);
+    WINRT_CHECK_EQUAL(0x80000000u, words[1]);
+
+    Midi1ToUmp64(Pack(0xB0, 7, 0x40), 0, words);
+    WINRT_CHECK_EQUAL(0x40B00700u, words[0]);
+    WINRT_CHECK_EQUAL(0x80000000u, words[1]);
+
+    Midi1ToUmp64(Pack(0xC5, 0x12, 0), 0, words);
+    WINRT_CHECK_EQUAL(0x40C50000u, words[0]);
+    WINRT_CHECK_EQUAL(0x12000000u, words[1]);
+
+    Midi1ToUmp64(Pack(0xD0, 0x7F, 0), 0, words);
+    WINRT_CHECK_EQUAL(0x40D00000u, words[0]);
+    WINRT_CHECK_EQUAL(0xFFFFFFFFu, words[1]);
+
+    // pitch bend center and maximum
+    Midi1ToUmp64(Pack(0xE0, 0x00, 0x40), 0, words);
+    WINRT_CHECK_EQUAL(0x40E00000u, words[0]);
+    WINRT_CHECK_EQUAL(0x80000000u, words[1]);
+    Midi1ToUmp64(Pack(0xE0, 0x7F, 0x7F), 0, words);
+    WINRT_CHECK_EQUAL(0xFFFFFFFFu, words[1]);
+}
+
+static void TestUmp64ToMidi1()
+{
+    // the note off made from a note on with velocity 0 has velocity 0x40
+    unsigned int noteOff[2] = { 0x41833C00u, 0x80000000u };
+    WINRT_CHECK_EQUAL(Pack(0x83, 60, 0x40), Ump64ToMidi1(noteOff));
+
+    // a note on velocity that scales down to 0 is sent as 1
+    unsigned int noteOn[2] = { 0x40903C00u, 0x01000000u };
+    WINRT_CHECK_EQUAL(Pack(0x90, 60, 1), Ump64ToMidi1(noteOn));
+
+    unsigned int bend[2] = { 0x40E00000u, 0x80000000u };
+    WINRT_CHECK_EQUAL(Pack(0xE0, 0x00, 0x40), Ump64ToMidi1(bend));
+}
+
+static void TestRoundTrip()
+{
+    unsigned int words[2];
+    for (unsigned int type = 0x8; type <= 0xE; type++)
+    {
+        unsigned int status = (type << 4) | (type & 0xF);
+        for (unsigned int data1 = 0; data1 < 0x80; data1++)
+        {
+            for (unsigned int data2 = 0; data2 < 0x80; data2++)
+            {
+                // program change and channel pressure have a single data byte
+                if ((type == 0xC || type == 0xD) && data2 != 0)
+                {
+                    break;
+                }
+
+                unsigned int message = Pack(status, data1, data2);
+                Midi1ToUmp64(message, 0, words);
+                unsigned int expected = type == 0x9 && data2 == 0 ? Pack(status ^ 0x10, data1, 0x40) : message;
+                WINRT_CHECK_EQUAL(expected, Ump64ToMidi1(words));
+            }
+        }
+    }
+}
+
+int main()
+{
+    TestScaleUp();
+    TestMidi1ToUmp64();
+    TestUmp64ToMidi1();
+    TestRoundTrip();
+    return 0;
+}
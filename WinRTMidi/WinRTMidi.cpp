@@ -13,14 +13,75 @@
 #include "WinRTMidi.h"
 #include "WinRTMidiImpl.h"
 #include "WinRTMidiportWatcher.h"
+#include "WinRTMidiRecorder.h"
+#include "WinRTMidiPlayer.h"
+#include "WinRTMidiScheduler.h"
+#include "WinRTMidiBlockSender.h"
+#include "WinRTMidiCapture.h"
+#include "WinRTMidiClockGenerator.h"
+#include "WinRTMidiSysEx.h"
+#include "WinRTMidiSysExStream.h"
+#include "WinRTMidiMerge.h"
+#include "WinRTMidiBroker.h"
+#include "WinRTMidiNetwork.h"
+#include "WinRTMidiHandleTable.h"
 #include <wrl\wrappers\corewrappers.h>
 
 namespace WinRT
 {
+    // port handles are generation tagged slots, so a freed handle is rejected instead of being dereferenced
+    static WinRTMidiHandleTable<MidiInPortWrapper, kMaxOpenInPorts> sMidiInPorts;
+    static WinRTMidiHandleTable<MidiOutPortWrapper, kMaxOpenOutPorts> sMidiOutPorts;
+
+    static MidiInPortWrapper* GetMidiInPortWrapper(WinRTMidiInPortPtr port)
+    {
+        return sMidiInPorts.Get(port);
+    }
+
+    static MidiOutPortWrapper* GetMidiOutPortWrapper(WinRTMidiOutPortPtr port)
+    {
+        return sMidiOutPorts.Get(port);
+    }
+
+    static WinRTMidiErrorType CreateMidiInPortHandle(WinRTMidiInPort^ port, WinRTMidiInCallback callback, WinRTMidiInPortPtr* midiPort)
+    {
+        *midiPort = sMidiInPorts.Create(port, callback);
+        if (*midiPort == nullptr)
+        {
+            port->ClosePort();
+            return WINRT_MEMORY_ERROR;
+        }
+
+        return WINRT_NO_ERROR;
+    }
+
+    static WinRTMidiErrorType CreateMidiOutPortHandle(WinRTMidiOutPort^ port, WinRTMidiOutPortPtr* midiPort)
+    {
+        *midiPort = sMidiOutPorts.Create(port);
+        if (*midiPort == nullptr)
+        {
+            port->ClosePort();
+            return WINRT_MEMORY_ERROR;
+        }
+
+        return WINRT_NO_ERROR;
+    }
+
     WinRTMidiErrorType winrt_initialize_midi(MidiPortChangedCallback callback, WinRTMidiPtr* winrtMidi)
+    {
+        return winrt_initialize_midi_ex(callback, nullptr, winrtMidi);
+    }
+
+    WinRTMidiErrorType winrt_initialize_midi_ex(MidiPortChangedCallback callback, const WinRTMidiConfig* config, WinRTMidiPtr* winrtMidi)
     {
         *winrtMidi = nullptr;
 
+        WinRTMidiConfig resolved;
+        if (WinRTMidi::GetConfig(config, resolved) != WINRT_NO_ERROR)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
         // Initialize the Windows Runtime.
         static Microsoft::WRL::Wrappers::RoInitializeWrapper initialize(RO_INIT_MULTITHREADED);
 
@@ -36,7 +97,7 @@ namespace WinRT
         }
 
         // attempt to initialize the Midi Portwatchers
-        WinRTMidi* midi = new WinRTMidi(callback);
+        WinRTMidi* midi = new WinRTMidi(callback, resolved);
         WinRTMidiErrorType result = midi->Initialize();
         if(result != WINRT_NO_ERROR)
         {
@@ -53,9 +114,10 @@ namespace WinRT
 
     void winrt_free_midi(WinRTMidiPtr midi)
     {
-        if (midi)
+        WinRTMidi* midiPtr = (WinRTMidi*)midi;
+        if (midiPtr)
         {
-            delete midi;
+            delete midiPtr;
         }
     }
 
@@ -65,6 +127,30 @@ namespace WinRT
         return midiPtr->GetPortWatcherWrapper(type);
     }
 
+    WinRTMidiErrorType winrt_enable_input_dispatcher(WinRTMidiPtr midi, const WinRTMidiDispatcherConfig* config)
+    {
+        WinRTMidi* midiPtr = (WinRTMidi*)midi;
+
+        if (midiPtr == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return midiPtr->EnableInputDispatcher(config ? *config : midiPtr->GetDispatcherConfig());
+    }
+
+    WinRTMidiErrorType winrt_get_input_dispatcher_stats(WinRTMidiPtr midi, WinRTMidiDispatcherStats* stats)
+    {
+        WinRTMidi* midiPtr = (WinRTMidi*)midi;
+
+        if (midiPtr == nullptr || stats == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return midiPtr->GetInputDispatcherStats(*stats) ? WINRT_NO_ERROR : WINRT_INVALID_PARAMETER_ERROR;
+    }
+
     WinRTMidiErrorType winrt_open_midi_in_port(WinRTMidiPtr midi, unsigned int index, WinRTMidiInCallback callback, WinRTMidiInPortPtr* midiPort)
     {
         *midiPort = nullptr;
@@ -84,64 +170,1244 @@ namespace WinRT
         }
 
         auto port = ref new WinRTMidiInPort;
-        result = port->OpenPort(id);
+        midiPtr->ConfigurePort(port);
+        port->SetNetworkConfig(midiPtr->GetNetworkConfig());
+        auto virtualPort = midiPtr->GetVirtualPort(id);
+        result = virtualPort ? port->OpenVirtualPort(virtualPort) : port->OpenPort(id);
+        if (result == WINRT_NO_ERROR)
+        {
+            midiPtr->AddOpenPort(port);
+            result = CreateMidiInPortHandle(port, callback, midiPort);
+        }
+        return result;
+    }
+
+    WinRTMidiErrorType winrt_open_midi_in_loopback_port(WinRTMidiPtr midi, WinRTMidiInCallback callback, WinRTMidiInPortPtr* midiPort)
+    {
+        *midiPort = nullptr;
+
+        WinRTMidi* midiPtr = (WinRTMidi*)midi;
+
+        if (midiPtr == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        auto port = ref new WinRTMidiInPort;
+        midiPtr->ConfigurePort(port);
+        WinRTMidiErrorType result = port->OpenLoopbackPort();
         if (result == WINRT_NO_ERROR)
         {
-            *midiPort = (WinRTMidiInPortPtr) new MidiInPortWrapper(port, callback);
+            result = CreateMidiInPortHandle(port, callback, midiPort);
         }
         return result;
     }
 
     void winrt_free_midi_in_port(WinRTMidiInPortPtr port)
     {
-        MidiInPortWrapper* wrapper = (MidiInPortWrapper*)port;
+        sMidiInPorts.Destroy(port);
+    }
+
+    WinRTMidiErrorType winrt_midi_in_port_subscribe(WinRTMidiInPortPtr port, WinRTMidiInCallback callback, unsigned int typeMask, unsigned int channelMask, unsigned int queueCapacity, WinRTMidiSubscriberPtr* subscriber)
+    {
+        MidiInPortWrapper* wrapper = GetMidiInPortWrapper(port);
+
+        if (wrapper == nullptr || callback == nullptr || subscriber == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        *subscriber = nullptr;
+        return wrapper->AddSubscriber(callback, typeMask, channelMask, queueCapacity, (WinRTMidiInSubscriber**)subscriber);
+    }
+
+    WinRTMidiErrorType winrt_midi_in_port_unsubscribe(WinRTMidiInPortPtr port, WinRTMidiSubscriberPtr subscriber)
+    {
+        MidiInPortWrapper* wrapper = GetMidiInPortWrapper(port);
+
+        if (wrapper == nullptr || subscriber == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return wrapper->RemoveSubscriber((WinRTMidiInSubscriber*)subscriber);
+    }
+
+    WinRTMidiErrorType winrt_midi_subscriber_get_stats(WinRTMidiSubscriberPtr subscriber, WinRTMidiSubscriberStats* stats)
+    {
+        WinRTMidiInSubscriber* subscriberPtr = (WinRTMidiInSubscriber*)subscriber;
+
+        if (subscriberPtr == nullptr || stats == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        subscriberPtr->GetStats(*stats);
+        return WINRT_NO_ERROR;
+    }
+
+    WinRTMidiErrorType winrt_midi_in_port_set_filter(WinRTMidiInPortPtr port, unsigned int typeMask)
+    {
+        MidiInPortWrapper* wrapper = GetMidiInPortWrapper(port);
+
+        if (wrapper == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        wrapper->getPort()->SetFilter(typeMask);
+        return WINRT_NO_ERROR;
+    }
+
+    WinRTMidiErrorType winrt_midi_in_port_get_clock(WinRTMidiInPortPtr port, WinRTMidiClockState* state)
+    {
+        MidiInPortWrapper* wrapper = GetMidiInPortWrapper(port);
+
+        if (wrapper == nullptr || state == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        wrapper->getPort()->GetClockState(*state);
+        return WINRT_NO_ERROR;
+    }
+
+    WinRTMidiErrorType winrt_midi_in_port_get_channel_state(WinRTMidiInPortPtr port, WinRTMidiChannelStateSnapshot* snapshot)
+    {
+        MidiInPortWrapper* wrapper = GetMidiInPortWrapper(port);
+
+        if (wrapper == nullptr || snapshot == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        wrapper->getPort()->GetChannelState(*snapshot);
+        return WINRT_NO_ERROR;
+    }
+
+    WinRTMidiErrorType winrt_midi_in_port_add_route(WinRTMidiInPortPtr port, WinRTMidiOutPortPtr destination)
+    {
+        MidiInPortWrapper* wrapper = GetMidiInPortWrapper(port);
+        MidiOutPortWrapper* outWrapper = GetMidiOutPortWrapper(destination);
+
+        if (wrapper == nullptr || outWrapper == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        wrapper->getPort()->AddRoute(outWrapper->getPort());
+        return WINRT_NO_ERROR;
+    }
+
+    WinRTMidiErrorType winrt_midi_in_port_remove_route(WinRTMidiInPortPtr port, WinRTMidiOutPortPtr destination)
+    {
+        MidiInPortWrapper* wrapper = GetMidiInPortWrapper(port);
+        MidiOutPortWrapper* outWrapper = GetMidiOutPortWrapper(destination);
+
+        if (wrapper == nullptr || outWrapper == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        wrapper->getPort()->RemoveRoute(outWrapper->getPort());
+        return WINRT_NO_ERROR;
+    }
+
+    WinRTMidiErrorType winrt_midi_in_port_set_coalescer(WinRTMidiInPortPtr port, const WinRTMidiCoalescerConfig* config)
+    {
+        MidiInPortWrapper* wrapper = GetMidiInPortWrapper(port);
+
+        if (wrapper == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return wrapper->getPort()->SetCoalescer(config);
+    }
+
+    void winrt_midi_in_port_flush(WinRTMidiInPortPtr port)
+    {
+        MidiInPortWrapper* wrapper = GetMidiInPortWrapper(port);
         if (wrapper)
         {
-            delete wrapper;
+            wrapper->getPort()->FlushCoalescer();
         }
     }
 
-    // WinRT Midi Out port functions
-    WinRTMidiErrorType winrt_open_midi_out_port(WinRTMidiPtr midi, unsigned int index, WinRTMidiOutPortPtr* midiPort)
+    WinRTMidiErrorType winrt_midi_in_port_set_ump_callback(WinRTMidiInPortPtr port, WinRTMidiUmpCallback callback, WinRTMidiUmpProtocol protocol, unsigned int group)
     {
-        *midiPort = nullptr;
-        WinRTMidiErrorType result = WINRT_NO_ERROR;
+        MidiInPortWrapper* wrapper = GetMidiInPortWrapper(port);
 
-        WinRTMidi* midiPtr = (WinRTMidi*)midi;
+        if (wrapper == nullptr || group > 15 || (protocol != WINRT_UMP_MIDI1 && protocol != WINRT_UMP_MIDI2))
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
 
-        if (midiPtr == nullptr)
+        wrapper->SetUmpCallback(callback, protocol, group);
+        return WINRT_NO_ERROR;
+    }
+
+    WinRTMidiErrorType winrt_midi_in_port_set_parameter_callback(WinRTMidiInPortPtr port, WinRTMidiParameterCallback callback)
+    {
+        MidiInPortWrapper* wrapper = GetMidiInPortWrapper(port);
+
+        if (wrapper == nullptr)
         {
             return WINRT_INVALID_PARAMETER_ERROR;
         }
 
-        auto id = midiPtr->getPortId(WinRTMidiPortType::Out, index);
-        if (id == nullptr)
+        wrapper->SetParameterCallback(callback);
+        return WINRT_NO_ERROR;
+    }
+
+    WinRTMidiErrorType winrt_midi_in_port_set_mpe_callback(WinRTMidiInPortPtr port, WinRTMidiMpeCallback callback)
+    {
+        MidiInPortWrapper* wrapper = GetMidiInPortWrapper(port);
+
+        if (wrapper == nullptr)
         {
-            return WINRT_INVALID_PORT_INDEX_ERROR;
+            return WINRT_INVALID_PARAMETER_ERROR;
         }
 
-        auto port = ref new WinRTMidiOutPort;
-        result = port->OpenPort(id);
-        if (result == WINRT_NO_ERROR)
+        wrapper->SetMpeCallback(callback);
+        return WINRT_NO_ERROR;
+    }
+
+    WinRTMidiErrorType winrt_midi_in_port_set_sysex_callback(WinRTMidiInPortPtr port, WinRTMidiSysExCallback callback, unsigned int maxSize)
+    {
+        MidiInPortWrapper* wrapper = GetMidiInPortWrapper(port);
+
+        if (wrapper == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        wrapper->SetSysExCallback(callback, maxSize);
+        return WINRT_NO_ERROR;
+    }
+
+    void winrt_midi_in_port_release_sysex(WinRTMidiInPortPtr port, const unsigned char* message)
+    {
+        MidiInPortWrapper* wrapper = GetMidiInPortWrapper(port);
+        if (wrapper && message)
+        {
+            wrapper->ReleaseSysEx(message);
+        }
+    }
+
+    WinRTMidiErrorType winrt_midi_in_port_get_sysex_stats(WinRTMidiInPortPtr port, WinRTMidiSysExStats* stats)
+    {
+        MidiInPortWrapper* wrapper = GetMidiInPortWrapper(port);
+
+        if (wrapper == nullptr || stats == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        wrapper->GetSysExStats(*stats);
+        return WINRT_NO_ERROR;
+    }
+
+    // WinRT Midi Recorder functions
+    WinRTMidiErrorType winrt_record_start(WinRTMidiInPortPtr port, const char* path, WinRTMidiRecorderPtr* recorder)
+    {
+        MidiInPortWrapper* wrapper = GetMidiInPortWrapper(port);
+
+        if (wrapper == nullptr || path == nullptr || recorder == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        *recorder = nullptr;
+        WinRTMidiRecorder* recorderPtr = new WinRTMidiRecorder(wrapper->getPort());
+        WinRTMidiErrorType result = recorderPtr->Start(path);
+        if (result != WINRT_NO_ERROR)
+        {
+            delete recorderPtr;
+        }
+        else
         {
-            *midiPort = (WinRTMidiOutPortPtr) new MidiOutPortWrapper(port);
+            *recorder = (WinRTMidiRecorderPtr)recorderPtr;
         }
+
         return result;
     }
 
-    void winrt_free_midi_out_port(WinRTMidiOutPortPtr port)
+    WinRTMidiErrorType winrt_record_stop(WinRTMidiRecorderPtr recorder)
     {
-        MidiOutPortWrapper* wrapper = (MidiOutPortWrapper*)port;
-        if (wrapper)
+        WinRTMidiRecorder* recorderPtr = (WinRTMidiRecorder*)recorder;
+
+        if (recorderPtr == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        WinRTMidiErrorType result = recorderPtr->Finish();
+        delete recorderPtr;
+        return result;
+    }
+
+    // WinRT Midi Capture functions
+    static bool GetInPorts(WinRTMidiInPortPtr* ports, unsigned int nPorts, std::vector<WinRTMidiInPort^>& inPorts)
+    {
+        if (ports == nullptr || nPorts == 0)
+        {
+            return false;
+        }
+
+        for (unsigned int i = 0; i < nPorts; i++)
+        {
+            MidiInPortWrapper* wrapper = GetMidiInPortWrapper(ports[i]);
+            if (wrapper == nullptr)
+            {
+                return false;
+            }
+            inPorts.push_back(wrapper->getPort());
+        }
+
+        return true;
+    }
+
+    WinRTMidiErrorType winrt_capture_start(WinRTMidiInPortPtr* ports, unsigned int nPorts, const char* path, WinRTMidiCapturePtr* capture)
+    {
+        std::vector<WinRTMidiInPort^> inPorts;
+
+        if (path == nullptr || capture == nullptr || !GetInPorts(ports, nPorts, inPorts))
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        *capture = nullptr;
+        WinRTMidiCapture* capturePtr = new WinRTMidiCapture(inPorts);
+        WinRTMidiErrorType result = capturePtr->Start(path);
+        if (result != WINRT_NO_ERROR)
+        {
+            delete capturePtr;
+        }
+        else
+        {
+            *capture = (WinRTMidiCapturePtr)capturePtr;
+        }
+
+        return result;
+    }
+
+    WinRTMidiErrorType winrt_capture_stop(WinRTMidiCapturePtr capture)
+    {
+        WinRTMidiCapture* capturePtr = (WinRTMidiCapture*)capture;
+
+        if (capturePtr == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        WinRTMidiErrorType result = capturePtr->Finish();
+        delete capturePtr;
+        return result;
+    }
+
+    WinRTMidiErrorType winrt_replay_start(const char* path, WinRTMidiInPortPtr* ports, unsigned int nPorts, double speed, WinRTMidiReplayPtr* replay)
+    {
+        std::vector<WinRTMidiInPort^> inPorts;
+
+        if (path == nullptr || replay == nullptr || !GetInPorts(ports, nPorts, inPorts))
         {
-            delete wrapper;
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        *replay = nullptr;
+        WinRTMidiCaptureReplay* replayPtr = new WinRTMidiCaptureReplay();
+        WinRTMidiErrorType result = replayPtr->Start(path, inPorts, speed);
+        if (result != WINRT_NO_ERROR)
+        {
+            delete replayPtr;
         }
+        else
+        {
+            *replay = (WinRTMidiReplayPtr)replayPtr;
+        }
+
+        return result;
     }
 
-    void winrt_midi_out_port_send(WinRTMidiOutPortPtr port, const unsigned char* message, unsigned int nBytes)
+    WinRTMidiErrorType winrt_replay_wait(WinRTMidiReplayPtr replay)
     {
-        MidiOutPortWrapper* wrapper = (MidiOutPortWrapper*)port;
-        wrapper->getPort()->Send(message, nBytes);
+        WinRTMidiCaptureReplay* replayPtr = (WinRTMidiCaptureReplay*)replay;
+
+        if (replayPtr == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return replayPtr->Wait();
+    }
+
+    void winrt_replay_stop(WinRTMidiReplayPtr replay)
+    {
+        WinRTMidiCaptureReplay* replayPtr = (WinRTMidiCaptureReplay*)replay;
+        if (replayPtr)
+        {
+            delete replayPtr;
+        }
+    }
+
+    // WinRT Midi Merge functions
+    WinRTMidiErrorType winrt_merge_start(WinRTMidiInPortPtr* ports, unsigned int nPorts, double reorderWindow, unsigned int queueCapacity, WinRTMidiMergeCallback callback, WinRTMidiMergePtr* merge)
+    {
+        std::vector<WinRTMidiInPort^> inPorts;
+
+        if (callback == nullptr || merge == nullptr || !GetInPorts(ports, nPorts, inPorts))
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        *merge = nullptr;
+        WinRTMidiMerge* mergePtr = new WinRTMidiMerge(inPorts, callback, reorderWindow, queueCapacity);
+        WinRTMidiErrorType result = mergePtr->Start();
+        if (result != WINRT_NO_ERROR)
+        {
+            delete mergePtr;
+        }
+        else
+        {
+            *merge = (WinRTMidiMergePtr)mergePtr;
+        }
+
+        return result;
+    }
+
+    void winrt_merge_stop(WinRTMidiMergePtr merge)
+    {
+        WinRTMidiMerge* mergePtr = (WinRTMidiMerge*)merge;
+        delete mergePtr;
+    }
+
+    WinRTMidiErrorType winrt_merge_get_stats(WinRTMidiMergePtr merge, WinRTMidiMergeStats* stats)
+    {
+        WinRTMidiMerge* mergePtr = (WinRTMidiMerge*)merge;
+
+        if (mergePtr == nullptr || stats == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        mergePtr->GetStats(*stats);
+        return WINRT_NO_ERROR;
+    }
+
+    // WinRT Midi Broker functions
+    WinRTMidiErrorType winrt_broker_start(WinRTMidiInPortPtr inPort, WinRTMidiOutPortPtr outPort, const char* name, WinRTMidiBrokerPtr* broker)
+    {
+        MidiInPortWrapper* inWrapper = GetMidiInPortWrapper(inPort);
+        MidiOutPortWrapper* outWrapper = GetMidiOutPortWrapper(outPort);
+
+        if ((inWrapper == nullptr && outWrapper == nullptr) || !WinRTMidiBroker::IsValidName(name) || broker == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        *broker = nullptr;
+        WinRTMidiBroker* brokerPtr = new WinRTMidiBroker(inWrapper ? inWrapper->getPort() : nullptr, outWrapper ? outWrapper->getPort() : nullptr);
+        WinRTMidiErrorType result = brokerPtr->Start(name);
+        if (result != WINRT_NO_ERROR)
+        {
+            delete brokerPtr;
+        }
+        else
+        {
+            *broker = (WinRTMidiBrokerPtr)brokerPtr;
+        }
+
+        return result;
+    }
+
+    void winrt_broker_stop(WinRTMidiBrokerPtr broker)
+    {
+        WinRTMidiBroker* brokerPtr = (WinRTMidiBroker*)broker;
+        delete brokerPtr;
+    }
+
+    WinRTMidiErrorType winrt_open_midi_in_broker_port(WinRTMidiPtr midi, const char* name, WinRTMidiInCallback callback, WinRTMidiInPortPtr* midiPort)
+    {
+        *midiPort = nullptr;
+
+        WinRTMidi* midiPtr = (WinRTMidi*)midi;
+
+        if (midiPtr == nullptr || !WinRTMidiBroker::IsValidName(name))
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        auto port = ref new WinRTMidiInPort;
+        midiPtr->ConfigurePort(port);
+        WinRTMidiErrorType result = port->OpenBrokerPort(name);
+        if (result == WINRT_NO_ERROR)
+        {
+            result = CreateMidiInPortHandle(port, callback, midiPort);
+        }
+        return result;
+    }
+
+    WinRTMidiErrorType winrt_open_midi_out_broker_port(WinRTMidiPtr midi, const char* name, WinRTMidiOutPortPtr* midiPort)
+    {
+        *midiPort = nullptr;
+
+        WinRTMidi* midiPtr = (WinRTMidi*)midi;
+
+        if (midiPtr == nullptr || !WinRTMidiBroker::IsValidName(name))
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        auto port = ref new WinRTMidiOutPort;
+        WinRTMidiErrorType result = port->OpenBrokerPort(name);
+        if (result == WINRT_NO_ERROR)
+        {
+            result = CreateMidiOutPortHandle(port, midiPort);
+        }
+        return result;
+    }
+
+    // WinRT Midi Network functions
+    WinRTMidiErrorType winrt_add_network_port(WinRTMidiPtr midi, WinRTMidiPortType type, const char* name, const char* host, unsigned short port)
+    {
+        WinRTMidi* midiPtr = (WinRTMidi*)midi;
+
+        if (midiPtr == nullptr || name == nullptr || host == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return midiPtr->AddNetworkPort(type, name, host, port);
+    }
+
+    WinRTMidiErrorType winrt_remove_network_port(WinRTMidiPtr midi, WinRTMidiPortType type, const char* host, unsigned short port)
+    {
+        WinRTMidi* midiPtr = (WinRTMidi*)midi;
+
+        if (midiPtr == nullptr || host == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return midiPtr->RemoveNetworkPort(type, host, port);
+    }
+
+    WinRTMidiErrorType winrt_set_network_config(WinRTMidiPtr midi, const WinRTMidiNetworkConfig* config)
+    {
+        WinRTMidi* midiPtr = (WinRTMidi*)midi;
+
+        if (midiPtr == nullptr || config == nullptr || config->batchWindow < 0 || config->jitterBuffer < 0
+            || config->lossRate < 0 || config->lossRate > 1 || config->delay < 0 || config->delayJitter < 0)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        midiPtr->SetNetworkConfig(*config);
+        return WINRT_NO_ERROR;
+    }
+
+    WinRTMidiErrorType winrt_midi_in_port_get_network_stats(WinRTMidiInPortPtr port, WinRTMidiNetworkStats* stats)
+    {
+        MidiInPortWrapper* wrapper = GetMidiInPortWrapper(port);
+
+        if (wrapper == nullptr || stats == nullptr || !wrapper->getPort()->GetNetworkStats(*stats))
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return WINRT_NO_ERROR;
+    }
+
+    WinRTMidiErrorType winrt_midi_out_port_get_network_stats(WinRTMidiOutPortPtr port, WinRTMidiNetworkStats* stats)
+    {
+        MidiOutPortWrapper* wrapper = GetMidiOutPortWrapper(port);
+
+        if (wrapper == nullptr || stats == nullptr || !wrapper->getPort()->GetNetworkStats(*stats))
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return WINRT_NO_ERROR;
+    }
+
+    // WinRT Midi Reconnect functions
+    WinRTMidiErrorType winrt_set_auto_reconnect(WinRTMidiPtr midi, int enable)
+    {
+        WinRTMidi* midiPtr = (WinRTMidi*)midi;
+
+        if (midiPtr == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        midiPtr->SetAutoReconnect(enable != 0);
+        return WINRT_NO_ERROR;
+    }
+
+    WinRTMidiErrorType winrt_midi_in_port_get_connection_stats(WinRTMidiInPortPtr port, WinRTMidiConnectionStats* stats)
+    {
+        MidiInPortWrapper* wrapper = GetMidiInPortWrapper(port);
+
+        if (wrapper == nullptr || stats == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        wrapper->getPort()->GetConnectionStats(*stats);
+        return WINRT_NO_ERROR;
+    }
+
+    WinRTMidiErrorType winrt_midi_out_port_get_connection_stats(WinRTMidiOutPortPtr port, WinRTMidiConnectionStats* stats)
+    {
+        MidiOutPortWrapper* wrapper = GetMidiOutPortWrapper(port);
+
+        if (wrapper == nullptr || stats == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        wrapper->getPort()->GetConnectionStats(*stats);
+        return WINRT_NO_ERROR;
+    }
+
+    // WinRT Midi Virtual Port functions
+    WinRTMidiErrorType winrt_create_virtual_port_pair(WinRTMidiPtr midi, const char* name, WinRTMidiInCallback callback, WinRTMidiInPortPtr* inPort, WinRTMidiOutPortPtr* outPort)
+    {
+        WinRTMidi* midiPtr = (WinRTMidi*)midi;
+
+        if (midiPtr == nullptr || name == nullptr || *name == 0 || inPort == nullptr || outPort == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        *inPort = nullptr;
+        *outPort = nullptr;
+
+        std::shared_ptr<WinRTMidiVirtualPort> virtualPort;
+        WinRTMidiErrorType result = midiPtr->CreateVirtualPortPair(name, virtualPort);
+        if (result != WINRT_NO_ERROR)
+        {
+            return result;
+        }
+
+        auto in = ref new WinRTMidiInPort;
+        midiPtr->ConfigurePort(in);
+        in->OpenVirtualPort(virtualPort);
+        midiPtr->AddOpenPort(in);
+
+        auto out = ref new WinRTMidiOutPort;
+        out->OpenVirtualPort(virtualPort);
+        midiPtr->AddOpenPort(out);
+
+        result = CreateMidiInPortHandle(in, callback, inPort);
+        if (result == WINRT_NO_ERROR)
+        {
+            result = CreateMidiOutPortHandle(out, outPort);
+            if (result != WINRT_NO_ERROR)
+            {
+                winrt_free_midi_in_port(*inPort);
+                *inPort = nullptr;
+            }
+        }
+
+        if (result != WINRT_NO_ERROR)
+        {
+            out->ClosePort();
+            midiPtr->RemoveVirtualPortPair(name);
+        }
+
+        return result;
+    }
+
+    WinRTMidiErrorType winrt_remove_virtual_port_pair(WinRTMidiPtr midi, const char* name)
+    {
+        WinRTMidi* midiPtr = (WinRTMidi*)midi;
+
+        if (midiPtr == nullptr || name == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return midiPtr->RemoveVirtualPortPair(name);
+    }
+
+    // WinRT Midi Out port functions
+    WinRTMidiErrorType winrt_open_midi_out_port(WinRTMidiPtr midi, unsigned int index, WinRTMidiOutPortPtr* midiPort)
+    {
+        *midiPort = nullptr;
+        WinRTMidiErrorType result = WINRT_NO_ERROR;
+
+        WinRTMidi* midiPtr = (WinRTMidi*)midi;
+
+        if (midiPtr == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        auto id = midiPtr->getPortId(WinRTMidiPortType::Out, index);
+        if (id == nullptr)
+        {
+            return WINRT_INVALID_PORT_INDEX_ERROR;
+        }
+
+        auto port = ref new WinRTMidiOutPort;
+        midiPtr->ConfigurePort(port);
+        port->SetNetworkConfig(midiPtr->GetNetworkConfig());
+        auto virtualPort = midiPtr->GetVirtualPort(id);
+        result = virtualPort ? port->OpenVirtualPort(virtualPort) : port->OpenPort(id);
+        if (result == WINRT_NO_ERROR)
+        {
+            midiPtr->AddOpenPort(port);
+            result = CreateMidiOutPortHandle(port, midiPort);
+        }
+        return result;
+    }
+
+    void winrt_free_midi_out_port(WinRTMidiOutPortPtr port)
+    {
+        sMidiOutPorts.Destroy(port);
+    }
+
+    WinRTMidiErrorType winrt_midi_out_port_send(WinRTMidiOutPortPtr port, const unsigned char* message, unsigned int nBytes)
+    {
+        MidiOutPortWrapper* wrapper = GetMidiOutPortWrapper(port);
+
+        if (wrapper == nullptr || message == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        if (!wrapper->Send(message, nBytes))
+        {
+            // an open port only drops messages that do not fit its send buffer
+            return wrapper->getPort()->IsOpen() ? WINRT_MEMORY_ERROR : WINRT_PORT_CLOSED_ERROR;
+        }
+
+        return WINRT_NO_ERROR;
+    }
+
+    WinRTMidiErrorType winrt_midi_out_port_get_channel_state(WinRTMidiOutPortPtr port, WinRTMidiChannelStateSnapshot* snapshot)
+    {
+        MidiOutPortWrapper* wrapper = GetMidiOutPortWrapper(port);
+
+        if (wrapper == nullptr || snapshot == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        wrapper->getPort()->GetChannelState(*snapshot);
+        return WINRT_NO_ERROR;
+    }
+
+    void winrt_midi_out_port_all_notes_off(WinRTMidiOutPortPtr port)
+    {
+        MidiOutPortWrapper* wrapper = GetMidiOutPortWrapper(port);
+        if (wrapper)
+        {
+            wrapper->getPort()->AllNotesOff();
+        }
+    }
+
+    WinRTMidiErrorType winrt_midi_out_port_set_coalescer(WinRTMidiOutPortPtr port, const WinRTMidiCoalescerConfig* config)
+    {
+        MidiOutPortWrapper* wrapper = GetMidiOutPortWrapper(port);
+
+        if (wrapper == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return wrapper->SetCoalescer(config);
+    }
+
+    void winrt_midi_out_port_flush(WinRTMidiOutPortPtr port)
+    {
+        MidiOutPortWrapper* wrapper = GetMidiOutPortWrapper(port);
+        if (wrapper)
+        {
+            wrapper->FlushCoalescer();
+        }
+    }
+
+    WinRTMidiErrorType winrt_midi_out_port_send_ump(WinRTMidiOutPortPtr port, const unsigned int* words, unsigned int nWords)
+    {
+        MidiOutPortWrapper* wrapper = GetMidiOutPortWrapper(port);
+
+        if (wrapper == nullptr || words == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return wrapper->SendUmp(words, nWords);
+    }
+
+    // WinRT Midi Clock Generator functions
+    WinRTMidiErrorType winrt_clock_start(WinRTMidiOutPortPtr* ports, unsigned int nPorts, double bpm, WinRTMidiClockPtr* clock)
+    {
+        if (ports == nullptr || nPorts == 0 || clock == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        *clock = nullptr;
+        std::vector<WinRTMidiOutPort^> outPorts;
+        for (unsigned int i = 0; i < nPorts; i++)
+        {
+            MidiOutPortWrapper* wrapper = GetMidiOutPortWrapper(ports[i]);
+            if (wrapper == nullptr)
+            {
+                return WINRT_INVALID_PARAMETER_ERROR;
+            }
+            outPorts.push_back(wrapper->getPort());
+        }
+
+        WinRTMidiClockGenerator* clockPtr = new WinRTMidiClockGenerator(outPorts);
+        WinRTMidiErrorType result = clockPtr->Start(bpm);
+        if (result != WINRT_NO_ERROR)
+        {
+            delete clockPtr;
+        }
+        else
+        {
+            *clock = (WinRTMidiClockPtr)clockPtr;
+        }
+
+        return result;
+    }
+
+    void winrt_clock_stop(WinRTMidiClockPtr clock)
+    {
+        WinRTMidiClockGenerator* clockPtr = (WinRTMidiClockGenerator*)clock;
+        if (clockPtr)
+        {
+            delete clockPtr;
+        }
+    }
+
+    WinRTMidiErrorType winrt_clock_set_tempo(WinRTMidiClockPtr clock, double bpm)
+    {
+        WinRTMidiClockGenerator* clockPtr = (WinRTMidiClockGenerator*)clock;
+
+        if (clockPtr == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return clockPtr->SetTempo(bpm);
+    }
+
+    void winrt_clock_send_start(WinRTMidiClockPtr clock)
+    {
+        WinRTMidiClockGenerator* clockPtr = (WinRTMidiClockGenerator*)clock;
+        clockPtr->SendTransport(0xFA);
+    }
+
+    void winrt_clock_send_continue(WinRTMidiClockPtr clock)
+    {
+        WinRTMidiClockGenerator* clockPtr = (WinRTMidiClockGenerator*)clock;
+        clockPtr->SendTransport(0xFB);
+    }
+
+    void winrt_clock_send_stop(WinRTMidiClockPtr clock)
+    {
+        WinRTMidiClockGenerator* clockPtr = (WinRTMidiClockGenerator*)clock;
+        clockPtr->SendTransport(0xFC);
+    }
+
+    void winrt_clock_send_song_position(WinRTMidiClockPtr clock, unsigned int position)
+    {
+        WinRTMidiClockGenerator* clockPtr = (WinRTMidiClockGenerator*)clock;
+        clockPtr->SetSongPosition(position);
+    }
+
+    WinRTMidiErrorType winrt_clock_get_stats(WinRTMidiClockPtr clock, WinRTMidiClockStats* stats)
+    {
+        WinRTMidiClockGenerator* clockPtr = (WinRTMidiClockGenerator*)clock;
+
+        if (clockPtr == nullptr || stats == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        clockPtr->GetStats(*stats);
+        return WINRT_NO_ERROR;
+    }
+
+    // WinRT Midi UMP functions
+    unsigned int winrt_midi_to_ump(const unsigned int* messages, unsigned int count, unsigned int group, WinRTMidiUmpProtocol protocol, unsigned int* ump)
+    {
+        return MidiToUmpBatch(messages, count, group, protocol, ump);
+    }
+
+    unsigned int winrt_ump_to_midi(const unsigned int* ump, unsigned int count, WinRTMidiUmpProtocol protocol, unsigned int* messages)
+    {
+        return UmpToMidiBatch(ump, count, protocol, messages);
+    }
+
+    // WinRT Midi SysEx functions
+    unsigned int winrt_sysex_pack(const unsigned char* data, unsigned int nBytes, unsigned char* packed)
+    {
+        if (data == nullptr || packed == nullptr)
+        {
+            return 0;
+        }
+
+        return PackSysEx(data, nBytes, packed);
+    }
+
+    unsigned int winrt_sysex_unpack(const unsigned char* packed, unsigned int nBytes, unsigned char* data)
+    {
+        if (packed == nullptr || data == nullptr)
+        {
+            return 0;
+        }
+
+        return UnpackSysEx(packed, nBytes, data);
+    }
+
+    unsigned char winrt_sysex_roland_checksum(const unsigned char* data, unsigned int nBytes)
+    {
+        if (data == nullptr)
+        {
+            return 0;
+        }
+
+        return RolandChecksum(data, nBytes);
+    }
+
+    WinRTMidiErrorType winrt_sysex_stream_begin(WinRTMidiOutPortPtr port, const WinRTMidiSysExStreamConfig* config, unsigned long long totalBytes, WinRTMidiSysExProgressCallback callback, WinRTMidiSysExStreamPtr* stream)
+    {
+        MidiOutPortWrapper* wrapper = GetMidiOutPortWrapper(port);
+
+        if (wrapper == nullptr || stream == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        WinRTMidiSysExStreamConfig defaultConfig = { 0, 0, 0.0, 0.0 };
+        WinRTMidiSysExStream* streamPtr = new WinRTMidiSysExStream(wrapper->getPort(), config ? *config : defaultConfig, totalBytes, callback);
+        WinRTMidiErrorType result = streamPtr->Start();
+        if (result != WINRT_NO_ERROR)
+        {
+            delete streamPtr;
+            *stream = nullptr;
+        }
+        else
+        {
+            *stream = (WinRTMidiSysExStreamPtr)streamPtr;
+        }
+
+        return result;
+    }
+
+    WinRTMidiErrorType winrt_sysex_stream_write(WinRTMidiSysExStreamPtr stream, const unsigned char* data, unsigned int nBytes)
+    {
+        WinRTMidiSysExStream* streamPtr = (WinRTMidiSysExStream*)stream;
+
+        if (streamPtr == nullptr || (data == nullptr && nBytes > 0))
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return streamPtr->Write(data, nBytes);
+    }
+
+    WinRTMidiErrorType winrt_sysex_stream_end(WinRTMidiSysExStreamPtr stream)
+    {
+        WinRTMidiSysExStream* streamPtr = (WinRTMidiSysExStream*)stream;
+
+        if (streamPtr == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        WinRTMidiErrorType result = streamPtr->End();
+        delete streamPtr;
+        return result;
+    }
+
+    // WinRT Midi Player functions
+    WinRTMidiErrorType winrt_player_open(const char* path, WinRTMidiOutPortPtr* ports, unsigned int nPorts, WinRTMidiPlayerPtr* player)
+    {
+        if (path == nullptr || ports == nullptr || nPorts == 0 || player == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        *player = nullptr;
+        std::vector<WinRTMidiOutPort^> outPorts;
+        for (unsigned int i = 0; i < nPorts; i++)
+        {
+            MidiOutPortWrapper* wrapper = GetMidiOutPortWrapper(ports[i]);
+            if (wrapper == nullptr)
+            {
+                return WINRT_INVALID_PARAMETER_ERROR;
+            }
+            outPorts.push_back(wrapper->getPort());
+        }
+
+        WinRTMidiPlayer* playerPtr = new WinRTMidiPlayer();
+        WinRTMidiErrorType result = playerPtr->Open(path, outPorts);
+        if (result != WINRT_NO_ERROR)
+        {
+            delete playerPtr;
+        }
+        else
+        {
+            *player = (WinRTMidiPlayerPtr)playerPtr;
+        }
+
+        return result;
+    }
+
+    void winrt_player_free(WinRTMidiPlayerPtr player)
+    {
+        WinRTMidiPlayer* playerPtr = (WinRTMidiPlayer*)player;
+        if (playerPtr)
+        {
+            delete playerPtr;
+        }
+    }
+
+    WinRTMidiErrorType winrt_player_start(WinRTMidiPlayerPtr player)
+    {
+        WinRTMidiPlayer* playerPtr = (WinRTMidiPlayer*)player;
+        if (playerPtr == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return playerPtr->Start();
+    }
+
+    void winrt_player_stop(WinRTMidiPlayerPtr player)
+    {
+        WinRTMidiPlayer* playerPtr = (WinRTMidiPlayer*)player;
+        playerPtr->Stop();
+    }
+
+    void winrt_player_seek(WinRTMidiPlayerPtr player, double position)
+    {
+        WinRTMidiPlayer* playerPtr = (WinRTMidiPlayer*)player;
+        playerPtr->Seek(position);
+    }
+
+    void winrt_player_set_loop(WinRTMidiPlayerPtr player, double start, double end)
+    {
+        WinRTMidiPlayer* playerPtr = (WinRTMidiPlayer*)player;
+        playerPtr->SetLoop(start, end);
+    }
+
+    double winrt_player_get_position(WinRTMidiPlayerPtr player)
+    {
+        WinRTMidiPlayer* playerPtr = (WinRTMidiPlayer*)player;
+        return playerPtr->GetPosition();
+    }
+
+    double winrt_player_get_duration(WinRTMidiPlayerPtr player)
+    {
+        WinRTMidiPlayer* playerPtr = (WinRTMidiPlayer*)player;
+        return playerPtr->GetDuration();
+    }
+
+    double winrt_player_get_tempo(WinRTMidiPlayerPtr player)
+    {
+        WinRTMidiPlayer* playerPtr = (WinRTMidiPlayer*)player;
+        return playerPtr->GetTempo();
+    }
+
+    // WinRT Midi Scheduler functions
+    WinRTMidiErrorType winrt_scheduler_open(WinRTMidiOutPortPtr* ports, unsigned int nPorts, unsigned int ppq, double bpm, WinRTMidiSchedulerPtr* scheduler)
+    {
+        if (ports == nullptr || nPorts == 0 || ppq == 0 || scheduler == nullptr
+            || !(bpm >= kMinSchedulerTempo && bpm <= kMaxSchedulerTempo))
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        *scheduler = nullptr;
+        std::vector<WinRTMidiOutPort^> outPorts;
+        for (unsigned int i = 0; i < nPorts; i++)
+        {
+            MidiOutPortWrapper* wrapper = GetMidiOutPortWrapper(ports[i]);
+            if (wrapper == nullptr)
+            {
+                return WINRT_INVALID_PARAMETER_ERROR;
+            }
+            outPorts.push_back(wrapper->getPort());
+        }
+
+        *scheduler = (WinRTMidiSchedulerPtr) new WinRTMidiScheduler(outPorts, ppq, bpm);
+        return WINRT_NO_ERROR;
+    }
+
+    void winrt_scheduler_free(WinRTMidiSchedulerPtr scheduler)
+    {
+        WinRTMidiScheduler* schedulerPtr = (WinRTMidiScheduler*)scheduler;
+        if (schedulerPtr)
+        {
+            delete schedulerPtr;
+        }
+    }
+
+    WinRTMidiErrorType winrt_scheduler_start(WinRTMidiSchedulerPtr scheduler)
+    {
+        WinRTMidiScheduler* schedulerPtr = (WinRTMidiScheduler*)scheduler;
+        if (schedulerPtr == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return schedulerPtr->Start();
+    }
+
+    void winrt_scheduler_stop(WinRTMidiSchedulerPtr scheduler)
+    {
+        WinRTMidiScheduler* schedulerPtr = (WinRTMidiScheduler*)scheduler;
+        schedulerPtr->Stop();
+    }
+
+    void winrt_scheduler_seek(WinRTMidiSchedulerPtr scheduler, unsigned long long tick)
+    {
+        WinRTMidiScheduler* schedulerPtr = (WinRTMidiScheduler*)scheduler;
+        schedulerPtr->Seek(tick);
+    }
+
+    WinRTMidiErrorType winrt_scheduler_schedule(WinRTMidiSchedulerPtr scheduler, unsigned int port, unsigned long long tick, const unsigned char* message, unsigned int nBytes)
+    {
+        WinRTMidiScheduler* schedulerPtr = (WinRTMidiScheduler*)scheduler;
+        if (schedulerPtr == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return schedulerPtr->Schedule(port, tick, message, nBytes);
+    }
+
+    void winrt_scheduler_clear(WinRTMidiSchedulerPtr scheduler)
+    {
+        WinRTMidiScheduler* schedulerPtr = (WinRTMidiScheduler*)scheduler;
+        schedulerPtr->Clear();
+    }
+
+    WinRTMidiErrorType winrt_scheduler_set_tempo(WinRTMidiSchedulerPtr scheduler, unsigned long long tick, double bpm)
+    {
+        WinRTMidiScheduler* schedulerPtr = (WinRTMidiScheduler*)scheduler;
+        if (schedulerPtr == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return schedulerPtr->SetTempo(tick, bpm);
+    }
+
+    WinRTMidiErrorType winrt_scheduler_remove_tempo(WinRTMidiSchedulerPtr scheduler, unsigned long long tick)
+    {
+        WinRTMidiScheduler* schedulerPtr = (WinRTMidiScheduler*)scheduler;
+        if (schedulerPtr == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return schedulerPtr->RemoveTempo(tick);
+    }
+
+    double winrt_scheduler_get_position(WinRTMidiSchedulerPtr scheduler)
+    {
+        WinRTMidiScheduler* schedulerPtr = (WinRTMidiScheduler*)scheduler;
+        return schedulerPtr->GetPosition();
+    }
+
+    double winrt_scheduler_get_tempo(WinRTMidiSchedulerPtr scheduler)
+    {
+        WinRTMidiScheduler* schedulerPtr = (WinRTMidiScheduler*)scheduler;
+        return schedulerPtr->GetTempo();
+    }
+
+    WinRTMidiErrorType winrt_scheduler_get_stats(WinRTMidiSchedulerPtr scheduler, WinRTMidiSchedulerStats* stats)
+    {
+        WinRTMidiScheduler* schedulerPtr = (WinRTMidiScheduler*)scheduler;
+        if (schedulerPtr == nullptr || stats == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        schedulerPtr->GetStats(*stats);
+        return WINRT_NO_ERROR;
+    }
+
+    // WinRT Midi Block Sender functions
+    WinRTMidiErrorType winrt_block_sender_open(WinRTMidiOutPortPtr port, double sampleRate, double latency, WinRTMidiBlockSenderPtr* sender)
+    {
+        if (sender == nullptr || !(sampleRate > 0.0) || !(latency >= 0.0 && latency <= kMaxBlockSenderLatency))
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        *sender = nullptr;
+        MidiOutPortWrapper* wrapper = GetMidiOutPortWrapper(port);
+        if (wrapper == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        WinRTMidiBlockSender* senderPtr = new WinRTMidiBlockSender(wrapper->getPort(), sampleRate, latency);
+        WinRTMidiErrorType result = senderPtr->Start();
+        if (result != WINRT_NO_ERROR)
+        {
+            delete senderPtr;
+        }
+        else
+        {
+            *sender = (WinRTMidiBlockSenderPtr)senderPtr;
+        }
+
+        return result;
+    }
+
+    void winrt_block_sender_free(WinRTMidiBlockSenderPtr sender)
+    {
+        WinRTMidiBlockSender* senderPtr = (WinRTMidiBlockSender*)sender;
+        if (senderPtr)
+        {
+            delete senderPtr;
+        }
+    }
+
+    WinRTMidiErrorType winrt_block_sender_set_latency(WinRTMidiBlockSenderPtr sender, double latency)
+    {
+        WinRTMidiBlockSender* senderPtr = (WinRTMidiBlockSender*)sender;
+        if (senderPtr == nullptr || !(latency >= 0.0 && latency <= kMaxBlockSenderLatency))
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        senderPtr->SetLatency(latency);
+        return WINRT_NO_ERROR;
+    }
+
+    WinRTMidiErrorType winrt_block_sender_send(WinRTMidiBlockSenderPtr sender, long long blockTime, const WinRTMidiBlockEvent* events, unsigned int nEvents)
+    {
+        WinRTMidiBlockSender* senderPtr = (WinRTMidiBlockSender*)sender;
+        if (senderPtr == nullptr || (events == nullptr && nEvents > 0))
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        return senderPtr->SendBlock(blockTime, events, nEvents);
+    }
+
+    WinRTMidiErrorType winrt_block_sender_get_stats(WinRTMidiBlockSenderPtr sender, WinRTMidiBlockSenderStats* stats)
+    {
+        WinRTMidiBlockSender* senderPtr = (WinRTMidiBlockSender*)sender;
+        if (senderPtr == nullptr || stats == nullptr)
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        senderPtr->GetStats(*stats);
+        return WINRT_NO_ERROR;
     }
 
     // WinRT Midi Watcher Functions
@@ -32,13 +32,178 @@ namespace WinRT
         WINRT_OPEN_PORT_ERROR,                      // open midi port error
         WINRT_INVALID_PARAMETER_ERROR,
         WINRT_MEMORY_ERROR, 
-        WINRT_UNSPECIFIED_ERROR
+        WINRT_UNSPECIFIED_ERROR,
+        WINRT_FILE_ERROR,                           // unable to create, read, write or parse a file
+        WINRT_PORT_CLOSED_ERROR                     // the port was closed or its device was removed
+    };
+
+    // Midi message type filter bits
+    enum WinRTMidiMessageTypeMask {
+        WINRT_MIDI_NOTE_OFF             = 0x0001,
+        WINRT_MIDI_NOTE_ON              = 0x0002,
+        WINRT_MIDI_POLY_PRESSURE        = 0x0004,
+        WINRT_MIDI_CONTROL_CHANGE       = 0x0008,
+        WINRT_MIDI_PROGRAM_CHANGE       = 0x0010,
+        WINRT_MIDI_CHANNEL_PRESSURE     = 0x0020,
+        WINRT_MIDI_PITCH_BEND           = 0x0040,
+        WINRT_MIDI_SYSEX                = 0x0080,   // SysEx messages and continuation fragments
+        WINRT_MIDI_SYSTEM_COMMON        = 0x0100,   // MTC quarter frame, song position, song select, tune request
+        WINRT_MIDI_CLOCK                = 0x0200,   // 0xF8
+        WINRT_MIDI_TRANSPORT            = 0x0400,   // start, continue, stop
+        WINRT_MIDI_ACTIVE_SENSING       = 0x0800,   // 0xFE
+        WINRT_MIDI_RESET                = 0x1000,   // 0xFF
+        WINRT_MIDI_UNDEFINED            = 0x2000,   // 0xF4, 0xF5, 0xF9, 0xFD
+
+        WINRT_MIDI_CHANNEL_MESSAGES     = 0x007F,
+        WINRT_MIDI_REALTIME_MESSAGES    = 0x1E00,
+        WINRT_MIDI_ALL_MESSAGES         = 0x3FFF
+    };
+
+    #define WINRT_MIDI_ALL_CHANNELS 0xFFFF
+
+    // Universal MIDI Packet protocols
+    enum WinRTMidiUmpProtocol {
+        WINRT_UMP_MIDI1 = 1,    // MIDI 1.0 channel voice packets (32 bit, message type 2)
+        WINRT_UMP_MIDI2 = 2     // MIDI 2.0 channel voice packets (64 bit, message type 4)
+    };
+
+    // Parameter event types
+    enum WinRTMidiParameterType {
+        WINRT_PARAMETER_CONTROLLER = 0,         // 7 bit controller 64 - 127 (except RPN/NRPN and data entry)
+        WINRT_PARAMETER_CONTROLLER_14BIT = 1,   // controller 0 - 31 combined with its LSB (32 - 63)
+        WINRT_PARAMETER_RPN = 2,                // registered parameter number
+        WINRT_PARAMETER_NRPN = 3                // non-registered parameter number
+    };
+
+    // MPE event types
+    enum WinRTMidiMpeEventType {
+        WINRT_MPE_NOTE_ON = 0,
+        WINRT_MPE_NOTE_OFF = 1,
+        WINRT_MPE_PITCH_BEND = 2,
+        WINRT_MPE_PRESSURE = 3,
+        WINRT_MPE_TIMBRE = 4        // CC74
+    };
+
+    // What happens when a message does not fit in a preallocated buffer or queue
+    enum WinRTMidiOverflowPolicy
+    {
+        WINRT_OVERFLOW_DEFAULT = 0,     // grow for out port buffers, drop newest for queues
+        WINRT_OVERFLOW_GROW,            // allocate a larger buffer (out ports only)
+        WINRT_OVERFLOW_SPLIT,           // send the message in buffer sized chunks, like a SysEx stream (out ports only)
+        WINRT_OVERFLOW_DROP_NEWEST,     // drop the message that does not fit
+        WINRT_OVERFLOW_DROP_OLDEST      // drop the oldest queued message to make room (queues only)
     };
 
     typedef void* WinRTMidiPtr;
     typedef void* WinRTMidiPortWatcherPtr;
     typedef void* WinRTMidiInPortPtr;
     typedef void* WinRTMidiOutPortPtr;
+    typedef void* WinRTMidiSubscriberPtr;
+    typedef void* WinRTMidiRecorderPtr;
+    typedef void* WinRTMidiPlayerPtr;
+    typedef void* WinRTMidiCapturePtr;
+    typedef void* WinRTMidiReplayPtr;
+    typedef void* WinRTMidiClockPtr;
+    typedef void* WinRTMidiSysExStreamPtr;
+    typedef void* WinRTMidiMergePtr;
+    typedef void* WinRTMidiBrokerPtr;
+    typedef void* WinRTMidiSchedulerPtr;
+    typedef void* WinRTMidiBlockSenderPtr;
+
+    // Midi coalescer configuration
+    struct WinRTMidiCoalescerConfig
+    {
+        unsigned int typeMask;      // any of WINRT_MIDI_CONTROL_CHANGE, WINRT_MIDI_POLY_PRESSURE, WINRT_MIDI_CHANNEL_PRESSURE, WINRT_MIDI_PITCH_BEND
+        unsigned int flushInterval; // milliseconds. 0 only flushes on winrt_midi_*_port_flush and before other messages
+    };
+
+    // Midi clock state estimated from received MIDI clock
+    struct WinRTMidiClockState
+    {
+        double bpm;                     // 0 if no clock is received
+        double beatPhase;               // position within the current quarter note (0 - 1) while running
+        double jitter;                  // smoothed deviation of the clock intervals in milliseconds
+        unsigned long long position;    // midi clocks (24 per quarter note) since start or song position pointer
+        int running;                    // 1 after start or continue, 0 after stop
+    };
+
+    // Midi clock generator statistics. Jitter is the delay between the scheduled and actual send time in milliseconds
+    struct WinRTMidiClockStats
+    {
+        unsigned long long ticksSent;
+        double averageJitter;
+        double maxJitter;
+    };
+
+    // SysEx stream configuration
+    struct WinRTMidiSysExStreamConfig
+    {
+        unsigned int chunkSize;         // bytes per chunk, 0 for the default (256)
+        unsigned int bufferCount;       // chunks that can be queued, 0 for the default (4)
+        double bytesPerMillisecond;     // maximum data rate, 0 for no limit (a DIN MIDI cable carries 3.125)
+        double chunkGap;                // additional pause after each chunk in milliseconds
+    };
+
+    // Midi merge statistics
+    struct WinRTMidiMergeStats
+    {
+        unsigned long long messagesMerged;
+        unsigned long long messagesLate;    // messages that arrived after the reorder window and were delivered out of order
+        unsigned long long messagesDropped; // messages dropped because the queue of their port was full
+    };
+
+    // Midi network port settings. Times are in milliseconds
+    struct WinRTMidiNetworkConfig
+    {
+        double batchWindow;         // time an out port collects messages into one packet, 0 sends every message at once
+        double jitterBuffer;        // time an in port holds packets to reorder them and absorb network jitter
+        double lossRate;            // testing: fraction (0 - 1) of the packets an out port drops
+        double delay;               // testing: delay an out port adds to every packet
+        double delayJitter;         // testing: random additional delay (0 - delayJitter) per packet; reorders packets
+    };
+
+    // Midi network port statistics
+    struct WinRTMidiNetworkStats
+    {
+        unsigned long long packetsSent;
+        unsigned long long packetsReceived;
+        unsigned long long packetsLost;         // packets that never arrived or arrived after their playout time
+        unsigned long long packetsLate;         // packets that arrived after their playout time or twice
+        unsigned long long packetsInjectedLoss; // packets dropped by the loss injector (lossRate)
+        unsigned long long journalRecoveries;   // times the channel state was repaired from a packet journal
+    };
+
+    // Midi channel state of a port
+    struct WinRTMidiChannelStateSnapshot
+    {
+        unsigned int activeNotes[16][4];    // note n of a channel is on if bit (n % 32) of activeNotes[channel][n / 32] is set
+        unsigned char controllers[16][128];
+        unsigned char programs[16];
+        unsigned short pitchBend[16];       // 0 - 16383, 8192 is center
+    };
+
+    // Decoded controller, RPN or NRPN value
+    struct WinRTMidiParameterEvent
+    {
+        WinRTMidiParameterType type;
+        unsigned char channel;      // 0 - 15
+        unsigned short number;      // controller number or 14 bit parameter number
+        unsigned short value;       // 14 bit value (7 bit for WINRT_PARAMETER_CONTROLLER)
+    };
+
+    // Per note MPE event. Every event carries the current expression of the note
+    struct WinRTMidiMpeEvent
+    {
+        WinRTMidiMpeEventType type;
+        unsigned int noteId;        // identifies the note from note on to note off
+        unsigned char zone;         // 0 lower zone, 1 upper zone
+        unsigned char channel;      // member channel (0 - 15)
+        unsigned char note;
+        unsigned char velocity;     // note on or note off velocity
+        float pitchBend;            // semitones, member and manager pitch bend combined
+        float pressure;             // 0 - 1
+        float timbre;               // 0 - 1
+    };
 
     // Midi port changed callback
     typedef void(*MidiPortChangedCallback) (const WinRTMidiPortWatcherPtr portWatcher, WinRTMidiPortUpdateType update);
@@ -46,9 +211,127 @@ namespace WinRT
     // Midi In callback
     typedef void(*WinRTMidiInCallback) (const WinRTMidiInPortPtr port, double timeStamp, const unsigned char* message, unsigned int nBytes);
 
+    // Midi in callback delivering Universal MIDI Packets
+    typedef void(*WinRTMidiUmpCallback) (const WinRTMidiInPortPtr port, double timeStamp, const unsigned int* words, unsigned int nWords);
+
+    // Midi in callback delivering decoded controller, RPN and NRPN values
+    typedef void(*WinRTMidiParameterCallback) (const WinRTMidiInPortPtr port, double timeStamp, const WinRTMidiParameterEvent* event);
+
+    // Midi in callback delivering MPE note events
+    typedef void(*WinRTMidiMpeCallback) (const WinRTMidiInPortPtr port, double timeStamp, const WinRTMidiMpeEvent* event);
+
+    // SysEx stream progress callback. totalBytes is the value passed to winrt_sysex_stream_begin
+    typedef void(*WinRTMidiSysExProgressCallback) (const WinRTMidiSysExStreamPtr stream, unsigned long long bytesSent, unsigned long long totalBytes);
+
+    // Midi in callback delivering a complete SysEx message (F0 ... F7)
+    typedef void(*WinRTMidiSysExCallback) (const WinRTMidiInPortPtr port, double timeStamp, const unsigned char* message, unsigned int nBytes);
+
+    // Merged midi in callback. source is the index of the message's port in the ports passed to winrt_merge_start
+    typedef void(*WinRTMidiMergeCallback) (const WinRTMidiMergePtr merge, double timeStamp, unsigned int source, const unsigned char* message, unsigned int nBytes);
+
+    // Midi In subscriber statistics. Delays are in milliseconds
+    struct WinRTMidiSubscriberStats
+    {
+        unsigned long long messagesDelivered;
+        unsigned long long messagesDropped; // messages dropped because the subscriber queue was full
+        double averageQueueDelay;
+        double maxQueueDelay;
+    };
+
+    // SysEx reassembly statistics of a midi in port
+    struct WinRTMidiSysExStats
+    {
+        unsigned long long messagesDelivered;
+        unsigned long long bytesDelivered;
+        unsigned long long messagesDropped;     // messages larger than the maximum size, or ended without F7
+    };
+
+    // Midi In dispatcher thread settings
+    struct WinRTMidiDispatcherConfig
+    {
+        int threadPriority;                 // Win32 thread priority (THREAD_PRIORITY_*)
+        unsigned long long affinityMask;    // CPU affinity mask of the dispatcher thread. 0 = no affinity
+        unsigned int queueCapacity;         // maximum number of queued messages. 0 = default (4096)
+    };
+
+    // Resource budgets of a WinRTMidi instance. Buffers, queues and threads are allocated by winrt_initialize_midi_ex.
+    // Fields set to 0 use the default.
+    struct WinRTMidiConfig
+    {
+        unsigned int maxPorts;                  // ports listed per port watcher without reallocating. 0 = default (64)
+        unsigned int outputBufferCount;         // send buffers, one per open device out port. 0 = default (16)
+        unsigned int outputBufferSize;          // bytes per send buffer. 0 = default (128)
+        WinRTMidiOverflowPolicy outputOverflow; // messages larger than a send buffer and out ports opened when all buffers are in use:
+                                                // WINRT_OVERFLOW_GROW (default) allocates, WINRT_OVERFLOW_SPLIT splits messages and
+                                                // fails the open, WINRT_OVERFLOW_DROP_NEWEST drops messages and fails the open
+        unsigned int maxSysExSize;              // longer received messages are dropped before they are queued. Also the
+                                                // winrt_midi_in_port_set_sysex_callback limit when it is called with 0. 0 = no limit
+        unsigned int dispatcherThreads;         // input dispatcher threads started at initialization (at most 16). Ports are
+                                                // assigned to them in turn. 0 = callbacks on the WinRT threads
+        WinRTMidiDispatcherConfig dispatcher;   // priority (0 is THREAD_PRIORITY_NORMAL), affinity and queue capacity of each
+                                                // dispatcher thread. Also used by winrt_enable_input_dispatcher with nullptr
+        WinRTMidiOverflowPolicy inputOverflow;  // full dispatcher queues: WINRT_OVERFLOW_DROP_NEWEST (default) or WINRT_OVERFLOW_DROP_OLDEST
+    };
+
+    // Connection statistics of a port. Times are in seconds
+    struct WinRTMidiConnectionStats
+    {
+        int connected;                  // 0 while the device of the port is removed
+        unsigned int disconnects;       // times the device was removed while the port was open
+        unsigned int reconnects;        // times the port was reopened when its device came back
+        double lastOutage;              // time from the last removal to the reconnection
+        double longestOutage;
+        double totalOutage;             // includes the current outage
+    };
+
+    // Midi scheduler statistics. Lateness is the delay between the scheduled and actual release time in milliseconds.
+    // Events scheduled before the current position count as late.
+    struct WinRTMidiSchedulerStats
+    {
+        unsigned long long eventsSent;
+        unsigned long long eventsPending;
+        double averageLateness;
+        double maxLateness;
+    };
+
+    // Midi message rendered in an audio block, frameOffset frames after the first frame of the block
+    struct WinRTMidiBlockEvent
+    {
+        unsigned int frameOffset;
+        unsigned int nBytes;
+        const unsigned char* message;
+    };
+
+    // Midi block sender statistics. Jitter is the delay between the intended and actual send time in milliseconds
+    struct WinRTMidiBlockSenderStats
+    {
+        unsigned long long messagesSent;
+        unsigned long long messagesDropped;     // messages dropped because the queue was full
+        unsigned long long messagesLate;        // messages sent more than 1 ms late, usually because the latency is too short
+        double averageJitter;
+        double maxJitter;
+    };
+
+    // Midi In dispatcher statistics. Delays are in milliseconds
+    struct WinRTMidiDispatcherStats
+    {
+        unsigned long long messagesDispatched;
+        unsigned long long messagesDropped; // messages dropped because the queue was full
+        double averageQueueDelay;
+        double maxQueueDelay;
+    };
+
     // WinRT Midi Functions
+    // The port watchers and the opened devices are shared by all instances of the process. Only the first
+    // initialization waits for the device enumeration; the callback of every instance receives EnumerationComplete.
     typedef WinRTMidiErrorType(__cdecl *WinRTMidiInitializeFunc)(MidiPortChangedCallback callback, WinRTMidiPtr* midi);
     WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_initialize_midi(MidiPortChangedCallback callback, WinRTMidiPtr* winrtMidi);
+
+    // Like winrt_initialize_midi, but allocates the buffers, queues and threads of the instance up front. config can be nullptr
+    // for the defaults. Port and message objects of Windows::Devices::Midi are still allocated by Windows when ports are opened.
+    // maxPorts only applies to the first initialization of the process, which creates the shared port watchers.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiInitializeExFunc)(MidiPortChangedCallback callback, const WinRTMidiConfig* config, WinRTMidiPtr* midi);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_initialize_midi_ex(MidiPortChangedCallback callback, const WinRTMidiConfig* config, WinRTMidiPtr* winrtMidi);
  
     typedef void(__cdecl *WinRTMidiFreeFunc)(WinRTMidiPtr midi);
     WINRTMIDI_API void __cdecl winrt_free_midi(WinRTMidiPtr midi);
@@ -56,13 +339,214 @@ namespace WinRT
     typedef const WinRTMidiPortWatcherPtr(__cdecl *WinRTMidiGetPortWatcherFunc)(WinRTMidiPtr midi, WinRTMidiPortType type);
     WINRTMIDI_API const WinRTMidiPortWatcherPtr __cdecl winrt_get_portwatcher(WinRTMidiPtr midi, WinRTMidiPortType type);
 
+    // Routes the callbacks of all midi in ports opened after this call through a dedicated dispatcher thread.
+    // Calling it again updates the thread priority and affinity of the running dispatcher.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiEnableInputDispatcherFunc)(WinRTMidiPtr midi, const WinRTMidiDispatcherConfig* config);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_enable_input_dispatcher(WinRTMidiPtr midi, const WinRTMidiDispatcherConfig* config);
+
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiGetInputDispatcherStatsFunc)(WinRTMidiPtr midi, WinRTMidiDispatcherStats* stats);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_get_input_dispatcher_stats(WinRTMidiPtr midi, WinRTMidiDispatcherStats* stats);
+
     // WinRT Midi In Port Functions
+    // In and out port handles are checked on every call: a handle that was freed returns WINRT_INVALID_PARAMETER_ERROR
+    // (functions without a result ignore it). At most 256 in and 256 out ports can be open at the same time.
     typedef WinRTMidiErrorType(__cdecl *WinRTMidiInPortOpenFunc)(WinRTMidiPtr midi, unsigned int index, WinRTMidiInCallback callback, WinRTMidiInPortPtr* midiPort);
     WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_open_midi_in_port(WinRTMidiPtr midi, unsigned int index, WinRTMidiInCallback callback, WinRTMidiInPortPtr* midiPort);
 
     typedef void(__cdecl *WinRTMidiInPortFreeFunc)(WinRTMidiInPortPtr port);
     WINRTMIDI_API void __cdecl winrt_free_midi_in_port(WinRTMidiInPortPtr port);
 
+    // Adds a subscriber to an open midi in port. The subscriber callback is called on its own thread with the
+    // messages matching typeMask (WinRTMidiMessageTypeMask bits) and channelMask (bit n = channel n + 1).
+    // queueCapacity = 0 uses the default capacity (1024). Messages are dropped if the subscriber queue is full.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiInPortSubscribeFunc)(WinRTMidiInPortPtr port, WinRTMidiInCallback callback, unsigned int typeMask, unsigned int channelMask, unsigned int queueCapacity, WinRTMidiSubscriberPtr* subscriber);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_in_port_subscribe(WinRTMidiInPortPtr port, WinRTMidiInCallback callback, unsigned int typeMask, unsigned int channelMask, unsigned int queueCapacity, WinRTMidiSubscriberPtr* subscriber);
+
+    // must not be called from the callback of the subscriber being removed
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiInPortUnsubscribeFunc)(WinRTMidiInPortPtr port, WinRTMidiSubscriberPtr subscriber);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_in_port_unsubscribe(WinRTMidiInPortPtr port, WinRTMidiSubscriberPtr subscriber);
+
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiSubscriberGetStatsFunc)(WinRTMidiSubscriberPtr subscriber, WinRTMidiSubscriberStats* stats);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_subscriber_get_stats(WinRTMidiSubscriberPtr subscriber, WinRTMidiSubscriberStats* stats);
+
+    // Only messages matching typeMask (WinRTMidiMessageTypeMask bits) are passed to the midi in callback.
+    // The default is WINRT_MIDI_ALL_MESSAGES. Clock messages are tracked even if they are filtered.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiInPortSetFilterFunc)(WinRTMidiInPortPtr port, unsigned int typeMask);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_in_port_set_filter(WinRTMidiInPortPtr port, unsigned int typeMask);
+
+    // tempo, beat phase and transport state of the MIDI clock received by the port
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiInPortGetClockFunc)(WinRTMidiInPortPtr port, WinRTMidiClockState* state);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_in_port_get_clock(WinRTMidiInPortPtr port, WinRTMidiClockState* state);
+
+    // state of the 16 channels of the messages received by the port
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiInPortGetChannelStateFunc)(WinRTMidiInPortPtr port, WinRTMidiChannelStateSnapshot* snapshot);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_in_port_get_channel_state(WinRTMidiInPortPtr port, WinRTMidiChannelStateSnapshot* snapshot);
+
+    // All messages received by the in port are also sent to the out port. If the in port device is removed,
+    // note offs for its active notes are sent to all routed out ports.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiInPortAddRouteFunc)(WinRTMidiInPortPtr port, WinRTMidiOutPortPtr destination);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_in_port_add_route(WinRTMidiInPortPtr port, WinRTMidiOutPortPtr destination);
+
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiInPortRemoveRouteFunc)(WinRTMidiInPortPtr port, WinRTMidiOutPortPtr destination);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_in_port_remove_route(WinRTMidiInPortPtr port, WinRTMidiOutPortPtr destination);
+
+    // Coalesces high rate controller messages before they are passed to the midi in callback: only the latest value
+    // per channel and controller is delivered at each flush. Notes and SysEx are not reordered. Pass a nullptr config to disable.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiInPortSetCoalescerFunc)(WinRTMidiInPortPtr port, const WinRTMidiCoalescerConfig* config);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_in_port_set_coalescer(WinRTMidiInPortPtr port, const WinRTMidiCoalescerConfig* config);
+
+    // delivers the pending coalesced messages now (e.g. at the start of a processing block)
+    typedef void(__cdecl *WinRTMidiInPortFlushFunc)(WinRTMidiInPortPtr port);
+    WINRTMIDI_API void __cdecl winrt_midi_in_port_flush(WinRTMidiInPortPtr port);
+
+    // Delivers all messages of the port as Universal MIDI Packets of the given protocol and group (0 - 15).
+    // The callback is called on the thread that received the message. Pass a nullptr callback to remove it.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiInPortSetUmpCallbackFunc)(WinRTMidiInPortPtr port, WinRTMidiUmpCallback callback, WinRTMidiUmpProtocol protocol, unsigned int group);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_in_port_set_ump_callback(WinRTMidiInPortPtr port, WinRTMidiUmpCallback callback, WinRTMidiUmpProtocol protocol, unsigned int group);
+
+    // Decodes the control change messages of the port into 14 bit controller, RPN and NRPN events. A controller
+    // pair or a complete data entry produces a single event. The callback is called on the thread that received
+    // the message, the control changes are still passed to the midi in callback (see winrt_midi_in_port_set_filter).
+    // Pass a nullptr callback to remove it.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiInPortSetParameterCallbackFunc)(WinRTMidiInPortPtr port, WinRTMidiParameterCallback callback);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_in_port_set_parameter_callback(WinRTMidiInPortPtr port, WinRTMidiParameterCallback callback);
+
+    // Enables MPE mode: the messages of the port's MPE zones are delivered as per note events. The zones follow the
+    // MPE Configuration Message (a lower zone with 15 member channels is assumed until one is received).
+    // The callback is called on the thread that received the message. Pass a nullptr callback to remove it.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiInPortSetMpeCallbackFunc)(WinRTMidiInPortPtr port, WinRTMidiMpeCallback callback);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_in_port_set_mpe_callback(WinRTMidiInPortPtr port, WinRTMidiMpeCallback callback);
+
+    // Reassembles SysEx messages received in several fragments and passes each complete message to the callback.
+    // The message stays valid until it is released with winrt_midi_in_port_release_sysex, which must happen before
+    // the port is freed. Messages larger than maxSize (0 for 64 KB, at most 16 MB) are dropped. The callback is
+    // called on the thread that received the message. Pass a nullptr callback to remove it.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiInPortSetSysExCallbackFunc)(WinRTMidiInPortPtr port, WinRTMidiSysExCallback callback, unsigned int maxSize);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_in_port_set_sysex_callback(WinRTMidiInPortPtr port, WinRTMidiSysExCallback callback, unsigned int maxSize);
+
+    // returns a message passed to the SysEx callback to the port's buffer pool
+    typedef void(__cdecl *WinRTMidiInPortReleaseSysExFunc)(WinRTMidiInPortPtr port, const unsigned char* message);
+    WINRTMIDI_API void __cdecl winrt_midi_in_port_release_sysex(WinRTMidiInPortPtr port, const unsigned char* message);
+
+    // SysEx reassembly statistics. The counters are kept when the SysEx callback is removed and set again
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiInPortGetSysExStatsFunc)(WinRTMidiInPortPtr port, WinRTMidiSysExStats* stats);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_in_port_get_sysex_stats(WinRTMidiInPortPtr port, WinRTMidiSysExStats* stats);
+
+    // Opens a midi in port that is not connected to a device. It only receives messages replayed with winrt_replay_start
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiInLoopbackPortOpenFunc)(WinRTMidiPtr midi, WinRTMidiInCallback callback, WinRTMidiInPortPtr* midiPort);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_open_midi_in_loopback_port(WinRTMidiPtr midi, WinRTMidiInCallback callback, WinRTMidiInPortPtr* midiPort);
+
+    // WinRT Midi Recorder Functions
+    // Records the channel and SysEx messages of a midi in port to a Standard MIDI File (type 1). path is UTF-8.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiRecordStartFunc)(WinRTMidiInPortPtr port, const char* path, WinRTMidiRecorderPtr* recorder);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_record_start(WinRTMidiInPortPtr port, const char* path, WinRTMidiRecorderPtr* recorder);
+
+    // completes the file and frees the recorder
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiRecordStopFunc)(WinRTMidiRecorderPtr recorder);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_record_stop(WinRTMidiRecorderPtr recorder);
+
+    // WinRT Midi Capture Functions
+    // Captures all messages of the in ports with their timestamps to a compact binary file. path is UTF-8.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiCaptureStartFunc)(WinRTMidiInPortPtr* ports, unsigned int nPorts, const char* path, WinRTMidiCapturePtr* capture);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_capture_start(WinRTMidiInPortPtr* ports, unsigned int nPorts, const char* path, WinRTMidiCapturePtr* capture);
+
+    // completes the file and frees the capture
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiCaptureStopFunc)(WinRTMidiCapturePtr capture);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_capture_stop(WinRTMidiCapturePtr capture);
+
+    // Replays a capture file into in ports (capture port n to ports[n % nPorts]) as if the messages were received by the ports.
+    // speed 1.0 replays in real time, 2.0 twice as fast and 0 as fast as possible.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiReplayStartFunc)(const char* path, WinRTMidiInPortPtr* ports, unsigned int nPorts, double speed, WinRTMidiReplayPtr* replay);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_replay_start(const char* path, WinRTMidiInPortPtr* ports, unsigned int nPorts, double speed, WinRTMidiReplayPtr* replay);
+
+    // blocks until the replay is complete
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiReplayWaitFunc)(WinRTMidiReplayPtr replay);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_replay_wait(WinRTMidiReplayPtr replay);
+
+    // stops the replay and frees it
+    typedef void(__cdecl *WinRTMidiReplayStopFunc)(WinRTMidiReplayPtr replay);
+    WINRTMIDI_API void __cdecl winrt_replay_stop(WinRTMidiReplayPtr replay);
+
+    // WinRT Midi Merge Functions
+    // Merges the messages of up to 16 in ports into one stream ordered by timestamp, delivered on a merge thread.
+    // Messages are held for reorderWindow milliseconds so messages of other ports with earlier timestamps can be
+    // delivered first. queueCapacity is the queue size per port (0 for the default).
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiMergeStartFunc)(WinRTMidiInPortPtr* ports, unsigned int nPorts, double reorderWindow, unsigned int queueCapacity, WinRTMidiMergeCallback callback, WinRTMidiMergePtr* merge);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_merge_start(WinRTMidiInPortPtr* ports, unsigned int nPorts, double reorderWindow, unsigned int queueCapacity, WinRTMidiMergeCallback callback, WinRTMidiMergePtr* merge);
+
+    // stops merging and frees the merge
+    typedef void(__cdecl *WinRTMidiMergeStopFunc)(WinRTMidiMergePtr merge);
+    WINRTMIDI_API void __cdecl winrt_merge_stop(WinRTMidiMergePtr merge);
+
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiMergeGetStatsFunc)(WinRTMidiMergePtr merge, WinRTMidiMergeStats* stats);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_merge_get_stats(WinRTMidiMergePtr merge, WinRTMidiMergeStats* stats);
+
+    // WinRT Midi Broker Functions
+    // Shares ports with other processes of the session: the messages of inPort are published to the processes that
+    // open an in broker port with the same name, and the messages they send to an out broker port are sent to outPort.
+    // Either port may be nullptr. name must not contain slashes or backslashes.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiBrokerStartFunc)(WinRTMidiInPortPtr inPort, WinRTMidiOutPortPtr outPort, const char* name, WinRTMidiBrokerPtr* broker);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_broker_start(WinRTMidiInPortPtr inPort, WinRTMidiOutPortPtr outPort, const char* name, WinRTMidiBrokerPtr* broker);
+
+    // stops sharing the ports and frees the broker
+    typedef void(__cdecl *WinRTMidiBrokerStopFunc)(WinRTMidiBrokerPtr broker);
+    WINRTMIDI_API void __cdecl winrt_broker_stop(WinRTMidiBrokerPtr broker);
+
+    // Opens a midi in port that receives the messages published by a broker. The port is used and freed like any other in port.
+    // Messages are read from the shared memory in place and passed to the callback on a reader thread.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiInBrokerPortOpenFunc)(WinRTMidiPtr midi, const char* name, WinRTMidiInCallback callback, WinRTMidiInPortPtr* midiPort);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_open_midi_in_broker_port(WinRTMidiPtr midi, const char* name, WinRTMidiInCallback callback, WinRTMidiInPortPtr* midiPort);
+
+    // Opens a midi out port whose messages are sent by a broker. The port is used and freed like any other out port.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiOutBrokerPortOpenFunc)(WinRTMidiPtr midi, const char* name, WinRTMidiOutPortPtr* midiPort);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_open_midi_out_broker_port(WinRTMidiPtr midi, const char* name, WinRTMidiOutPortPtr* midiPort);
+
+    // WinRT Midi Network Functions
+    // Adds an RTP MIDI network endpoint to the port watcher of type. It is listed and opened like a device port
+    // (winrt_open_midi_in_port / winrt_open_midi_out_port). An in port receives packets on host:port (host "0.0.0.0"
+    // for all interfaces), an out port sends them to host:port.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiAddNetworkPortFunc)(WinRTMidiPtr midi, WinRTMidiPortType type, const char* name, const char* host, unsigned short port);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_add_network_port(WinRTMidiPtr midi, WinRTMidiPortType type, const char* name, const char* host, unsigned short port);
+
+    // removes a network endpoint added with the same midi pointer. Open ports are notified like ports of a
+    // removed device. The endpoints still added are removed by winrt_free_midi
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiRemoveNetworkPortFunc)(WinRTMidiPtr midi, WinRTMidiPortType type, const char* host, unsigned short port);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_remove_network_port(WinRTMidiPtr midi, WinRTMidiPortType type, const char* host, unsigned short port);
+
+    // settings of the network ports opened after this call. The loss and delay settings are meant for testing
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiSetNetworkConfigFunc)(WinRTMidiPtr midi, const WinRTMidiNetworkConfig* config);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_set_network_config(WinRTMidiPtr midi, const WinRTMidiNetworkConfig* config);
+
+    // returns WINRT_INVALID_PARAMETER_ERROR if the port is not a network port
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiInPortGetNetworkStatsFunc)(WinRTMidiInPortPtr port, WinRTMidiNetworkStats* stats);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_in_port_get_network_stats(WinRTMidiInPortPtr port, WinRTMidiNetworkStats* stats);
+
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiOutPortGetNetworkStatsFunc)(WinRTMidiOutPortPtr port, WinRTMidiNetworkStats* stats);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_out_port_get_network_stats(WinRTMidiOutPortPtr port, WinRTMidiNetworkStats* stats);
+
+    // WinRT Midi Reconnect Functions
+    // With auto reconnect the in and out ports opened by midi keep their handle and callbacks when their device is
+    // removed. When the device is added again the port reopens it in the background. Disabled by default
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiSetAutoReconnectFunc)(WinRTMidiPtr midi, int enable);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_set_auto_reconnect(WinRTMidiPtr midi, int enable);
+
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiInPortGetConnectionStatsFunc)(WinRTMidiInPortPtr port, WinRTMidiConnectionStats* stats);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_in_port_get_connection_stats(WinRTMidiInPortPtr port, WinRTMidiConnectionStats* stats);
+
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiOutPortGetConnectionStatsFunc)(WinRTMidiOutPortPtr port, WinRTMidiConnectionStats* stats);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_out_port_get_connection_stats(WinRTMidiOutPortPtr port, WinRTMidiConnectionStats* stats);
+
+    // WinRT Midi Virtual Port Functions
+    // Creates an in memory port pair that does not need a device driver: messages sent to outPort are received by
+    // inPort on the pair's thread. The pair is listed by both port watchers under name (PortAdded is raised), so other
+    // code can open more in and out ports on it. The returned ports are freed like other ports.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiCreateVirtualPortPairFunc)(WinRTMidiPtr midi, const char* name, WinRTMidiInCallback callback, WinRTMidiInPortPtr* inPort, WinRTMidiOutPortPtr* outPort);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_create_virtual_port_pair(WinRTMidiPtr midi, const char* name, WinRTMidiInCallback callback, WinRTMidiInPortPtr* inPort, WinRTMidiOutPortPtr* outPort);
+
+    // removes the pair from the port watchers (PortRemoved is raised). Ports still open on the pair keep working
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiRemoveVirtualPortPairFunc)(WinRTMidiPtr midi, const char* name);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_remove_virtual_port_pair(WinRTMidiPtr midi, const char* name);
+
     // WinRT Midi Out Port Functions
     typedef WinRTMidiErrorType(__cdecl *WinRTMidiOutPortOpenFunc)(WinRTMidiPtr midi, unsigned int index, WinRTMidiOutPortPtr* midiPort);
     WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_open_midi_out_port(WinRTMidiPtr midi, unsigned int index, WinRTMidiOutPortPtr* midiPort);
@@ -70,8 +554,206 @@ namespace WinRT
     typedef void(__cdecl *WinRTMidiOutPortFreeFunc)(WinRTMidiOutPortPtr port);
     WINRTMIDI_API void __cdecl winrt_free_midi_out_port(WinRTMidiOutPortPtr port);
 
-    typedef void(__cdecl *WinRTMidiOutPortSendFunc)(WinRTMidiOutPortPtr port, const unsigned char* message, unsigned int nBytes);
-    WINRTMIDI_API void __cdecl winrt_midi_out_port_send(WinRTMidiOutPortPtr port, const unsigned char* message, unsigned int nBytes);
+    // returns WINRT_PORT_CLOSED_ERROR if the device of the port was removed, WINRT_MEMORY_ERROR if the message
+    // did not fit the send buffer and the output overflow policy is WINRT_OVERFLOW_DROP_NEWEST
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiOutPortSendFunc)(WinRTMidiOutPortPtr port, const unsigned char* message, unsigned int nBytes);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_out_port_send(WinRTMidiOutPortPtr port, const unsigned char* message, unsigned int nBytes);
+
+    // state of the 16 channels of the messages sent to the port
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiOutPortGetChannelStateFunc)(WinRTMidiOutPortPtr port, WinRTMidiChannelStateSnapshot* snapshot);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_out_port_get_channel_state(WinRTMidiOutPortPtr port, WinRTMidiChannelStateSnapshot* snapshot);
+
+    // sends sustain off and note off messages for the notes that are still on
+    typedef void(__cdecl *WinRTMidiOutPortAllNotesOffFunc)(WinRTMidiOutPortPtr port);
+    WINRTMIDI_API void __cdecl winrt_midi_out_port_all_notes_off(WinRTMidiOutPortPtr port);
+
+    // Coalesces high rate controller messages sent with winrt_midi_out_port_send. Pass a nullptr config to disable.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiOutPortSetCoalescerFunc)(WinRTMidiOutPortPtr port, const WinRTMidiCoalescerConfig* config);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_out_port_set_coalescer(WinRTMidiOutPortPtr port, const WinRTMidiCoalescerConfig* config);
+
+    // sends the pending coalesced messages now (e.g. at the end of a batch of messages)
+    typedef void(__cdecl *WinRTMidiOutPortFlushFunc)(WinRTMidiOutPortPtr port);
+    WINRTMIDI_API void __cdecl winrt_midi_out_port_flush(WinRTMidiOutPortPtr port);
+
+    // Sends Universal MIDI Packets (system, MIDI 1.0 and MIDI 2.0 channel voice and SysEx7) as MIDI 1.0 messages
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiOutPortSendUmpFunc)(WinRTMidiOutPortPtr port, const unsigned int* words, unsigned int nWords);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_midi_out_port_send_ump(WinRTMidiOutPortPtr port, const unsigned int* words, unsigned int nWords);
+
+    // WinRT Midi Clock Generator Functions
+    // Sends 24 PPQN MIDI clock (0xF8) to the out ports at bpm (1 - 1000) until winrt_clock_stop is called
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiClockStartFunc)(WinRTMidiOutPortPtr* ports, unsigned int nPorts, double bpm, WinRTMidiClockPtr* clock);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_clock_start(WinRTMidiOutPortPtr* ports, unsigned int nPorts, double bpm, WinRTMidiClockPtr* clock);
+
+    // stops sending clock and frees the clock generator
+    typedef void(__cdecl *WinRTMidiClockStopFunc)(WinRTMidiClockPtr clock);
+    WINRTMIDI_API void __cdecl winrt_clock_stop(WinRTMidiClockPtr clock);
+
+    // the new tempo starts at the next tick
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiClockSetTempoFunc)(WinRTMidiClockPtr clock, double bpm);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_clock_set_tempo(WinRTMidiClockPtr clock, double bpm);
+
+    // Transport messages are sent right before the next tick, in the order they were sent (up to 16 per tick).
+    // After start (0xFA) the next tick is the first beat
+    typedef void(__cdecl *WinRTMidiClockSendStartFunc)(WinRTMidiClockPtr clock);
+    WINRTMIDI_API void __cdecl winrt_clock_send_start(WinRTMidiClockPtr clock);
+
+    typedef void(__cdecl *WinRTMidiClockSendContinueFunc)(WinRTMidiClockPtr clock);
+    WINRTMIDI_API void __cdecl winrt_clock_send_continue(WinRTMidiClockPtr clock);
+
+    typedef void(__cdecl *WinRTMidiClockSendStopFunc)(WinRTMidiClockPtr clock);
+    WINRTMIDI_API void __cdecl winrt_clock_send_stop(WinRTMidiClockPtr clock);
+
+    // song position pointer in sixteenth notes (0 - 16383)
+    typedef void(__cdecl *WinRTMidiClockSendSongPositionFunc)(WinRTMidiClockPtr clock, unsigned int position);
+    WINRTMIDI_API void __cdecl winrt_clock_send_song_position(WinRTMidiClockPtr clock, unsigned int position);
+
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiClockGetStatsFunc)(WinRTMidiClockPtr clock, WinRTMidiClockStats* stats);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_clock_get_stats(WinRTMidiClockPtr clock, WinRTMidiClockStats* stats);
+
+    // WinRT Midi UMP Functions
+    // Converts packed MIDI 1.0 channel voice messages (status | data1 << 8 | data2 << 16) to UMP.
+    // ump must hold count words (WINRT_UMP_MIDI1) or 2 * count words (WINRT_UMP_MIDI2). Returns the number of words written.
+    typedef unsigned int(__cdecl *WinRTMidiToUmpFunc)(const unsigned int* messages, unsigned int count, unsigned int group, WinRTMidiUmpProtocol protocol, unsigned int* ump);
+    WINRTMIDI_API unsigned int __cdecl winrt_midi_to_ump(const unsigned int* messages, unsigned int count, unsigned int group, WinRTMidiUmpProtocol protocol, unsigned int* ump);
+
+    // Converts count channel voice packets of one protocol (note on to pitch bend) to packed MIDI 1.0 messages.
+    // Returns the number of messages written.
+    typedef unsigned int(__cdecl *WinRTUmpToMidiFunc)(const unsigned int* ump, unsigned int count, WinRTMidiUmpProtocol protocol, unsigned int* messages);
+    WINRTMIDI_API unsigned int __cdecl winrt_ump_to_midi(const unsigned int* ump, unsigned int count, WinRTMidiUmpProtocol protocol, unsigned int* messages);
+
+    // WinRT Midi SysEx Functions
+    // Packs 8 bit data into 7 bit SysEx bytes: each group of up to 7 data bytes is preceded by a byte holding their
+    // high bits (bit n for data byte n). packed must hold nBytes + (nBytes + 6) / 7 bytes. Returns the number of bytes written.
+    typedef unsigned int(__cdecl *WinRTSysExPackFunc)(const unsigned char* data, unsigned int nBytes, unsigned char* packed);
+    WINRTMIDI_API unsigned int __cdecl winrt_sysex_pack(const unsigned char* data, unsigned int nBytes, unsigned char* packed);
+
+    // Reverses winrt_sysex_pack. data must hold nBytes - (nBytes + 7) / 8 bytes. Returns the number of bytes written.
+    typedef unsigned int(__cdecl *WinRTSysExUnpackFunc)(const unsigned char* packed, unsigned int nBytes, unsigned char* data);
+    WINRTMIDI_API unsigned int __cdecl winrt_sysex_unpack(const unsigned char* packed, unsigned int nBytes, unsigned char* data);
+
+    // Roland checksum of the address and data bytes of a SysEx message
+    typedef unsigned char(__cdecl *WinRTSysExRolandChecksumFunc)(const unsigned char* data, unsigned int nBytes);
+    WINRTMIDI_API unsigned char __cdecl winrt_sysex_roland_checksum(const unsigned char* data, unsigned int nBytes);
+
+    // Streams a SysEx message to a midi out port in paced chunks from a fixed pool of buffers. The data written must
+    // form the complete message (F0 ... F7). Only realtime messages should be sent to the port while streaming.
+    // totalBytes is only passed to the progress callback, which is called from the sender thread after each chunk.
+    typedef WinRTMidiErrorType(__cdecl *WinRTSysExStreamBeginFunc)(WinRTMidiOutPortPtr port, const WinRTMidiSysExStreamConfig* config, unsigned long long totalBytes, WinRTMidiSysExProgressCallback callback, WinRTMidiSysExStreamPtr* stream);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_sysex_stream_begin(WinRTMidiOutPortPtr port, const WinRTMidiSysExStreamConfig* config, unsigned long long totalBytes, WinRTMidiSysExProgressCallback callback, WinRTMidiSysExStreamPtr* stream);
+
+    // blocks while all buffers are waiting to be sent
+    typedef WinRTMidiErrorType(__cdecl *WinRTSysExStreamWriteFunc)(WinRTMidiSysExStreamPtr stream, const unsigned char* data, unsigned int nBytes);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_sysex_stream_write(WinRTMidiSysExStreamPtr stream, const unsigned char* data, unsigned int nBytes);
+
+    // blocks until all data is sent and frees the stream
+    typedef WinRTMidiErrorType(__cdecl *WinRTSysExStreamEndFunc)(WinRTMidiSysExStreamPtr stream);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_sysex_stream_end(WinRTMidiSysExStreamPtr stream);
+
+    // WinRT Midi Player Functions
+    // Plays a Standard MIDI File to the out ports. Port meta events select the port (port n plays to ports[n % nPorts]). path is UTF-8.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiPlayerOpenFunc)(const char* path, WinRTMidiOutPortPtr* ports, unsigned int nPorts, WinRTMidiPlayerPtr* player);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_player_open(const char* path, WinRTMidiOutPortPtr* ports, unsigned int nPorts, WinRTMidiPlayerPtr* player);
+
+    typedef void(__cdecl *WinRTMidiPlayerFreeFunc)(WinRTMidiPlayerPtr player);
+    WINRTMIDI_API void __cdecl winrt_player_free(WinRTMidiPlayerPtr player);
+
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiPlayerStartFunc)(WinRTMidiPlayerPtr player);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_player_start(WinRTMidiPlayerPtr player);
+
+    // stops playback and turns off all notes
+    typedef void(__cdecl *WinRTMidiPlayerStopFunc)(WinRTMidiPlayerPtr player);
+    WINRTMIDI_API void __cdecl winrt_player_stop(WinRTMidiPlayerPtr player);
+
+    // position in seconds
+    typedef void(__cdecl *WinRTMidiPlayerSeekFunc)(WinRTMidiPlayerPtr player, double position);
+    WINRTMIDI_API void __cdecl winrt_player_seek(WinRTMidiPlayerPtr player, double position);
+
+    // loops between start and end (seconds). Set end <= start to disable looping
+    typedef void(__cdecl *WinRTMidiPlayerSetLoopFunc)(WinRTMidiPlayerPtr player, double start, double end);
+    WINRTMIDI_API void __cdecl winrt_player_set_loop(WinRTMidiPlayerPtr player, double start, double end);
+
+    typedef double(__cdecl *WinRTMidiPlayerGetPositionFunc)(WinRTMidiPlayerPtr player);
+    WINRTMIDI_API double __cdecl winrt_player_get_position(WinRTMidiPlayerPtr player);
+
+    typedef double(__cdecl *WinRTMidiPlayerGetDurationFunc)(WinRTMidiPlayerPtr player);
+    WINRTMIDI_API double __cdecl winrt_player_get_duration(WinRTMidiPlayerPtr player);
+
+    // tempo in beats per minute at the current position
+    typedef double(__cdecl *WinRTMidiPlayerGetTempoFunc)(WinRTMidiPlayerPtr player);
+    WINRTMIDI_API double __cdecl winrt_player_get_tempo(WinRTMidiPlayerPtr player);
+
+    // WinRT Midi Scheduler Functions
+    // Sends messages scheduled in ticks (ppq per quarter note) to the out ports. Messages for port n are sent to ports[n].
+    // The tempo map starts with bpm at tick 0 and can be edited at any time; pending messages follow the new tempo.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiSchedulerOpenFunc)(WinRTMidiOutPortPtr* ports, unsigned int nPorts, unsigned int ppq, double bpm, WinRTMidiSchedulerPtr* scheduler);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_scheduler_open(WinRTMidiOutPortPtr* ports, unsigned int nPorts, unsigned int ppq, double bpm, WinRTMidiSchedulerPtr* scheduler);
+
+    typedef void(__cdecl *WinRTMidiSchedulerFreeFunc)(WinRTMidiSchedulerPtr scheduler);
+    WINRTMIDI_API void __cdecl winrt_scheduler_free(WinRTMidiSchedulerPtr scheduler);
+
+    // starts releasing messages from the current position
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiSchedulerStartFunc)(WinRTMidiSchedulerPtr scheduler);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_scheduler_start(WinRTMidiSchedulerPtr scheduler);
+
+    // stops releasing messages and turns off all notes. Pending messages are kept
+    typedef void(__cdecl *WinRTMidiSchedulerStopFunc)(WinRTMidiSchedulerPtr scheduler);
+    WINRTMIDI_API void __cdecl winrt_scheduler_stop(WinRTMidiSchedulerPtr scheduler);
+
+    // moves to tick and drops the pending messages before it
+    typedef void(__cdecl *WinRTMidiSchedulerSeekFunc)(WinRTMidiSchedulerPtr scheduler, unsigned long long tick);
+    WINRTMIDI_API void __cdecl winrt_scheduler_seek(WinRTMidiSchedulerPtr scheduler, unsigned long long tick);
+
+    // messages at the same tick are sent in the order they were scheduled. Messages before the current position are sent immediately.
+    // port is an index into the ports passed to winrt_scheduler_open. Returns WINRT_INVALID_PARAMETER_ERROR if it is out of range
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiSchedulerScheduleFunc)(WinRTMidiSchedulerPtr scheduler, unsigned int port, unsigned long long tick, const unsigned char* message, unsigned int nBytes);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_scheduler_schedule(WinRTMidiSchedulerPtr scheduler, unsigned int port, unsigned long long tick, const unsigned char* message, unsigned int nBytes);
+
+    // drops all pending messages
+    typedef void(__cdecl *WinRTMidiSchedulerClearFunc)(WinRTMidiSchedulerPtr scheduler);
+    WINRTMIDI_API void __cdecl winrt_scheduler_clear(WinRTMidiSchedulerPtr scheduler);
+
+    // adds or replaces the tempo change at tick. bpm must be between 1 and 1000
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiSchedulerSetTempoFunc)(WinRTMidiSchedulerPtr scheduler, unsigned long long tick, double bpm);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_scheduler_set_tempo(WinRTMidiSchedulerPtr scheduler, unsigned long long tick, double bpm);
+
+    // the tempo at tick 0 cannot be removed
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiSchedulerRemoveTempoFunc)(WinRTMidiSchedulerPtr scheduler, unsigned long long tick);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_scheduler_remove_tempo(WinRTMidiSchedulerPtr scheduler, unsigned long long tick);
+
+    // position in ticks
+    typedef double(__cdecl *WinRTMidiSchedulerGetPositionFunc)(WinRTMidiSchedulerPtr scheduler);
+    WINRTMIDI_API double __cdecl winrt_scheduler_get_position(WinRTMidiSchedulerPtr scheduler);
+
+    // tempo in beats per minute at the current position
+    typedef double(__cdecl *WinRTMidiSchedulerGetTempoFunc)(WinRTMidiSchedulerPtr scheduler);
+    WINRTMIDI_API double __cdecl winrt_scheduler_get_tempo(WinRTMidiSchedulerPtr scheduler);
+
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiSchedulerGetStatsFunc)(WinRTMidiSchedulerPtr scheduler, WinRTMidiSchedulerStats* stats);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_scheduler_get_stats(WinRTMidiSchedulerPtr scheduler, WinRTMidiSchedulerStats* stats);
+
+    // WinRT Midi Block Sender Functions
+    // Sends messages rendered by an audio callback at the time of their frame plus a constant latency (milliseconds, 0 - 1000)
+    // instead of all at once from the callback. The latency must cover the delay between the start of a block and the
+    // winrt_block_sender_send call.
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiBlockSenderOpenFunc)(WinRTMidiOutPortPtr port, double sampleRate, double latency, WinRTMidiBlockSenderPtr* sender);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_block_sender_open(WinRTMidiOutPortPtr port, double sampleRate, double latency, WinRTMidiBlockSenderPtr* sender);
+
+    // messages still queued are dropped
+    typedef void(__cdecl *WinRTMidiBlockSenderFreeFunc)(WinRTMidiBlockSenderPtr sender);
+    WINRTMIDI_API void __cdecl winrt_block_sender_free(WinRTMidiBlockSenderPtr sender);
+
+    // latency in milliseconds. Applies to the following blocks
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiBlockSenderSetLatencyFunc)(WinRTMidiBlockSenderPtr sender, double latency);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_block_sender_set_latency(WinRTMidiBlockSenderPtr sender, double latency);
+
+    // blockTime is the performance counter time of the first frame of the block in microseconds (for example the WASAPI
+    // QPC position divided by 10). Events must be sorted by frame offset. Safe to call from the audio thread: it never
+    // blocks, and only allocates for messages longer than 16 bytes. Returns WINRT_MEMORY_ERROR if messages were dropped
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiBlockSenderSendFunc)(WinRTMidiBlockSenderPtr sender, long long blockTime, const WinRTMidiBlockEvent* events, unsigned int nEvents);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_block_sender_send(WinRTMidiBlockSenderPtr sender, long long blockTime, const WinRTMidiBlockEvent* events, unsigned int nEvents);
+
+    typedef WinRTMidiErrorType(__cdecl *WinRTMidiBlockSenderGetStatsFunc)(WinRTMidiBlockSenderPtr sender, WinRTMidiBlockSenderStats* stats);
+    WINRTMIDI_API WinRTMidiErrorType __cdecl winrt_block_sender_get_stats(WinRTMidiBlockSenderPtr sender, WinRTMidiBlockSenderStats* stats);
 
     // WinRT Midi Watcher Functions
     typedef unsigned int(__cdecl *WinRTWatcherPortCountFunc)(WinRTMidiPortWatcherPtr watcher);
@@ -0,0 +1,200 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+
+#include "WinRTMidiBlockSender.h"
+#include "WinRTMidiTime.h"
+
+using namespace WinRT;
+
+WinRTMidiBlockSender::WinRTMidiBlockSender(WinRTMidiOutPort^ port, double sampleRate, double latency)
+    : mPort(port)
+    , mMicrosecondsPerFrame(1000000.0 / sampleRate)
+    , mLatency((long long)(latency * 1000.0))
+    , mQueue(kBlockSenderQueueCapacity)
+    , mRunning(false)
+    , mWaiting(false)
+    , mSent(0)
+    , mDropped(0)
+    , mLate(0)
+    , mTotalJitter(0)
+    , mMaxJitter(0)
+{
+}
+
+WinRTMidiBlockSender::~WinRTMidiBlockSender()
+{
+    Stop();
+
+    // free any heap copies still in the queue
+    WinRTMidiBlockMessage message;
+    while (mQueue.Pop(message))
+    {
+        delete[] message.heapData;
+    }
+}
+
+WinRTMidiErrorType WinRTMidiBlockSender::Start()
+{
+    mTimer.Reset();
+    mRunning = true;
+    mThread = std::thread(&WinRTMidiBlockSender::Run, this);
+    SetThreadPriority(mThread.native_handle(), THREAD_PRIORITY_TIME_CRITICAL);
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiBlockSender::Stop()
+{
+    if (mRunning.exchange(false))
+    {
+        mTimer.Cancel();
+        mThread.join();
+    }
+}
+
+void WinRTMidiBlockSender::SetLatency(double latency)
+{
+    mLatency = (long long)(latency * 1000.0);
+}
+
+WinRTMidiErrorType WinRTMidiBlockSender::SendBlock(long long blockTime, const WinRTMidiBlockEvent* events, unsigned int nEvents)
+{
+    // validate the whole block first so it is never queued in part
+    for (unsigned int i = 0; i < nEvents; i++)
+    {
+        if (events[i].message == nullptr || events[i].nBytes == 0 || (i > 0 && events[i].frameOffset < events[i - 1].frameOffset))
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+    }
+
+    long long startTime = blockTime + mLatency.load();
+    WinRTMidiErrorType result = WINRT_NO_ERROR;
+
+    for (unsigned int i = 0; i < nEvents; i++)
+    {
+        const WinRTMidiBlockEvent& event = events[i];
+        WinRTMidiBlockMessage item;
+        item.time = startTime + (long long)(event.frameOffset * mMicrosecondsPerFrame);
+        item.nBytes = event.nBytes;
+        item.heapData = nullptr;
+
+        if (event.nBytes <= kMidiInlineBytes)
+        {
+            memcpy(item.inlineData, event.message, event.nBytes);
+        }
+        else
+        {
+            item.heapData = new unsigned char[event.nBytes];
+            memcpy(item.heapData, event.message, event.nBytes);
+        }
+
+        if (!mQueue.Push(item))
+        {
+            delete[] item.heapData;
+            mDropped++;
+            result = WINRT_MEMORY_ERROR;
+        }
+    }
+
+    // only wake the sender thread if it is (about to go) asleep with an empty queue
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mWaiting.exchange(false))
+    {
+        mTimer.Cancel();
+    }
+
+    return result;
+}
+
+void WinRTMidiBlockSender::GetStats(WinRTMidiBlockSenderStats& stats)
+{
+    unsigned long long sent = mSent.load();
+    stats.messagesSent = sent;
+    stats.messagesDropped = mDropped.load();
+    stats.messagesLate = mLate.load();
+    stats.averageJitter = sent > 0 ? (mTotalJitter.load() / (double)sent) * .001 : 0.0;
+    stats.maxJitter = mMaxJitter.load() * .001;
+}
+
+void WinRTMidiBlockSender::SendMessage(WinRTMidiBlockMessage& message)
+{
+    mPort->Send(message.GetData(), message.nBytes);
+    delete[] message.heapData;
+
+    long long jitter = GetTimeMicroseconds() - message.time;
+    if (jitter < 0)
+    {
+        jitter = 0;
+    }
+
+    if (jitter > kBlockSenderLateThreshold)
+    {
+        mLate++;
+    }
+
+    mTotalJitter.fetch_add(jitter, std::memory_order_relaxed);
+    if (jitter > mMaxJitter.load(std::memory_order_relaxed))
+    {
+        mMaxJitter.store(jitter, std::memory_order_relaxed);
+    }
+
+    mSent++;
+}
+
+void WinRTMidiBlockSender::Run()
+{
+    WinRTMidiBlockMessage message;
+    bool pending = false;
+
+    while (mRunning)
+    {
+        if (!pending)
+        {
+            pending = mQueue.Pop(message);
+        }
+
+        if (!pending)
+        {
+            // announce that we are going to sleep, then check the queue once more
+            // so a block pushed in between is not missed
+            mWaiting = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            pending = mQueue.Pop(message);
+            if (!pending)
+            {
+                if (!mTimer.WaitUntil(GetTimeMicroseconds() + kBlockSenderIdleWait))
+                {
+                    mTimer.Reset();
+                }
+            }
+
+            mWaiting = false;
+            continue;
+        }
+
+        if (!mTimer.WaitUntil(message.time))
+        {
+            // woken by SendBlock() or Stop(); the message is still pending
+            mTimer.Reset();
+            continue;
+        }
+
+        SendMessage(message);
+        pending = false;
+    }
+
+    if (pending)
+    {
+        delete[] message.heapData;
+    }
+}
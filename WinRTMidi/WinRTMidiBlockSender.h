@@ -0,0 +1,98 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiImpl.h"
+#include "WinRTMidiMessage.h"
+#include "WinRTMidiQueue.h"
+#include "WinRTMidiTimer.h"
+#include <atomic>
+#include <thread>
+
+namespace WinRT
+{
+    #define kBlockSenderQueueCapacity 4096
+    #define kBlockSenderIdleWait 100000         // microseconds the thread sleeps with nothing queued
+    #define kBlockSenderLateThreshold 1000      // microseconds after which a message counts as late
+    #define kMaxBlockSenderLatency 1000.0       // milliseconds
+
+    // MIDI message queued with the time it must be sent. Messages larger than
+    // kMidiInlineBytes are copied to the heap and freed by the sender thread.
+    struct WinRTMidiBlockMessage
+    {
+        long long time;             // microseconds (see GetTimeMicroseconds)
+        unsigned int nBytes;
+        unsigned char* heapData;
+        unsigned char inlineData[kMidiInlineBytes];
+
+        const unsigned char* GetData() const {
+            return heapData ? heapData : inlineData;
+        };
+    };
+
+    /**********************************************************************************
+    Sends MIDI messages rendered by an audio callback at the time of their audio
+    frame instead of all at once when the callback returns. SendBlock() converts
+    the frame offset of each message to an absolute time from the start time of
+    the block and the sample rate, adds a constant latency, and pushes the
+    message to a lock-free queue without blocking. Messages up to
+    kMidiInlineBytes are queued without allocating, so SendBlock() can be called
+    from the audio thread.
+
+    A time critical thread waits on a high resolution timer until the time of
+    each queued message and sends it to the out port. The jitter of a block
+    length becomes a constant latency as long as the latency is longer than
+    the time between the start of a block and the SendBlock() call.
+    **********************************************************************************/
+    class WinRTMidiBlockSender
+    {
+    public:
+        // latency is in milliseconds
+        WinRTMidiBlockSender(WinRTMidiOutPort^ port, double sampleRate, double latency);
+        ~WinRTMidiBlockSender();
+
+        WinRTMidiErrorType Start();
+        void Stop();
+
+        // milliseconds. Applies to the following blocks
+        void SetLatency(double latency);
+
+        // blockTime is the time of the first frame of the block in microseconds. Events must be sorted by frame offset
+        WinRTMidiErrorType SendBlock(long long blockTime, const WinRTMidiBlockEvent* events, unsigned int nEvents);
+
+        void GetStats(WinRTMidiBlockSenderStats& stats);
+
+    private:
+        void Run();
+        void SendMessage(WinRTMidiBlockMessage& message);
+
+        WinRTMidiOutPort^ mPort;
+        double mMicrosecondsPerFrame;
+        std::atomic<long long> mLatency;    // microseconds
+
+        WinRTMidiQueue<WinRTMidiBlockMessage> mQueue;
+        WinRTMidiTimer mTimer;
+        std::thread mThread;
+        std::atomic<bool> mRunning;
+        std::atomic<bool> mWaiting;
+
+        // statistics
+        std::atomic<unsigned long long> mSent;
+        std::atomic<unsigned long long> mDropped;
+        std::atomic<unsigned long long> mLate;
+        std::atomic<long long> mTotalJitter;    // microseconds
+        std::atomic<long long> mMaxJitter;      // microseconds
+    };
+};
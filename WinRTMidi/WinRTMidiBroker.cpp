@@ -0,0 +1,238 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiBroker.h"
+#include "WinRTMidiTime.h"
+#include <climits>
+#include <vector>
+
+using namespace WinRT;
+
+#define kNoTimeOffset LLONG_MIN
+
+/*****************************************************
+    WinRTMidiBroker
+*****************************************************/
+
+WinRTMidiBroker::WinRTMidiBroker(WinRTMidiInPort^ inPort, WinRTMidiOutPort^ outPort)
+    : mInPort(inPort)
+    , mOutPort(outPort)
+    , mTimeOffset(kNoTimeOffset)
+    , mRunning(false)
+{
+}
+
+WinRTMidiBroker::~WinRTMidiBroker()
+{
+    Stop();
+}
+
+bool WinRTMidiBroker::IsValidName(const char* name)
+{
+    if (name == nullptr || *name == '\0')
+    {
+        return false;
+    }
+
+    // the name becomes part of a kernel object or file name
+    for (const char* c = name; *c; c++)
+    {
+        if (*c == '/' || *c == '\\')
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+WinRTMidiErrorType WinRTMidiBroker::Start(const std::string& name)
+{
+    size_t size = WinRTMidiSharedRing::GetMemorySize(kBrokerRingCapacity);
+
+    if (mInPort != nullptr)
+    {
+        WinRTMidiErrorType result = mInMemory.Create(name + ".in", size);
+        if (result != WINRT_NO_ERROR)
+        {
+            return result;
+        }
+
+        mInRing.Initialize(mInMemory.GetData(), size, SharedRingBroadcast);
+        mInPort->AddListener(this);
+    }
+
+    if (mOutPort != nullptr)
+    {
+        WinRTMidiErrorType result = mOutMemory.Create(name + ".out", size);
+        if (result != WINRT_NO_ERROR)
+        {
+            Stop();
+            return result;
+        }
+
+        mOutRing.Initialize(mOutMemory.GetData(), size, SharedRingMpsc);
+        mTimer.Reset();
+        mRunning = true;
+        mThread = std::thread(&WinRTMidiBroker::Run, this);
+    }
+
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiBroker::Stop()
+{
+    if (mInPort != nullptr)
+    {
+        mInPort->RemoveListener(this);
+    }
+
+    if (mRunning.exchange(false))
+    {
+        mTimer.Cancel();
+        mThread.join();
+    }
+
+    mInMemory.Close();
+    mOutMemory.Close();
+}
+
+void WinRTMidiBroker::OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes)
+{
+    std::lock_guard<std::mutex> lock(mPublishMutex);
+
+    // device timestamps are in 100ns units relative to the creation of the port
+    long long micros = time / 10;
+    if (mTimeOffset == kNoTimeOffset)
+    {
+        mTimeOffset = GetTimeMicroseconds() - micros;
+    }
+
+    // messages larger than a quarter of the ring are not published
+    mInRing.Write(micros + mTimeOffset, message, nBytes);
+}
+
+void WinRTMidiBroker::Run()
+{
+    while (mRunning)
+    {
+        long long time;
+        unsigned int nBytes;
+        const unsigned char* message = mOutRing.Peek(time, nBytes);
+        if (message != nullptr)
+        {
+            // sent straight from the shared memory
+            mOutPort->Send(message, nBytes);
+            mOutRing.Consume();
+            continue;
+        }
+
+        mTimer.WaitUntil(GetTimeMicroseconds() + kBrokerPollInterval);
+    }
+}
+
+/*****************************************************
+    WinRTMidiBrokerInput
+*****************************************************/
+
+WinRTMidiBrokerInput::WinRTMidiBrokerInput(WinRTMidiInPort^ port)
+    : mPort(port)
+    , mRunning(false)
+{
+}
+
+WinRTMidiBrokerInput::~WinRTMidiBrokerInput()
+{
+    Stop();
+}
+
+WinRTMidiErrorType WinRTMidiBrokerInput::Start(const std::string& name)
+{
+    size_t size = WinRTMidiSharedRing::GetMemorySize(kBrokerRingCapacity);
+    WinRTMidiErrorType result = mMemory.Open(name + ".in", size);
+    if (result != WINRT_NO_ERROR)
+    {
+        return result;
+    }
+
+    if (!mRing.Attach(mMemory.GetData(), size, SharedRingBroadcast))
+    {
+        mMemory.Close();
+        return WINRT_OPEN_PORT_ERROR;
+    }
+
+    mTimer.Reset();
+    mRunning = true;
+    mThread = std::thread(&WinRTMidiBrokerInput::Run, this);
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiBrokerInput::Stop()
+{
+    if (mRunning.exchange(false))
+    {
+        mTimer.Cancel();
+        mThread.join();
+    }
+
+    mMemory.Close();
+}
+
+void WinRTMidiBrokerInput::Run()
+{
+    WinRTMidiBroadcastRing::Reader reader;
+    mRing.InitReader(reader);
+
+    // the broker keeps writing while the listeners run, so messages are copied out of the ring first
+    std::vector<unsigned char> message(mRing.GetMaxMessageSize());
+
+    while (mRunning)
+    {
+        long long time;
+        unsigned int nBytes;
+        if (mRing.Read(reader, time, message.data(), nBytes))
+        {
+            // ReceiveMessage expects 100ns units
+            mPort->ReceiveMessage(time * 10, message.data(), nBytes);
+            continue;
+        }
+
+        mTimer.WaitUntil(GetTimeMicroseconds() + kBrokerPollInterval);
+    }
+}
+
+/*****************************************************
+    WinRTMidiBrokerOutput
+*****************************************************/
+
+WinRTMidiErrorType WinRTMidiBrokerOutput::Open(const std::string& name)
+{
+    size_t size = WinRTMidiSharedRing::GetMemorySize(kBrokerRingCapacity);
+    WinRTMidiErrorType result = mMemory.Open(name + ".out", size);
+    if (result != WINRT_NO_ERROR)
+    {
+        return result;
+    }
+
+    if (!mRing.Attach(mMemory.GetData(), size, SharedRingMpsc))
+    {
+        mMemory.Close();
+        return WINRT_OPEN_PORT_ERROR;
+    }
+
+    return WINRT_NO_ERROR;
+}
+
+bool WinRTMidiBrokerOutput::Send(const unsigned char* message, unsigned int nBytes)
+{
+    return mRing.Write(GetTimeMicroseconds(), message, nBytes);
+}
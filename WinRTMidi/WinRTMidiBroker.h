@@ -0,0 +1,106 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiImpl.h"
+#include "WinRTMidiSharedMemory.h"
+#include "WinRTMidiSharedRing.h"
+#include "WinRTMidiTimer.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace WinRT
+{
+    #define kBrokerRingCapacity (256 * 1024)
+    #define kBrokerPollInterval 250             // microseconds
+
+    /**********************************************************************************
+    Broker mode lets several processes share the ports opened by one process.
+
+    The broker publishes the messages of its in port to a shared memory
+    broadcast ring ("<name>.in"), which any number of client processes read
+    in place, and sends the messages that clients write to a shared MPSC ring
+    ("<name>.out") to its out port. Ring times are GetTimeMicroseconds() values,
+    which all processes share. Readers poll the rings every kBrokerPollInterval.
+    The shared memory is visible to the processes of the same session.
+    **********************************************************************************/
+    class WinRTMidiBroker : public WinRTMidiInListener
+    {
+    public:
+        WinRTMidiBroker(WinRTMidiInPort^ inPort, WinRTMidiOutPort^ outPort);
+        virtual ~WinRTMidiBroker();
+
+        WinRTMidiErrorType Start(const std::string& name);
+        void Stop();
+
+        virtual void OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes) override;
+
+        static bool IsValidName(const char* name);
+
+    private:
+        void Run();
+
+        WinRTMidiInPort^ mInPort;
+        WinRTMidiOutPort^ mOutPort;
+        WinRTMidiSharedMemory mInMemory;
+        WinRTMidiSharedMemory mOutMemory;
+        WinRTMidiBroadcastRing mInRing;
+        WinRTMidiMpscRing mOutRing;
+
+        // MessageReceived can be raised on different threads
+        std::mutex mPublishMutex;
+        long long mTimeOffset;
+
+        std::thread mThread;
+        WinRTMidiTimer mTimer;
+        std::atomic<bool> mRunning;
+    };
+
+    // Passes the messages published by a broker to a loopback in port of a client process
+    class WinRTMidiBrokerInput
+    {
+    public:
+        WinRTMidiBrokerInput(WinRTMidiInPort^ port);
+        ~WinRTMidiBrokerInput();
+
+        WinRTMidiErrorType Start(const std::string& name);
+        void Stop();
+
+    private:
+        void Run();
+
+        WinRTMidiInPort^ mPort;
+        WinRTMidiSharedMemory mMemory;
+        WinRTMidiBroadcastRing mRing;
+        std::thread mThread;
+        WinRTMidiTimer mTimer;
+        std::atomic<bool> mRunning;
+    };
+
+    // Writes the messages of an out port of a client process to a broker
+    class WinRTMidiBrokerOutput
+    {
+    public:
+        WinRTMidiErrorType Open(const std::string& name);
+
+        // returns false if the broker's ring is full or the message is too large
+        bool Send(const unsigned char* message, unsigned int nBytes);
+
+    private:
+        WinRTMidiSharedMemory mMemory;
+        WinRTMidiMpscRing mRing;
+    };
+};
@@ -0,0 +1,57 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+
+#include "WinRTMidiBufferPool.h"
+
+using namespace WinRT;
+using namespace Windows::Storage::Streams;
+
+WinRTMidiBufferPool::WinRTMidiBufferPool(unsigned int count, unsigned int size)
+    : mBufferCount(count)
+    , mBufferSize(size)
+{
+    mBuffers.reserve(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        mBuffers.push_back(ref new Buffer(size));
+    }
+}
+
+IBuffer^ WinRTMidiBufferPool::Acquire()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mBuffers.empty())
+    {
+        return nullptr;
+    }
+
+    IBuffer^ buffer = mBuffers.back();
+    mBuffers.pop_back();
+    return buffer;
+}
+
+void WinRTMidiBufferPool::Release(IBuffer^ buffer)
+{
+    if (buffer == nullptr || buffer->Capacity != mBufferSize)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // buffers allocated because the pool was empty are freed
+    if (mBuffers.size() < mBufferCount)
+    {
+        mBuffers.push_back(buffer);
+    }
+}
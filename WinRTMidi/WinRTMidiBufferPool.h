@@ -0,0 +1,48 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+namespace WinRT
+{
+    #define kDefaultOutputBufferCount 16
+    #define kDefaultOutputBufferSize 128
+
+    /**********************************************************************************
+    Fixed set of send buffers allocated once and shared by the out ports of a
+    WinRTMidi instance. An out port takes a buffer when it opens a device and
+    returns it when it is closed, so opening and closing ports does not
+    allocate. Only buffers of the pool size are taken back; a buffer an out
+    port grew for a larger message is freed instead.
+    **********************************************************************************/
+    class WinRTMidiBufferPool
+    {
+    public:
+        WinRTMidiBufferPool(unsigned int count, unsigned int size);
+
+        // returns nullptr if all buffers are in use
+        Windows::Storage::Streams::IBuffer^ Acquire();
+        void Release(Windows::Storage::Streams::IBuffer^ buffer);
+
+        unsigned int GetBufferSize() const { return mBufferSize; };
+
+    private:
+        std::mutex mMutex;
+        std::vector<Windows::Storage::Streams::IBuffer^> mBuffers;     // free buffers
+        unsigned int mBufferCount;
+        unsigned int mBufferSize;
+    };
+};
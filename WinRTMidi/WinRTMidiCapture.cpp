@@ -0,0 +1,260 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiCapture.h"
+#include "WinRTMidiTime.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace WinRT;
+
+static const unsigned char kCaptureMagic[4] = { 'W', 'R', 'M', 'C' };
+
+static bool ReadVarint(const unsigned char*& pos, const unsigned char* end, unsigned long long& value)
+{
+    value = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 7)
+    {
+        if (pos >= end)
+        {
+            return false;
+        }
+
+        unsigned char b = *pos++;
+        value |= (unsigned long long)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*****************************************************
+    WinRTMidiCapture
+*****************************************************/
+
+WinRTMidiCapture::WinRTMidiCapture(const std::vector<WinRTMidiInPort^>& ports)
+    : WinRTMidiMessageWorker(kCaptureQueueCapacity)
+    , mPorts(ports)
+    , mPortOffsets(ports.size(), kNoPortOffset)
+    , mStartTime(0)
+    , mLastTime(0)
+    , mCapturing(false)
+{
+}
+
+WinRTMidiCapture::~WinRTMidiCapture()
+{
+    Finish();
+}
+
+WinRTMidiErrorType WinRTMidiCapture::Start(const char* path)
+{
+    if (mPorts.empty() || mPorts.size() > kCaptureMaxPorts)
+    {
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    WinRTMidiErrorType result = mWriter.Open(path);
+    if (result != WINRT_NO_ERROR)
+    {
+        return result;
+    }
+
+    mWriter.Write(kCaptureMagic, sizeof(kCaptureMagic));
+    mWriter.WriteByte(kCaptureVersion);
+    mWriter.WriteByte((unsigned char)mPorts.size());
+
+    result = WinRTMidiMessageWorker::Start();
+    if (result != WINRT_NO_ERROR)
+    {
+        mWriter.Close();
+        return result;
+    }
+
+    mStartTime = GetTimeMicroseconds();
+    mLastTime = 0;
+    mCapturing = true;
+    for (auto port : mPorts)
+    {
+        port->AddListener(this);
+    }
+
+    return WINRT_NO_ERROR;
+}
+
+WinRTMidiErrorType WinRTMidiCapture::Finish()
+{
+    if (!mCapturing)
+    {
+        return WINRT_NO_ERROR;
+    }
+
+    mCapturing = false;
+    for (auto port : mPorts)
+    {
+        port->RemoveListener(this);
+    }
+
+    // write everything that was received before the capture was stopped
+    Drain();
+    Stop();
+
+    bool error = mWriter.HasError();
+    WinRTMidiErrorType result = mWriter.Close();
+    return error ? WINRT_FILE_ERROR : result;
+}
+
+unsigned int WinRTMidiCapture::GetPortIndex(WinRTMidiInPortPtr port)
+{
+    for (unsigned int i = 0; i < mPorts.size(); i++)
+    {
+        if ((WinRTMidiInPortPtr)mPorts[i] == port)
+        {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+void WinRTMidiCapture::OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes)
+{
+    unsigned int index = GetPortIndex(port);
+
+    // device timestamps are in 100ns units relative to the creation of the port
+    long long micros = time / 10;
+    if (mPortOffsets[index] == kNoPortOffset)
+    {
+        mPortOffsets[index] = GetTimeMicroseconds() - micros;
+    }
+
+    Enqueue(nullptr, port, micros + mPortOffsets[index], 0.0, message, nBytes);
+}
+
+void WinRTMidiCapture::Process(const WinRTMidiQueuedMessage& message)
+{
+    // messages of different ports can be queued slightly out of order
+    long long time = std::max(message.time - mStartTime, mLastTime);
+
+    mWriter.WriteVarint(time - mLastTime);
+    mWriter.WriteByte((unsigned char)GetPortIndex(message.port));
+    mWriter.WriteVarint(message.nBytes);
+    mWriter.Write(message.GetData(), message.nBytes);
+    mLastTime = time;
+}
+
+/*****************************************************
+    WinRTMidiCaptureReplay
+*****************************************************/
+
+WinRTMidiCaptureReplay::WinRTMidiCaptureReplay()
+    : mSpeed(1.0)
+    , mCancelled(false)
+    , mResult(WINRT_NO_ERROR)
+{
+}
+
+WinRTMidiCaptureReplay::~WinRTMidiCaptureReplay()
+{
+    Stop();
+    mFile.Close();
+}
+
+WinRTMidiErrorType WinRTMidiCaptureReplay::Start(const char* path, const std::vector<WinRTMidiInPort^>& ports, double speed)
+{
+    if (ports.empty() || speed < 0.0)
+    {
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    WinRTMidiErrorType result = mFile.Open(path);
+    if (result != WINRT_NO_ERROR)
+    {
+        return result;
+    }
+
+    const unsigned char* data = mFile.GetData();
+    if (mFile.GetSize() < 6 || memcmp(data, kCaptureMagic, sizeof(kCaptureMagic)) != 0 || data[4] != kCaptureVersion)
+    {
+        mFile.Close();
+        return WINRT_FILE_ERROR;
+    }
+
+    mPorts = ports;
+    mSpeed = speed;
+    mCancelled = false;
+    mThread = std::thread(&WinRTMidiCaptureReplay::Run, this);
+    SetThreadPriority(mThread.native_handle(), THREAD_PRIORITY_TIME_CRITICAL);
+    return WINRT_NO_ERROR;
+}
+
+WinRTMidiErrorType WinRTMidiCaptureReplay::Wait()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+
+    return mResult;
+}
+
+void WinRTMidiCaptureReplay::Stop()
+{
+    mCancelled = true;
+    mTimer.Cancel();
+    Wait();
+}
+
+void WinRTMidiCaptureReplay::Run()
+{
+    const unsigned char* pos = mFile.GetData() + 6;
+    const unsigned char* end = mFile.GetData() + mFile.GetSize();
+    long long startTime = GetTimeMicroseconds();
+    unsigned long long time = 0;
+
+    while (pos < end && !mCancelled)
+    {
+        unsigned long long delta;
+        unsigned long long nBytes;
+        if (!ReadVarint(pos, end, delta) || pos >= end)
+        {
+            mResult = WINRT_FILE_ERROR;
+            return;
+        }
+
+        unsigned int index = *pos++;
+        if (!ReadVarint(pos, end, nBytes) || nBytes > (unsigned long long)(end - pos))
+        {
+            mResult = WINRT_FILE_ERROR;
+            return;
+        }
+
+        time += delta;
+        long long replayTime = (long long)time;
+        if (mSpeed > 0.0)
+        {
+            replayTime = (long long)(time / mSpeed);
+            if (!mTimer.WaitUntil(startTime + replayTime))
+            {
+                return;
+            }
+        }
+
+        // ports expect 100ns timestamps
+        mPorts[index % mPorts.size()]->ReceiveMessage(replayTime * 10, pos, (unsigned int)nBytes);
+        pos += nBytes;
+    }
+}
@@ -0,0 +1,111 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiImpl.h"
+#include "WinRTMidiFile.h"
+#include "WinRTMidiMessageWorker.h"
+#include "WinRTMidiTimer.h"
+#include <atomic>
+#include <climits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WinRT
+{
+    #define kCaptureQueueCapacity 8192
+    #define kCaptureVersion 1
+    #define kCaptureMaxPorts 255
+    #define kNoPortOffset LLONG_MIN
+
+    /**********************************************************************************
+    Capture file format (all varints are little endian base 128):
+
+        header: 'W' 'R' 'M' 'C', version (1 byte), port count (1 byte)
+        record: delta time in microseconds since the previous record (varint),
+                port index (1 byte), message length (varint), message bytes
+
+    Times are the device timestamps of each port aligned to a common clock, so
+    messages of different ports keep their relative timing.
+    **********************************************************************************/
+
+    /**********************************************************************************
+    Captures all messages of one or more midi in ports. Messages are queued on
+    the MessageReceived thread and written on the capture thread.
+    **********************************************************************************/
+    class WinRTMidiCapture : public WinRTMidiInListener, public WinRTMidiMessageWorker
+    {
+    public:
+        WinRTMidiCapture(const std::vector<WinRTMidiInPort^>& ports);
+        virtual ~WinRTMidiCapture();
+
+        WinRTMidiErrorType Start(const char* path);
+
+        // stops capturing and completes the file
+        WinRTMidiErrorType Finish();
+
+        virtual void OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes) override;
+
+    protected:
+        virtual void Process(const WinRTMidiQueuedMessage& message) override;
+
+    private:
+        unsigned int GetPortIndex(WinRTMidiInPortPtr port);
+
+        std::vector<WinRTMidiInPort^> mPorts;
+
+        // offset from the device timestamps of each port to GetTimeMicroseconds().
+        // Each entry is only accessed by the MessageReceived thread of its port
+        std::vector<long long> mPortOffsets;
+
+        WinRTMidiFileWriter mWriter;
+        long long mStartTime;
+        long long mLastTime;
+        bool mCapturing;
+    };
+
+    /**********************************************************************************
+    Replays a capture file into midi in ports through WinRTMidiInPort::ReceiveMessage(),
+    so the messages take the same path as messages received from a device
+    (listeners, dispatcher and midi in callback). Capture port n is replayed to
+    ports[n % number of ports]. speed scales the timing (2.0 replays twice as
+    fast); a speed of 0 replays as fast as possible with the captured timestamps.
+    **********************************************************************************/
+    class WinRTMidiCaptureReplay
+    {
+    public:
+        WinRTMidiCaptureReplay();
+        ~WinRTMidiCaptureReplay();
+
+        WinRTMidiErrorType Start(const char* path, const std::vector<WinRTMidiInPort^>& ports, double speed);
+
+        // blocks until all messages have been replayed
+        WinRTMidiErrorType Wait();
+
+        void Stop();
+
+    private:
+        void Run();
+
+        WinRTMidiMappedFile mFile;
+        std::vector<WinRTMidiInPort^> mPorts;
+        double mSpeed;
+        WinRTMidiTimer mTimer;
+        std::thread mThread;
+        std::mutex mMutex;
+        std::atomic<bool> mCancelled;
+        WinRTMidiErrorType mResult;
+    };
+};
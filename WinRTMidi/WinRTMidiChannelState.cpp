@@ -0,0 +1,143 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiChannelState.h"
+#include <cstring>
+
+using namespace WinRT;
+
+#define kSustainController 64
+#define kPitchBendCenter 0x2000
+
+WinRTMidiChannelState::WinRTMidiChannelState()
+{
+    Reset();
+}
+
+void WinRTMidiChannelState::ResetChannel(WinRTMidiChannelStateSnapshot& state, unsigned int channel)
+{
+    memset(state.activeNotes[channel], 0, sizeof(state.activeNotes[channel]));
+    memset(state.controllers[channel], 0, sizeof(state.controllers[channel]));
+    state.programs[channel] = 0;
+    state.pitchBend[channel] = kPitchBendCenter;
+}
+
+void WinRTMidiChannelState::Reset()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (unsigned int channel = 0; channel < 16; channel++)
+    {
+        ResetChannel(mState, channel);
+    }
+}
+
+void WinRTMidiChannelState::Update(const unsigned char* message, unsigned int nBytes)
+{
+    if (nBytes == 0 || message[0] < 0x80)
+    {
+        return;
+    }
+
+    unsigned char status = message[0];
+    if (status >= 0xF0)
+    {
+        // system reset
+        if (status == 0xFF)
+        {
+            Reset();
+        }
+        return;
+    }
+
+    unsigned int channel = status & 0x0F;
+    unsigned char data1 = nBytes > 1 ? message[1] & 0x7F : 0;
+    unsigned char data2 = nBytes > 2 ? message[2] & 0x7F : 0;
+    unsigned int noteBit = 1u << (data1 & 31);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    switch (status & 0xF0)
+    {
+    case 0x90:
+        // note on with velocity 0 is a note off
+        if (data2 > 0)
+        {
+            mState.activeNotes[channel][data1 >> 5] |= noteBit;
+        }
+        else
+        {
+            mState.activeNotes[channel][data1 >> 5] &= ~noteBit;
+        }
+        break;
+    case 0x80:
+        mState.activeNotes[channel][data1 >> 5] &= ~noteBit;
+        break;
+    case 0xB0:
+        mState.controllers[channel][data1] = data2;
+        if (data1 == 120 || data1 == 123)
+        {
+            // all sound off, all notes off
+            memset(mState.activeNotes[channel], 0, sizeof(mState.activeNotes[channel]));
+        }
+        else if (data1 == 121)
+        {
+            // reset all controllers
+            memset(mState.controllers[channel], 0, sizeof(mState.controllers[channel]));
+            mState.pitchBend[channel] = kPitchBendCenter;
+        }
+        break;
+    case 0xC0:
+        mState.programs[channel] = data1;
+        break;
+    case 0xE0:
+        mState.pitchBend[channel] = data1 | (data2 << 7);
+        break;
+    default:
+        break;
+    }
+}
+
+void WinRTMidiChannelState::GetSnapshot(WinRTMidiChannelStateSnapshot& snapshot)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    snapshot = mState;
+}
+
+void WinRTMidiChannelState::GetAllNotesOff(const WinRTMidiChannelStateSnapshot& snapshot, const MessageFunc& func)
+{
+    for (unsigned char channel = 0; channel < 16; channel++)
+    {
+        const unsigned int* notes = snapshot.activeNotes[channel];
+        if (snapshot.controllers[channel][kSustainController] >= 64)
+        {
+            unsigned char sustainOff[3] = { (unsigned char)(0xB0 | channel), kSustainController, 0 };
+            func(sustainOff, 3);
+        }
+
+        for (unsigned int word = 0; word < 4; word++)
+        {
+            unsigned int bits = notes[word];
+            while (bits != 0)
+            {
+                unsigned int bit = 0;
+                while ((bits & (1u << bit)) == 0)
+                {
+                    bit++;
+                }
+                bits &= bits - 1;
+
+                unsigned char noteOff[3] = { (unsigned char)(0x80 | channel), (unsigned char)(word * 32 + bit), 64 };
+                func(noteOff, 3);
+            }
+        }
+    }
+}
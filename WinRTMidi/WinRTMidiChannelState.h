@@ -0,0 +1,48 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include <functional>
+#include <mutex>
+
+namespace WinRT
+{
+    /**********************************************************************************
+    Tracks the state of the 16 MIDI channels of a port: active notes as a bitset,
+    controller values, program and pitch bend. Update() is O(1) per message and
+    is called inline on the send and receive paths.
+    **********************************************************************************/
+    class WinRTMidiChannelState
+    {
+    public:
+        typedef std::function<void(const unsigned char* message, unsigned int nBytes)> MessageFunc;
+
+        WinRTMidiChannelState();
+
+        void Update(const unsigned char* message, unsigned int nBytes);
+        void Reset();
+        void GetSnapshot(WinRTMidiChannelStateSnapshot& snapshot);
+
+        // Calls func with the messages needed to release the active notes of a snapshot:
+        // sustain off where the sustain pedal is down and a note off for each active note.
+        // Channels with neither active notes nor a held sustain pedal produce no messages.
+        static void GetAllNotesOff(const WinRTMidiChannelStateSnapshot& snapshot, const MessageFunc& func);
+
+    private:
+        static void ResetChannel(WinRTMidiChannelStateSnapshot& state, unsigned int channel);
+
+        std::mutex mMutex;
+        WinRTMidiChannelStateSnapshot mState;
+    };
+};
@@ -0,0 +1,183 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiClockGenerator.h"
+#include "WinRTMidiClockTracker.h"
+#include "WinRTMidiTime.h"
+
+using namespace WinRT;
+
+#define kClockMinTempo 1.0
+#define kClockMaxTempo 1000.0
+
+WinRTMidiClockGenerator::WinRTMidiClockGenerator(const std::vector<WinRTMidiOutPort^>& ports)
+    : mPorts(ports)
+    , mRunning(false)
+    , mTempo(120.0)
+    , mTransportRead(0)
+    , mTransportCount(0)
+    , mTicks(0)
+    , mTotalJitter(0)
+    , mMaxJitter(0)
+{
+}
+
+WinRTMidiClockGenerator::~WinRTMidiClockGenerator()
+{
+    Stop();
+}
+
+WinRTMidiErrorType WinRTMidiClockGenerator::Start(double bpm)
+{
+    WinRTMidiErrorType result = SetTempo(bpm);
+    if (result != WINRT_NO_ERROR)
+    {
+        return result;
+    }
+
+    mTimer.Reset();
+    mRunning = true;
+    mThread = std::thread(&WinRTMidiClockGenerator::Run, this);
+    SetThreadPriority(mThread.native_handle(), THREAD_PRIORITY_TIME_CRITICAL);
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiClockGenerator::Stop()
+{
+    if (mRunning.exchange(false))
+    {
+        mTimer.Cancel();
+        mThread.join();
+    }
+}
+
+WinRTMidiErrorType WinRTMidiClockGenerator::SetTempo(double bpm)
+{
+    if (!(bpm >= kClockMinTempo && bpm <= kClockMaxTempo))
+    {
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    mTempo = bpm;
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiClockGenerator::SendTransport(unsigned char status)
+{
+    QueueTransport(status);
+}
+
+void WinRTMidiClockGenerator::SetSongPosition(unsigned int position)
+{
+    // queued like a transport message so it stays ahead of a following continue
+    position &= 0x3FFF;
+    QueueTransport(0xF2 | ((position & 0x7F) << 8) | ((position >> 7) << 16));
+}
+
+void WinRTMidiClockGenerator::QueueTransport(unsigned int message)
+{
+    std::lock_guard<std::mutex> lock(mTransportMutex);
+
+    if (mTransportCount == kClockTransportSlots)
+    {
+        // full: the oldest message is dropped
+        mTransportRead = (mTransportRead + 1) % kClockTransportSlots;
+        mTransportCount--;
+    }
+
+    mTransportQueue[(mTransportRead + mTransportCount) % kClockTransportSlots] = message;
+    mTransportCount++;
+}
+
+void WinRTMidiClockGenerator::GetStats(WinRTMidiClockStats& stats)
+{
+    unsigned long long ticks = mTicks.load();
+    stats.ticksSent = ticks;
+    stats.averageJitter = ticks > 0 ? (mTotalJitter.load() / (double)ticks) * .001 : 0.0;
+    stats.maxJitter = mMaxJitter.load() * .001;
+}
+
+void WinRTMidiClockGenerator::SendToPorts(const unsigned char* message, unsigned int nBytes)
+{
+    for (auto port : mPorts)
+    {
+        port->Send(message, nBytes);
+    }
+}
+
+void WinRTMidiClockGenerator::Run()
+{
+    const unsigned char clock = 0xF8;
+    double bpm = mTempo;
+    double period = 60000000.0 / (bpm * kMidiClocksPerQuarterNote);   // microseconds
+
+    // all deadlines are derived from the last tempo change
+    double tempoTime = (double)GetTimeMicroseconds();
+    unsigned long long tempoTick = 0;
+    unsigned long long tick = 0;
+    unsigned int transport[kClockTransportSlots];
+
+    while (mRunning)
+    {
+        double deadline = tempoTime + (tick - tempoTick) * period;
+        if (!mTimer.WaitUntil((long long)deadline))
+        {
+            break;
+        }
+
+        long long jitter = GetTimeMicroseconds() - (long long)deadline;
+
+        unsigned int nTransport = 0;
+        {
+            std::lock_guard<std::mutex> lock(mTransportMutex);
+            for (; nTransport < mTransportCount; nTransport++)
+            {
+                transport[nTransport] = mTransportQueue[(mTransportRead + nTransport) % kClockTransportSlots];
+            }
+
+            mTransportRead = (mTransportRead + mTransportCount) % kClockTransportSlots;
+            mTransportCount = 0;
+        }
+
+        // after a start the next clock is the first beat
+        for (unsigned int i = 0; i < nTransport; i++)
+        {
+            unsigned char message[3] = {
+                (unsigned char)(transport[i] & 0xFF),
+                (unsigned char)((transport[i] >> 8) & 0xFF),
+                (unsigned char)((transport[i] >> 16) & 0xFF)
+            };
+            SendToPorts(message, message[0] == 0xF2 ? 3 : 1);
+        }
+
+        SendToPorts(&clock, 1);
+
+        mTicks++;
+        mTotalJitter += jitter;
+        if (jitter > mMaxJitter)
+        {
+            mMaxJitter = jitter;
+        }
+
+        // a new tempo starts at this tick
+        double newBpm = mTempo;
+        if (newBpm != bpm)
+        {
+            bpm = newBpm;
+            period = 60000000.0 / (bpm * kMidiClocksPerQuarterNote);
+            tempoTime = deadline;
+            tempoTick = tick;
+        }
+
+        tick++;
+    }
+}
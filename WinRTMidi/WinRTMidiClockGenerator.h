@@ -0,0 +1,77 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiImpl.h"
+#include "WinRTMidiTimer.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WinRT
+{
+    #define kClockTransportSlots 16
+
+    /**********************************************************************************
+    Sends 24 PPQN MIDI clock to one or more midi out ports from a time critical
+    thread. Every tick has an absolute deadline computed from the time and tick
+    of the last tempo change, so timer errors never accumulate. Tempo changes
+    and transport messages (start, continue, stop, song position pointer) take
+    effect at the next tick boundary; transport messages queued within one
+    clock period are all sent, in the order they were queued. The difference
+    between each deadline and the actual send time is measured.
+    **********************************************************************************/
+    class WinRTMidiClockGenerator
+    {
+    public:
+        WinRTMidiClockGenerator(const std::vector<WinRTMidiOutPort^>& ports);
+        ~WinRTMidiClockGenerator();
+
+        WinRTMidiErrorType Start(double bpm);
+        void Stop();
+
+        WinRTMidiErrorType SetTempo(double bpm);
+
+        // 0xFA, 0xFB or 0xFC, sent right before the next clock
+        void SendTransport(unsigned char status);
+
+        // position in sixteenth notes
+        void SetSongPosition(unsigned int position);
+
+        void GetStats(WinRTMidiClockStats& stats);
+
+    private:
+        void Run();
+        void SendToPorts(const unsigned char* message, unsigned int nBytes);
+        void QueueTransport(unsigned int message);
+
+        std::vector<WinRTMidiOutPort^> mPorts;
+        WinRTMidiTimer mTimer;
+        std::thread mThread;
+        std::atomic<bool> mRunning;
+        std::atomic<double> mTempo;
+
+        // packed messages (status | data1 << 8 | data2 << 16) waiting for the next tick
+        std::mutex mTransportMutex;
+        unsigned int mTransportQueue[kClockTransportSlots];
+        unsigned int mTransportRead;
+        unsigned int mTransportCount;
+
+        // statistics in microseconds
+        std::atomic<unsigned long long> mTicks;
+        std::atomic<long long> mTotalJitter;
+        std::atomic<long long> mMaxJitter;
+    };
+};
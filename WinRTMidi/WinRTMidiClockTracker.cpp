@@ -0,0 +1,132 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiClockTracker.h"
+#include "WinRTMidiTime.h"
+#include <cmath>
+
+using namespace WinRT;
+
+#define kClockSmoothing 0.1         // weight of a new interval
+#define kClockMaxIntervalRatio 2.5  // longer intervals restart the estimation
+#define kClockTimeout 500000        // microseconds without clock before the tempo is reported as unknown
+
+WinRTMidiClockTracker::WinRTMidiClockTracker()
+    : mLastClockTime(0)
+    , mLastClockReceived(0)
+    , mPeriod(0.0)
+    , mJitter(0.0)
+    , mPosition(0)
+    , mHasClock(false)
+    , mRunning(false)
+{
+}
+
+bool WinRTMidiClockTracker::Process(long long time, const unsigned char* message, unsigned int nBytes)
+{
+    if (nBytes == 0)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    switch (message[0])
+    {
+    case 0xF8:
+        ProcessClock(time);
+        return true;
+    case 0xFA:
+        // start: the next clock is the first beat
+        mPosition = 0;
+        mRunning = true;
+        return true;
+    case 0xFB:
+        mRunning = true;
+        return true;
+    case 0xFC:
+        mRunning = false;
+        return true;
+    case 0xF2:
+        // song position in sixteenth notes (6 clocks)
+        if (nBytes >= 3)
+        {
+            mPosition = (unsigned long long)(message[1] | (message[2] << 7)) * 6;
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+void WinRTMidiClockTracker::ProcessClock(long long time)
+{
+    if (mHasClock)
+    {
+        double interval = (double)(time - mLastClockTime);
+        if (mPeriod == 0.0)
+        {
+            mPeriod = interval;
+        }
+        else if (interval > 0.0 && interval < mPeriod * kClockMaxIntervalRatio)
+        {
+            mJitter += (std::fabs(interval - mPeriod) - mJitter) * kClockSmoothing;
+            mPeriod += (interval - mPeriod) * kClockSmoothing;
+        }
+        else
+        {
+            // dropout or restart
+            mPeriod = 0.0;
+            mJitter = 0.0;
+        }
+    }
+
+    mHasClock = true;
+    mLastClockTime = time;
+    mLastClockReceived = GetTimeMicroseconds();
+
+    if (mRunning)
+    {
+        mPosition++;
+    }
+}
+
+void WinRTMidiClockTracker::GetState(WinRTMidiClockState& state)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    long long age = GetTimeMicroseconds() - mLastClockReceived;
+    bool valid = mHasClock && mPeriod > 0.0 && age < kClockTimeout;
+
+    // period is in 100ns units
+    state.bpm = valid ? 60.0 / (mPeriod * 1e-7 * kMidiClocksPerQuarterNote) : 0.0;
+    state.jitter = valid ? mJitter * .0001 : 0.0;
+    state.position = mPosition;
+    state.running = mRunning ? 1 : 0;
+
+    // extrapolate the phase from the last clock. The first clock after start is at position 0
+    double phase = 0.0;
+    if (valid && mRunning && mPosition > 0)
+    {
+        double fraction = (age * 10.0) / mPeriod;
+        if (fraction > 1.0)
+        {
+            fraction = 1.0;
+        }
+        phase = (((mPosition - 1) % kMidiClocksPerQuarterNote) + fraction) / kMidiClocksPerQuarterNote;
+        if (phase >= 1.0)
+        {
+            phase -= 1.0;
+        }
+    }
+    state.beatPhase = phase;
+}
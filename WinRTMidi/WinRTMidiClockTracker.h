@@ -0,0 +1,51 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include <mutex>
+
+namespace WinRT
+{
+    #define kMidiClocksPerQuarterNote 24
+
+    /**********************************************************************************
+    Estimates tempo and beat phase from received MIDI clock (0xF8). The clock
+    period is smoothed with a one-pole low pass filter on the device timestamps;
+    intervals much longer than the current estimate (dropouts, stop/start) are
+    not used. Start, continue, stop and song position pointer messages update
+    the transport state and position.
+    **********************************************************************************/
+    class WinRTMidiClockTracker
+    {
+    public:
+        WinRTMidiClockTracker();
+
+        // time is the port timestamp in 100ns units. Returns true for clock and transport messages
+        bool Process(long long time, const unsigned char* message, unsigned int nBytes);
+
+        void GetState(WinRTMidiClockState& state);
+
+    private:
+        void ProcessClock(long long time);
+
+        std::mutex mMutex;
+        long long mLastClockTime;       // 100ns
+        long long mLastClockReceived;   // microseconds (GetTimeMicroseconds)
+        double mPeriod;                 // smoothed clock period in 100ns units, 0 if unknown
+        double mJitter;                 // smoothed absolute deviation from the period
+        unsigned long long mPosition;   // clocks received since start or song position
+        bool mHasClock;
+        bool mRunning;
+    };
+};
@@ -0,0 +1,220 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiCoalescer.h"
+#include "WinRTMidiMessage.h"
+#include <cstring>
+
+using namespace WinRT;
+
+// controllers whose order matters
+static bool IsOrderedController(unsigned char controller)
+{
+    switch (controller)
+    {
+    case 0:     // bank select
+    case 32:
+    case 6:     // data entry
+    case 38:
+    case 96:    // data increment/decrement
+    case 97:
+    case 98:    // NRPN
+    case 99:
+    case 100:   // RPN
+    case 101:
+        return true;
+    default:
+        return controller >= 120;   // channel mode messages
+    }
+}
+
+WinRTMidiCoalescer::WinRTMidiCoalescer(const WinRTMidiCoalescerConfig& config, MessageFunc func)
+    : mConfig(config)
+    , mFunc(func)
+    , mChangedCount(0)
+    , mDelivering(false)
+    , mStopEvent(NULL)
+    , mRunning(false)
+{
+    memset(mSlots, 0, sizeof(mSlots));
+    memset(mSlotTimes, 0, sizeof(mSlotTimes));
+
+    // a full flush followed by one message is queued without allocating
+    mOutput.reserve(kCoalescerSlots + 1);
+    mSending.reserve(kCoalescerSlots + 1);
+    mOutputBytes.reserve(kCoalescerSlots * 3);
+    mSendingBytes.reserve(kCoalescerSlots * 3);
+}
+
+WinRTMidiCoalescer::~WinRTMidiCoalescer()
+{
+    Stop();
+}
+
+WinRTMidiErrorType WinRTMidiCoalescer::Start()
+{
+    if (mConfig.flushInterval == 0)
+    {
+        return WINRT_NO_ERROR;
+    }
+
+    mStopEvent = CreateEventEx(NULL, NULL, 0, EVENT_ALL_ACCESS);
+    if (mStopEvent == NULL)
+    {
+        return WINRT_MEMORY_ERROR;
+    }
+
+    mRunning = true;
+    mThread = std::thread(&WinRTMidiCoalescer::Run, this);
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiCoalescer::Stop()
+{
+    if (mRunning.exchange(false))
+    {
+        SetEvent(mStopEvent);
+        mThread.join();
+    }
+
+    if (mStopEvent != NULL)
+    {
+        CloseHandle(mStopEvent);
+        mStopEvent = NULL;
+    }
+
+    // pending values are not lost
+    Flush();
+}
+
+int WinRTMidiCoalescer::GetSlot(const unsigned char* message, unsigned int nBytes)
+{
+    unsigned int type = GetMidiMessageType(message, nBytes);
+    if ((type & mConfig.typeMask) == 0)
+    {
+        return -1;
+    }
+
+    int channelSlot = (message[0] & 0x0F) * kCoalescerSlotsPerChannel;
+    switch (type)
+    {
+    case WINRT_MIDI_CONTROL_CHANGE:
+        return nBytes < 3 || IsOrderedController(message[1]) ? -1 : channelSlot + message[1];
+    case WINRT_MIDI_POLY_PRESSURE:
+        return nBytes < 3 ? -1 : channelSlot + 128 + message[1];
+    case WINRT_MIDI_PITCH_BEND:
+        return nBytes < 3 ? -1 : channelSlot + 256;
+    case WINRT_MIDI_CHANNEL_PRESSURE:
+        return nBytes < 2 ? -1 : channelSlot + 257;
+    default:
+        return -1;
+    }
+}
+
+void WinRTMidiCoalescer::Process(long long time, const unsigned char* message, unsigned int nBytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        int slot = GetSlot(message, nBytes);
+        if (slot >= 0)
+        {
+            if (mSlots[slot] == 0)
+            {
+                mChanged[mChangedCount++] = (unsigned short)slot;
+            }
+
+            mSlots[slot] = message[0] | (message[1] << 8) | (nBytes > 2 ? message[2] << 16 : 0);
+            mSlotTimes[slot] = time;
+            return;
+        }
+
+        // everything that changed before this message is sent first. Realtime
+        // messages are not ordered relative to other messages
+        if (nBytes > 0 && message[0] < 0xF8)
+        {
+            FlushSlots();
+        }
+
+        Queue(time, message, nBytes);
+    }
+
+    Deliver();
+}
+
+void WinRTMidiCoalescer::Flush()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        FlushSlots();
+    }
+
+    Deliver();
+}
+
+void WinRTMidiCoalescer::FlushSlots()
+{
+    for (unsigned int i = 0; i < mChangedCount; i++)
+    {
+        unsigned short slot = mChanged[i];
+        unsigned int packed = mSlots[slot];
+        unsigned char message[3] = { (unsigned char)packed, (unsigned char)(packed >> 8), (unsigned char)(packed >> 16) };
+        mSlots[slot] = 0;
+        Queue(mSlotTimes[slot], message, (message[0] & 0xF0) == 0xD0 ? 2 : 3);
+    }
+
+    mChangedCount = 0;
+}
+
+void WinRTMidiCoalescer::Queue(long long time, const unsigned char* message, unsigned int nBytes)
+{
+    OutputMessage output = { time, mOutputBytes.size(), nBytes };
+    mOutput.push_back(output);
+    mOutputBytes.insert(mOutputBytes.end(), message, message + nBytes);
+}
+
+void WinRTMidiCoalescer::Deliver()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (mDelivering)
+    {
+        // the thread that is sending picks up the queued messages
+        return;
+    }
+
+    mDelivering = true;
+    while (!mOutput.empty())
+    {
+        mOutput.swap(mSending);
+        mOutputBytes.swap(mSendingBytes);
+        lock.unlock();
+
+        for (auto& output : mSending)
+        {
+            mFunc(output.time, mSendingBytes.data() + output.offset, output.nBytes);
+        }
+
+        mSending.clear();
+        mSendingBytes.clear();
+        lock.lock();
+    }
+
+    mDelivering = false;
+}
+
+void WinRTMidiCoalescer::Run()
+{
+    while (WaitForSingleObjectEx(mStopEvent, mConfig.flushInterval, FALSE) == WAIT_TIMEOUT)
+    {
+        Flush();
+    }
+}
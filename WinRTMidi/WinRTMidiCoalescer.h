@@ -0,0 +1,92 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <Windows.h>
+
+namespace WinRT
+{
+    #define kCoalescerSlotsPerChannel 258      // 128 controllers, 128 poly pressure notes, pitch bend, channel pressure
+    #define kCoalescerSlots (16 * kCoalescerSlotsPerChannel)
+
+    /**********************************************************************************
+    Keeps only the latest value of continuous controller messages per channel
+    and controller (or note, for poly pressure) in a fixed slot table and
+    forwards the changed slots in the order they first changed. Slots are
+    flushed periodically, on Flush() and before every other non-realtime
+    message, so notes, program changes and SysEx are never reordered relative
+    to the controllers that preceded them.
+
+    Bank select, data entry, RPN/NRPN and channel mode controllers are never
+    coalesced because their order is significant.
+
+    Messages are passed to the message function outside of the lock. When
+    another thread is already sending, the message is queued and that thread
+    sends it, so the message function may call Process() or Flush().
+    **********************************************************************************/
+    class WinRTMidiCoalescer
+    {
+    public:
+        typedef std::function<void(long long time, const unsigned char* message, unsigned int nBytes)> MessageFunc;
+
+        WinRTMidiCoalescer(const WinRTMidiCoalescerConfig& config, MessageFunc func);
+        ~WinRTMidiCoalescer();
+
+        WinRTMidiErrorType Start();
+        void Stop();
+
+        // time is passed on with the message
+        void Process(long long time, const unsigned char* message, unsigned int nBytes);
+        void Flush();
+
+    private:
+        struct OutputMessage
+        {
+            long long time;
+            size_t offset;
+            unsigned int nBytes;
+        };
+
+        void Run();
+        void FlushSlots();
+        void Queue(long long time, const unsigned char* message, unsigned int nBytes);
+        void Deliver();
+        int GetSlot(const unsigned char* message, unsigned int nBytes);
+
+        WinRTMidiCoalescerConfig mConfig;
+        MessageFunc mFunc;
+
+        std::mutex mMutex;
+        unsigned int mSlots[kCoalescerSlots];          // packed message, 0 if the slot is unchanged
+        long long mSlotTimes[kCoalescerSlots];
+        unsigned short mChanged[kCoalescerSlots];       // changed slots in order
+        unsigned int mChangedCount;
+
+        // messages waiting to be sent and the batch being sent
+        std::vector<OutputMessage> mOutput;
+        std::vector<unsigned char> mOutputBytes;
+        std::vector<OutputMessage> mSending;
+        std::vector<unsigned char> mSendingBytes;
+        bool mDelivering;
+
+        std::thread mThread;
+        HANDLE mStopEvent;
+        std::atomic<bool> mRunning;
+    };
+};
@@ -0,0 +1,115 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiDevicePorts.h"
+#include <ppltasks.h>
+
+using namespace WinRT;
+using namespace Windows::Devices::Midi;
+using namespace concurrency;
+
+std::mutex WinRTMidiDevicePorts::sMutex;
+WinRTMidiDevicePorts::EntryMap WinRTMidiDevicePorts::sInPorts;
+WinRTMidiDevicePorts::EntryMap WinRTMidiDevicePorts::sOutPorts;
+
+MidiInPort^ WinRTMidiDevicePorts::AcquireInPort(Platform::String^ id)
+{
+    // held while the device is opened so two ports opening the same device wait for one open
+    std::lock_guard<std::mutex> lock(sMutex);
+
+    auto it = sInPorts.find(id->Data());
+    if (it != sInPorts.end())
+    {
+        it->second.refCount++;
+        return safe_cast<MidiInPort^>(it->second.port);
+    }
+
+    MidiInPort^ port = nullptr;
+    try
+    {
+        port = create_task(MidiInPort::FromIdAsync(id)).get();
+    }
+    catch (Platform::Exception^ ex)
+    {
+        return nullptr;
+    }
+
+    if (port != nullptr)
+    {
+        sInPorts[id->Data()] = { port, 1 };
+    }
+
+    return port;
+}
+
+void WinRTMidiDevicePorts::ReleaseInPort(Platform::String^ id, MidiInPort^ port)
+{
+    Release(sInPorts, id, port);
+}
+
+IMidiOutPort^ WinRTMidiDevicePorts::AcquireOutPort(Platform::String^ id)
+{
+    std::lock_guard<std::mutex> lock(sMutex);
+
+    auto it = sOutPorts.find(id->Data());
+    if (it != sOutPorts.end())
+    {
+        it->second.refCount++;
+        return safe_cast<IMidiOutPort^>(it->second.port);
+    }
+
+    IMidiOutPort^ port = nullptr;
+    try
+    {
+        port = create_task(MidiOutPort::FromIdAsync(id)).get();
+    }
+    catch (Platform::Exception^ ex)
+    {
+        return nullptr;
+    }
+
+    if (port != nullptr)
+    {
+        sOutPorts[id->Data()] = { port, 1 };
+    }
+
+    return port;
+}
+
+void WinRTMidiDevicePorts::ReleaseOutPort(Platform::String^ id, IMidiOutPort^ port)
+{
+    Release(sOutPorts, id, port);
+}
+
+void WinRTMidiDevicePorts::Release(EntryMap& entries, Platform::String^ id, Platform::Object^ port)
+{
+    if (id == nullptr || port == nullptr)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(sMutex);
+
+    // the entry may belong to a device opened again after port's device was removed
+    auto it = entries.find(id->Data());
+    if (it != entries.end() && it->second.port == port && --it->second.refCount == 0)
+    {
+        entries.erase(it);
+    }
+}
+
+void WinRTMidiDevicePorts::Forget(Platform::String^ id)
+{
+    std::lock_guard<std::mutex> lock(sMutex);
+    sInPorts.erase(id->Data());
+    sOutPorts.erase(id->Data());
+}
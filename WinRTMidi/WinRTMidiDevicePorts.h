@@ -0,0 +1,56 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace WinRT
+{
+    /**********************************************************************************
+    The Windows::Devices::Midi ports opened by the process, shared by device id.
+    Opening a device blocks and some drivers allow it to be opened only once,
+    so every WinRTMidiInPort and WinRTMidiOutPort on the same device uses the
+    same device port. The device port is released with its last user.
+    **********************************************************************************/
+    class WinRTMidiDevicePorts
+    {
+    public:
+        // returns nullptr if the device cannot be opened. Blocks while the device is opened
+        static Windows::Devices::Midi::MidiInPort^ AcquireInPort(Platform::String^ id);
+        static void ReleaseInPort(Platform::String^ id, Windows::Devices::Midi::MidiInPort^ port);
+
+        static Windows::Devices::Midi::IMidiOutPort^ AcquireOutPort(Platform::String^ id);
+        static void ReleaseOutPort(Platform::String^ id, Windows::Devices::Midi::IMidiOutPort^ port);
+
+        // The device was removed. Its ports are no longer shared so the next acquire opens the device
+        // again; the ports still in use are released by their users.
+        static void Forget(Platform::String^ id);
+
+    private:
+        struct Entry
+        {
+            Platform::Object^ port;
+            unsigned int refCount;
+        };
+
+        typedef std::map<std::wstring, Entry> EntryMap;
+
+        static void Release(EntryMap& entries, Platform::String^ id, Platform::Object^ port);
+
+        static std::mutex sMutex;
+        static EntryMap sInPorts;
+        static EntryMap sOutPorts;
+    };
+};
@@ -0,0 +1,263 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiFile.h"
+
+using namespace WinRT;
+
+namespace WinRT
+{
+    std::wstring Utf8ToWString(const char* s)
+    {
+        int size = MultiByteToWideChar(CP_UTF8, 0, s, -1, nullptr, 0);
+        if (size <= 0)
+        {
+            return std::wstring();
+        }
+
+        std::wstring result(size, L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, s, -1, &result[0], size);
+        result.resize(size - 1);
+        return result;
+    }
+}
+
+WinRTMidiFileWriter::WinRTMidiFileWriter(size_t bufferSize)
+    : mFile(INVALID_HANDLE_VALUE)
+    , mBuffer(bufferSize)
+    , mBufferUsed(0)
+    , mFilePosition(0)
+    , mError(false)
+{
+}
+
+WinRTMidiFileWriter::~WinRTMidiFileWriter()
+{
+    Close();
+}
+
+WinRTMidiErrorType WinRTMidiFileWriter::Open(const char* path)
+{
+    std::wstring widePath = Utf8ToWString(path);
+    mFile = CreateFileW(widePath.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (mFile == INVALID_HANDLE_VALUE)
+    {
+        return WINRT_FILE_ERROR;
+    }
+
+    mBufferUsed = 0;
+    mFilePosition = 0;
+    mError = false;
+    return WINRT_NO_ERROR;
+}
+
+WinRTMidiErrorType WinRTMidiFileWriter::Close()
+{
+    if (mFile == INVALID_HANDLE_VALUE)
+    {
+        return WINRT_NO_ERROR;
+    }
+
+    Flush();
+    CloseHandle(mFile);
+    mFile = INVALID_HANDLE_VALUE;
+    return mError ? WINRT_FILE_ERROR : WINRT_NO_ERROR;
+}
+
+WinRTMidiErrorType WinRTMidiFileWriter::Flush()
+{
+    if (mBufferUsed > 0 && !mError)
+    {
+        DWORD written = 0;
+        if (!WriteFile(mFile, mBuffer.data(), (DWORD)mBufferUsed, &written, NULL) || written != mBufferUsed)
+        {
+            mError = true;
+        }
+    }
+
+    mFilePosition += mBufferUsed;
+    mBufferUsed = 0;
+    return mError ? WINRT_FILE_ERROR : WINRT_NO_ERROR;
+}
+
+void WinRTMidiFileWriter::Write(const unsigned char* data, size_t nBytes)
+{
+    while (nBytes > 0)
+    {
+        size_t n = mBuffer.size() - mBufferUsed;
+        if (n > nBytes)
+        {
+            n = nBytes;
+        }
+
+        memcpy(mBuffer.data() + mBufferUsed, data, n);
+        mBufferUsed += n;
+        data += n;
+        nBytes -= n;
+
+        if (mBufferUsed == mBuffer.size())
+        {
+            Flush();
+        }
+    }
+}
+
+void WinRTMidiFileWriter::WriteByte(unsigned char value)
+{
+    mBuffer[mBufferUsed++] = value;
+    if (mBufferUsed == mBuffer.size())
+    {
+        Flush();
+    }
+}
+
+void WinRTMidiFileWriter::WriteBigEndian(unsigned int value, unsigned int nBytes)
+{
+    while (nBytes-- > 0)
+    {
+        WriteByte((unsigned char)(value >> (nBytes * 8)));
+    }
+}
+
+// Standard MIDI File variable length quantity (7 bits per byte, most significant first).
+// the format allows at most 4 bytes so larger values are clamped to 0x0FFFFFFF
+void WinRTMidiFileWriter::WriteVariableLength(unsigned int value)
+{
+    unsigned char bytes[4];
+    int n = 0;
+
+    if (value > 0x0FFFFFFF)
+    {
+        value = 0x0FFFFFFF;
+    }
+
+    bytes[n++] = value & 0x7F;
+    while ((value >>= 7) != 0)
+    {
+        bytes[n++] = 0x80 | (value & 0x7F);
+    }
+
+    while (n > 0)
+    {
+        WriteByte(bytes[--n]);
+    }
+}
+
+void WinRTMidiFileWriter::WriteVarint(unsigned long long value)
+{
+    while (value >= 0x80)
+    {
+        WriteByte(0x80 | (value & 0x7F));
+        value >>= 7;
+    }
+
+    WriteByte((unsigned char)value);
+}
+
+WinRTMidiErrorType WinRTMidiFileWriter::Patch(unsigned long long position, unsigned int value, unsigned int nBytes)
+{
+    if (Flush() != WINRT_NO_ERROR)
+    {
+        return WINRT_FILE_ERROR;
+    }
+
+    unsigned char bytes[4];
+    for (unsigned int i = 0; i < nBytes; i++)
+    {
+        bytes[i] = (unsigned char)(value >> ((nBytes - i - 1) * 8));
+    }
+
+    LARGE_INTEGER offset;
+    offset.QuadPart = (LONGLONG)position;
+    DWORD written = 0;
+    if (!SetFilePointerEx(mFile, offset, NULL, FILE_BEGIN)
+        || !WriteFile(mFile, bytes, nBytes, &written, NULL)
+        || written != nBytes)
+    {
+        mError = true;
+    }
+
+    // continue appending at the end of the file
+    offset.QuadPart = 0;
+    SetFilePointerEx(mFile, offset, NULL, FILE_END);
+    return mError ? WINRT_FILE_ERROR : WINRT_NO_ERROR;
+}
+
+WinRTMidiMappedFile::WinRTMidiMappedFile()
+    : mFile(INVALID_HANDLE_VALUE)
+    , mMapping(NULL)
+    , mData(nullptr)
+    , mSize(0)
+{
+}
+
+WinRTMidiMappedFile::~WinRTMidiMappedFile()
+{
+    Close();
+}
+
+WinRTMidiErrorType WinRTMidiMappedFile::Open(const char* path)
+{
+    std::wstring widePath = Utf8ToWString(path);
+    mFile = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (mFile == INVALID_HANDLE_VALUE)
+    {
+        return WINRT_FILE_ERROR;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mFile, &size) || size.QuadPart == 0 || (unsigned long long)size.QuadPart > SIZE_MAX)
+    {
+        Close();
+        return WINRT_FILE_ERROR;
+    }
+
+    mMapping = CreateFileMappingW(mFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mMapping == NULL)
+    {
+        Close();
+        return WINRT_FILE_ERROR;
+    }
+
+    mData = (const unsigned char*)MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+    if (mData == nullptr)
+    {
+        Close();
+        return WINRT_FILE_ERROR;
+    }
+
+    mSize = (size_t)size.QuadPart;
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiMappedFile::Close()
+{
+    if (mData)
+    {
+        UnmapViewOfFile(mData);
+        mData = nullptr;
+    }
+
+    if (mMapping)
+    {
+        CloseHandle(mMapping);
+        mMapping = NULL;
+    }
+
+    if (mFile != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(mFile);
+        mFile = INVALID_HANDLE_VALUE;
+    }
+
+    mSize = 0;
+}
@@ -0,0 +1,85 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include <string>
+#include <vector>
+#include <Windows.h>
+
+namespace WinRT
+{
+    std::wstring Utf8ToWString(const char* s);
+
+    #define kDefaultFileWriterBufferSize (64 * 1024)
+
+    /**********************************************************************************
+    Sequential file writer that collects small writes in a fixed size buffer and
+    hands them to the OS in large blocks. Nothing is allocated after Open().
+    Patch() overwrites bytes that were already written (e.g. chunk lengths).
+    **********************************************************************************/
+    class WinRTMidiFileWriter
+    {
+    public:
+        WinRTMidiFileWriter(size_t bufferSize = kDefaultFileWriterBufferSize);
+        ~WinRTMidiFileWriter();
+
+        WinRTMidiErrorType Open(const char* path);
+        WinRTMidiErrorType Close();
+
+        void Write(const unsigned char* data, size_t nBytes);
+        void WriteByte(unsigned char value);
+        void WriteBigEndian(unsigned int value, unsigned int nBytes);
+        void WriteVariableLength(unsigned int value);
+
+        // little endian base 128 (7 bits per byte, least significant group first)
+        void WriteVarint(unsigned long long value);
+        WinRTMidiErrorType Flush();
+
+        // overwrites nBytes big endian bytes at an absolute file position
+        WinRTMidiErrorType Patch(unsigned long long position, unsigned int value, unsigned int nBytes);
+
+        // number of bytes written so far including buffered bytes
+        unsigned long long GetPosition() { return mFilePosition + mBufferUsed; };
+        bool HasError() { return mError; };
+
+    private:
+        HANDLE mFile;
+        std::vector<unsigned char> mBuffer;
+        size_t mBufferUsed;
+        unsigned long long mFilePosition;
+        bool mError;
+    };
+
+    /**********************************************************************************
+    Read-only memory mapping of a complete file.
+    **********************************************************************************/
+    class WinRTMidiMappedFile
+    {
+    public:
+        WinRTMidiMappedFile();
+        ~WinRTMidiMappedFile();
+
+        WinRTMidiErrorType Open(const char* path);
+        void Close();
+
+        const unsigned char* GetData() { return mData; };
+        size_t GetSize() { return mSize; };
+
+    private:
+        HANDLE mFile;
+        HANDLE mMapping;
+        const unsigned char* mData;
+        size_t mSize;
+    };
+};
@@ -0,0 +1,155 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace WinRT
+{
+    #define kHandleIndexBits 12
+    #define kHandleIndexMask ((1u << kHandleIndexBits) - 1)
+    #define kHandleGenerationMask (0xFFFFFFFFu >> kHandleIndexBits)
+
+    /**********************************************************************************
+    Fixed capacity slab of objects addressed by generation tagged handles. A
+    handle holds the slot index and the generation of the slot when the object
+    was created. Freeing the object increments the generation, so a stale
+    handle no longer matches its slot and Get() returns nullptr instead of a
+    dangling pointer. Validation is O(1) and lock free, and objects are built
+    in place: creating or freeing one does not allocate.
+
+    Get() does not protect against an object being destroyed by another thread
+    while it is used; the caller must not free a handle that is still in use.
+    Objects that are not destroyed are never destructed, like the raw pointers
+    the handles replace.
+    **********************************************************************************/
+    template <class T, unsigned int Capacity>
+    class WinRTMidiHandleTable
+    {
+        static_assert(Capacity > 0 && Capacity < kHandleIndexMask, "handle table capacity must fit in the index bits");
+
+    public:
+        WinRTMidiHandleTable()
+            : mFreeHead(0)
+        {
+            for (unsigned int i = 0; i < Capacity; i++)
+            {
+                mSlots[i].generation = 0;
+                mSlots[i].nextFree = i + 1;
+            }
+        }
+
+        // returns nullptr if all slots are in use
+        template <class... Args>
+        void* Create(Args&&... args)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mFreeHead == Capacity)
+            {
+                return nullptr;
+            }
+
+            unsigned int index = mFreeHead;
+            Slot& slot = mSlots[index];
+            mFreeHead = slot.nextFree;
+
+            new (&slot.storage) T(std::forward<Args>(args)...);
+
+            // odd generations are live
+            unsigned int generation = (slot.generation.load(std::memory_order_relaxed) + 1) & kHandleGenerationMask;
+            slot.generation.store(generation, std::memory_order_release);
+            return MakeHandle(index, generation);
+        }
+
+        // returns nullptr if the handle is null, stale or was not created by this table
+        T* Get(const void* handle)
+        {
+            unsigned int index, generation;
+            if (!ParseHandle(handle, index, generation))
+            {
+                return nullptr;
+            }
+
+            Slot& slot = mSlots[index];
+            if (slot.generation.load(std::memory_order_acquire) != generation)
+            {
+                return nullptr;
+            }
+
+            return reinterpret_cast<T*>(&slot.storage);
+        }
+
+        // returns false if the handle is not valid
+        bool Destroy(const void* handle)
+        {
+            T* object;
+            unsigned int index, generation;
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (!ParseHandle(handle, index, generation) || mSlots[index].generation.load(std::memory_order_relaxed) != generation)
+                {
+                    return false;
+                }
+
+                // invalidate the handle before the object goes away
+                mSlots[index].generation.store((generation + 1) & kHandleGenerationMask, std::memory_order_release);
+                object = reinterpret_cast<T*>(&mSlots[index].storage);
+            }
+
+            // the destructor may close ports and wait for threads, so it runs without the lock
+            object->~T();
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            mSlots[index].nextFree = mFreeHead;
+            mFreeHead = index;
+            return true;
+        }
+
+    private:
+        struct Slot
+        {
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+            std::atomic<unsigned int> generation;
+            unsigned int nextFree;
+        };
+
+        static void* MakeHandle(unsigned int index, unsigned int generation)
+        {
+            // index + 1 keeps handles non null
+            return reinterpret_cast<void*>(static_cast<uintptr_t>((generation << kHandleIndexBits) | (index + 1)));
+        }
+
+        static bool ParseHandle(const void* handle, unsigned int& index, unsigned int& generation)
+        {
+            uintptr_t value = reinterpret_cast<uintptr_t>(handle);
+            if (value == 0 || value > 0xFFFFFFFFu)
+            {
+                return false;
+            }
+
+            index = static_cast<unsigned int>(value & kHandleIndexMask) - 1;
+            generation = static_cast<unsigned int>(value >> kHandleIndexBits);
+            return index < Capacity && (generation & 1) != 0;
+        }
+
+        std::mutex mMutex;
+        Slot mSlots[Capacity];
+        unsigned int mFreeHead;
+    };
+};
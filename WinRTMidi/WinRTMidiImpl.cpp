@@ -12,6 +12,12 @@
 
 #include "WinRTMidi.h"
 #include "WinRTMidiimpl.h"
+#include "WinRTMidiBroker.h"
+#include "WinRTMidiNetwork.h"
+#include "WinRTMidiVirtualPort.h"
+#include "WinRTMidiDevicePorts.h"
+#include "WinRTMidiTime.h"
+#include <algorithm>
 #include <ppltasks.h>
 #include <robuffer.h> 
 
@@ -27,23 +33,156 @@ using namespace Microsoft::WRL;
     WinRTMidiInPort
 *****************************************************/
 
-WinRTMidi::WinRTMidi(MidiPortChangedCallback callback)
+std::mutex WinRTMidi::sVirtualPortMutex;
+std::vector<WinRTMidi::VirtualPortEntry> WinRTMidi::sVirtualPorts;
+std::mutex WinRTMidi::sNetworkPortMutex;
+std::vector<WinRTMidi::NetworkPortEntry> WinRTMidi::sNetworkPorts;
+
+WinRTMidi::WinRTMidi(MidiPortChangedCallback callback, const WinRTMidiConfig& config)
+    : mCallback(callback)
+    , mAutoReconnect(false)
+    , mMidiInPortWatcher(nullptr)
+    , mMidiOutPortWatcher(nullptr)
+    , mConfig(config)
+    , mNextDispatcher(0)
 {
-    mMidiInPortWatcher = ref new WinRTMidiPortWatcher(WinRTMidiPortType::In, callback);
-    mMidiOutPortWatcher = ref new WinRTMidiPortWatcher(WinRTMidiPortType::Out, callback);
-    mMidiInPortWatcherWrapper = std::make_shared<MidiPortWatcherWrapper>(mMidiInPortWatcher);
-    mMidiOutPortWatcherWrapper = std::make_shared<MidiPortWatcherWrapper>(mMidiOutPortWatcher);
+    mNetworkConfig = GetDefaultNetworkConfig();
+}
+
+WinRTMidiErrorType WinRTMidi::GetConfig(const WinRTMidiConfig* config, WinRTMidiConfig& resolved)
+{
+    memset(&resolved, 0, sizeof(resolved));
+    if (config)
+    {
+        resolved = *config;
+    }
+
+    // the smallest buffer must hold a channel message
+    if ((resolved.outputBufferSize > 0 && resolved.outputBufferSize < 3)
+        || resolved.outputOverflow == WINRT_OVERFLOW_DROP_OLDEST || resolved.outputOverflow > WINRT_OVERFLOW_DROP_OLDEST
+        || resolved.inputOverflow == WINRT_OVERFLOW_GROW || resolved.inputOverflow == WINRT_OVERFLOW_SPLIT
+        || resolved.inputOverflow > WINRT_OVERFLOW_DROP_OLDEST
+        || resolved.dispatcherThreads > kMaxDispatcherThreads)
+    {
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    if (resolved.maxPorts == 0)
+    {
+        resolved.maxPorts = kDefaultMaxPorts;
+    }
+
+    if (resolved.outputBufferCount == 0)
+    {
+        resolved.outputBufferCount = kDefaultOutputBufferCount;
+    }
+
+    if (resolved.outputBufferSize == 0)
+    {
+        resolved.outputBufferSize = kDefaultOutputBufferSize;
+    }
+
+    if (resolved.outputOverflow == WINRT_OVERFLOW_DEFAULT)
+    {
+        resolved.outputOverflow = WINRT_OVERFLOW_GROW;
+    }
+
+    if (resolved.inputOverflow == WINRT_OVERFLOW_DEFAULT)
+    {
+        resolved.inputOverflow = WINRT_OVERFLOW_DROP_NEWEST;
+    }
+
+    if (config == nullptr)
+    {
+        resolved.dispatcher.threadPriority = THREAD_PRIORITY_TIME_CRITICAL;
+    }
+
+    if (resolved.dispatcher.queueCapacity == 0)
+    {
+        resolved.dispatcher.queueCapacity = kDefaultDispatcherQueueCapacity;
+    }
+
+    return WINRT_NO_ERROR;
+}
+
+WinRTMidi::~WinRTMidi()
+{
+    if (!mPortWatchers || mMidiInPortWatcher == nullptr || mMidiOutPortWatcher == nullptr)
+    {
+        return;
+    }
+
+    std::vector<std::string> names;
+    {
+        std::lock_guard<std::mutex> lock(sVirtualPortMutex);
+        for (const auto& entry : sVirtualPorts)
+        {
+            if (entry.owner == this)
+            {
+                names.push_back(entry.port->GetName());
+            }
+        }
+    }
+
+    for (const auto& name : names)
+    {
+        RemoveVirtualPortPair(name);
+    }
+
+    std::vector<NetworkPortEntry> networkPorts;
+    {
+        std::lock_guard<std::mutex> lock(sNetworkPortMutex);
+        auto it = std::partition(sNetworkPorts.begin(), sNetworkPorts.end(), [this](const NetworkPortEntry& entry)
+        {
+            return entry.owner != this;
+        });
+        networkPorts.assign(it, sNetworkPorts.end());
+        sNetworkPorts.erase(it, sNetworkPorts.end());
+    }
+
+    // the watchers raise PortRemoved, so this is done without holding the lock
+    for (const auto& entry : networkPorts)
+    {
+        GetPortWatcher(entry.type)->RemovePort(entry.id);
+    }
+
+    // waits for the callbacks of this instance that are running
+    mMidiInPortWatcher->RemoveListener(this);
+    mMidiOutPortWatcher->RemoveListener(this);
 }
 
 WinRTMidiErrorType WinRTMidi::Initialize()
 {
-    WinRTMidiErrorType result = mMidiInPortWatcher->Initialize();
-    if (result == WINRT_NO_ERROR)
+    // only the first instance of the process waits for the device enumeration
+    WinRTMidiErrorType result = WinRTMidiPortWatchers::Acquire(mPortWatchers, mConfig.maxPorts);
+    if (result != WINRT_NO_ERROR)
     {
-        result = mMidiOutPortWatcher->Initialize();
+        return result;
     }
 
-    return result;
+    // the destructor uses the watchers once mPortWatchers is set, so they are assigned
+    // before anything else can fail
+    mMidiInPortWatcher = mPortWatchers->GetWatcher(WinRTMidiPortType::In);
+    mMidiOutPortWatcher = mPortWatchers->GetWatcher(WinRTMidiPortType::Out);
+    mMidiInPortWatcherWrapper = std::make_shared<MidiPortWatcherWrapper>(mMidiInPortWatcher);
+    mMidiOutPortWatcherWrapper = std::make_shared<MidiPortWatcherWrapper>(mMidiOutPortWatcher);
+
+    mBufferPool = std::make_shared<WinRTMidiBufferPool>(mConfig.outputBufferCount, mConfig.outputBufferSize);
+
+    mInputDispatchers.reserve(kMaxDispatcherThreads);
+    for (unsigned int i = 0; i < mConfig.dispatcherThreads; i++)
+    {
+        result = EnableInputDispatcher(mConfig.dispatcher);
+        if (result != WINRT_NO_ERROR)
+        {
+            return result;
+        }
+    }
+
+    // the callback receives EnumerationComplete while the listener is added
+    mMidiInPortWatcher->AddListener(this, mCallback, std::bind(&WinRTMidi::OnPortIdChanged, this, _1, _2));
+    mMidiOutPortWatcher->AddListener(this, mCallback, std::bind(&WinRTMidi::OnPortIdChanged, this, _1, _2));
+    return WINRT_NO_ERROR;
 }
 
 WinRTMidiPortWatcher^ WinRTMidi::GetPortWatcher(WinRTMidiPortType type)
@@ -87,177 +226,1277 @@ Platform::String^ WinRTMidi::getPortId(WinRTMidiPortType type, unsigned int inde
     return nullptr;
 }
 
-WinRTMidiPort::WinRTMidiPort()
-    : mErrorMessage("")
-    , mError(WINRT_NO_ERROR)
+WinRTMidiErrorType WinRTMidi::EnableInputDispatcher(const WinRTMidiDispatcherConfig& config)
 {
+    // Initialize() starts the dispatchers of the config one by one
+    if (mInputDispatchers.size() >= std::max(mConfig.dispatcherThreads, 1u))
+    {
+        for (auto& dispatcher : mInputDispatchers)
+        {
+            WinRTMidiErrorType result = dispatcher->Configure(config);
+            if (result != WINRT_NO_ERROR)
+            {
+                return result;
+            }
+        }
+
+        return WINRT_NO_ERROR;
+    }
+
+    auto dispatcher = std::make_shared<WinRTMidiInputDispatcher>(config);
+    dispatcher->SetOverflowPolicy(mConfig.inputOverflow);
+    WinRTMidiErrorType result = dispatcher->Start();
+    if (result == WINRT_NO_ERROR)
+    {
+        mInputDispatchers.push_back(std::move(dispatcher));
+    }
 
+    return result;
 }
 
-WinRTMidiPort::~WinRTMidiPort()
+bool WinRTMidi::GetInputDispatcherStats(WinRTMidiDispatcherStats& stats)
 {
+    if (mInputDispatchers.empty())
+    {
+        return false;
+    }
+
+    memset(&stats, 0, sizeof(stats));
+    double totalDelay = 0.0;
+    for (auto& dispatcher : mInputDispatchers)
+    {
+        WinRTMidiDispatcherStats threadStats;
+        dispatcher->GetStats(threadStats);
+        stats.messagesDispatched += threadStats.messagesDispatched;
+        stats.messagesDropped += threadStats.messagesDropped;
+        stats.maxQueueDelay = std::max(stats.maxQueueDelay, threadStats.maxQueueDelay);
+        totalDelay += threadStats.averageQueueDelay * threadStats.messagesDispatched;
+    }
 
+    if (stats.messagesDispatched > 0)
+    {
+        stats.averageQueueDelay = totalDelay / stats.messagesDispatched;
+    }
+
+    return true;
 }
 
-void WinRTMidiPort::SetError(WinRTMidiErrorType error, const std::string& message)
+void WinRTMidi::ConfigurePort(WinRTMidiInPort^ port)
 {
-    mError = error;
-    mErrorMessage = message;
+    if (!mInputDispatchers.empty())
+    {
+        // the messages of a port stay on one thread so they are delivered in order
+        unsigned int index = mNextDispatcher++ % mInputDispatchers.size();
+        port->SetInputDispatcher(mInputDispatchers[index]);
+    }
+
+    port->SetMaxMessageSize(mConfig.maxSysExSize);
 }
 
-const std::string& WinRTMidiPort::GetErrorMessage()
+void WinRTMidi::ConfigurePort(WinRTMidiOutPort^ port)
 {
-    return mErrorMessage;
+    port->SetBufferPool(mBufferPool, mConfig.outputOverflow);
 }
 
-WinRTMidiErrorType WinRTMidiPort::GetError()
+WinRTMidiErrorType WinRTMidi::AddNetworkPort(WinRTMidiPortType type, const std::string& name, const std::string& host, unsigned short port)
 {
-    return mError;
+    auto watcher = GetPortWatcher(type);
+    WinRTMidiNetworkAddress address;
+    if (watcher == nullptr || port == 0 || !WinRTMidiUdpSocket::Resolve(host, port, address))
+    {
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    auto id = ref new Platform::String(MakeNetworkPortId(host, port).c_str());
+    {
+        // recorded before the port is listed so the port never exists without an owner
+        std::lock_guard<std::mutex> lock(sNetworkPortMutex);
+        sNetworkPorts.push_back({ this, type, id });
+    }
+
+    if (!watcher->AddPort(name, id))
+    {
+        RemoveNetworkPortEntry(type, id);
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    return WINRT_NO_ERROR;
 }
 
-WinRTMidiInPort::WinRTMidiInPort()
-    : mMessageReceivedCallback(nullptr)
+WinRTMidiErrorType WinRTMidi::RemoveNetworkPort(WinRTMidiPortType type, const std::string& host, unsigned short port)
 {
+    auto watcher = GetPortWatcher(type);
+    auto id = ref new Platform::String(MakeNetworkPortId(host, port).c_str());
+    if (watcher == nullptr || !RemoveNetworkPortEntry(type, id))
+    {
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    watcher->RemovePort(id);
+    return WINRT_NO_ERROR;
 }
 
-WinRTMidiInPort::~WinRTMidiInPort()
+// returns false if this instance did not add the port
+bool WinRTMidi::RemoveNetworkPortEntry(WinRTMidiPortType type, Platform::String^ id)
 {
+    std::lock_guard<std::mutex> lock(sNetworkPortMutex);
+    auto it = std::find_if(sNetworkPorts.begin(), sNetworkPorts.end(), [this, type, id](const NetworkPortEntry& entry)
+    {
+        return entry.owner == this && entry.type == type && entry.id == id;
+    });
+
+    if (it == sNetworkPorts.end())
+    {
+        return false;
+    }
 
+    sNetworkPorts.erase(it);
+    return true;
 }
 
-//Blocks until port is open
-WinRTMidiErrorType WinRTMidiInPort::OpenPort(Platform::String^ id)
+WinRTMidiErrorType WinRTMidi::CreateVirtualPortPair(const std::string& name, std::shared_ptr<WinRTMidiVirtualPort>& port)
 {
-    WinRTMidiErrorType result = WINRT_NO_ERROR;
-    mLastMessageTime = 0;
-    mFirstMessage = true;
-    auto task = create_task(MidiInPort::FromIdAsync(id));
+    auto inWatcher = GetPortWatcher(In);
+    auto outWatcher = GetPortWatcher(Out);
+    if (name.empty() || inWatcher == nullptr || outWatcher == nullptr)
+    {
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    {
+        // names are unique in the process as the watchers are shared
+        std::lock_guard<std::mutex> lock(sVirtualPortMutex);
+        for (const auto& entry : sVirtualPorts)
+        {
+            if (entry.port->GetName() == name)
+            {
+                return WINRT_INVALID_PARAMETER_ERROR;
+            }
+        }
+
+        port = std::make_shared<WinRTMidiVirtualPort>(name);
+        WinRTMidiErrorType result = port->Start();
+        if (result != WINRT_NO_ERROR)
+        {
+            port = nullptr;
+            return result;
+        }
+
+        sVirtualPorts.push_back({ this, port });
+    }
 
-    // get results
-    try
+    // the watchers raise PortAdded, so this is done without holding the lock
+    inWatcher->AddPort(name, port->GetId());
+    outWatcher->AddPort(name, port->GetId());
+
+    // another thread may have removed the pair before it was listed. Its RemovePort calls then
+    // found nothing, so the ports are unlisted here
+    if (GetVirtualPort(port->GetId()) == nullptr)
     {
-        // block until port is created
-        mMidiInPort = task.get();
-		if (mMidiInPort != nullptr)
-		{
-			mMidiInPort->MessageReceived += ref new Windows::Foundation::TypedEventHandler<MidiInPort ^, MidiMessageReceivedEventArgs ^>(this, &WinRTMidiInPort::OnMidiInMessageReceived);
-		}
-		else
-		{
-			// no exception but we didn't get a valid port
-			result = WINRT_OPEN_PORT_ERROR;
-		}
+        inWatcher->RemovePort(port->GetId());
+        outWatcher->RemovePort(port->GetId());
     }
-    catch (Platform::Exception^ ex)
+
+    return WINRT_NO_ERROR;
+}
+
+WinRTMidiErrorType WinRTMidi::RemoveVirtualPortPair(const std::string& name)
+{
+    std::shared_ptr<WinRTMidiVirtualPort> port;
+
     {
-        result = WINRT_OPEN_PORT_ERROR;
+        // an instance can only remove the pairs it created
+        std::lock_guard<std::mutex> lock(sVirtualPortMutex);
+        auto it = std::find_if(sVirtualPorts.begin(), sVirtualPorts.end(), [this, &name](const VirtualPortEntry& entry)
+        {
+            return entry.owner == this && entry.port->GetName() == name;
+        });
+
+        if (it == sVirtualPorts.end())
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        port = it->port;
+        sVirtualPorts.erase(it);
     }
 
-    return result;
+    // ports opened on the pair hold a reference to it and keep working until they are closed
+    GetPortWatcher(In)->RemovePort(port->GetId());
+    GetPortWatcher(Out)->RemovePort(port->GetId());
+    return WINRT_NO_ERROR;
 }
 
-void WinRTMidiInPort::ClosePort(void) 
+std::shared_ptr<WinRTMidiVirtualPort> WinRTMidi::GetVirtualPort(Platform::String^ id)
 {
-    mMidiInPort = nullptr;
+    std::lock_guard<std::mutex> lock(sVirtualPortMutex);
+    for (const auto& entry : sVirtualPorts)
+    {
+        if (entry.port->GetId() == id)
+        {
+            return entry.port;
+        }
+    }
+
+    return nullptr;
 }
 
-void WinRTMidiInPort::OnMidiInMessageReceived(MidiInPort^ sender, MidiMessageReceivedEventArgs^ args)
+void WinRTMidi::AddOpenPort(WinRTMidiPort^ port)
 {
-    if (mMessageReceivedCallback)
+    std::lock_guard<std::mutex> lock(mOpenPortMutex);
+
+    // forget ports that have been released
+    mOpenPorts.erase(std::remove_if(mOpenPorts.begin(), mOpenPorts.end(), [](Platform::WeakReference& ref)
     {
-        if (mFirstMessage)
+        return ref.Resolve<WinRTMidiPort>() == nullptr;
+    }), mOpenPorts.end());
+
+    mOpenPorts.push_back(Platform::WeakReference(port));
+}
+
+void WinRTMidi::OnPortIdChanged(Platform::String^ id, WinRTMidiPortUpdateType update)
+{
+    if (update == WinRTMidiPortUpdateType::PortAdded)
+    {
+        if (mAutoReconnect)
         {
-            mFirstMessage = false;
-            mLastMessageTime = args->Message->Timestamp.Duration;
+            ReconnectPorts(id);
         }
 
-        double timestamp = (args->Message->Timestamp.Duration - mLastMessageTime) * .0001;
-        mLastMessageTime = args->Message->Timestamp.Duration;
+        return;
+    }
+
+    if (update != WinRTMidiPortUpdateType::PortRemoved)
+    {
+        return;
+    }
 
-        auto buffer = args->Message->RawData;
+    std::vector<WinRTMidiPort^> removed;
+    {
+        std::lock_guard<std::mutex> lock(mOpenPortMutex);
+        for (auto& ref : mOpenPorts)
+        {
+            auto port = ref.Resolve<WinRTMidiPort>();
+            if (port != nullptr && port->GetId() == id)
+            {
+                removed.push_back(port);
+            }
+        }
+    }
 
-        // Obtain IBufferByteAccess 
-        ComPtr<IBufferByteAccess> pBufferByteAccess;
-        ComPtr<IUnknown> pBuffer((IUnknown*)buffer);
-        pBuffer.As(&pBufferByteAccess);
+    // the device port is no longer shared; ports that open the device again get a new one
+    WinRTMidiDevicePorts::Forget(id);
 
-        // Get pointer to iBuffer bytes 
-        byte* pData;
-        pBufferByteAccess->Buffer(&pData);
-        mMessageReceivedCallback((WinRTMidiInPortPtr) this, timestamp, pData, buffer->Length);
+    for (auto port : removed)
+    {
+        port->OnDeviceRemoved();
     }
 }
 
+void WinRTMidi::ReconnectPorts(Platform::String^ id)
+{
+    std::vector<WinRTMidiPort^> disconnected;
+    {
+        std::lock_guard<std::mutex> lock(mOpenPortMutex);
+        for (auto& ref : mOpenPorts)
+        {
+            auto port = ref.Resolve<WinRTMidiPort>();
+            if (port != nullptr && port->GetId() == id && port->IsDisconnected())
+            {
+                disconnected.push_back(port);
+            }
+        }
+    }
 
-/*****************************************************
-    WinRTMidiOutPort
-*****************************************************/
+    // opening the device blocks, so the watcher thread is not held up. Ports of the same device
+    // share the device port and wait for a single open
+    for (auto port : disconnected)
+    {
+        create_task([port]()
+        {
+            port->Reconnect();
+        });
+    }
+}
 
-#define kOutputMidiBufferSize 128
-WinRTMidiOutPort::WinRTMidiOutPort()
+WinRTMidiPort::WinRTMidiPort()
+    : mErrorMessage("")
+    , mError(WINRT_NO_ERROR)
+    , mNetworkConfig(GetDefaultNetworkConfig())
+    , mDisconnectTime(0)
 {
-    mBuffer = ref new Buffer(kOutputMidiBufferSize);
-    mBufferData = getIBufferDataPtr(mBuffer);
+    memset(&mConnectionStats, 0, sizeof(mConnectionStats));
+    mConnectionStats.connected = 1;
 }
 
-WinRTMidiOutPort::~WinRTMidiOutPort()
+WinRTMidiPort::~WinRTMidiPort()
 {
+
 }
 
-//Blocks until port is open
-WinRTMidiErrorType WinRTMidiOutPort::OpenPort(Platform::String^ id)
+void WinRTMidiPort::SetError(WinRTMidiErrorType error, const std::string& message)
+{
+    mError = error;
+    mErrorMessage = message;
+}
+
+const std::string& WinRTMidiPort::GetErrorMessage()
+{
+    return mErrorMessage;
+}
+
+WinRTMidiErrorType WinRTMidiPort::GetError()
 {
-    WinRTMidiErrorType result = WINRT_NO_ERROR;
-    auto task = create_task(MidiOutPort::FromIdAsync(id));
+    return mError;
+}
 
-    try
+void WinRTMidiPort::OnDisconnected()
+{
+    std::lock_guard<std::mutex> lock(mConnectionMutex);
+    if (mConnectionStats.connected)
     {
-        // blocks until port is created
-        mMidiOutPort = task.get();
-		if (mMidiOutPort == nullptr)
-		{
-			// no exception but we didn't get a valid port
-			result = WINRT_OPEN_PORT_ERROR;
-		}
+        mConnectionStats.connected = 0;
+        mConnectionStats.disconnects++;
+        mDisconnectTime = GetTimeMicroseconds();
     }
-    catch (Platform::Exception^ ex)
+}
+
+void WinRTMidiPort::OnReconnected()
+{
+    std::lock_guard<std::mutex> lock(mConnectionMutex);
+    if (!mConnectionStats.connected)
     {
-        result = WINRT_OPEN_PORT_ERROR;
+        double outage = (GetTimeMicroseconds() - mDisconnectTime) / 1000000.0;
+        mConnectionStats.connected = 1;
+        mConnectionStats.reconnects++;
+        mConnectionStats.lastOutage = outage;
+        mConnectionStats.longestOutage = std::max(mConnectionStats.longestOutage, outage);
+        mConnectionStats.totalOutage += outage;
     }
+}
 
-    return result;
+bool WinRTMidiPort::IsDisconnected()
+{
+    std::lock_guard<std::mutex> lock(mConnectionMutex);
+    return !mConnectionStats.connected;
 }
 
-void WinRTMidiOutPort::ClosePort(void)
+void WinRTMidiPort::GetConnectionStats(WinRTMidiConnectionStats& stats)
 {
-    mMidiOutPort = nullptr;
+    std::lock_guard<std::mutex> lock(mConnectionMutex);
+    stats = mConnectionStats;
+    if (!stats.connected)
+    {
+        stats.totalOutage += (GetTimeMicroseconds() - mDisconnectTime) / 1000000.0;
+    }
 }
 
-byte* WinRTMidiOutPort::getIBufferDataPtr(IBuffer^ buffer)
+WinRTMidiInPort::WinRTMidiInPort()
+    : mLastMessageTime(0)
+    , mFirstMessage(true)
+    , mMessageReceivedCallback(nullptr)
+    , mFilterMask(WINRT_MIDI_ALL_MESSAGES)
+    , mMaxMessageSize(0)
+{
+}
+
+WinRTMidiInPort::~WinRTMidiInPort()
 {
-    // Obtain IBufferByteAccess 
-    ComPtr<IBufferByteAccess> pBufferByteAccess;
-    ComPtr<IUnknown> pBuffer((IUnknown*)buffer);
-    pBuffer.As(&pBufferByteAccess);
 
-    // Get pointer to iBuffer bytes 
-    byte* pData;
-    pBufferByteAccess->Buffer(&pData);
-    return pData;
 }
 
-void WinRTMidiOutPort::Send(const unsigned char* message, unsigned int nBytes)
+//Blocks until port is open
+WinRTMidiErrorType WinRTMidiInPort::OpenPort(Platform::String^ id)
 {
-    // check if preallocated IBuffer is big enough and reallocate if needed
-    if (nBytes > mBuffer->Capacity)
+    std::string host;
+    unsigned short port;
+    if (ParseNetworkPortId(id->Data(), host, port))
     {
-        mBuffer = ref new Buffer(nBytes);
-        mBufferData = getIBufferDataPtr(mBuffer);
+        return OpenNetworkPort(id, host, port);
     }
 
-    memcpy_s(mBufferData, nBytes, message, nBytes);
-    mBuffer->Length = nBytes;
-    mMidiOutPort->SendBuffer(mBuffer);
+    mLastMessageTime = 0;
+    mFirstMessage = true;
+
+    // blocks until the device is opened unless another port already uses it
+    auto devicePort = WinRTMidiDevicePorts::AcquireInPort(id);
+    if (devicePort == nullptr)
+    {
+        return WINRT_OPEN_PORT_ERROR;
+    }
+
+    std::lock_guard<std::mutex> lock(mDeviceMutex);
+    SetId(id);
+    mMidiInPort = devicePort;
+    mMessageReceivedToken = mMidiInPort->MessageReceived += ref new Windows::Foundation::TypedEventHandler<MidiInPort ^, MidiMessageReceivedEventArgs ^>(this, &WinRTMidiInPort::OnMidiInMessageReceived);
+    return WINRT_NO_ERROR;
 }
 
+void WinRTMidiInPort::Reconnect()
+{
+    auto id = GetId();
+    if (id == nullptr)
+    {
+        return;
+    }
+
+    auto devicePort = WinRTMidiDevicePorts::AcquireInPort(id);
+    if (devicePort == nullptr)
+    {
+        // stays disconnected until the device is added again
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mDeviceMutex);
+    if (GetId() != id || mMidiInPort != nullptr)
+    {
+        // closed or reconnected while the device was opened
+        WinRTMidiDevicePorts::ReleaseInPort(id, devicePort);
+        return;
+    }
+
+    // the timestamps of the reopened device start again
+    mFirstMessage = true;
+    mMidiInPort = devicePort;
+    mMessageReceivedToken = mMidiInPort->MessageReceived += ref new Windows::Foundation::TypedEventHandler<MidiInPort ^, MidiMessageReceivedEventArgs ^>(this, &WinRTMidiInPort::OnMidiInMessageReceived);
+    OnReconnected();
+}
 
+void WinRTMidiInPort::ReleaseDevicePort()
+{
+    if (mMidiInPort != nullptr)
+    {
+        // the device port is shared, so the port stops listening to it
+        mMidiInPort->MessageReceived -= mMessageReceivedToken;
+        WinRTMidiDevicePorts::ReleaseInPort(GetId(), mMidiInPort);
+        mMidiInPort = nullptr;
+    }
+}
+
+WinRTMidiErrorType WinRTMidiInPort::OpenLoopbackPort()
+{
+    mLastMessageTime = 0;
+    mFirstMessage = true;
+
+    std::lock_guard<std::mutex> lock(mDeviceMutex);
+    ReleaseDevicePort();
+    SetId(nullptr);
+    return WINRT_NO_ERROR;
+}
+
+WinRTMidiErrorType WinRTMidiInPort::OpenBrokerPort(const std::string& name)
+{
+    OpenLoopbackPort();
+    mBrokerInput.reset(new WinRTMidiBrokerInput(this));
+    WinRTMidiErrorType result = mBrokerInput->Start(name);
+    if (result != WINRT_NO_ERROR)
+    {
+        mBrokerInput.reset();
+    }
+
+    return result;
+}
+
+WinRTMidiErrorType WinRTMidiInPort::OpenNetworkPort(Platform::String^ id, const std::string& host, unsigned short port)
+{
+    OpenLoopbackPort();
+    mNetworkReceiver.reset(new WinRTMidiNetworkReceiver(GetNetworkConfig(), [this](long long time, const unsigned char* message, unsigned int nBytes)
+    {
+        // ReceiveMessage expects 100ns units
+        ReceiveMessage(time * 10, message, nBytes);
+    }));
+
+    WinRTMidiErrorType result = mNetworkReceiver->Start(host, port);
+    if (result != WINRT_NO_ERROR)
+    {
+        mNetworkReceiver.reset();
+        return result;
+    }
+
+    SetId(id);
+    return WINRT_NO_ERROR;
+}
+
+WinRTMidiErrorType WinRTMidiInPort::OpenVirtualPort(const std::shared_ptr<WinRTMidiVirtualPort>& port)
+{
+    OpenLoopbackPort();
+    mVirtualPort = port;
+    mVirtualPort->AddInPort(this);
+    SetId(port->GetId());
+    return WINRT_NO_ERROR;
+}
+
+bool WinRTMidiInPort::GetNetworkStats(WinRTMidiNetworkStats& stats)
+{
+    if (!mNetworkReceiver)
+    {
+        return false;
+    }
+
+    mNetworkReceiver->GetStats(stats);
+    return true;
+}
+
+void WinRTMidiInPort::ClosePort(void) 
+{
+    mBrokerInput.reset();
+    mNetworkReceiver.reset();
+    if (mVirtualPort)
+    {
+        // the pair holds a reference to this port until it is removed
+        mVirtualPort->RemoveInPort(this);
+        mVirtualPort = nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mDeviceMutex);
+        ReleaseDevicePort();
+        SetId(nullptr);
+    }
+
+    SetCoalescer(nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(mRouteMutex);
+        mRoutes.clear();
+    }
+
+    // wait for queued callbacks of this port to complete
+    if (mDispatcher)
+    {
+        mDispatcher->Drain();
+    }
+}
+
+void WinRTMidiInPort::AddListener(WinRTMidiInListener* listener)
+{
+    std::lock_guard<std::mutex> lock(mListenerMutex);
+    mListeners.push_back(listener);
+}
+
+// once this returns the listener is no longer called
+void WinRTMidiInPort::RemoveListener(WinRTMidiInListener* listener)
+{
+    std::lock_guard<std::mutex> lock(mListenerMutex);
+    mListeners.erase(std::remove(mListeners.begin(), mListeners.end(), listener), mListeners.end());
+}
+
+void WinRTMidiInPort::OnMidiInMessageReceived(MidiInPort^ sender, MidiMessageReceivedEventArgs^ args)
+{
+    auto buffer = args->Message->RawData;
+    long long time = args->Message->Timestamp.Duration;
+
+    // Obtain IBufferByteAccess 
+    ComPtr<IBufferByteAccess> pBufferByteAccess;
+    ComPtr<IUnknown> pBuffer((IUnknown*)buffer);
+    pBuffer.As(&pBufferByteAccess);
+
+    // Get pointer to iBuffer bytes 
+    byte* pData;
+    pBufferByteAccess->Buffer(&pData);
+
+    ReceiveMessage(time, pData, buffer->Length);
+}
+
+void WinRTMidiInPort::ReceiveMessage(long long time, const unsigned char* message, unsigned int nBytes)
+{
+    if (mMaxMessageSize > 0 && nBytes > mMaxMessageSize)
+    {
+        return;
+    }
+
+    mChannelState.Update(message, nBytes);
+
+    {
+        std::lock_guard<std::mutex> lock(mRouteMutex);
+        for (auto route : mRoutes)
+        {
+            route->Send(message, nBytes);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mListenerMutex);
+        for (auto listener : mListeners)
+        {
+            listener->OnMidiInMessage((WinRTMidiInPortPtr) this, time, message, nBytes);
+        }
+    }
+
+    // clock and transport messages are tracked before filtering
+    if (nBytes > 0 && message[0] >= 0xF2)
+    {
+        mClockTracker.Process(time, message, nBytes);
+    }
+
+    if ((GetMidiMessageType(message, nBytes) & mFilterMask.load(std::memory_order_relaxed)) == 0)
+    {
+        return;
+    }
+
+    auto coalescer = std::atomic_load(&mCoalescer);
+    if (coalescer)
+    {
+        coalescer->Process(time, message, nBytes);
+    }
+    else
+    {
+        DeliverMessage(time, message, nBytes);
+    }
+}
+
+void WinRTMidiInPort::AddRoute(WinRTMidiOutPort^ port)
+{
+    std::lock_guard<std::mutex> lock(mRouteMutex);
+    if (std::find(mRoutes.begin(), mRoutes.end(), port) == mRoutes.end())
+    {
+        mRoutes.push_back(port);
+    }
+}
+
+void WinRTMidiInPort::RemoveRoute(WinRTMidiOutPort^ port)
+{
+    std::lock_guard<std::mutex> lock(mRouteMutex);
+    mRoutes.erase(std::remove(mRoutes.begin(), mRoutes.end(), port), mRoutes.end());
+}
+
+void WinRTMidiInPort::OnDeviceRemoved()
+{
+    {
+        // keeps the id so the port can be reconnected. Network and virtual ports keep working
+        std::lock_guard<std::mutex> lock(mDeviceMutex);
+        if (mMidiInPort != nullptr)
+        {
+            ReleaseDevicePort();
+            OnDisconnected();
+        }
+    }
+
+    // the device can no longer send the note offs
+    WinRTMidiChannelStateSnapshot snapshot;
+    mChannelState.GetSnapshot(snapshot);
+    mChannelState.Reset();
+
+    std::lock_guard<std::mutex> lock(mRouteMutex);
+    for (auto route : mRoutes)
+    {
+        WinRTMidiChannelState::GetAllNotesOff(snapshot, [route](const unsigned char* message, unsigned int nBytes)
+        {
+            route->Send(message, nBytes);
+        });
+    }
+}
+
+WinRTMidiErrorType WinRTMidiInPort::SetCoalescer(const WinRTMidiCoalescerConfig* config)
+{
+    std::shared_ptr<WinRTMidiCoalescer> coalescer;
+    if (config)
+    {
+        coalescer = std::make_shared<WinRTMidiCoalescer>(*config, [this](long long time, const unsigned char* message, unsigned int nBytes)
+        {
+            DeliverMessage(time, message, nBytes);
+        });
+
+        WinRTMidiErrorType result = coalescer->Start();
+        if (result != WINRT_NO_ERROR)
+        {
+            return result;
+        }
+    }
+
+    // a message being processed by the previous coalescer keeps it alive until it is done
+    auto previous = std::atomic_exchange(&mCoalescer, coalescer);
+    if (previous)
+    {
+        previous->Stop();
+    }
+
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiInPort::FlushCoalescer()
+{
+    auto coalescer = std::atomic_load(&mCoalescer);
+    if (coalescer)
+    {
+        coalescer->Flush();
+    }
+}
+
+void WinRTMidiInPort::DeliverMessage(long long time, const unsigned char* message, unsigned int nBytes)
+{
+    if (mMessageReceivedCallback)
+    {
+        if (mFirstMessage)
+        {
+            mFirstMessage = false;
+            mLastMessageTime = time;
+        }
+
+        // coalesced messages can be older than the last delivered message
+        if (time < mLastMessageTime)
+        {
+            time = mLastMessageTime;
+        }
+
+        double timestamp = (time - mLastMessageTime) * .0001;
+        mLastMessageTime = time;
+
+        if (mDispatcher)
+        {
+            mDispatcher->Enqueue(mMessageReceivedCallback, (WinRTMidiInPortPtr) this, time, timestamp, message, nBytes);
+        }
+        else
+        {
+            mMessageReceivedCallback((WinRTMidiInPortPtr) this, timestamp, message, nBytes);
+        }
+    }
+}
+
+
+/*****************************************************
+    WinRTMidiOutPort
+*****************************************************/
+
+WinRTMidiOutPort::WinRTMidiOutPort()
+    : mBufferData(nullptr)
+    , mOverflow(WINRT_OVERFLOW_GROW)
+{
+}
+
+WinRTMidiOutPort::~WinRTMidiOutPort()
+{
+}
+
+//Blocks until port is open
+WinRTMidiErrorType WinRTMidiOutPort::OpenPort(Platform::String^ id)
+{
+    std::string host;
+    unsigned short port;
+    if (ParseNetworkPortId(id->Data(), host, port))
+    {
+        return OpenNetworkPort(id, host, port);
+    }
+
+    // blocks until the device is opened unless another port already uses it
+    auto devicePort = WinRTMidiDevicePorts::AcquireOutPort(id);
+    if (devicePort == nullptr)
+    {
+        return WINRT_OPEN_PORT_ERROR;
+    }
+
+    std::lock_guard<std::mutex> lock(mSendMutex);
+    WinRTMidiErrorType result = AcquireBuffer();
+    if (result != WINRT_NO_ERROR)
+    {
+        WinRTMidiDevicePorts::ReleaseOutPort(id, devicePort);
+        return result;
+    }
+
+    mMidiOutPort = devicePort;
+    SetId(id);
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiOutPort::SetBufferPool(const std::shared_ptr<WinRTMidiBufferPool>& pool, WinRTMidiOverflowPolicy overflow)
+{
+    std::lock_guard<std::mutex> lock(mSendMutex);
+    mBufferPool = pool;
+    mOverflow = overflow;
+}
+
+WinRTMidiErrorType WinRTMidiOutPort::AcquireBuffer()
+{
+    if (mBuffer != nullptr)
+    {
+        return WINRT_NO_ERROR;
+    }
+
+    if (mBufferPool)
+    {
+        mBuffer = mBufferPool->Acquire();
+    }
+
+    if (mBuffer == nullptr)
+    {
+        // all buffers of the pool are in use
+        if (mOverflow != WINRT_OVERFLOW_GROW)
+        {
+            return WINRT_MEMORY_ERROR;
+        }
+
+        mBuffer = ref new Buffer(mBufferPool ? mBufferPool->GetBufferSize() : kDefaultOutputBufferSize);
+    }
+
+    mBufferData = getIBufferDataPtr(mBuffer);
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiOutPort::ReleaseBuffer()
+{
+    if (mBuffer != nullptr)
+    {
+        if (mBufferPool)
+        {
+            mBufferPool->Release(mBuffer);
+        }
+
+        mBuffer = nullptr;
+        mBufferData = nullptr;
+    }
+}
+
+void WinRTMidiOutPort::ReleaseDevicePort()
+{
+    if (mMidiOutPort != nullptr)
+    {
+        WinRTMidiDevicePorts::ReleaseOutPort(GetId(), mMidiOutPort);
+        mMidiOutPort = nullptr;
+    }
+}
+
+WinRTMidiErrorType WinRTMidiOutPort::OpenBrokerPort(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(mSendMutex);
+    ReleaseDevicePort();
+    SetId(nullptr);
+
+    mBrokerOutput.reset(new WinRTMidiBrokerOutput());
+    WinRTMidiErrorType result = mBrokerOutput->Open(name);
+    if (result != WINRT_NO_ERROR)
+    {
+        mBrokerOutput.reset();
+    }
+
+    return result;
+}
+
+WinRTMidiErrorType WinRTMidiOutPort::OpenNetworkPort(Platform::String^ id, const std::string& host, unsigned short port)
+{
+    std::lock_guard<std::mutex> lock(mSendMutex);
+    ReleaseDevicePort();
+    SetId(nullptr);
+
+    mNetworkSender.reset(new WinRTMidiNetworkSender(GetNetworkConfig()));
+    WinRTMidiErrorType result = mNetworkSender->Start(host, port);
+    if (result != WINRT_NO_ERROR)
+    {
+        mNetworkSender.reset();
+        return result;
+    }
+
+    SetId(id);
+    return WINRT_NO_ERROR;
+}
+
+WinRTMidiErrorType WinRTMidiOutPort::OpenVirtualPort(const std::shared_ptr<WinRTMidiVirtualPort>& port)
+{
+    std::lock_guard<std::mutex> lock(mSendMutex);
+    ReleaseDevicePort();
+    mVirtualPort = port;
+    SetId(port->GetId());
+    return WINRT_NO_ERROR;
+}
+
+bool WinRTMidiOutPort::GetNetworkStats(WinRTMidiNetworkStats& stats)
+{
+    std::lock_guard<std::mutex> lock(mSendMutex);
+    if (!mNetworkSender)
+    {
+        return false;
+    }
+
+    mNetworkSender->GetStats(stats);
+    return true;
+}
+
+void WinRTMidiOutPort::ClosePort(void)
+{
+    std::lock_guard<std::mutex> lock(mSendMutex);
+    ReleaseDevicePort();
+    ReleaseBuffer();
+    mBrokerOutput.reset();
+    mNetworkSender.reset();
+    mVirtualPort = nullptr;
+    SetId(nullptr);
+}
+
+byte* WinRTMidiOutPort::getIBufferDataPtr(IBuffer^ buffer)
+{
+    // Obtain IBufferByteAccess 
+    ComPtr<IBufferByteAccess> pBufferByteAccess;
+    ComPtr<IUnknown> pBuffer((IUnknown*)buffer);
+    pBuffer.As(&pBufferByteAccess);
+
+    // Get pointer to iBuffer bytes 
+    byte* pData;
+    pBufferByteAccess->Buffer(&pData);
+    return pData;
+}
+
+void WinRTMidiOutPort::OnDeviceRemoved()
+{
+    std::lock_guard<std::mutex> lock(mSendMutex);
+    mChannelState.Reset();
+
+    // keeps the id so the port can be reconnected. Network and virtual ports keep working when they are unlisted
+    if (mMidiOutPort != nullptr)
+    {
+        ReleaseDevicePort();
+        OnDisconnected();
+    }
+}
+
+void WinRTMidiOutPort::Reconnect()
+{
+    auto id = GetId();
+    if (id == nullptr)
+    {
+        return;
+    }
+
+    auto devicePort = WinRTMidiDevicePorts::AcquireOutPort(id);
+    if (devicePort == nullptr)
+    {
+        // stays disconnected until the device is added again
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mSendMutex);
+    if (GetId() != id || mMidiOutPort != nullptr)
+    {
+        // closed or reconnected while the device was opened
+        WinRTMidiDevicePorts::ReleaseOutPort(id, devicePort);
+        return;
+    }
+
+    mMidiOutPort = devicePort;
+    OnReconnected();
+}
+
+bool WinRTMidiOutPort::IsOpen()
+{
+    std::lock_guard<std::mutex> lock(mSendMutex);
+    return mMidiOutPort != nullptr || mBrokerOutput || mNetworkSender || mVirtualPort;
+}
+
+bool WinRTMidiOutPort::Send(const unsigned char* message, unsigned int nBytes)
+{
+    std::lock_guard<std::mutex> lock(mSendMutex);
+    if (mMidiOutPort == nullptr && !mBrokerOutput && !mNetworkSender && !mVirtualPort)
+    {
+        return false;
+    }
+
+    mChannelState.Update(message, nBytes);
+
+    if (mBrokerOutput)
+    {
+        mBrokerOutput->Send(message, nBytes);
+        return true;
+    }
+
+    if (mNetworkSender)
+    {
+        mNetworkSender->Send(message, nBytes);
+        return true;
+    }
+
+    if (mVirtualPort)
+    {
+        mVirtualPort->Send(message, nBytes);
+        return true;
+    }
+
+    unsigned int capacity = mBuffer->Capacity;
+    if (nBytes > capacity)
+    {
+        switch (mOverflow)
+        {
+        case WINRT_OVERFLOW_SPLIT:
+            for (unsigned int offset = 0; offset < nBytes; offset += capacity)
+            {
+                SendBuffer(message + offset, std::min(nBytes - offset, capacity));
+            }
+            return true;
+
+        case WINRT_OVERFLOW_DROP_NEWEST:
+            return false;
+
+        default:
+            // the pooled buffer goes back to the pool
+            ReleaseBuffer();
+            mBuffer = ref new Buffer(nBytes);
+            mBufferData = getIBufferDataPtr(mBuffer);
+            break;
+        }
+    }
+
+    SendBuffer(message, nBytes);
+    return true;
+}
+
+void WinRTMidiOutPort::SendBuffer(const unsigned char* message, unsigned int nBytes)
+{
+    memcpy_s(mBufferData, nBytes, message, nBytes);
+    mBuffer->Length = nBytes;
+    mMidiOutPort->SendBuffer(mBuffer);
+}
+
+bool WinRTMidiOutPort::SendRawBuffer(IBuffer^ buffer)
+{
+    std::lock_guard<std::mutex> lock(mSendMutex);
+    if (mBrokerOutput)
+    {
+        return mBrokerOutput->Send(getIBufferDataPtr(buffer), buffer->Length);
+    }
+
+    if (mNetworkSender)
+    {
+        mNetworkSender->Send(getIBufferDataPtr(buffer), buffer->Length);
+        return true;
+    }
+
+    if (mVirtualPort)
+    {
+        return mVirtualPort->Send(getIBufferDataPtr(buffer), buffer->Length);
+    }
+
+    if (mMidiOutPort == nullptr)
+    {
+        return false;
+    }
+
+    mMidiOutPort->SendBuffer(buffer);
+    return true;
+}
+
+void WinRTMidiOutPort::AllNotesOff()
+{
+    WinRTMidiChannelStateSnapshot snapshot;
+    mChannelState.GetSnapshot(snapshot);
+
+    // Send() clears the notes from the channel state
+    WinRTMidiChannelState::GetAllNotesOff(snapshot, [this](const unsigned char* message, unsigned int nBytes)
+    {
+        Send(message, nBytes);
+    });
+}
+
+
+/*****************************************************
+    MidiInPortWrapper
+*****************************************************/
+
+MidiInPortWrapper::~MidiInPortWrapper()
+{
+    {
+        std::lock_guard<std::mutex> lock(mSubscriberMutex);
+        for (auto& subscriber : mSubscribers)
+        {
+            mPort->RemoveListener(subscriber.get());
+        }
+        mSubscribers.clear();
+    }
+    SetUmpCallback(nullptr, WINRT_UMP_MIDI1, 0);
+    SetParameterCallback(nullptr);
+    SetMpeCallback(nullptr);
+    SetSysExCallback(nullptr, 0);
+
+    // no callbacks for this port may be pending once the wrapper is gone
+    mPort->RemoveMidiInCallback();
+    mPort->ClosePort();
+}
+
+WinRTMidiErrorType MidiInPortWrapper::AddSubscriber(WinRTMidiInCallback callback, unsigned int typeMask, unsigned int channelMask, unsigned int queueCapacity, WinRTMidiInSubscriber** subscriber)
+{
+    std::unique_ptr<WinRTMidiInSubscriber> s(new WinRTMidiInSubscriber(callback, typeMask, channelMask, queueCapacity));
+    WinRTMidiErrorType result = s->Start();
+    if (result != WINRT_NO_ERROR)
+    {
+        return result;
+    }
+
+    std::lock_guard<std::mutex> lock(mSubscriberMutex);
+    *subscriber = s.get();
+    mPort->AddListener(s.get());
+    mSubscribers.push_back(std::move(s));
+    return WINRT_NO_ERROR;
+}
+
+WinRTMidiErrorType MidiInPortWrapper::RemoveSubscriber(WinRTMidiInSubscriber* subscriber)
+{
+    std::lock_guard<std::mutex> lock(mSubscriberMutex);
+    for (auto it = mSubscribers.begin(); it != mSubscribers.end(); ++it)
+    {
+        if (it->get() == subscriber)
+        {
+            mPort->RemoveListener(subscriber);
+            mSubscribers.erase(it);
+            return WINRT_NO_ERROR;
+        }
+    }
+
+    return WINRT_INVALID_PARAMETER_ERROR;
+}
+
+
+void MidiInPortWrapper::SetUmpCallback(WinRTMidiUmpCallback callback, WinRTMidiUmpProtocol protocol, unsigned int group)
+{
+    if (mUmpListener)
+    {
+        mPort->RemoveListener(mUmpListener.get());
+        mUmpListener.reset();
+    }
+
+    if (callback)
+    {
+        mUmpListener.reset(new WinRTMidiUmpListener(callback, protocol, group));
+        mPort->AddListener(mUmpListener.get());
+    }
+}
+
+void MidiInPortWrapper::SetParameterCallback(WinRTMidiParameterCallback callback)
+{
+    if (mParameterListener)
+    {
+        mPort->RemoveListener(mParameterListener.get());
+        mParameterListener.reset();
+    }
+
+    if (callback)
+    {
+        mParameterListener.reset(new WinRTMidiParameterListener(callback));
+        mPort->AddListener(mParameterListener.get());
+    }
+}
+
+void MidiInPortWrapper::SetMpeCallback(WinRTMidiMpeCallback callback)
+{
+    if (mMpeListener)
+    {
+        mPort->RemoveListener(mMpeListener.get());
+        mMpeListener.reset();
+    }
+
+    if (callback)
+    {
+        mMpeListener.reset(new WinRTMidiMpeListener(callback));
+        mPort->AddListener(mMpeListener.get());
+    }
+}
+
+void MidiInPortWrapper::SetSysExCallback(WinRTMidiSysExCallback callback, unsigned int maxSize)
+{
+    if (mSysExEnabled)
+    {
+        mPort->RemoveListener(mSysExAssembler.get());
+        mSysExEnabled = false;
+    }
+
+    if (callback)
+    {
+        if (!mSysExAssembler)
+        {
+            mSysExAssembler.reset(new WinRTMidiSysExAssembler());
+        }
+
+        mSysExAssembler->Configure(callback, maxSize > 0 ? maxSize : mPort->GetMaxMessageSize());
+        mPort->AddListener(mSysExAssembler.get());
+        mSysExEnabled = true;
+    }
+}
+
+void MidiInPortWrapper::ReleaseSysEx(const unsigned char* message)
+{
+    if (mSysExAssembler)
+    {
+        mSysExAssembler->Release(message);
+    }
+}
+
+void MidiInPortWrapper::GetSysExStats(WinRTMidiSysExStats& stats)
+{
+    if (mSysExAssembler)
+    {
+        mSysExAssembler->GetStats(stats);
+    }
+    else
+    {
+        memset(&stats, 0, sizeof(stats));
+    }
+}
+
+
+/*****************************************************
+    MidiOutPortWrapper
+*****************************************************/
+
+static void SendDecodedMessage(void* context, const unsigned char* message, unsigned int nBytes)
+{
+    WinRTMidiOutPort^ port = *(WinRTMidiOutPort^*)context;
+    port->Send(message, nBytes);
+}
+
+MidiOutPortWrapper::~MidiOutPortWrapper()
+{
+    // pending coalesced messages are sent before the port is closed
+    mCoalescer.reset();
+    mPort->ClosePort();
+}
+
+bool MidiOutPortWrapper::Send(const unsigned char* message, unsigned int nBytes)
+{
+    auto coalescer = std::atomic_load(&mCoalescer);
+    if (coalescer)
+    {
+        coalescer->Process(0, message, nBytes);
+        return mPort->IsOpen();
+    }
+
+    return mPort->Send(message, nBytes);
+}
+
+WinRTMidiErrorType MidiOutPortWrapper::SetCoalescer(const WinRTMidiCoalescerConfig* config)
+{
+    std::shared_ptr<WinRTMidiCoalescer> coalescer;
+    if (config)
+    {
+        WinRTMidiOutPort^ port = mPort;
+        coalescer = std::make_shared<WinRTMidiCoalescer>(*config, [port](long long time, const unsigned char* message, unsigned int nBytes)
+        {
+            port->Send(message, nBytes);
+        });
+
+        WinRTMidiErrorType result = coalescer->Start();
+        if (result != WINRT_NO_ERROR)
+        {
+            return result;
+        }
+    }
+
+    // a message being sent through the previous coalescer keeps it alive until it is done
+    auto previous = std::atomic_exchange(&mCoalescer, coalescer);
+    if (previous)
+    {
+        previous->Stop();
+    }
+
+    return WINRT_NO_ERROR;
+}
+
+void MidiOutPortWrapper::FlushCoalescer()
+{
+    auto coalescer = std::atomic_load(&mCoalescer);
+    if (coalescer)
+    {
+        coalescer->Flush();
+    }
+}
+
+WinRTMidiErrorType MidiOutPortWrapper::SendUmp(const unsigned int* words, unsigned int nWords)
+{
+    // the decoder keeps partial SysEx data between calls
+    std::lock_guard<std::mutex> lock(mUmpMutex);
+    return mUmpDecoder.Decode(words, nWords, SendDecodedMessage, &mPort) ? WINRT_NO_ERROR : WINRT_INVALID_PARAMETER_ERROR;
+}
@@ -14,12 +14,32 @@
 
 #include "WinRTMidi.h"
 #include "WinRTMidiPortWatcher.h"
+#include "WinRTMidiInputDispatcher.h"
+#include "WinRTMidiInSubscriber.h"
+#include "WinRTMidiUmp.h"
+#include "WinRTMidiParameterDecoder.h"
+#include "WinRTMidiMpe.h"
+#include "WinRTMidiSysExAssembler.h"
+#include "WinRTMidiCoalescer.h"
+#include "WinRTMidiClockTracker.h"
+#include "WinRTMidiChannelState.h"
+#include "WinRTMidiBufferPool.h"
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 #include <Windows.h>
 
 namespace WinRT
 {
+    ref class WinRTMidiOutPort;
+    class WinRTMidiBrokerInput;
+    class WinRTMidiBrokerOutput;
+    class WinRTMidiNetworkReceiver;
+    class WinRTMidiNetworkSender;
+    class WinRTMidiVirtualPort;
+
     ref class WinRTMidiPort abstract
     {
     public:
@@ -34,9 +54,37 @@ namespace WinRT
         const std::string& GetErrorMessage();
         WinRTMidiErrorType GetError();
 
+        // device id of the open port, nullptr if the port is closed or has no device
+        Platform::String^ GetId() { return mId; };
+        void SetId(Platform::String^ id) { mId = id; };
+
+        // called when the device of the port is removed
+        virtual void OnDeviceRemoved() = 0;
+
+        // Reopens the device of the port after it was removed and added again. Blocks while the device is
+        // opened, so it is called on a background thread
+        virtual void Reconnect() = 0;
+
+        bool IsDisconnected();
+        void GetConnectionStats(WinRTMidiConnectionStats& stats);
+
+        // called by the derived ports when their device is removed or reopened
+        void OnDisconnected();
+        void OnReconnected();
+
+        // settings used when OpenPort() opens a network port id
+        void SetNetworkConfig(const WinRTMidiNetworkConfig& config) { mNetworkConfig = config; };
+        const WinRTMidiNetworkConfig& GetNetworkConfig() { return mNetworkConfig; };
+
     private:
         std::string mErrorMessage;
         WinRTMidiErrorType mError;
+        Platform::String^ mId;
+        WinRTMidiNetworkConfig mNetworkConfig;
+
+        std::mutex mConnectionMutex;
+        WinRTMidiConnectionStats mConnectionStats;
+        long long mDisconnectTime;          // microseconds
     };
 
     ref class WinRTMidiInPort sealed : public WinRTMidiPort
@@ -54,17 +102,98 @@ namespace WinRT
         WinRTMidiInPort();
         virtual WinRTMidiErrorType OpenPort(Platform::String^ id) override;
 
+        // opens the port without a device. Messages are only received through ReceiveMessage()
+        WinRTMidiErrorType OpenLoopbackPort();
+
+        // opens the port without a device and receives the messages published by a broker process
+        WinRTMidiErrorType OpenBrokerPort(const std::string& name);
+
+        // receives the messages sent to the out ports of a virtual port pair
+        WinRTMidiErrorType OpenVirtualPort(const std::shared_ptr<WinRTMidiVirtualPort>& port);
+
+        // delivers a message to the listeners and the midi in callback as if it was received by the device.
+        // time is in 100ns units
+        void ReceiveMessage(long long time, const unsigned char* message, unsigned int nBytes);
+
+        // messages not matching typeMask are not passed to the midi in callback
+        void SetFilter(unsigned int typeMask) {
+            mFilterMask = typeMask;
+        };
+
+        // longer messages are dropped before they reach routes, listeners or queues. 0 = no limit
+        void SetMaxMessageSize(unsigned int maxSize) {
+            mMaxMessageSize = maxSize;
+        };
+        unsigned int GetMaxMessageSize() { return mMaxMessageSize; };
+
+        void GetClockState(WinRTMidiClockState& state) {
+            mClockTracker.GetState(state);
+        };
+
+        void GetChannelState(WinRTMidiChannelStateSnapshot& snapshot) {
+            mChannelState.GetSnapshot(snapshot);
+        };
+
+        // messages received by the port are also sent to the routes
+        void AddRoute(WinRTMidiOutPort^ port);
+        void RemoveRoute(WinRTMidiOutPort^ port);
+
+        // releases the active notes on the routes
+        virtual void OnDeviceRemoved() override;
+        virtual void Reconnect() override;
+
+        // coalesces controller messages before they are passed to the midi in callback. nullptr disables
+        WinRTMidiErrorType SetCoalescer(const WinRTMidiCoalescerConfig* config);
+        void FlushCoalescer();
+
         // needs to be internal as MidiInMessageReceivedCallbackType is not a WinRT type
         void SetMidiInCallback(WinRTMidiInCallback callback) {
             mMessageReceivedCallback = callback;
         };
 
+        // callbacks are delivered on the dispatcher thread if set. The port shares the dispatcher
+        // with its instance, so it keeps working if the instance is freed first
+        void SetInputDispatcher(const std::shared_ptr<WinRTMidiInputDispatcher>& dispatcher) {
+            mDispatcher = dispatcher;
+        };
+
+        // listeners receive all messages of the port in addition to the midi in callback
+        void AddListener(WinRTMidiInListener* listener);
+        void RemoveListener(WinRTMidiInListener* listener);
+
+        // returns false if the port is not a network port
+        bool GetNetworkStats(WinRTMidiNetworkStats& stats);
+
     private:
+        WinRTMidiErrorType OpenNetworkPort(Platform::String^ id, const std::string& host, unsigned short port);
         void OnMidiInMessageReceived(Windows::Devices::Midi::MidiInPort^ sender, Windows::Devices::Midi::MidiMessageReceivedEventArgs^ args);
+        void DeliverMessage(long long time, const unsigned char* message, unsigned int nBytes);
+        // called with mDeviceMutex held
+        void ReleaseDevicePort();
+
+        // the device port is replaced by Reconnect() on a background thread
+        std::mutex mDeviceMutex;
         Windows::Devices::Midi::MidiInPort^ mMidiInPort;
+        Windows::Foundation::EventRegistrationToken mMessageReceivedToken;
         long long mLastMessageTime;
         bool mFirstMessage;
         WinRTMidiInCallback mMessageReceivedCallback;
+        std::shared_ptr<WinRTMidiInputDispatcher> mDispatcher;
+        std::shared_ptr<WinRTMidiCoalescer> mCoalescer;
+        std::atomic<unsigned int> mFilterMask;
+        unsigned int mMaxMessageSize;
+        WinRTMidiClockTracker mClockTracker;
+        WinRTMidiChannelState mChannelState;
+
+        std::mutex mRouteMutex;
+        std::vector<WinRTMidiOutPort^> mRoutes;
+
+        std::mutex mListenerMutex;
+        std::vector<WinRTMidiInListener*> mListeners;
+
+        std::unique_ptr<WinRTMidiBrokerInput> mBrokerInput;
+        std::unique_ptr<WinRTMidiNetworkReceiver> mNetworkReceiver;
+        std::shared_ptr<WinRTMidiVirtualPort> mVirtualPort;
     };
 
     ref class WinRTMidiOutPort sealed : public WinRTMidiPort
@@ -77,47 +206,197 @@ namespace WinRT
     internal:
         WinRTMidiOutPort();
         virtual WinRTMidiErrorType OpenPort(Platform::String^ id) override;
-        void Send(const unsigned char* message, unsigned int nBytes);
+
+        // opens the port without a device. Messages are sent to the out port of a broker process
+        WinRTMidiErrorType OpenBrokerPort(const std::string& name);
+
+        // sends to the in ports of a virtual port pair
+        WinRTMidiErrorType OpenVirtualPort(const std::shared_ptr<WinRTMidiVirtualPort>& port);
+
+        // OpenPort() takes the send buffer of a device from the pool. overflow is WINRT_OVERFLOW_GROW,
+        // WINRT_OVERFLOW_SPLIT or WINRT_OVERFLOW_DROP_NEWEST
+        void SetBufferPool(const std::shared_ptr<WinRTMidiBufferPool>& pool, WinRTMidiOverflowPolicy overflow);
+
+        // returns false if the port is closed, its device was removed or the message was dropped (see SetBufferPool)
+        bool Send(const unsigned char* message, unsigned int nBytes);
+        bool IsOpen();
+
+        void GetChannelState(WinRTMidiChannelStateSnapshot& snapshot) {
+            mChannelState.GetSnapshot(snapshot);
+        };
+
+        // sends note offs for the notes that are still on
+        void AllNotesOff();
+
+        // sends the bytes of a buffer as they are (e.g. a chunk of a SysEx message).
+        // Returns false if the port is closed
+        bool SendRawBuffer(Windows::Storage::Streams::IBuffer^ buffer);
+
+        static byte* getIBufferDataPtr(Windows::Storage::Streams::IBuffer^ buffer);
+
+        // closes the device port; the notes can no longer be released
+        virtual void OnDeviceRemoved() override;
+        virtual void Reconnect() override;
+
+        // returns false if the port is not a network port
+        bool GetNetworkStats(WinRTMidiNetworkStats& stats);
 
     private:
-        byte* getIBufferDataPtr(Windows::Storage::Streams::IBuffer^ buffer);
+        WinRTMidiErrorType OpenNetworkPort(Platform::String^ id, const std::string& host, unsigned short port);
+
+        // called with mSendMutex held
+        void ReleaseDevicePort();
+        WinRTMidiErrorType AcquireBuffer();
+        void ReleaseBuffer();
+        void SendBuffer(const unsigned char* message, unsigned int nBytes);
 
         Windows::Devices::Midi::IMidiOutPort^ mMidiOutPort;
         Windows::Storage::Streams::IBuffer^ mBuffer;
         byte* mBufferData;
+        std::shared_ptr<WinRTMidiBufferPool> mBufferPool;
+        WinRTMidiOverflowPolicy mOverflow;
+
+        // ports can be used by the client and by player threads
+        std::mutex mSendMutex;
+        WinRTMidiChannelState mChannelState;
+        std::unique_ptr<WinRTMidiBrokerOutput> mBrokerOutput;
+        std::unique_ptr<WinRTMidiNetworkSender> mNetworkSender;
+        std::shared_ptr<WinRTMidiVirtualPort> mVirtualPort;
     };
 
+    #define kDefaultMaxPorts 64
+    #define kMaxDispatcherThreads 16
+
     class WinRTMidi
     {
     public:
-        WinRTMidi(MidiPortChangedCallback callback);
+        // config must be resolved with GetConfig()
+        WinRTMidi(MidiPortChangedCallback callback, const WinRTMidiConfig& config);
+        ~WinRTMidi();
+
+        // replaces the fields of config that are 0 with the defaults. Returns WINRT_INVALID_PARAMETER_ERROR for invalid settings
+        static WinRTMidiErrorType GetConfig(const WinRTMidiConfig* config, WinRTMidiConfig& resolved);
+
+        // shares the port watchers of the process and allocates the buffers and threads of the config
         WinRTMidiErrorType Initialize();
 
         WinRTMidiPortWatcher^ GetPortWatcher(WinRTMidiPortType type);
         WinRTMidiPortWatcherPtr GetPortWatcherWrapper(WinRTMidiPortType type);
         Platform::String^ getPortId(WinRTMidiPortType type, unsigned int index);
 
+        // starts one dispatcher thread if there is none, otherwise updates the settings of all of them
+        WinRTMidiErrorType EnableInputDispatcher(const WinRTMidiDispatcherConfig& config);
+
+        // dispatcher settings of the config
+        const WinRTMidiDispatcherConfig& GetDispatcherConfig() { return mConfig.dispatcher; };
+
+        // returns false if there are no dispatcher threads. The statistics of all threads are combined
+        bool GetInputDispatcherStats(WinRTMidiDispatcherStats& stats);
+
+        // applies the dispatcher threads (in turn), buffer pool and size limits of the instance to a new port
+        void ConfigurePort(WinRTMidiInPort^ port);
+        void ConfigurePort(WinRTMidiOutPort^ port);
+
+        // Network ports are listed by the port watcher of their type, which is shared by the instances of the process.
+        // An instance can only remove the ports it added, and the rest are removed when it is freed.
+        WinRTMidiErrorType AddNetworkPort(WinRTMidiPortType type, const std::string& name, const std::string& host, unsigned short port);
+        WinRTMidiErrorType RemoveNetworkPort(WinRTMidiPortType type, const std::string& host, unsigned short port);
+        void SetNetworkConfig(const WinRTMidiNetworkConfig& config) { mNetworkConfig = config; };
+        const WinRTMidiNetworkConfig& GetNetworkConfig() { return mNetworkConfig; };
+
+        // open ports reopen their device when it is added again
+        void SetAutoReconnect(bool enable) { mAutoReconnect = enable; };
+
+        // Virtual port pairs are listed by both port watchers, so every instance of the process can open them.
+        // The pairs created by an instance are removed when it is freed.
+        WinRTMidiErrorType CreateVirtualPortPair(const std::string& name, std::shared_ptr<WinRTMidiVirtualPort>& port);
+        WinRTMidiErrorType RemoveVirtualPortPair(const std::string& name);
+
+        // returns nullptr if id is not the id of a virtual port pair
+        std::shared_ptr<WinRTMidiVirtualPort> GetVirtualPort(Platform::String^ id);
+
+        // open ports are notified when their device is removed
+        void AddOpenPort(WinRTMidiPort^ port);
+
     private:
+        void OnPortIdChanged(Platform::String^ id, WinRTMidiPortUpdateType update);
+        void ReconnectPorts(Platform::String^ id);
+        bool RemoveNetworkPortEntry(WinRTMidiPortType type, Platform::String^ id);
+
+        std::mutex mOpenPortMutex;
+        std::vector<Platform::WeakReference> mOpenPorts;
+        std::atomic<bool> mAutoReconnect;
 
+        MidiPortChangedCallback mCallback;
+        std::shared_ptr<WinRTMidiPortWatchers> mPortWatchers;
         WinRTMidiPortWatcher^ mMidiInPortWatcher;
         WinRTMidiPortWatcher^ mMidiOutPortWatcher;
         std::shared_ptr<MidiPortWatcherWrapper> mMidiInPortWatcherWrapper;
         std::shared_ptr<MidiPortWatcherWrapper> mMidiOutPortWatcherWrapper;
+        WinRTMidiConfig mConfig;
+        std::shared_ptr<WinRTMidiBufferPool> mBufferPool;
+        std::vector<std::shared_ptr<WinRTMidiInputDispatcher>> mInputDispatchers;
+        std::atomic<unsigned int> mNextDispatcher;
+        WinRTMidiNetworkConfig mNetworkConfig;
+
+        struct VirtualPortEntry
+        {
+            WinRTMidi* owner;
+            std::shared_ptr<WinRTMidiVirtualPort> port;
+        };
+
+        static std::mutex sVirtualPortMutex;
+        static std::vector<VirtualPortEntry> sVirtualPorts;
+
+        struct NetworkPortEntry
+        {
+            WinRTMidi* owner;
+            WinRTMidiPortType type;
+            Platform::String^ id;
+        };
+
+        static std::mutex sNetworkPortMutex;
+        static std::vector<NetworkPortEntry> sNetworkPorts;
     };
 
+    #define kMaxOpenInPorts 256
+    #define kMaxOpenOutPorts 256
+
     class MidiInPortWrapper
     {
     public:
         MidiInPortWrapper(WinRTMidiInPort^ port, WinRTMidiInCallback callback)
             : mPort(port)
+            , mSysExEnabled(false)
         {
             mPort->SetMidiInCallback(callback);
         }
 
+        ~MidiInPortWrapper();
+
         WinRTMidiInPort^ getPort() { return mPort; };
 
+        WinRTMidiErrorType AddSubscriber(WinRTMidiInCallback callback, unsigned int typeMask, unsigned int channelMask, unsigned int queueCapacity, WinRTMidiInSubscriber** subscriber);
+        WinRTMidiErrorType RemoveSubscriber(WinRTMidiInSubscriber* subscriber);
+
+        void SetUmpCallback(WinRTMidiUmpCallback callback, WinRTMidiUmpProtocol protocol, unsigned int group);
+        void SetParameterCallback(WinRTMidiParameterCallback callback);
+        void SetMpeCallback(WinRTMidiMpeCallback callback);
+        void SetSysExCallback(WinRTMidiSysExCallback callback, unsigned int maxSize);
+        void ReleaseSysEx(const unsigned char* message);
+        void GetSysExStats(WinRTMidiSysExStats& stats);
+
     private:
         WinRTMidiInPort^ mPort;
+        std::vector<std::unique_ptr<WinRTMidiInSubscriber>> mSubscribers;
+        std::mutex mSubscriberMutex;
+        std::unique_ptr<WinRTMidiUmpListener> mUmpListener;
+        std::unique_ptr<WinRTMidiParameterListener> mParameterListener;
+        std::unique_ptr<WinRTMidiMpeListener> mMpeListener;
+
+        // kept until the wrapper is freed so released messages can return to its pool
+        std::unique_ptr<WinRTMidiSysExAssembler> mSysExAssembler;
+        bool mSysExEnabled;
     };
 
     class MidiOutPortWrapper
@@ -127,10 +406,22 @@ namespace WinRT
             : mPort(port)
         {}
 
+        ~MidiOutPortWrapper();
+
         WinRTMidiOutPort^ getPort() { return mPort; };
 
+        // returns false if the port is closed
+        bool Send(const unsigned char* message, unsigned int nBytes);
+        WinRTMidiErrorType SendUmp(const unsigned int* words, unsigned int nWords);
+
+        WinRTMidiErrorType SetCoalescer(const WinRTMidiCoalescerConfig* config);
+        void FlushCoalescer();
+
     private:
         WinRTMidiOutPort^ mPort;
+        WinRTMidiUmpDecoder mUmpDecoder;
+        std::mutex mUmpMutex;
+        std::shared_ptr<WinRTMidiCoalescer> mCoalescer;
     };
 };
 
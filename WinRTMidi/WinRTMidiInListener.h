@@ -0,0 +1,28 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+
+#pragma once
+
+#include "WinRTMidi.h"
+
+namespace WinRT
+{
+    // Receives every message of a midi in port on the thread that raised MessageReceived.
+    // Implementations must not block.
+    class WinRTMidiInListener
+    {
+    public:
+        virtual ~WinRTMidiInListener() {};
+        virtual void OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes) = 0;
+    };
+};
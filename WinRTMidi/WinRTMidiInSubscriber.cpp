@@ -0,0 +1,60 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiInSubscriber.h"
+
+using namespace WinRT;
+
+WinRTMidiInSubscriber::WinRTMidiInSubscriber(WinRTMidiInCallback callback, unsigned int typeMask, unsigned int channelMask, unsigned int queueCapacity)
+    : WinRTMidiMessageWorker(queueCapacity > 0 ? queueCapacity : kDefaultSubscriberQueueCapacity)
+    , mCallback(callback)
+    , mTypeMask(typeMask)
+    , mChannelMask(channelMask)
+    , mLastMessageTime(0)
+    , mFirstMessage(true)
+{
+}
+
+WinRTMidiInSubscriber::~WinRTMidiInSubscriber()
+{
+    Stop();
+}
+
+void WinRTMidiInSubscriber::OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes)
+{
+    if (MidiMessageMatchesFilter(message, nBytes, mTypeMask, mChannelMask))
+    {
+        Enqueue(mCallback, port, time, 0.0, message, nBytes);
+    }
+}
+
+void WinRTMidiInSubscriber::Process(const WinRTMidiQueuedMessage& message)
+{
+    // timestamps are relative to the previous message this subscriber received
+    if (mFirstMessage)
+    {
+        mFirstMessage = false;
+        mLastMessageTime = message.time;
+    }
+
+    double timestamp = (message.time - mLastMessageTime) * .0001;
+    mLastMessageTime = message.time;
+    mCallback(message.port, timestamp, message.GetData(), message.nBytes);
+}
+
+void WinRTMidiInSubscriber::GetStats(WinRTMidiSubscriberStats& stats)
+{
+    stats.messagesDelivered = GetProcessedCount();
+    stats.messagesDropped = GetDroppedCount();
+    stats.averageQueueDelay = GetAverageQueueDelay();
+    stats.maxQueueDelay = GetMaxQueueDelay();
+}
@@ -0,0 +1,50 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiInListener.h"
+#include "WinRTMidiMessageWorker.h"
+
+namespace WinRT
+{
+    #define kDefaultSubscriberQueueCapacity 1024
+
+    /**********************************************************************************
+    Additional consumer of an open midi in port. Each subscriber has its own
+    filter, bounded queue and delivery thread so a slow subscriber only drops
+    its own messages and never delays the port or the other subscribers.
+    **********************************************************************************/
+    class WinRTMidiInSubscriber : public WinRTMidiInListener, public WinRTMidiMessageWorker
+    {
+    public:
+        WinRTMidiInSubscriber(WinRTMidiInCallback callback, unsigned int typeMask, unsigned int channelMask, unsigned int queueCapacity);
+        virtual ~WinRTMidiInSubscriber();
+
+        virtual void OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes) override;
+
+        void GetStats(WinRTMidiSubscriberStats& stats);
+
+    protected:
+        virtual void Process(const WinRTMidiQueuedMessage& message) override;
+
+    private:
+        WinRTMidiInCallback mCallback;
+        unsigned int mTypeMask;
+        unsigned int mChannelMask;
+
+        // only accessed on the delivery thread
+        long long mLastMessageTime;
+        bool mFirstMessage;
+    };
+};
@@ -0,0 +1,60 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiInputDispatcher.h"
+
+using namespace WinRT;
+
+WinRTMidiInputDispatcher::WinRTMidiInputDispatcher(const WinRTMidiDispatcherConfig& config)
+    : WinRTMidiMessageWorker(config.queueCapacity > 0 ? config.queueCapacity : kDefaultDispatcherQueueCapacity)
+    , mConfig(config)
+{
+}
+
+WinRTMidiInputDispatcher::~WinRTMidiInputDispatcher()
+{
+    Stop();
+}
+
+WinRTMidiErrorType WinRTMidiInputDispatcher::Start()
+{
+    WinRTMidiErrorType result = WinRTMidiMessageWorker::Start();
+    if (result == WINRT_NO_ERROR)
+    {
+        result = SetThreadSettings(mConfig.threadPriority, mConfig.affinityMask);
+    }
+
+    return result;
+}
+
+WinRTMidiErrorType WinRTMidiInputDispatcher::Configure(const WinRTMidiDispatcherConfig& config)
+{
+    mConfig.threadPriority = config.threadPriority;
+    mConfig.affinityMask = config.affinityMask;
+    return SetThreadSettings(mConfig.threadPriority, mConfig.affinityMask);
+}
+
+void WinRTMidiInputDispatcher::GetStats(WinRTMidiDispatcherStats& stats)
+{
+    stats.messagesDispatched = GetProcessedCount();
+    stats.messagesDropped = GetDroppedCount();
+    stats.averageQueueDelay = GetAverageQueueDelay();
+    stats.maxQueueDelay = GetMaxQueueDelay();
+}
+
+void WinRTMidiInputDispatcher::Process(const WinRTMidiQueuedMessage& message)
+{
+    if (message.callback)
+    {
+        message.callback(message.port, message.timestamp, message.GetData(), message.nBytes);
+    }
+}
@@ -0,0 +1,48 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiMessageWorker.h"
+
+namespace WinRT
+{
+    #define kDefaultDispatcherQueueCapacity 4096
+
+    /**********************************************************************************
+    Delivers MIDI input callbacks on a single dedicated thread instead of the
+    thread pool thread that raised MidiInPort::MessageReceived. Messages are
+    handed over through a lock-free queue; the dispatcher thread only sleeps
+    when the queue is empty. The time each message spends in the queue is
+    measured so the scheduling behavior can be verified.
+    **********************************************************************************/
+    class WinRTMidiInputDispatcher : public WinRTMidiMessageWorker
+    {
+    public:
+        WinRTMidiInputDispatcher(const WinRTMidiDispatcherConfig& config);
+        virtual ~WinRTMidiInputDispatcher();
+
+        WinRTMidiErrorType Start();
+
+        // Priority and affinity can be changed while the dispatcher is running
+        WinRTMidiErrorType Configure(const WinRTMidiDispatcherConfig& config);
+
+        void GetStats(WinRTMidiDispatcherStats& stats);
+
+    protected:
+        virtual void Process(const WinRTMidiQueuedMessage& message) override;
+
+    private:
+        WinRTMidiDispatcherConfig mConfig;
+    };
+};
@@ -0,0 +1,261 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiMerge.h"
+#include "WinRTMidiTime.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace WinRT;
+
+WinRTMidiMerge::WinRTMidiMerge(const std::vector<WinRTMidiInPort^>& ports, WinRTMidiMergeCallback callback, double reorderWindow, unsigned int queueCapacity)
+    : mPorts(ports)
+    , mCallback(callback)
+    , mReorderWindow((long long)(reorderWindow * 1000.0))
+    , mLastDeliveredTime(LLONG_MIN)
+    , mFirstMessage(true)
+    , mWakeEvent(NULL)
+    , mRunning(false)
+    , mWaiting(false)
+    , mMerged(0)
+    , mLate(0)
+    , mDropped(0)
+{
+    for (size_t i = 0; i < ports.size(); i++)
+    {
+        mInputs.emplace_back(new Input(queueCapacity > 0 ? queueCapacity : kDefaultMergeQueueCapacity));
+    }
+}
+
+WinRTMidiMerge::~WinRTMidiMerge()
+{
+    Stop();
+
+    for (auto& input : mInputs)
+    {
+        WinRTMidiQueuedMessage message;
+        while (input->queue.Pop(message))
+        {
+            delete[] message.heapData;
+        }
+
+        if (input->hasHead)
+        {
+            delete[] input->head.heapData;
+        }
+    }
+}
+
+WinRTMidiErrorType WinRTMidiMerge::Start()
+{
+    if (mPorts.empty() || mPorts.size() > kMergeMaxPorts || mCallback == nullptr || mReorderWindow < 0)
+    {
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    mWakeEvent = CreateEventEx(NULL, NULL, 0, EVENT_ALL_ACCESS);
+    if (mWakeEvent == NULL)
+    {
+        return WINRT_MEMORY_ERROR;
+    }
+
+    mTimer.Reset();
+    mRunning = true;
+    mThread = std::thread(&WinRTMidiMerge::Run, this);
+
+    for (auto port : mPorts)
+    {
+        port->AddListener(this);
+    }
+
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiMerge::Stop()
+{
+    for (auto port : mPorts)
+    {
+        port->RemoveListener(this);
+    }
+
+    if (mRunning.exchange(false))
+    {
+        SetEvent(mWakeEvent);
+        mTimer.Cancel();
+        mThread.join();
+    }
+
+    if (mWakeEvent != NULL)
+    {
+        CloseHandle(mWakeEvent);
+        mWakeEvent = NULL;
+    }
+}
+
+void WinRTMidiMerge::GetStats(WinRTMidiMergeStats& stats)
+{
+    stats.messagesMerged = mMerged.load();
+    stats.messagesLate = mLate.load();
+    stats.messagesDropped = mDropped.load();
+}
+
+int WinRTMidiMerge::GetPortIndex(WinRTMidiInPortPtr port)
+{
+    for (unsigned int i = 0; i < mPorts.size(); i++)
+    {
+        if ((WinRTMidiInPortPtr)mPorts[i] == port)
+        {
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+void WinRTMidiMerge::OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes)
+{
+    int index = GetPortIndex(port);
+    if (index < 0)
+    {
+        return;
+    }
+
+    Input& input = *mInputs[index];
+
+    // device timestamps are in 100ns units relative to the creation of the port
+    long long micros = time / 10;
+    if (input.offset == LLONG_MIN)
+    {
+        input.offset = GetTimeMicroseconds() - micros;
+    }
+
+    WinRTMidiQueuedMessage item;
+    item.callback = nullptr;
+    item.port = port;
+    item.time = std::max(micros + input.offset, input.lastTime);
+    item.timestamp = 0.0;
+    item.enqueueTime = 0;
+    item.nBytes = nBytes;
+    item.heapData = nullptr;
+    input.lastTime = item.time;
+
+    if (nBytes <= kMidiInlineBytes)
+    {
+        memcpy(item.inlineData, message, nBytes);
+    }
+    else
+    {
+        item.heapData = new unsigned char[nBytes];
+        memcpy(item.heapData, message, nBytes);
+    }
+
+    if (!input.queue.Push(item))
+    {
+        delete[] item.heapData;
+        mDropped++;
+        return;
+    }
+
+    // only signal the event if the merge thread is (about to go) asleep
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mWaiting.exchange(false))
+    {
+        SetEvent(mWakeEvent);
+    }
+}
+
+void WinRTMidiMerge::Deliver(unsigned int source, WinRTMidiQueuedMessage& message)
+{
+    long long time = message.time;
+    if (time < mLastDeliveredTime)
+    {
+        // arrived after the reorder window
+        mLate++;
+        time = mLastDeliveredTime;
+    }
+
+    if (mFirstMessage)
+    {
+        mFirstMessage = false;
+        mLastDeliveredTime = time;
+    }
+
+    double timestamp = (time - mLastDeliveredTime) * .001;
+    mLastDeliveredTime = time;
+
+    mCallback((WinRTMidiMergePtr)this, timestamp, source, message.GetData(), message.nBytes);
+    delete[] message.heapData;
+    message.heapData = nullptr;
+    mMerged++;
+}
+
+void WinRTMidiMerge::Run()
+{
+    while (mRunning)
+    {
+        // refill the heads and find the oldest message
+        int oldest = -1;
+        for (unsigned int i = 0; i < mInputs.size(); i++)
+        {
+            Input& input = *mInputs[i];
+            if (!input.hasHead)
+            {
+                input.hasHead = input.queue.Pop(input.head);
+            }
+
+            if (input.hasHead && (oldest < 0 || input.head.time < mInputs[oldest]->head.time))
+            {
+                oldest = (int)i;
+            }
+        }
+
+        if (oldest >= 0)
+        {
+            Input& input = *mInputs[oldest];
+            long long due = input.head.time + mReorderWindow;
+            if (GetTimeMicroseconds() >= due)
+            {
+                input.hasHead = false;
+                Deliver(oldest, input.head);
+            }
+            else
+            {
+                // the heads are refilled and compared again after the wait, so a
+                // message with an earlier timestamp queued in the meantime goes first
+                mTimer.WaitUntil(due);
+            }
+            continue;
+        }
+
+        // announce that we are going to sleep. A message queued in between
+        // sets the event, so the wait returns immediately
+        mWaiting = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool queued = false;
+        for (auto& input : mInputs)
+        {
+            if (!input->hasHead)
+            {
+                input->hasHead = input->queue.Pop(input->head);
+                queued |= input->hasHead;
+            }
+        }
+
+        if (queued)
+        {
+            mWaiting = false;
+            continue;
+        }
+
+        WaitForSingleObjectEx(mWakeEvent, INFINITE, FALSE);
+    }
+}
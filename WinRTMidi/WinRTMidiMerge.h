@@ -0,0 +1,97 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiImpl.h"
+#include "WinRTMidiMessage.h"
+#include "WinRTMidiQueue.h"
+#include "WinRTMidiTimer.h"
+#include <atomic>
+#include <climits>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <Windows.h>
+
+namespace WinRT
+{
+    #define kMergeMaxPorts 16
+    #define kDefaultMergeQueueCapacity 1024
+
+    /**********************************************************************************
+    Merges the messages of several midi in ports into one stream ordered by
+    timestamp.
+
+    Each port has its own lock-free queue, filled on the port's
+    MessageReceived thread. The merge thread keeps the oldest message of each
+    queue and repeatedly delivers the oldest of those (a k-way merge). A
+    message is only delivered once it is older than the reorder window, so a
+    message of another port with an earlier timestamp that arrives within the
+    window is still delivered first. The merge thread waits for the next due
+    message on the high resolution timer and only sleeps on an event while
+    all queues are empty. Device timestamps are aligned to a common
+    clock with the offset observed at the first message of each port.
+    **********************************************************************************/
+    class WinRTMidiMerge : public WinRTMidiInListener
+    {
+    public:
+        WinRTMidiMerge(const std::vector<WinRTMidiInPort^>& ports, WinRTMidiMergeCallback callback, double reorderWindow, unsigned int queueCapacity);
+        virtual ~WinRTMidiMerge();
+
+        WinRTMidiErrorType Start();
+        void Stop();
+
+        virtual void OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes) override;
+
+        void GetStats(WinRTMidiMergeStats& stats);
+
+    private:
+        struct Input
+        {
+            Input(unsigned int queueCapacity)
+                : queue(queueCapacity)
+                , offset(LLONG_MIN)
+                , lastTime(LLONG_MIN)
+                , hasHead(false)
+            {}
+
+            WinRTMidiQueue<WinRTMidiQueuedMessage> queue;
+            long long offset;               // MessageReceived thread only
+            long long lastTime;
+            WinRTMidiQueuedMessage head;    // merge thread only
+            bool hasHead;
+        };
+
+        void Run();
+        void Deliver(unsigned int source, WinRTMidiQueuedMessage& message);
+        int GetPortIndex(WinRTMidiInPortPtr port);
+
+        std::vector<WinRTMidiInPort^> mPorts;
+        std::vector<std::unique_ptr<Input>> mInputs;
+        WinRTMidiMergeCallback mCallback;
+        long long mReorderWindow;           // microseconds
+        long long mLastDeliveredTime;
+        bool mFirstMessage;
+
+        std::thread mThread;
+        WinRTMidiTimer mTimer;
+        HANDLE mWakeEvent;
+        std::atomic<bool> mRunning;
+        std::atomic<bool> mWaiting;
+
+        std::atomic<unsigned long long> mMerged;
+        std::atomic<unsigned long long> mLate;
+        std::atomic<unsigned long long> mDropped;
+    };
+};
@@ -0,0 +1,100 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+
+namespace WinRT
+{
+    #define kMidiInlineBytes 16
+
+    // MIDI message copied into a queue. Messages larger than kMidiInlineBytes
+    // are copied to the heap and freed by the consumer.
+    struct WinRTMidiQueuedMessage
+    {
+        WinRTMidiInCallback callback;
+        WinRTMidiInPortPtr port;
+        long long time;             // port timestamp in 100ns units
+        double timestamp;           // milliseconds since the previous message of the port
+        long long enqueueTime;      // microseconds
+        unsigned int nBytes;
+        unsigned char* heapData;
+        unsigned char inlineData[kMidiInlineBytes];
+
+        const unsigned char* GetData() const {
+            return heapData ? heapData : inlineData;
+        };
+    };
+
+    // Returns the WinRTMidiMessageTypeMask bit of a MIDI message.
+    // Data bytes without a status byte are SysEx continuation fragments.
+    inline unsigned int GetMidiMessageType(const unsigned char* message, unsigned int nBytes)
+    {
+        if (nBytes == 0)
+        {
+            return 0;
+        }
+
+        unsigned char status = message[0];
+        if (status < 0x80)
+        {
+            return WINRT_MIDI_SYSEX;
+        }
+
+        if (status < 0xF0)
+        {
+            return 1u << ((status >> 4) - 8);
+        }
+
+        switch (status)
+        {
+        case 0xF0:
+        case 0xF7:
+            return WINRT_MIDI_SYSEX;
+        case 0xF1:
+        case 0xF2:
+        case 0xF3:
+        case 0xF6:
+            return WINRT_MIDI_SYSTEM_COMMON;
+        case 0xF8:
+            return WINRT_MIDI_CLOCK;
+        case 0xFA:
+        case 0xFB:
+        case 0xFC:
+            return WINRT_MIDI_TRANSPORT;
+        case 0xFE:
+            return WINRT_MIDI_ACTIVE_SENSING;
+        case 0xFF:
+            return WINRT_MIDI_RESET;
+        default:
+            return WINRT_MIDI_UNDEFINED;
+        }
+    }
+
+    // channelMask bit n selects MIDI channel n + 1. It only applies to channel messages.
+    inline bool MidiMessageMatchesFilter(const unsigned char* message, unsigned int nBytes, unsigned int typeMask, unsigned int channelMask)
+    {
+        unsigned int type = GetMidiMessageType(message, nBytes);
+        if ((type & typeMask) == 0)
+        {
+            return false;
+        }
+
+        if (type & WINRT_MIDI_CHANNEL_MESSAGES)
+        {
+            return (channelMask & (1u << (message[0] & 0x0F))) != 0;
+        }
+
+        return true;
+    }
+};
@@ -0,0 +1,212 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiMessageWorker.h"
+#include "WinRTMidiTime.h"
+
+using namespace WinRT;
+
+WinRTMidiMessageWorker::WinRTMidiMessageWorker(unsigned int queueCapacity)
+    : mQueue(queueCapacity)
+    , mThreadId(0)
+    , mWakeEvent(NULL)
+    , mRunning(false)
+    , mWaiting(false)
+    , mOverflow(WINRT_OVERFLOW_DROP_NEWEST)
+    , mEnqueued(0)
+    , mProcessed(0)
+    , mDropped(0)
+    , mEvicted(0)
+    , mTotalDelay(0)
+    , mMaxDelay(0)
+{
+}
+
+WinRTMidiMessageWorker::~WinRTMidiMessageWorker()
+{
+    Stop();
+
+    // free any heap copies still in the queue
+    WinRTMidiQueuedMessage message;
+    while (mQueue.Pop(message))
+    {
+        delete[] message.heapData;
+    }
+}
+
+WinRTMidiErrorType WinRTMidiMessageWorker::Start()
+{
+    mWakeEvent = CreateEventEx(NULL, NULL, 0, EVENT_ALL_ACCESS);
+    if (mWakeEvent == NULL)
+    {
+        return WINRT_MEMORY_ERROR;
+    }
+
+    mRunning = true;
+    mThread = std::thread(&WinRTMidiMessageWorker::Run, this);
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiMessageWorker::Stop()
+{
+    if (mRunning.exchange(false))
+    {
+        SetEvent(mWakeEvent);
+        mThread.join();
+    }
+
+    if (mWakeEvent != NULL)
+    {
+        CloseHandle(mWakeEvent);
+        mWakeEvent = NULL;
+    }
+}
+
+WinRTMidiErrorType WinRTMidiMessageWorker::SetThreadSettings(int priority, unsigned long long affinityMask)
+{
+    HANDLE thread = mThread.native_handle();
+
+    if (!SetThreadPriority(thread, priority))
+    {
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    if (affinityMask != 0 && SetThreadAffinityMask(thread, (DWORD_PTR)affinityMask) == 0)
+    {
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    return WINRT_NO_ERROR;
+}
+
+bool WinRTMidiMessageWorker::Enqueue(WinRTMidiInCallback callback, WinRTMidiInPortPtr port, long long time, double timestamp, const unsigned char* message, unsigned int nBytes)
+{
+    WinRTMidiQueuedMessage item;
+    item.callback = callback;
+    item.port = port;
+    item.time = time;
+    item.timestamp = timestamp;
+    item.nBytes = nBytes;
+    item.heapData = nullptr;
+
+    if (nBytes <= kMidiInlineBytes)
+    {
+        memcpy(item.inlineData, message, nBytes);
+    }
+    else
+    {
+        item.heapData = new unsigned char[nBytes];
+        memcpy(item.heapData, message, nBytes);
+    }
+
+    item.enqueueTime = GetTimeMicroseconds();
+    bool queued = mQueue.Push(item);
+    if (!queued && mOverflow == WINRT_OVERFLOW_DROP_OLDEST)
+    {
+        // the queue supports several consumers, so the producer can take the oldest message itself
+        WinRTMidiQueuedMessage oldest;
+        if (mQueue.Pop(oldest))
+        {
+            delete[] oldest.heapData;
+            mEvicted++;
+            mDropped++;
+        }
+
+        queued = mQueue.Push(item);
+    }
+
+    if (!queued)
+    {
+        delete[] item.heapData;
+        mDropped++;
+        return false;
+    }
+
+    mEnqueued++;
+
+    // only signal the event if the worker thread is (about to go) asleep
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mWaiting.exchange(false))
+    {
+        SetEvent(mWakeEvent);
+    }
+
+    return true;
+}
+
+void WinRTMidiMessageWorker::Drain()
+{
+    // a callback freeing its own port must not wait on itself
+    if (GetCurrentThreadId() == mThreadId)
+    {
+        return;
+    }
+
+    unsigned long long target = mEnqueued.load();
+    while (mRunning && mProcessed.load() + mEvicted.load() < target)
+    {
+        Sleep(1);
+    }
+}
+
+double WinRTMidiMessageWorker::GetAverageQueueDelay()
+{
+    unsigned long long processed = mProcessed.load();
+    return processed > 0 ? (mTotalDelay.load() / (double)processed) * .001 : 0.0;
+}
+
+double WinRTMidiMessageWorker::GetMaxQueueDelay()
+{
+    return mMaxDelay.load() * .001;
+}
+
+void WinRTMidiMessageWorker::ProcessMessage(WinRTMidiQueuedMessage& message)
+{
+    long long delay = GetTimeMicroseconds() - message.enqueueTime;
+    mTotalDelay.fetch_add(delay, std::memory_order_relaxed);
+    if (delay > mMaxDelay.load(std::memory_order_relaxed))
+    {
+        mMaxDelay.store(delay, std::memory_order_relaxed);
+    }
+
+    Process(message);
+    delete[] message.heapData;
+    mProcessed++;
+}
+
+void WinRTMidiMessageWorker::Run()
+{
+    mThreadId = GetCurrentThreadId();
+    WinRTMidiQueuedMessage message;
+
+    while (mRunning)
+    {
+        if (mQueue.Pop(message))
+        {
+            ProcessMessage(message);
+            continue;
+        }
+
+        // announce that we are going to sleep, then check the queue once more
+        // so a message pushed in between is not missed
+        mWaiting = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (mQueue.Pop(message))
+        {
+            mWaiting = false;
+            ProcessMessage(message);
+            continue;
+        }
+
+        WaitForSingleObjectEx(mWakeEvent, INFINITE, FALSE);
+    }
+}
@@ -0,0 +1,84 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiMessage.h"
+#include "WinRTMidiQueue.h"
+#include <atomic>
+#include <thread>
+#include <Windows.h>
+
+namespace WinRT
+{
+    /**********************************************************************************
+    Thread that consumes MIDI messages from a bounded lock-free queue. Producers
+    never block: when the queue is full Enqueue() drops the new message, or the
+    oldest queued one with WINRT_OVERFLOW_DROP_OLDEST, and counts it. The
+    worker thread only sleeps when the queue is empty. The time each message
+    spends in the queue is measured.
+
+    Derived classes implement Process() and must call Stop() in their destructor.
+    **********************************************************************************/
+    class WinRTMidiMessageWorker
+    {
+    public:
+        WinRTMidiMessageWorker(unsigned int queueCapacity);
+        virtual ~WinRTMidiMessageWorker();
+
+        WinRTMidiErrorType Start();
+        void Stop();
+
+        WinRTMidiErrorType SetThreadSettings(int priority, unsigned long long affinityMask);
+
+        // WINRT_OVERFLOW_DROP_NEWEST (default) or WINRT_OVERFLOW_DROP_OLDEST. Set before Start()
+        void SetOverflowPolicy(WinRTMidiOverflowPolicy policy) { mOverflow = policy; };
+
+        // called by the producer thread. Returns false if the queue is full
+        bool Enqueue(WinRTMidiInCallback callback, WinRTMidiInPortPtr port, long long time, double timestamp, const unsigned char* message, unsigned int nBytes);
+
+        // blocks until all messages queued before the call have been processed
+        void Drain();
+
+        unsigned long long GetProcessedCount() { return mProcessed.load(); };
+        unsigned long long GetDroppedCount() { return mDropped.load(); };
+
+        // milliseconds
+        double GetAverageQueueDelay();
+        double GetMaxQueueDelay();
+
+    protected:
+        // called on the worker thread for each message
+        virtual void Process(const WinRTMidiQueuedMessage& message) = 0;
+
+    private:
+        void Run();
+        void ProcessMessage(WinRTMidiQueuedMessage& message);
+
+        WinRTMidiQueue<WinRTMidiQueuedMessage> mQueue;
+        std::thread mThread;
+        DWORD mThreadId;
+        HANDLE mWakeEvent;
+        std::atomic<bool> mRunning;
+        std::atomic<bool> mWaiting;
+        WinRTMidiOverflowPolicy mOverflow;
+
+        // statistics
+        std::atomic<unsigned long long> mEnqueued;
+        std::atomic<unsigned long long> mProcessed;
+        std::atomic<unsigned long long> mDropped;
+        std::atomic<unsigned long long> mEvicted;   // queued messages dropped to make room, included in mDropped
+        std::atomic<long long> mTotalDelay;
+        std::atomic<long long> mMaxDelay;
+    };
+};
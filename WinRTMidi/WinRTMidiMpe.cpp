@@ -0,0 +1,318 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiMpe.h"
+#include <cstring>
+
+using namespace WinRT;
+
+#define kMpeConfigurationRpn 6
+#define kPitchBendRangeRpn 0
+#define kTimbreController 74
+#define kDefaultMemberPitchBendRange 48.0f
+#define kDefaultManagerPitchBendRange 2.0f
+
+WinRTMidiMpeDecoder::WinRTMidiMpeDecoder()
+{
+    Reset();
+}
+
+void WinRTMidiMpeDecoder::Reset()
+{
+    mParameters.Reset();
+    memset(mChannels, 0, sizeof(mChannels));
+    mMemberCount[0] = 15;
+    mMemberCount[1] = 0;
+    mNextNoteId = 1;
+
+    for (unsigned int channel = 0; channel < 16; channel++)
+    {
+        mChannels[channel].pitchBendRange = IsManager(channel) ? kDefaultManagerPitchBendRange : kDefaultMemberPitchBendRange;
+    }
+}
+
+int WinRTMidiMpeDecoder::GetZone(unsigned int channel)
+{
+    // channel 0 belongs to the upper zone when it spans 15 member channels and the lower zone is off
+    if (mMemberCount[0] > 0 && channel <= mMemberCount[0])
+    {
+        return 0;
+    }
+
+    if (mMemberCount[1] > 0 && channel >= 15 - mMemberCount[1])
+    {
+        return 1;
+    }
+
+    return -1;
+}
+
+void WinRTMidiMpeDecoder::FillEvent(WinRTMidiMpeEvent& event, WinRTMidiMpeEventType type, unsigned int channel, const Voice& voice)
+{
+    const Channel& member = mChannels[channel];
+    const Channel& manager = mChannels[GetZone(channel) == 1 ? 15 : 0];
+
+    event.type = type;
+    event.noteId = voice.noteId;
+    event.zone = (unsigned char)GetZone(channel);
+    event.channel = (unsigned char)channel;
+    event.note = voice.note;
+    event.velocity = voice.velocity;
+    event.pitchBend = member.pitchBend * member.pitchBendRange + manager.pitchBend * manager.pitchBendRange;
+    event.pressure = member.pressure;
+    event.timbre = member.timbre;
+}
+
+unsigned int WinRTMidiMpeDecoder::EmitChannel(unsigned int channel, WinRTMidiMpeEventType type, WinRTMidiMpeEvent* events)
+{
+    unsigned int count = 0;
+    for (const Voice& voice : mChannels[channel].voices)
+    {
+        if (voice.noteId != 0)
+        {
+            FillEvent(events[count++], type, channel, voice);
+        }
+    }
+
+    return count;
+}
+
+unsigned int WinRTMidiMpeDecoder::ReleaseZone(unsigned int zone, WinRTMidiMpeEvent* events)
+{
+    unsigned int count = 0;
+    for (unsigned int channel = 0; channel < 16; channel++)
+    {
+        if (GetZone(channel) != (int)zone || IsManager(channel))
+        {
+            continue;
+        }
+
+        for (Voice& voice : mChannels[channel].voices)
+        {
+            if (voice.noteId != 0)
+            {
+                voice.velocity = 0;
+                FillEvent(events[count++], WINRT_MPE_NOTE_OFF, channel, voice);
+                voice.noteId = 0;
+            }
+        }
+    }
+
+    return count;
+}
+
+unsigned int WinRTMidiMpeDecoder::ConfigureZone(unsigned int zone, unsigned int memberCount, WinRTMidiMpeEvent* events)
+{
+    // notes of both zones are released since a zone may shrink the other one
+    unsigned int count = ReleaseZone(0, events);
+    count += ReleaseZone(1, events + count);
+
+    if (memberCount > 15)
+    {
+        memberCount = 15;
+    }
+
+    mMemberCount[zone] = memberCount;
+    unsigned int other = 1 - zone;
+    if (mMemberCount[zone] + mMemberCount[other] > 14)
+    {
+        mMemberCount[other] = memberCount >= 14 ? 0 : 14 - memberCount;
+    }
+
+    // the configuration message resets the pitch bend ranges of the zone
+    for (unsigned int channel = 0; channel < 16; channel++)
+    {
+        if (GetZone(channel) == (int)zone)
+        {
+            mChannels[channel].pitchBendRange = IsManager(channel) ? kDefaultManagerPitchBendRange : kDefaultMemberPitchBendRange;
+        }
+    }
+
+    return count;
+}
+
+unsigned int WinRTMidiMpeDecoder::Process(const unsigned char* message, unsigned int nBytes, WinRTMidiMpeEvent* events)
+{
+    if (nBytes < 2 || message[0] < 0x80 || message[0] >= 0xF0)
+    {
+        if (nBytes > 0 && message[0] == 0xFF)
+        {
+            unsigned int count = ReleaseZone(0, events);
+            count += ReleaseZone(1, events + count);
+            Reset();
+            return count;
+        }
+        return 0;
+    }
+
+    unsigned int channel = message[0] & 0x0F;
+    int zone = GetZone(channel);
+    Channel& state = mChannels[channel];
+
+    switch (message[0] & 0xF0)
+    {
+    case 0x90:
+        if (nBytes >= 3 && message[2] > 0)
+        {
+            if (zone < 0 || IsManager(channel))
+            {
+                return 0;
+            }
+
+            for (Voice& voice : state.voices)
+            {
+                if (voice.noteId == 0)
+                {
+                    voice.noteId = mNextNoteId++;
+                    if (mNextNoteId == 0)
+                    {
+                        mNextNoteId = 1;
+                    }
+                    voice.note = message[1] & 0x7F;
+                    voice.velocity = message[2];
+                    FillEvent(events[0], WINRT_MPE_NOTE_ON, channel, voice);
+                    return 1;
+                }
+            }
+            return 0;
+        }
+        // fall through: note on with velocity 0
+    case 0x80:
+        for (Voice& voice : state.voices)
+        {
+            if (voice.noteId != 0 && voice.note == (message[1] & 0x7F))
+            {
+                voice.velocity = nBytes >= 3 ? message[2] : 0;
+                FillEvent(events[0], WINRT_MPE_NOTE_OFF, channel, voice);
+                voice.noteId = 0;
+                return 1;
+            }
+        }
+        return 0;
+
+    case 0xD0:
+        state.pressure = (message[1] & 0x7F) / 127.0f;
+        return zone >= 0 && !IsManager(channel) ? EmitChannel(channel, WINRT_MPE_PRESSURE, events) : 0;
+
+    case 0xE0:
+        if (nBytes < 3)
+        {
+            return 0;
+        }
+
+        state.pitchBend = ((((message[2] & 0x7F) << 7) | (message[1] & 0x7F)) - 8192) / 8192.0f;
+        if (zone < 0)
+        {
+            return 0;
+        }
+
+        if (!IsManager(channel))
+        {
+            return EmitChannel(channel, WINRT_MPE_PITCH_BEND, events);
+        }
+
+        // manager pitch bend moves every note of the zone
+        {
+            unsigned int count = 0;
+            for (unsigned int member = 0; member < 16; member++)
+            {
+                if (GetZone(member) == zone && !IsManager(member))
+                {
+                    count += EmitChannel(member, WINRT_MPE_PITCH_BEND, events + count);
+                }
+            }
+            return count;
+        }
+
+    case 0xB0:
+    {
+        WinRTMidiParameterEvent parameter;
+        if (!mParameters.Process(message, nBytes, parameter))
+        {
+            return 0;
+        }
+
+        if (parameter.type == WINRT_PARAMETER_RPN)
+        {
+            if (parameter.number == kMpeConfigurationRpn && (channel == 0 || channel == 15))
+            {
+                return ConfigureZone(channel == 0 ? 0 : 1, parameter.value >> 7, events);
+            }
+
+            if (parameter.number == kPitchBendRangeRpn)
+            {
+                float range = (parameter.value >> 7) + (parameter.value & 0x7F) / 100.0f;
+                if (zone < 0 || IsManager(channel))
+                {
+                    state.pitchBendRange = range;
+                    return 0;
+                }
+
+                // the member pitch bend range is shared by all member channels of the zone
+                for (unsigned int member = 0; member < 16; member++)
+                {
+                    if (GetZone(member) == zone && !IsManager(member))
+                    {
+                        mChannels[member].pitchBendRange = range;
+                    }
+                }
+            }
+            return 0;
+        }
+
+        if (parameter.type == WINRT_PARAMETER_CONTROLLER && parameter.number == kTimbreController)
+        {
+            state.timbre = parameter.value / 127.0f;
+            return zone >= 0 && !IsManager(channel) ? EmitChannel(channel, WINRT_MPE_TIMBRE, events) : 0;
+        }
+        return 0;
+    }
+
+    default:
+        return 0;
+    }
+}
+
+/*****************************************************
+    WinRTMidiMpeListener
+*****************************************************/
+
+WinRTMidiMpeListener::WinRTMidiMpeListener(WinRTMidiMpeCallback callback)
+    : mCallback(callback)
+    , mLastMessageTime(0)
+    , mFirstMessage(true)
+{
+}
+
+void WinRTMidiMpeListener::OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes)
+{
+    unsigned int count = mDecoder.Process(message, nBytes, mEvents);
+    if (count == 0)
+    {
+        return;
+    }
+
+    // timestamps are relative to the previous message that produced events
+    if (mFirstMessage)
+    {
+        mFirstMessage = false;
+        mLastMessageTime = time;
+    }
+
+    double timestamp = (time - mLastMessageTime) * .0001;
+    mLastMessageTime = time;
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        mCallback(port, i == 0 ? timestamp : 0.0, &mEvents[i]);
+    }
+}
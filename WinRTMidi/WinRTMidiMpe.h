@@ -0,0 +1,96 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiInSubscriber.h"
+#include "WinRTMidiParameterDecoder.h"
+
+namespace WinRT
+{
+    #define kMpeVoicesPerChannel 4
+    #define kMpeMaxEvents (kMpeVoicesPerChannel * 15)
+
+    /**********************************************************************************
+    Tracks MIDI Polyphonic Expression zones and per note expression.
+
+    The zones are configured with the MPE Configuration Message (RPN 6 on the
+    manager channel 1 or 16). Until one is received a lower zone with 15
+    member channels is assumed. Pitch bend, channel pressure and CC74 of a
+    member channel apply to the notes on that channel; pitch bend of the
+    manager channel applies to all notes of the zone. The pitch bend ranges
+    are set with RPN 0 and default to 48 (member) and 2 (manager) semitones;
+    a range received on any member channel applies to every member channel
+    of the zone.
+
+    Voices are kept in a fixed table of kMpeVoicesPerChannel entries per
+    channel, so an expression message only touches the entries of its own
+    channel. A note on for a channel without a free entry is ignored.
+    **********************************************************************************/
+    class WinRTMidiMpeDecoder
+    {
+    public:
+        WinRTMidiMpeDecoder();
+
+        void Reset();
+
+        // returns the number of events written to events (at most kMpeMaxEvents)
+        unsigned int Process(const unsigned char* message, unsigned int nBytes, WinRTMidiMpeEvent* events);
+
+    private:
+        struct Voice
+        {
+            unsigned int noteId;    // 0 if the entry is free
+            unsigned char note;
+            unsigned char velocity;
+        };
+
+        struct Channel
+        {
+            Voice voices[kMpeVoicesPerChannel];
+            float pitchBend;        // -1 - 1
+            float pressure;
+            float timbre;
+            float pitchBendRange;   // semitones
+        };
+
+        // zone 0 is the lower zone (manager channel 0), zone 1 the upper zone (manager channel 15)
+        int GetZone(unsigned int channel);
+        bool IsManager(unsigned int channel) { return (channel == 0 && mMemberCount[0] > 0) || (channel == 15 && mMemberCount[1] > 0); };
+        unsigned int ConfigureZone(unsigned int zone, unsigned int memberCount, WinRTMidiMpeEvent* events);
+        unsigned int ReleaseZone(unsigned int zone, WinRTMidiMpeEvent* events);
+        unsigned int EmitChannel(unsigned int channel, WinRTMidiMpeEventType type, WinRTMidiMpeEvent* events);
+        void FillEvent(WinRTMidiMpeEvent& event, WinRTMidiMpeEventType type, unsigned int channel, const Voice& voice);
+
+        WinRTMidiParameterDecoder mParameters;
+        Channel mChannels[16];
+        unsigned int mMemberCount[2];
+        unsigned int mNextNoteId;
+    };
+
+    // Delivers the MPE events of a midi in port
+    class WinRTMidiMpeListener : public WinRTMidiInListener
+    {
+    public:
+        WinRTMidiMpeListener(WinRTMidiMpeCallback callback);
+
+        virtual void OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes) override;
+
+    private:
+        WinRTMidiMpeCallback mCallback;
+        WinRTMidiMpeDecoder mDecoder;
+        WinRTMidiMpeEvent mEvents[kMpeMaxEvents];
+        long long mLastMessageTime;
+        bool mFirstMessage;
+    };
+};
@@ -0,0 +1,726 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+// winsock2.h must be included before Windows.h
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "WinRTMidiNetwork.h"
+#include "WinRTMidiTime.h"
+#include <algorithm>
+#include <cstring>
+#include <cwchar>
+#include <limits>
+
+using namespace WinRT;
+
+#define kInvalidSocket (~(uintptr_t)0)
+
+namespace WinRT
+{
+    std::wstring MakeNetworkPortId(const std::string& host, unsigned short port)
+    {
+        return std::wstring(kNetworkPortIdPrefix) + std::wstring(host.begin(), host.end()) + L":" + std::to_wstring(port);
+    }
+
+    bool ParseNetworkPortId(const std::wstring& id, std::string& host, unsigned short& port)
+    {
+        std::wstring prefix(kNetworkPortIdPrefix);
+        if (id.compare(0, prefix.size(), prefix) != 0)
+        {
+            return false;
+        }
+
+        size_t separator = id.rfind(L':');
+        if (separator == std::wstring::npos || separator < prefix.size())
+        {
+            return false;
+        }
+
+        unsigned long value = wcstoul(id.c_str() + separator + 1, nullptr, 10);
+        if (value == 0 || value > 0xFFFF)
+        {
+            return false;
+        }
+
+        std::wstring name = id.substr(prefix.size(), separator - prefix.size());
+        host = std::string(name.begin(), name.end());
+        port = (unsigned short)value;
+        return true;
+    }
+};
+
+static sockaddr_in ToSockAddr(const WinRTMidiNetworkAddress& address)
+{
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = address.address;
+    addr.sin_port = address.port;
+    return addr;
+}
+
+/*****************************************************
+    WinRTMidiUdpSocket
+*****************************************************/
+
+WinRTMidiUdpSocket::WinRTMidiUdpSocket()
+    : mSocket(kInvalidSocket)
+    , mStarted(false)
+{
+}
+
+WinRTMidiUdpSocket::~WinRTMidiUdpSocket()
+{
+    Close();
+}
+
+WinRTMidiErrorType WinRTMidiUdpSocket::Open(const std::string& host, unsigned short port)
+{
+#ifdef _WIN32
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+    {
+        return WINRT_OPEN_PORT_ERROR;
+    }
+#endif
+    mStarted = true;
+
+    WinRTMidiNetworkAddress address;
+    if (!Resolve(host, port, address))
+    {
+        Close();
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    mSocket = (uintptr_t)socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (mSocket == kInvalidSocket)
+    {
+        Close();
+        return WINRT_OPEN_PORT_ERROR;
+    }
+
+    sockaddr_in addr = ToSockAddr(address);
+    if (bind(mSocket, (const sockaddr*)&addr, sizeof(addr)) != 0)
+    {
+        Close();
+        return WINRT_OPEN_PORT_ERROR;
+    }
+
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiUdpSocket::Close()
+{
+    if (mSocket != kInvalidSocket)
+    {
+#ifdef _WIN32
+        closesocket(mSocket);
+#else
+        close((int)mSocket);
+#endif
+        mSocket = kInvalidSocket;
+    }
+
+    if (mStarted)
+    {
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        mStarted = false;
+    }
+}
+
+static bool ResolveHost(const std::string& host, unsigned int& address)
+{
+    in_addr numeric;
+    if (inet_pton(AF_INET, host.c_str(), &numeric) == 1)
+    {
+        address = numeric.s_addr;
+        return true;
+    }
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || result == nullptr)
+    {
+        return false;
+    }
+
+    address = ((sockaddr_in*)result->ai_addr)->sin_addr.s_addr;
+    freeaddrinfo(result);
+    return true;
+}
+
+bool WinRTMidiUdpSocket::Resolve(const std::string& host, unsigned short port, WinRTMidiNetworkAddress& address)
+{
+    address.port = htons(port);
+    if (host.empty())
+    {
+        address.address = htonl(INADDR_ANY);
+        return true;
+    }
+
+#ifdef _WIN32
+    // Resolve is also called before any socket is open (e.g. by winrt_add_network_port),
+    // and name lookups fail until Winsock is started
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+    {
+        return false;
+    }
+#endif
+
+    bool resolved = ResolveHost(host, address.address);
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    return resolved;
+}
+
+bool WinRTMidiUdpSocket::SendTo(const unsigned char* data, unsigned int size, const WinRTMidiNetworkAddress& address)
+{
+    sockaddr_in addr = ToSockAddr(address);
+    return sendto(mSocket, (const char*)data, size, 0, (const sockaddr*)&addr, sizeof(addr)) == (int)size;
+}
+
+unsigned int WinRTMidiUdpSocket::Receive(unsigned char* data, unsigned int size, WinRTMidiNetworkAddress& from, long long timeout)
+{
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(mSocket, &readSet);
+
+    timeval tv;
+    tv.tv_sec = (long)(timeout / 1000000);
+    tv.tv_usec = (long)(timeout % 1000000);
+
+    // the first argument is ignored by Winsock
+    if (select((int)mSocket + 1, &readSet, nullptr, nullptr, &tv) <= 0)
+    {
+        return 0;
+    }
+
+    sockaddr_in addr;
+    socklen_t addrSize = sizeof(addr);
+    int result = recvfrom(mSocket, (char*)data, size, 0, (sockaddr*)&addr, &addrSize);
+    if (result <= 0)
+    {
+        return 0;
+    }
+
+    from.address = addr.sin_addr.s_addr;
+    from.port = addr.sin_port;
+    return (unsigned int)result;
+}
+
+/*****************************************************
+    WinRTMidiNetworkSender
+*****************************************************/
+
+WinRTMidiNetworkSender::WinRTMidiNetworkSender(const WinRTMidiNetworkConfig& config)
+    : mConfig(config)
+    , mPacketOpen(false)
+    , mPacketTime(0)
+    , mStartTime(0)
+    , mSequence(0)
+    , mSsrc(0)
+    , mRandom(std::random_device()())
+    , mUniform(0.0, 1.0)
+    , mRunning(false)
+    , mPacketsSent(0)
+    , mPacketsInjectedLoss(0)
+{
+    memset(&mAddress, 0, sizeof(mAddress));
+}
+
+WinRTMidiNetworkSender::~WinRTMidiNetworkSender()
+{
+    Stop();
+}
+
+WinRTMidiErrorType WinRTMidiNetworkSender::Start(const std::string& host, unsigned short port)
+{
+    WinRTMidiErrorType result = mSocket.Open("", 0);
+    if (result != WINRT_NO_ERROR)
+    {
+        return result;
+    }
+
+    if (!WinRTMidiUdpSocket::Resolve(host, port, mAddress))
+    {
+        mSocket.Close();
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    if (mConfig.delay > 0 || mConfig.delayJitter > 0)
+    {
+        mDelayedPackets.resize(kNetworkDelaySlots);
+    }
+
+    // random initial values as recommended by RFC 3550. Extended sequence numbers start above 0,
+    // which the journal uses for state that never changed
+    mSsrc = (unsigned int)mRandom();
+    mSequence = (mRandom() & 0xFFFF) + 1;
+    mStartTime = GetTimeMicroseconds();
+
+    mRunning = true;
+    mThread = std::thread(&WinRTMidiNetworkSender::Run, this);
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiNetworkSender::Stop()
+{
+    if (mRunning.exchange(false))
+    {
+        mTimer.Cancel();
+        mThread.join();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        Flush();
+    }
+
+    mSocket.Close();
+}
+
+void WinRTMidiNetworkSender::Send(const unsigned char* message, unsigned int nBytes)
+{
+    if (!mRunning || nBytes == 0)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    long long now = GetTimeMicroseconds();
+
+    unsigned int pos = 0;
+    while (pos < nBytes)
+    {
+        if (!mPacketOpen)
+        {
+            Begin(now);
+        }
+
+        unsigned int delta = (unsigned int)((now - mPacketTime) / 100);
+        unsigned int added = mPacket.Add(delta, message + pos, nBytes - pos);
+        pos += added;
+        if (pos < nBytes)
+        {
+            // the packet is full
+            Flush();
+        }
+    }
+
+    if (mConfig.batchWindow <= 0)
+    {
+        Flush();
+    }
+}
+
+void WinRTMidiNetworkSender::GetStats(WinRTMidiNetworkStats& stats)
+{
+    memset(&stats, 0, sizeof(stats));
+    stats.packetsSent = mPacketsSent.load();
+    stats.packetsInjectedLoss = mPacketsInjectedLoss.load();
+}
+
+void WinRTMidiNetworkSender::Begin(long long now)
+{
+    mPacket.Begin((unsigned short)mSequence, (unsigned int)((now - mStartTime) / 100), mSsrc);
+    mPacketTime = now;
+    mPacketOpen = true;
+}
+
+// called with mMutex locked
+void WinRTMidiNetworkSender::Flush()
+{
+    if (!mPacketOpen)
+    {
+        return;
+    }
+
+    unsigned int size = mPacket.Finish(&mJournal);
+
+    // the journal of a packet covers the packets before it, so the packet's own messages are recorded afterwards
+    WinRTMidiRtpPacketInfo info;
+    if (WinRTMidiRtpPacket::Parse(mPacket.GetData(), size, info))
+    {
+        WinRTMidiRtpPacket::ForEachCommand(info.commands, info.commandSize, [this](unsigned int /*delta*/, const unsigned char* message, unsigned int nBytes)
+        {
+            mJournal.Update(message, nBytes, mSequence);
+        });
+    }
+
+    Transmit(mPacket.GetData(), size, GetTimeMicroseconds());
+    mSequence++;
+    mPacketOpen = false;
+}
+
+// called with mMutex locked
+void WinRTMidiNetworkSender::Transmit(const unsigned char* data, unsigned int size, long long now)
+{
+    mPacketsSent++;
+
+    if (mConfig.lossRate > 0 && mUniform(mRandom) < mConfig.lossRate)
+    {
+        mPacketsInjectedLoss++;
+        return;
+    }
+
+    if (!mDelayedPackets.empty())
+    {
+        long long sendTime = now + (long long)((mConfig.delay + mUniform(mRandom) * mConfig.delayJitter) * 1000);
+        for (auto& packet : mDelayedPackets)
+        {
+            if (packet.size == 0)
+            {
+                packet.sendTime = sendTime;
+                packet.size = size;
+                memcpy(packet.data, data, size);
+                return;
+            }
+        }
+
+        // all slots are in use: the packet is sent without delay
+    }
+
+    mSocket.SendTo(data, size, mAddress);
+}
+
+// called with mMutex locked
+void WinRTMidiNetworkSender::SendDelayedPackets(long long now)
+{
+    for (auto& packet : mDelayedPackets)
+    {
+        if (packet.size > 0 && packet.sendTime <= now)
+        {
+            mSocket.SendTo(packet.data, packet.size, mAddress);
+            packet.size = 0;
+        }
+    }
+}
+
+void WinRTMidiNetworkSender::ReceiveFeedback()
+{
+    unsigned char data[64];
+    WinRTMidiNetworkAddress from;
+    unsigned int size;
+
+    while ((size = mSocket.Receive(data, sizeof(data), from, 0)) > 0)
+    {
+        unsigned int ssrc;
+        unsigned short sequence;
+        if (WinRTMidiRtpPacket::ParseFeedback(data, size, ssrc, sequence) && ssrc == mSsrc)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            // extend the sequence number; the receiver can only confirm packets that were sent
+            unsigned int extended = mSequence - (unsigned short)((unsigned short)mSequence - sequence);
+            mJournal.SetCheckpoint(extended);
+        }
+    }
+}
+
+void WinRTMidiNetworkSender::Run()
+{
+    while (mRunning)
+    {
+        long long now = GetTimeMicroseconds();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mPacketOpen && now >= mPacketTime + (long long)(mConfig.batchWindow * 1000))
+            {
+                Flush();
+            }
+
+            SendDelayedPackets(now);
+        }
+
+        ReceiveFeedback();
+        mTimer.WaitUntil(now + kNetworkPollInterval);
+    }
+}
+
+/*****************************************************
+    WinRTMidiNetworkReceiver
+*****************************************************/
+
+WinRTMidiNetworkReceiver::WinRTMidiNetworkReceiver(const WinRTMidiNetworkConfig& config, const MessageFunc& func)
+    : mConfig(config)
+    , mFunc(func)
+    , mSlots(kNetworkJitterSlots)
+    , mSynchronized(false)
+    , mLossPending(false)
+    , mSsrc(0)
+    , mNextSequence(0)
+    , mLastTimestamp(0)
+    , mTimeOffset(0)
+    , mLastFeedbackTime(0)
+    , mLastTime(0)
+    , mRunning(false)
+    , mPacketsReceived(0)
+    , mPacketsLost(0)
+    , mPacketsLate(0)
+    , mJournalRecoveries(0)
+{
+    memset(&mSender, 0, sizeof(mSender));
+}
+
+WinRTMidiNetworkReceiver::~WinRTMidiNetworkReceiver()
+{
+    Stop();
+}
+
+WinRTMidiErrorType WinRTMidiNetworkReceiver::Start(const std::string& host, unsigned short port)
+{
+    WinRTMidiErrorType result = mSocket.Open(host, port);
+    if (result != WINRT_NO_ERROR)
+    {
+        return result;
+    }
+
+    mRunning = true;
+    mThread = std::thread(&WinRTMidiNetworkReceiver::Run, this);
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiNetworkReceiver::Stop()
+{
+    if (mRunning.exchange(false))
+    {
+        mThread.join();
+    }
+
+    mSocket.Close();
+}
+
+void WinRTMidiNetworkReceiver::GetStats(WinRTMidiNetworkStats& stats)
+{
+    memset(&stats, 0, sizeof(stats));
+    stats.packetsReceived = mPacketsReceived.load();
+    stats.packetsLost = mPacketsLost.load();
+    stats.packetsLate = mPacketsLate.load();
+    stats.journalRecoveries = mJournalRecoveries.load();
+}
+
+void WinRTMidiNetworkReceiver::Run()
+{
+    unsigned char data[kRtpMaxPacketSize + 1];
+
+    while (mRunning)
+    {
+        long long now = GetTimeMicroseconds();
+        long long playTime = PlayPackets(now);
+
+        // select() does not wait with sub-millisecond accuracy, but messages keep their sender timing
+        long long timeout = kNetworkReceiveTimeout;
+        if (playTime != 0)
+        {
+            timeout = std::min(timeout, std::max(0LL, playTime - now));
+        }
+
+        WinRTMidiNetworkAddress from;
+        unsigned int size = mSocket.Receive(data, sizeof(data), from, timeout);
+        now = GetTimeMicroseconds();
+        if (size > 0)
+        {
+            OnPacket(data, size, from, now);
+        }
+
+        if (mSynchronized && now - mLastFeedbackTime >= kNetworkFeedbackInterval)
+        {
+            unsigned char feedback[kRtpFeedbackSize];
+            WinRTMidiRtpPacket::WriteFeedback(feedback, mSsrc, (unsigned short)(mNextSequence - 1));
+            mSocket.SendTo(feedback, sizeof(feedback), mSender);
+            mLastFeedbackTime = now;
+        }
+    }
+}
+
+void WinRTMidiNetworkReceiver::OnPacket(const unsigned char* data, unsigned int size, const WinRTMidiNetworkAddress& from, long long now)
+{
+    WinRTMidiRtpPacketInfo info;
+    if (size > kRtpMaxPacketSize || !WinRTMidiRtpPacket::Parse(data, size, info))
+    {
+        return;
+    }
+
+    mPacketsReceived++;
+
+    if (!mSynchronized || info.ssrc != mSsrc)
+    {
+        // first packet or the sender restarted. Extended sequence numbers start at 0x10000 so
+        // packets that were sent earlier but arrive later compare as late
+        for (auto& slot : mSlots)
+        {
+            slot.used = false;
+        }
+
+        mSsrc = info.ssrc;
+        mNextSequence = info.sequence + 0x10000;
+        mLastTimestamp = info.timestamp;
+        mTimeOffset = now - mLastTimestamp * 100;
+        mLastFeedbackTime = now;
+        mLossPending = false;
+        mSynchronized = true;
+    }
+
+    mSender = from;
+
+    unsigned int sequence = mNextSequence + (short)(info.sequence - (unsigned short)mNextSequence);
+    if ((int)(sequence - mNextSequence) < 0)
+    {
+        mPacketsLate++;
+        return;
+    }
+
+    if (sequence - mNextSequence >= kNetworkJitterSlots)
+    {
+        // too far ahead to be buffered: play what is buffered and skip the packets in between
+        PlayPackets(std::numeric_limits<long long>::max());
+        if (sequence - mNextSequence >= kNetworkJitterSlots)
+        {
+            mPacketsLost += sequence - mNextSequence;
+            mNextSequence = sequence;
+            mLossPending = true;
+        }
+    }
+
+    long long timestamp = mLastTimestamp + (int)(info.timestamp - (unsigned int)mLastTimestamp);
+    mLastTimestamp = std::max(mLastTimestamp, timestamp);
+
+    // track the smallest transit time and slowly follow clock drift
+    long long senderTime = timestamp * 100;
+    long long transit = now - senderTime;
+    if (transit < mTimeOffset)
+    {
+        mTimeOffset = transit;
+    }
+    else
+    {
+        mTimeOffset += (transit - mTimeOffset) / 1024;
+    }
+
+    Slot& slot = mSlots[sequence % kNetworkJitterSlots];
+    if (slot.used)
+    {
+        // duplicate
+        mPacketsLate++;
+        return;
+    }
+
+    slot.used = true;
+    slot.sequence = sequence;
+    slot.time = senderTime + mTimeOffset;
+    slot.playTime = slot.time + (long long)(mConfig.jitterBuffer * 1000);
+    slot.size = size;
+    memcpy(slot.data, data, size);
+}
+
+// plays the packets due at now. Returns the play time of the next buffered packet or 0 if there is none
+long long WinRTMidiNetworkReceiver::PlayPackets(long long now)
+{
+    while (mSynchronized)
+    {
+        Slot& next = mSlots[mNextSequence % kNetworkJitterSlots];
+        if (next.used && next.sequence == mNextSequence)
+        {
+            if (next.playTime > now)
+            {
+                return next.playTime;
+            }
+
+            PlayPacket(next);
+            next.used = false;
+            mNextSequence++;
+            continue;
+        }
+
+        Slot* first = nullptr;
+        for (auto& slot : mSlots)
+        {
+            if (slot.used && (first == nullptr || slot.sequence < first->sequence))
+            {
+                first = &slot;
+            }
+        }
+
+        if (first == nullptr)
+        {
+            return 0;
+        }
+
+        if (first->playTime > now)
+        {
+            return first->playTime;
+        }
+
+        // the missing packets did not arrive in time
+        mPacketsLost += first->sequence - mNextSequence;
+        mNextSequence = first->sequence;
+        mLossPending = true;
+    }
+
+    return 0;
+}
+
+void WinRTMidiNetworkReceiver::PlayPacket(Slot& slot)
+{
+    WinRTMidiRtpPacketInfo info;
+    if (!WinRTMidiRtpPacket::Parse(slot.data, slot.size, info))
+    {
+        return;
+    }
+
+    long long time = slot.time;
+    if (mLossPending)
+    {
+        // without a journal nothing changed in the lost packets
+        mLossPending = false;
+        if (info.journal)
+        {
+            mState.GetSnapshot(mSnapshot);
+            WinRTMidiRtpJournal::Recover(info.journal, info.journalSize, mSnapshot, [this, time](const unsigned char* message, unsigned int nBytes)
+            {
+                Deliver(time, message, nBytes);
+            });
+            mJournalRecoveries++;
+        }
+    }
+
+    WinRTMidiRtpPacket::ForEachCommand(info.commands, info.commandSize, [this, time](unsigned int delta, const unsigned char* message, unsigned int nBytes)
+    {
+        Deliver(time + delta * 100LL, message, nBytes);
+    });
+}
+
+void WinRTMidiNetworkReceiver::Deliver(long long time, const unsigned char* message, unsigned int nBytes)
+{
+    // the time offset estimate can move backwards between packets
+    mLastTime = std::max(time, mLastTime);
+    mState.Update(message, nBytes);
+    mFunc(mLastTime, message, nBytes);
+}
@@ -0,0 +1,209 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiChannelState.h"
+#include "WinRTMidiRtp.h"
+#include "WinRTMidiTimer.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace WinRT
+{
+    #define kNetworkPortIdPrefix L"rtpmidi:"
+    #define kNetworkPollInterval 500            // microseconds
+    #define kNetworkReceiveTimeout 10000        // microseconds, bounds the time Stop() waits for the receiver thread
+    #define kNetworkFeedbackInterval 50000      // microseconds
+    #define kNetworkJitterSlots 64              // packets the jitter buffer can hold
+    #define kNetworkDelaySlots 256              // packets the delay injector can hold
+    #define kDefaultNetworkBatchWindow 1.0      // milliseconds
+    #define kDefaultNetworkJitterBuffer 5.0     // milliseconds
+
+    inline WinRTMidiNetworkConfig GetDefaultNetworkConfig()
+    {
+        WinRTMidiNetworkConfig config = { kDefaultNetworkBatchWindow, kDefaultNetworkJitterBuffer, 0.0, 0.0, 0.0 };
+        return config;
+    }
+
+    // network port ids are "rtpmidi:<host>:<port>"
+    std::wstring MakeNetworkPortId(const std::string& host, unsigned short port);
+    bool ParseNetworkPortId(const std::wstring& id, std::string& host, unsigned short& port);
+
+    // IPv4 address and port in network byte order
+    struct WinRTMidiNetworkAddress
+    {
+        unsigned int address;
+        unsigned short port;
+    };
+
+    class WinRTMidiUdpSocket
+    {
+    public:
+        WinRTMidiUdpSocket();
+        ~WinRTMidiUdpSocket();
+
+        // binds the socket to host:port. port 0 binds to any free port
+        WinRTMidiErrorType Open(const std::string& host, unsigned short port);
+        void Close();
+
+        bool SendTo(const unsigned char* data, unsigned int size, const WinRTMidiNetworkAddress& address);
+
+        // waits up to timeout microseconds for a datagram. Returns its size or 0 if none arrived
+        unsigned int Receive(unsigned char* data, unsigned int size, WinRTMidiNetworkAddress& from, long long timeout);
+
+        static bool Resolve(const std::string& host, unsigned short port, WinRTMidiNetworkAddress& address);
+
+    private:
+        uintptr_t mSocket;
+        bool mStarted;
+    };
+
+    /**********************************************************************************
+    Sends the messages of a network out port as RTP MIDI packets. Messages sent
+    within the batch window are collected into one packet, which the sender
+    thread sends when the window closes or the packet is full. Every packet
+    carries the journal of the state the receiver has not confirmed, so the
+    receiver can recover from lost packets. The receiver's feedback moves the
+    journal checkpoint.
+
+    For testing, packets can be dropped and delayed before they are sent.
+    **********************************************************************************/
+    class WinRTMidiNetworkSender
+    {
+    public:
+        WinRTMidiNetworkSender(const WinRTMidiNetworkConfig& config);
+        ~WinRTMidiNetworkSender();
+
+        WinRTMidiErrorType Start(const std::string& host, unsigned short port);
+        void Stop();
+
+        // Messages larger than a packet are split across packets
+        void Send(const unsigned char* message, unsigned int nBytes);
+
+        void GetStats(WinRTMidiNetworkStats& stats);
+
+    private:
+        struct DelayedPacket
+        {
+            long long sendTime;
+            unsigned int size;      // 0 if the slot is free
+            unsigned char data[kRtpMaxPacketSize];
+        };
+
+        void Run();
+        void Begin(long long now);
+        void Flush();
+        void Transmit(const unsigned char* data, unsigned int size, long long now);
+        void SendDelayedPackets(long long now);
+        void ReceiveFeedback();
+
+        WinRTMidiNetworkConfig mConfig;
+        WinRTMidiUdpSocket mSocket;
+        WinRTMidiNetworkAddress mAddress;
+
+        // guards the packet and the journal, which are used by the client and by the sender thread
+        std::mutex mMutex;
+        WinRTMidiRtpPacket mPacket;
+        WinRTMidiRtpJournal mJournal;
+        bool mPacketOpen;
+        long long mPacketTime;
+        long long mStartTime;
+        unsigned int mSequence;     // extended sequence number of mPacket
+        unsigned int mSsrc;
+
+        std::vector<DelayedPacket> mDelayedPackets;
+        std::mt19937 mRandom;
+        std::uniform_real_distribution<double> mUniform;
+
+        std::thread mThread;
+        WinRTMidiTimer mTimer;
+        std::atomic<bool> mRunning;
+
+        std::atomic<unsigned long long> mPacketsSent;
+        std::atomic<unsigned long long> mPacketsInjectedLoss;
+    };
+
+    /**********************************************************************************
+    Receives the RTP MIDI packets of a network in port. Packets are held in a
+    jitter buffer for jitterBuffer milliseconds after their expected arrival,
+    the sender time plus the smallest transit time seen, and played out in
+    sequence order. A sequence gap that is still open at playout time counts
+    the missing packets as lost and the journal of the next packet repairs the
+    channel state. SysEx is not covered by the journal. Messages are passed on
+    with their sender timing.
+    **********************************************************************************/
+    class WinRTMidiNetworkReceiver
+    {
+    public:
+        // time is in microseconds (see GetTimeMicroseconds)
+        typedef std::function<void(long long time, const unsigned char* message, unsigned int nBytes)> MessageFunc;
+
+        WinRTMidiNetworkReceiver(const WinRTMidiNetworkConfig& config, const MessageFunc& func);
+        ~WinRTMidiNetworkReceiver();
+
+        WinRTMidiErrorType Start(const std::string& host, unsigned short port);
+        void Stop();
+
+        void GetStats(WinRTMidiNetworkStats& stats);
+
+    private:
+        struct Slot
+        {
+            bool used;
+            unsigned int sequence;  // extended sequence number
+            long long time;         // sender time in the local clock
+            long long playTime;
+            unsigned int size;
+            unsigned char data[kRtpMaxPacketSize];
+        };
+
+        void Run();
+        void OnPacket(const unsigned char* data, unsigned int size, const WinRTMidiNetworkAddress& from, long long now);
+        long long PlayPackets(long long now);
+        void PlayPacket(Slot& slot);
+        void Deliver(long long time, const unsigned char* message, unsigned int nBytes);
+
+        WinRTMidiNetworkConfig mConfig;
+        MessageFunc mFunc;
+        WinRTMidiUdpSocket mSocket;
+        WinRTMidiNetworkAddress mSender;
+
+        std::vector<Slot> mSlots;
+        bool mSynchronized;
+        bool mLossPending;
+        unsigned int mSsrc;
+        unsigned int mNextSequence;
+        long long mLastTimestamp;   // extended RTP timestamp
+        long long mTimeOffset;      // local time minus sender time in microseconds
+        long long mLastFeedbackTime;
+        long long mLastTime;
+
+        WinRTMidiChannelState mState;
+        WinRTMidiChannelStateSnapshot mSnapshot;
+
+        std::thread mThread;
+        std::atomic<bool> mRunning;
+
+        std::atomic<unsigned long long> mPacketsReceived;
+        std::atomic<unsigned long long> mPacketsLost;
+        std::atomic<unsigned long long> mPacketsLate;
+        std::atomic<unsigned long long> mJournalRecoveries;
+    };
+};
@@ -0,0 +1,180 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiParameterDecoder.h"
+#include <cstring>
+
+using namespace WinRT;
+
+#define kNullParameter 0x7F
+
+WinRTMidiParameterDecoder::WinRTMidiParameterDecoder()
+{
+    Reset();
+}
+
+void WinRTMidiParameterDecoder::Reset()
+{
+    memset(mChannels, 0, sizeof(mChannels));
+    for (auto& channel : mChannels)
+    {
+        channel.rpn[0] = channel.rpn[1] = kNullParameter;
+        channel.nrpn[0] = channel.nrpn[1] = kNullParameter;
+        channel.parameterType = WINRT_PARAMETER_RPN;
+    }
+}
+
+bool WinRTMidiParameterDecoder::Process(const unsigned char* message, unsigned int nBytes, WinRTMidiParameterEvent& event)
+{
+    if (nBytes < 3 || (message[0] & 0xF0) != 0xB0)
+    {
+        return false;
+    }
+
+    unsigned int channel = message[0] & 0x0F;
+    unsigned char controller = message[1] & 0x7F;
+    unsigned char value = message[2] & 0x7F;
+    ChannelState& state = mChannels[channel];
+
+    event.channel = (unsigned char)channel;
+
+    switch (controller)
+    {
+    case 6:     // data entry
+    case 38:
+    case 96:    // data increment
+    case 97:    // data decrement
+        return ProcessDataEntry(channel, controller, value, event);
+
+    case 99:    // NRPN
+    case 98:
+        state.nrpn[controller == 99 ? 0 : 1] = value;
+        state.parameterType = WINRT_PARAMETER_NRPN;
+        state.dataLsbSeen = false;
+        state.dataValue = 0;
+        return false;
+
+    case 101:   // RPN
+    case 100:
+        state.rpn[controller == 101 ? 0 : 1] = value;
+        state.parameterType = WINRT_PARAMETER_RPN;
+        state.dataLsbSeen = false;
+        state.dataValue = 0;
+        return false;
+
+    default:
+        break;
+    }
+
+    if (controller < 32)
+    {
+        state.msb[controller] = value;
+        if (state.lsbSeen & (1u << controller))
+        {
+            // wait for the LSB
+            return false;
+        }
+
+        event.type = WINRT_PARAMETER_CONTROLLER_14BIT;
+        event.number = controller;
+        event.value = (unsigned short)(value << 7);
+        return true;
+    }
+
+    if (controller < 64)
+    {
+        unsigned int msbController = controller - 32;
+        state.lsbSeen |= 1u << msbController;
+        event.type = WINRT_PARAMETER_CONTROLLER_14BIT;
+        event.number = (unsigned short)msbController;
+        event.value = (unsigned short)((state.msb[msbController] << 7) | value);
+        return true;
+    }
+
+    event.type = WINRT_PARAMETER_CONTROLLER;
+    event.number = controller;
+    event.value = value;
+    return true;
+}
+
+bool WinRTMidiParameterDecoder::ProcessDataEntry(unsigned int channel, unsigned char controller, unsigned char value, WinRTMidiParameterEvent& event)
+{
+    ChannelState& state = mChannels[channel];
+    const unsigned char* parameter = state.parameterType == WINRT_PARAMETER_RPN ? state.rpn : state.nrpn;
+    if (parameter[0] == kNullParameter && parameter[1] == kNullParameter)
+    {
+        return false;
+    }
+
+    switch (controller)
+    {
+    case 6:
+        state.dataValue = (unsigned short)(value << 7);
+        if (state.dataLsbSeen)
+        {
+            return false;
+        }
+        break;
+    case 38:
+        state.dataLsbSeen = true;
+        state.dataValue = (unsigned short)((state.dataValue & 0x3F80) | value);
+        break;
+    case 96:
+        if (state.dataValue < 0x3FFF)
+        {
+            state.dataValue++;
+        }
+        break;
+    case 97:
+        if (state.dataValue > 0)
+        {
+            state.dataValue--;
+        }
+        break;
+    }
+
+    event.type = (WinRTMidiParameterType)state.parameterType;
+    event.number = (unsigned short)((parameter[0] << 7) | parameter[1]);
+    event.value = state.dataValue;
+    return true;
+}
+
+/*****************************************************
+    WinRTMidiParameterListener
+*****************************************************/
+
+WinRTMidiParameterListener::WinRTMidiParameterListener(WinRTMidiParameterCallback callback)
+    : mCallback(callback)
+    , mLastMessageTime(0)
+    , mFirstMessage(true)
+{
+}
+
+void WinRTMidiParameterListener::OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes)
+{
+    WinRTMidiParameterEvent event;
+    if (!mDecoder.Process(message, nBytes, event))
+    {
+        return;
+    }
+
+    // timestamps are relative to the previous parameter event
+    if (mFirstMessage)
+    {
+        mFirstMessage = false;
+        mLastMessageTime = time;
+    }
+
+    double timestamp = (time - mLastMessageTime) * .0001;
+    mLastMessageTime = time;
+    mCallback(port, timestamp, &event);
+}
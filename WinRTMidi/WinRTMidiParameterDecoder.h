@@ -0,0 +1,74 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiInSubscriber.h"
+
+namespace WinRT
+{
+    /**********************************************************************************
+    Decodes controller messages into parameter events: 14 bit controllers from
+    MSB/LSB pairs (0 - 31 / 32 - 63), RPN and NRPN data entry (including data
+    increment and decrement) and plain 7 bit controllers.
+
+    A MSB is reported on its own until the LSB of that controller (or of data
+    entry) has been received once on the channel. After that, only the LSB
+    produces an event, so a device that sends pairs causes one event per value.
+    Selecting a RPN or NRPN starts its value at 0, so data increment and
+    decrement never continue from the value of the previous parameter.
+    Data entry for the null parameter (127/127) is ignored. All state is kept
+    in fixed per channel tables.
+    **********************************************************************************/
+    class WinRTMidiParameterDecoder
+    {
+    public:
+        WinRTMidiParameterDecoder();
+
+        void Reset();
+
+        // returns true if the message completes a parameter event
+        bool Process(const unsigned char* message, unsigned int nBytes, WinRTMidiParameterEvent& event);
+
+    private:
+        bool ProcessDataEntry(unsigned int channel, unsigned char controller, unsigned char value, WinRTMidiParameterEvent& event);
+
+        struct ChannelState
+        {
+            unsigned char msb[32];          // 14 bit controller MSBs
+            unsigned int lsbSeen;           // bit n: controller n has sent a LSB
+            unsigned char rpn[2];           // MSB, LSB
+            unsigned char nrpn[2];
+            unsigned char parameterType;    // WINRT_PARAMETER_RPN or WINRT_PARAMETER_NRPN of the last selected parameter
+            bool dataLsbSeen;
+            unsigned short dataValue;       // 14 bit value of the selected parameter
+        };
+
+        ChannelState mChannels[16];
+    };
+
+    // Delivers the parameter events of a midi in port
+    class WinRTMidiParameterListener : public WinRTMidiInListener
+    {
+    public:
+        WinRTMidiParameterListener(WinRTMidiParameterCallback callback);
+
+        virtual void OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes) override;
+
+    private:
+        WinRTMidiParameterCallback mCallback;
+        WinRTMidiParameterDecoder mDecoder;
+        long long mLastMessageTime;
+        bool mFirstMessage;
+    };
+};
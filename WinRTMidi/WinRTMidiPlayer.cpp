@@ -0,0 +1,294 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiPlayer.h"
+#include "WinRTMidiTime.h"
+#include <algorithm>
+
+using namespace WinRT;
+
+WinRTMidiPlayer::WinRTMidiPlayer()
+    : mPlaying(false)
+    , mStartTime(0)
+    , mPosition(0)
+    , mLoopStart(0)
+    , mLoopEnd(0)
+{
+}
+
+WinRTMidiPlayer::~WinRTMidiPlayer()
+{
+    Stop();
+    mFile.Close();
+}
+
+WinRTMidiErrorType WinRTMidiPlayer::Open(const char* path, const std::vector<WinRTMidiOutPort^>& ports)
+{
+    if (ports.empty())
+    {
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    WinRTMidiErrorType result = mFile.Open(path);
+    if (result != WINRT_NO_ERROR)
+    {
+        return result;
+    }
+
+    result = mTimeline.Build(mFile.GetData(), mFile.GetSize());
+    if (result != WINRT_NO_ERROR)
+    {
+        mFile.Close();
+        return result;
+    }
+
+    mPorts = ports;
+    mChannelStates.clear();
+    for (size_t i = 0; i < mPorts.size(); i++)
+    {
+        mChannelStates.push_back(std::unique_ptr<WinRTMidiChannelState>(new WinRTMidiChannelState()));
+    }
+
+    // the playback thread never allocates
+    mSysExBuffer.resize(mTimeline.GetMaxSysExLength());
+    return WINRT_NO_ERROR;
+}
+
+WinRTMidiErrorType WinRTMidiPlayer::Start()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mThread.joinable())
+    {
+        if (mPlaying)
+        {
+            return WINRT_NO_ERROR;
+        }
+
+        // playback reached the end of the file
+        mThread.join();
+        if (mPosition >= mTimeline.GetDuration())
+        {
+            mPosition = 0;
+        }
+    }
+
+    mTimer.Reset();
+    mStartTime = GetTimeMicroseconds() - mPosition;
+    mPlaying = true;
+    mThread = std::thread(&WinRTMidiPlayer::Run, this);
+    SetThreadPriority(mThread.native_handle(), THREAD_PRIORITY_TIME_CRITICAL);
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiPlayer::Stop()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (!mThread.joinable())
+    {
+        return;
+    }
+
+    bool wasPlaying = mPlaying.load();
+    mTimer.Cancel();
+    mThread.join();
+
+    if (wasPlaying)
+    {
+        // the position is taken from the clock before playback is marked as stopped
+        mPosition = std::min(GetPositionMicroseconds(), mTimeline.GetDuration());
+        mPlaying = false;
+    }
+
+    AllNotesOff();
+}
+
+void WinRTMidiPlayer::Seek(double position)
+{
+    bool playing = mPlaying.load();
+    Stop();
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        long long time = (long long)(position * 1000000.0);
+        mPosition = std::max(0LL, std::min(time, mTimeline.GetDuration()));
+    }
+
+    if (playing)
+    {
+        Start();
+    }
+}
+
+void WinRTMidiPlayer::SetLoop(double start, double end)
+{
+    long long loopStart = (long long)(start * 1000000.0);
+    long long loopEnd = (long long)(end * 1000000.0);
+    if (loopStart < 0 || loopEnd <= loopStart)
+    {
+        loopStart = loopEnd = 0;
+    }
+
+    // the end is published last so the playback thread never sees an empty range
+    mLoopEnd = 0;
+    mLoopStart = loopStart;
+    mLoopEnd = loopEnd;
+}
+
+long long WinRTMidiPlayer::GetPositionMicroseconds()
+{
+    if (mPlaying)
+    {
+        return std::max(0LL, GetTimeMicroseconds() - mStartTime.load());
+    }
+
+    return mPosition;
+}
+
+double WinRTMidiPlayer::GetPosition()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return GetPositionMicroseconds() * .000001;
+}
+
+double WinRTMidiPlayer::GetDuration()
+{
+    return mTimeline.GetDuration() * .000001;
+}
+
+double WinRTMidiPlayer::GetTempo()
+{
+    // beats per minute
+    std::lock_guard<std::mutex> lock(mMutex);
+    return 60000000.0 / mTimeline.GetTempo(GetPositionMicroseconds());
+}
+
+void WinRTMidiPlayer::Run()
+{
+    const std::vector<WinRTMidiTimelineEvent>& events = mTimeline.GetEvents();
+    long long startTime = mStartTime;
+    size_t index = mTimeline.FindEvent(mPosition);
+
+    while (true)
+    {
+        long long loopStart = mLoopStart;
+        long long loopEnd = mLoopEnd;
+        bool loop = loopEnd > loopStart && GetTimeMicroseconds() - startTime < loopEnd;
+        long long next;
+
+        if (loop && (index == events.size() || events[index].time >= loopEnd))
+        {
+            next = loopEnd;
+        }
+        else if (index < events.size())
+        {
+            loop = false;
+            next = events[index].time;
+        }
+        else
+        {
+            break;
+        }
+
+        if (!mTimer.WaitUntil(startTime + next))
+        {
+            // stopped
+            return;
+        }
+
+        if (loop)
+        {
+            ReleaseNotes();
+
+            // shift the time base so loop start plays right now
+            startTime += loopEnd - loopStart;
+            mStartTime = startTime;
+            index = mTimeline.FindEvent(loopStart);
+            continue;
+        }
+
+        SendEvent(events[index++]);
+    }
+
+    // end of file
+    mPosition = mTimeline.GetDuration();
+    mPlaying = false;
+}
+
+void WinRTMidiPlayer::SendEvent(const WinRTMidiTimelineEvent& event)
+{
+    size_t portIndex = event.port % mPorts.size();
+    WinRTMidiOutPort^ port = mPorts[portIndex];
+
+    if (event.length == kTimelineSysEx)
+    {
+        const WinRTMidiTimelineSysEx& sysex = mTimeline.GetSysEx(event.message);
+        unsigned char* data = mSysExBuffer.data();
+        unsigned int nBytes = 0;
+        if (sysex.addStatus)
+        {
+            data[nBytes++] = 0xF0;
+        }
+
+        memcpy(data + nBytes, mTimeline.GetData() + sysex.offset, sysex.length);
+        nBytes += sysex.length;
+        if (nBytes > 0)
+        {
+            port->Send(data, nBytes);
+        }
+    }
+    else
+    {
+        unsigned char message[3] = {
+            (unsigned char)(event.message & 0xFF),
+            (unsigned char)((event.message >> 8) & 0xFF),
+            (unsigned char)((event.message >> 16) & 0xFF)
+        };
+        port->Send(message, event.length);
+        mChannelStates[portIndex]->Update(message, event.length);
+    }
+}
+
+void WinRTMidiPlayer::ReleaseNotes()
+{
+    // only the notes sent by the player; other clients of the port keep theirs
+    for (size_t i = 0; i < mPorts.size(); i++)
+    {
+        WinRTMidiOutPort^ port = mPorts[i];
+        WinRTMidiChannelStateSnapshot snapshot;
+        mChannelStates[i]->GetSnapshot(snapshot);
+        WinRTMidiChannelState::GetAllNotesOff(snapshot, [port](const unsigned char* message, unsigned int nBytes) {
+            port->Send(message, nBytes);
+        });
+        mChannelStates[i]->Reset();
+    }
+}
+
+void WinRTMidiPlayer::AllNotesOff()
+{
+    for (auto port : mPorts)
+    {
+        for (unsigned char channel = 0; channel < 16; channel++)
+        {
+            unsigned char sustainOff[3] = { (unsigned char)(0xB0 | channel), 64, 0 };
+            unsigned char allNotesOff[3] = { (unsigned char)(0xB0 | channel), 123, 0 };
+            port->Send(sustainOff, 3);
+            port->Send(allNotesOff, 3);
+        }
+    }
+
+    for (auto& state : mChannelStates)
+    {
+        state->Reset();
+    }
+}
@@ -0,0 +1,84 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiImpl.h"
+#include "WinRTMidiFile.h"
+#include "WinRTMidiSmf.h"
+#include "WinRTMidiTimer.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WinRT
+{
+    /**********************************************************************************
+    Plays a Standard MIDI File to one or more midi out ports. The file is memory
+    mapped and parsed once into a merged timeline with all tempo changes applied,
+    so the playback thread only compares precomputed times. Events are sent from
+    a time critical thread that waits on a high resolution timer. SMF port meta
+    events (0x21) select the out port; events for port n are sent to
+    ports[n % number of ports].
+
+    Stop() and Seek() silence all channels of all ports (sustain off and
+    all notes off). When playback wraps from the loop end back to the loop
+    start, the notes the player left sounding are released first.
+    **********************************************************************************/
+    class WinRTMidiPlayer
+    {
+    public:
+        WinRTMidiPlayer();
+        ~WinRTMidiPlayer();
+
+        WinRTMidiErrorType Open(const char* path, const std::vector<WinRTMidiOutPort^>& ports);
+
+        WinRTMidiErrorType Start();
+        void Stop();
+
+        // seconds from the start of the file
+        void Seek(double position);
+
+        // loops between start and end (seconds). end <= start disables looping
+        void SetLoop(double start, double end);
+
+        double GetPosition();
+        double GetDuration();
+        double GetTempo();
+        bool IsPlaying() { return mPlaying.load(); };
+
+    private:
+        void Run();
+        void SendEvent(const WinRTMidiTimelineEvent& event);
+        void AllNotesOff();
+        void ReleaseNotes();
+        long long GetPositionMicroseconds();
+
+        WinRTMidiMappedFile mFile;
+        WinRTMidiSmfTimeline mTimeline;
+        std::vector<WinRTMidiOutPort^> mPorts;
+        std::vector<unsigned char> mSysExBuffer;
+        std::vector<std::unique_ptr<WinRTMidiChannelState>> mChannelStates;  // notes sent by the player, per port
+
+        WinRTMidiTimer mTimer;
+        std::thread mThread;
+        std::mutex mMutex;
+        std::atomic<bool> mPlaying;
+        std::atomic<long long> mStartTime;      // performance counter time of file position 0
+        std::atomic<long long> mPosition;       // microseconds, valid while stopped
+        std::atomic<long long> mLoopStart;
+        std::atomic<long long> mLoopEnd;
+    };
+};
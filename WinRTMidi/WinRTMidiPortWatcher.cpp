@@ -41,14 +41,42 @@ namespace WinRT
         return stringUtf8;
     }
 
-    WinRTMidiPortWatcher::WinRTMidiPortWatcher(WinRTMidiPortType type, MidiPortChangedCallback callback)
+    WinRTMidiPortWatcher::WinRTMidiPortWatcher(WinRTMidiPortType type)
         : mPortEnumerationComplete(false)
-        , mPortChangedCallback(callback)
         , mPortType(type)
     {
  
     }
 
+    void WinRTMidiPortWatcher::Stop()
+    {
+        if (mPortWatcher != nullptr && (mPortWatcher->Status == DeviceWatcherStatus::Started || mPortWatcher->Status == DeviceWatcherStatus::EnumerationCompleted))
+        {
+            mPortWatcher->Stop();
+        }
+    }
+
+    void WinRTMidiPortWatcher::AddListener(const void* owner, MidiPortChangedCallback callback, const MidiPortIdChangedCallbackType& idCallback)
+    {
+        std::lock_guard<std::recursive_mutex> lock(mListenerMutex);
+        mListeners.push_back({ owner, callback, idCallback });
+
+        if (mPortEnumerationComplete && callback != nullptr)
+        {
+            MidiPortWatcherWrapper wrapper(this);
+            callback(&wrapper, WinRTMidiPortUpdateType::EnumerationComplete);
+        }
+    }
+
+    void WinRTMidiPortWatcher::RemoveListener(const void* owner)
+    {
+        std::lock_guard<std::recursive_mutex> lock(mListenerMutex);
+        mListeners.erase(std::remove_if(mListeners.begin(), mListeners.end(), [owner](const Listener& listener)
+        {
+            return listener.owner == owner;
+        }), mListeners.end());
+    }
+
     WinRTMidiErrorType WinRTMidiPortWatcher::Initialize()
     {
         auto task = create_task(create_async([this]
@@ -103,13 +131,22 @@ namespace WinRT
         }
     }
 
+    void WinRTMidiPortWatcher::Reserve(unsigned int maxPorts)
+    {
+        std::lock_guard<std::mutex> lock(mPortInfoMutex);
+        mPortInfo.reserve(maxPorts);
+    }
+
+    // the name is kept with the port, so it stays valid until the port is removed
     const std::string& WinRTMidiPortWatcher::GetPortName(unsigned int portNumber)
     {
+        std::lock_guard<std::mutex> lock(mPortInfoMutex);
         return mPortInfo[portNumber].get()->mName;
     }
 
     Platform::String^ WinRTMidiPortWatcher::GetPortId(unsigned int portNumber)
     {
+        std::lock_guard<std::mutex> lock(mPortInfoMutex);
         if (portNumber >= mPortInfo.size())
         {
             return "";
@@ -122,34 +159,70 @@ namespace WinRT
 
     unsigned int WinRTMidiPortWatcher::GetPortCount()
     {
+        std::lock_guard<std::mutex> lock(mPortInfoMutex);
         return static_cast<int>(mPortInfo.size());
     }
 
-    void WinRTMidiPortWatcher::OnDeviceAdded(DeviceWatcher^ sender, DeviceInformation^ args)
+    bool WinRTMidiPortWatcher::AddPort(const std::string& name, Platform::String^ id)
     {
-        mPortInfo.emplace_back(new WinRTMidiPortInfo(PlatformStringToString(args->Name), args->Id));
+        {
+            // the check and the add are done under one lock so two clients can't add the same id
+            std::string portName(name);
+            std::lock_guard<std::mutex> lock(mPortInfoMutex);
+            for (const auto& info : mPortInfo)
+            {
+                if (info->mID == id)
+                {
+                    return false;
+                }
+            }
+
+            mPortInfo.emplace_back(new WinRTMidiPortInfo(portName, id));
+        }
+
         if (mPortEnumerationComplete)
         {
+            OnMidiPortIdChanged(id, WinRTMidiPortUpdateType::PortAdded);
             OnMidiPortUpdated(WinRTMidiPortUpdateType::PortAdded);
         }
+
+        return true;
     }
 
-    void WinRTMidiPortWatcher::OnDeviceRemoved(DeviceWatcher^ sender, DeviceInformationUpdate^ args)
+    bool WinRTMidiPortWatcher::RemovePort(Platform::String^ id)
     {
-        for (unsigned int i = 0; i < mPortInfo.size(); i++)
+        bool found = false;
         {
-            if (mPortInfo[i]->mID == args->Id)
+            std::lock_guard<std::mutex> lock(mPortInfoMutex);
+            for (unsigned int i = 0; i < mPortInfo.size(); i++)
             {
-                std::swap(mPortInfo[i], mPortInfo.back());
-                mPortInfo.pop_back();
-                break;
+                if (mPortInfo[i]->mID == id)
+                {
+                    std::swap(mPortInfo[i], mPortInfo.back());
+                    mPortInfo.pop_back();
+                    found = true;
+                    break;
+                }
             }
         }
 
-        if (mPortEnumerationComplete)
+        if (found && mPortEnumerationComplete)
         {
+            OnMidiPortIdChanged(id, WinRTMidiPortUpdateType::PortRemoved);
             OnMidiPortUpdated(WinRTMidiPortUpdateType::PortRemoved);
         }
+
+        return found;
+    }
+
+    void WinRTMidiPortWatcher::OnDeviceAdded(DeviceWatcher^ sender, DeviceInformation^ args)
+    {
+        AddPort(PlatformStringToString(args->Name), args->Id);
+    }
+
+    void WinRTMidiPortWatcher::OnDeviceRemoved(DeviceWatcher^ sender, DeviceInformationUpdate^ args)
+    {
+        RemovePort(args->Id);
     }
 
     void WinRTMidiPortWatcher::OnDeviceUpdated(DeviceWatcher^ sender, DeviceInformationUpdate^ args)
@@ -164,17 +237,88 @@ namespace WinRT
         mSleepCondition.notify_one();
     }
 
+    void WinRTMidiPortWatcher::OnMidiPortIdChanged(Platform::String^ id, WinRTMidiPortUpdateType update)
+    {
+        std::lock_guard<std::recursive_mutex> lock(mListenerMutex);
+
+        // a callback may remove listeners
+        auto listeners = mListeners;
+        for (const auto& listener : listeners)
+        {
+            if (listener.idCallback)
+            {
+                listener.idCallback(id, update);
+            }
+        }
+    }
+
     void WinRTMidiPortWatcher::OnMidiPortUpdated(WinRTMidiPortUpdateType update)
     {
         MidiPortWatcherWrapper wrapper(this);
 
-        if (mPortChangedCallback != nullptr)
         {
-            mPortChangedCallback(&wrapper, update);
+            std::lock_guard<std::recursive_mutex> lock(mListenerMutex);
+            auto listeners = mListeners;
+            for (const auto& listener : listeners)
+            {
+                if (listener.callback != nullptr)
+                {
+                    listener.callback(&wrapper, update);
+                }
+            }
         }
 
         mMidiPortUpdateEventHander(this, update);
     }
+
+    /*****************************************************
+        WinRTMidiPortWatchers
+    *****************************************************/
+
+    std::mutex WinRTMidiPortWatchers::sMutex;
+    std::weak_ptr<WinRTMidiPortWatchers> WinRTMidiPortWatchers::sWatchers;
+
+    WinRTMidiPortWatchers::WinRTMidiPortWatchers()
+    {
+        mMidiInPortWatcher = ref new WinRTMidiPortWatcher(WinRTMidiPortType::In);
+        mMidiOutPortWatcher = ref new WinRTMidiPortWatcher(WinRTMidiPortType::Out);
+    }
+
+    WinRTMidiPortWatchers::~WinRTMidiPortWatchers()
+    {
+        mMidiInPortWatcher->Stop();
+        mMidiOutPortWatcher->Stop();
+    }
+
+    WinRTMidiErrorType WinRTMidiPortWatchers::Acquire(std::shared_ptr<WinRTMidiPortWatchers>& watchers, unsigned int maxPorts)
+    {
+        // held during the enumeration so concurrent initializations wait for it instead of enumerating again
+        std::lock_guard<std::mutex> lock(sMutex);
+
+        watchers = sWatchers.lock();
+        if (watchers)
+        {
+            return WINRT_NO_ERROR;
+        }
+
+        std::shared_ptr<WinRTMidiPortWatchers> newWatchers(new WinRTMidiPortWatchers());
+        newWatchers->mMidiInPortWatcher->Reserve(maxPorts);
+        newWatchers->mMidiOutPortWatcher->Reserve(maxPorts);
+        WinRTMidiErrorType result = newWatchers->mMidiInPortWatcher->Initialize();
+        if (result == WINRT_NO_ERROR)
+        {
+            result = newWatchers->mMidiOutPortWatcher->Initialize();
+        }
+
+        if (result != WINRT_NO_ERROR)
+        {
+            return result;
+        }
+
+        sWatchers = newWatchers;
+        watchers = newWatchers;
+        return WINRT_NO_ERROR;
+    }
 }
 
 
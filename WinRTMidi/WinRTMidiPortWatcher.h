@@ -45,6 +45,9 @@ namespace WinRT
     // C++ Midi port changed callback
     typedef std::function<void(WinRTMidiPortWatcher^ watcher, WinRTMidiPortUpdateType update)> MidiPortChangedCallbackType;
 
+    // C++ callback with the device id of an added or removed port. Called before the port changed callback
+    typedef std::function<void(Platform::String^ id, WinRTMidiPortUpdateType update)> MidiPortIdChangedCallbackType;
+
     // WinRT Delegate
     delegate void MidiPortUpdateHandler(WinRTMidiPortWatcher^ sender, WinRTMidiPortUpdateType update);
 
@@ -57,25 +60,37 @@ namespace WinRT
         unsigned int GetPortCount();
         Platform::String^ GetPortId(unsigned int portNumber);
 
-        void RemoveMidiPortChangedCallback() {
-            mPortChangedCallback = nullptr;
-        };
+        // stops watching for devices
+        void Stop();
+
+        // the port list holds maxPorts ports without reallocating. Called before Initialize()
+        void Reserve(unsigned int maxPorts);
 
         WinRTMidiPortType GetPortType() { return mPortType; };
         event MidiPortUpdateHandler^ mMidiPortUpdateEventHander;
         void OnMidiPortUpdated(WinRTMidiPortUpdateType update);
-        
-        // needs to be internal as MidiPortChangedCallbackType is not a WinRT type
-        void SetMidiPortChangedCallback(const MidiPortChangedCallback callback) {
-            mPortChangedCallback = callback;
-        };
-       
+
+        // The watcher is shared by all WinRTMidi instances of the process and each one adds its callbacks.
+        // If the enumeration is complete the new callback is called with EnumerationComplete.
+        // needs to be internal as MidiPortIdChangedCallbackType is not a WinRT type
+        void AddListener(const void* owner, MidiPortChangedCallback callback, const MidiPortIdChangedCallbackType& idCallback);
+
+        // callbacks that are running when the listener is removed complete before RemoveListener returns
+        void RemoveListener(const void* owner);
+
         // Constructor needs to be internal as this is an unsealed ref base class
-        WinRTMidiPortWatcher(WinRTMidiPortType type, MidiPortChangedCallback callback = nullptr);
+        WinRTMidiPortWatcher(WinRTMidiPortType type);
 
         // needs to be internal as std::string is not a WinRT type
         const std::string& WinRTMidiPortWatcher::GetPortName(unsigned int portNumber);
 
+        // adds a port without a device (e.g. a network endpoint). It is reported like an added device.
+        // returns false if there already is a port with the id
+        bool AddPort(const std::string& name, Platform::String^ id);
+
+        // returns false if there is no port with the id
+        bool RemovePort(Platform::String^ id);
+
     private:
         void OnDeviceAdded(Windows::Devices::Enumeration::DeviceWatcher^ sender, Windows::Devices::Enumeration::DeviceInformation^ args);
         void OnDeviceRemoved(Windows::Devices::Enumeration::DeviceWatcher^ sender, Windows::Devices::Enumeration::DeviceInformationUpdate^ args);
@@ -83,18 +98,63 @@ namespace WinRT
         void OnDeviceEnumerationCompleted(Windows::Devices::Enumeration::DeviceWatcher^ sender, Platform::Object^ args);
 
         void WaitForEnumeration();
+        void OnMidiPortIdChanged(Platform::String^ id, WinRTMidiPortUpdateType update);
 
         Windows::Devices::Enumeration::DeviceWatcher^ mPortWatcher;
         std::vector<std::unique_ptr<WinRTMidiPortInfo>> mPortInfo;
+
+        // guards mPortInfo, which is changed by the device watcher thread and by clients adding
+        // network and virtual ports. Not held while the listeners are called
+        std::mutex mPortInfoMutex;
+
         std::mutex mEnumerationMutex;
         std::condition_variable mSleepCondition;
 
-        MidiPortChangedCallback mPortChangedCallback;
+        struct Listener
+        {
+            const void* owner;
+            MidiPortChangedCallback callback;
+            MidiPortIdChangedCallbackType idCallback;
+        };
+
+        // held while the callbacks run. Recursive so a callback can remove its listener
+        std::recursive_mutex mListenerMutex;
+        std::vector<Listener> mListeners;
+
         WinRTMidiPortType mPortType;
         bool mPortEnumerationComplete;
     };
 
 
+    /**********************************************************************************
+    The in and out port watchers of the process. Enumerating the devices blocks
+    and each watcher has its own thread, so the first WinRTMidi instance
+    creates them and later instances share them. The watchers are stopped when
+    the last instance releases them.
+    **********************************************************************************/
+    class WinRTMidiPortWatchers
+    {
+    public:
+        // returns the watchers of the process, creating them and waiting for the enumeration on first use.
+        // maxPorts only applies when the watchers are created
+        static WinRTMidiErrorType Acquire(std::shared_ptr<WinRTMidiPortWatchers>& watchers, unsigned int maxPorts);
+
+        ~WinRTMidiPortWatchers();
+
+        WinRTMidiPortWatcher^ GetWatcher(WinRTMidiPortType type) {
+            return type == WinRTMidiPortType::In ? mMidiInPortWatcher : mMidiOutPortWatcher;
+        };
+
+    private:
+        WinRTMidiPortWatchers();
+
+        WinRTMidiPortWatcher^ mMidiInPortWatcher;
+        WinRTMidiPortWatcher^ mMidiOutPortWatcher;
+
+        static std::mutex sMutex;
+        static std::weak_ptr<WinRTMidiPortWatchers> sWatchers;
+    };
+
     class MidiPortWatcherWrapper
     {
     public:
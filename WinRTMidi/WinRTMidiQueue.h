@@ -0,0 +1,134 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace WinRT
+{
+    /**********************************************************************************
+    Bounded lock-free multi-producer/multi-consumer queue (Dmitry Vyukov's design).
+    Each cell carries a sequence number so producers and consumers only contend
+    on their own position counter. Capacity is rounded up to a power of 2 and
+    all memory is allocated in the constructor. Push() fails when the queue is full.
+    **********************************************************************************/
+    template <typename T>
+    class WinRTMidiQueue
+    {
+    public:
+        WinRTMidiQueue(size_t capacity)
+        {
+            size_t size = 2;
+            while (size < capacity)
+            {
+                size <<= 1;
+            }
+
+            mMask = size - 1;
+            mCells.reset(new Cell[size]);
+            for (size_t i = 0; i < size; i++)
+            {
+                mCells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            mEnqueuePos.store(0, std::memory_order_relaxed);
+            mDequeuePos.store(0, std::memory_order_relaxed);
+        }
+
+        bool Push(const T& item)
+        {
+            Cell* cell;
+            size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                cell = &mCells[pos & mMask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+                if (diff == 0)
+                {
+                    if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    // queue is full
+                    return false;
+                }
+                else
+                {
+                    pos = mEnqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            cell->data = item;
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool Pop(T& item)
+        {
+            Cell* cell;
+            size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                cell = &mCells[pos & mMask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+                if (diff == 0)
+                {
+                    if (mDequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    // queue is empty
+                    return false;
+                }
+                else
+                {
+                    pos = mDequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            item = cell->data;
+            cell->sequence.store(pos + mMask + 1, std::memory_order_release);
+            return true;
+        }
+
+        size_t Capacity() const { return mMask + 1; };
+
+    private:
+        WinRTMidiQueue(const WinRTMidiQueue&) = delete;
+        WinRTMidiQueue& operator=(const WinRTMidiQueue&) = delete;
+
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        std::unique_ptr<Cell[]> mCells;
+        size_t mMask;
+
+        // keep the producer and consumer positions on separate cache lines
+        alignas(64) std::atomic<size_t> mEnqueuePos;
+        alignas(64) std::atomic<size_t> mDequeuePos;
+    };
+};
@@ -0,0 +1,196 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiRecorder.h"
+#include "WinRTMidiMessage.h"
+
+using namespace WinRT;
+
+static const unsigned char kTempoTrack[] = {
+    0x00, 0xFF, 0x58, 0x04, 0x04, 0x02, 0x18, 0x08,                     // 4/4 time signature
+    0x00, 0xFF, 0x51, 0x03,                                             // tempo
+    (kRecorderTempo >> 16) & 0xFF, (kRecorderTempo >> 8) & 0xFF, kRecorderTempo & 0xFF,
+    0x00, 0xFF, 0x2F, 0x00                                              // end of track
+};
+
+WinRTMidiRecorder::WinRTMidiRecorder(WinRTMidiInPort^ port)
+    : WinRTMidiMessageWorker(kRecorderQueueCapacity)
+    , mPort(port)
+    , mTrackLengthPosition(0)
+    , mStartTime(0)
+    , mLastTick(0)
+    , mFirstMessage(true)
+    , mRecording(false)
+    , mRunningStatus(0)
+{
+}
+
+WinRTMidiRecorder::~WinRTMidiRecorder()
+{
+    Finish();
+}
+
+WinRTMidiErrorType WinRTMidiRecorder::Start(const char* path)
+{
+    WinRTMidiErrorType result = mWriter.Open(path);
+    if (result != WINRT_NO_ERROR)
+    {
+        return result;
+    }
+
+    WriteHeader();
+
+    result = WinRTMidiMessageWorker::Start();
+    if (result != WINRT_NO_ERROR)
+    {
+        mWriter.Close();
+        return result;
+    }
+
+    mRecording = true;
+    mPort->AddListener(this);
+    return WINRT_NO_ERROR;
+}
+
+WinRTMidiErrorType WinRTMidiRecorder::Finish()
+{
+    if (!mRecording)
+    {
+        return WINRT_NO_ERROR;
+    }
+
+    mRecording = false;
+    mPort->RemoveListener(this);
+
+    // write everything that was received before the recording was stopped
+    Drain();
+    Stop();
+
+    // end of track
+    mWriter.WriteByte(0x00);
+    mWriter.WriteByte(0xFF);
+    mWriter.WriteByte(0x2F);
+    mWriter.WriteByte(0x00);
+
+    unsigned long long trackLength = mWriter.GetPosition() - mTrackLengthPosition - 4;
+    mWriter.Patch(mTrackLengthPosition, (unsigned int)trackLength, 4);
+    return mWriter.Close();
+}
+
+void WinRTMidiRecorder::WriteHeader()
+{
+    static const unsigned char mthd[] = { 'M', 'T', 'h', 'd' };
+    static const unsigned char mtrk[] = { 'M', 'T', 'r', 'k' };
+
+    mWriter.Write(mthd, sizeof(mthd));
+    mWriter.WriteBigEndian(6, 4);
+    mWriter.WriteBigEndian(1, 2);  // format 1
+    mWriter.WriteBigEndian(2, 2);  // tempo track + recorded track
+    mWriter.WriteBigEndian(kRecorderTicksPerQuarterNote, 2);
+
+    mWriter.Write(mtrk, sizeof(mtrk));
+    mWriter.WriteBigEndian(sizeof(kTempoTrack), 4);
+    mWriter.Write(kTempoTrack, sizeof(kTempoTrack));
+
+    // the length of the recorded track is patched in Finish()
+    mWriter.Write(mtrk, sizeof(mtrk));
+    mTrackLengthPosition = mWriter.GetPosition();
+    mWriter.WriteBigEndian(0, 4);
+}
+
+void WinRTMidiRecorder::OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes)
+{
+    // realtime and system common messages can't be stored in a Standard MIDI File
+    if (GetMidiMessageType(message, nBytes) & (WINRT_MIDI_CHANNEL_MESSAGES | WINRT_MIDI_SYSEX))
+    {
+        Enqueue(nullptr, port, time, 0.0, message, nBytes);
+    }
+}
+
+void WinRTMidiRecorder::WriteDeltaTime(long long time)
+{
+    if (mFirstMessage)
+    {
+        mFirstMessage = false;
+        mStartTime = time;
+    }
+
+    // absolute ticks are computed from the start time so rounding errors don't accumulate.
+    // port timestamps are in 100ns units
+    long long tick = (time - mStartTime) * kRecorderTicksPerQuarterNote / (kRecorderTempo * 10LL);
+    if (tick < mLastTick)
+    {
+        tick = mLastTick;
+    }
+
+    // longer gaps are split with empty text events so each delta fits in 4 bytes
+    long long delta = tick - mLastTick;
+    while (delta > kRecorderMaxDeltaTime)
+    {
+        mWriter.WriteVariableLength(kRecorderMaxDeltaTime);
+        mWriter.WriteByte(0xFF);
+        mWriter.WriteByte(0x01);
+        mWriter.WriteByte(0x00);
+        delta -= kRecorderMaxDeltaTime;
+
+        // meta events cancel running status
+        mRunningStatus = 0;
+    }
+
+    mWriter.WriteVariableLength((unsigned int)delta);
+    mLastTick = tick;
+}
+
+void WinRTMidiRecorder::Process(const WinRTMidiQueuedMessage& message)
+{
+    const unsigned char* data = message.GetData();
+    unsigned int nBytes = message.nBytes;
+    if (nBytes == 0)
+    {
+        return;
+    }
+
+    WriteDeltaTime(message.time);
+
+    unsigned char status = data[0];
+    if (status == 0xF0)
+    {
+        mWriter.WriteByte(0xF0);
+        mWriter.WriteVariableLength(nBytes - 1);
+        mWriter.Write(data + 1, nBytes - 1);
+        mRunningStatus = 0;
+    }
+    else if (status < 0x80 || status == 0xF7)
+    {
+        // SysEx continuation fragment is written as an escape sequence
+        mWriter.WriteByte(0xF7);
+        mWriter.WriteVariableLength(nBytes);
+        mWriter.Write(data, nBytes);
+        mRunningStatus = 0;
+    }
+    else
+    {
+        unsigned int length = (status & 0xE0) == 0xC0 ? 2 : 3;
+        if (nBytes < length)
+        {
+            length = nBytes;
+        }
+
+        if (status != mRunningStatus)
+        {
+            mWriter.WriteByte(status);
+            mRunningStatus = status;
+        }
+
+        mWriter.Write(data + 1, length - 1);
+    }
+}
@@ -0,0 +1,64 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiImpl.h"
+#include "WinRTMidiFile.h"
+#include "WinRTMidiMessageWorker.h"
+
+namespace WinRT
+{
+    #define kRecorderQueueCapacity 4096
+    #define kRecorderTicksPerQuarterNote 960
+    #define kRecorderTempo 500000           // microseconds per quarter note (120 bpm)
+    #define kRecorderMaxDeltaTime 0x0FFFFFFF // largest delta time a variable length quantity can hold
+
+    /**********************************************************************************
+    Records a midi in port to a Standard MIDI File (type 1). Messages are copied
+    into a bounded queue on the MessageReceived thread and written on the
+    recorder thread, so file I/O never delays the port. Track 0 holds the tempo
+    and time signature, track 1 the recorded channel and SysEx messages. The
+    length of track 1 is patched when the recording is finished. Memory use is
+    constant for the duration of the recording.
+    **********************************************************************************/
+    class WinRTMidiRecorder : public WinRTMidiInListener, public WinRTMidiMessageWorker
+    {
+    public:
+        WinRTMidiRecorder(WinRTMidiInPort^ port);
+        virtual ~WinRTMidiRecorder();
+
+        WinRTMidiErrorType Start(const char* path);
+
+        // stops recording and completes the file
+        WinRTMidiErrorType Finish();
+
+        virtual void OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes) override;
+
+    protected:
+        virtual void Process(const WinRTMidiQueuedMessage& message) override;
+
+    private:
+        void WriteHeader();
+        void WriteDeltaTime(long long time);
+
+        WinRTMidiInPort^ mPort;
+        WinRTMidiFileWriter mWriter;
+        unsigned long long mTrackLengthPosition;
+        long long mStartTime;
+        long long mLastTick;
+        bool mFirstMessage;
+        bool mRecording;
+        unsigned char mRunningStatus;
+    };
+};
@@ -0,0 +1,466 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiRtp.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace WinRT;
+
+#define kRtpCommandHeaderSize 2
+#define kRtpFlagLongHeader 0x80
+#define kRtpFlagJournal 0x40
+#define kRtpFlagFirstDelta 0x20
+#define kJournalChannelSize 21      // channel, program, pitch bend, 16 bytes of notes, controller count
+#define kFirstChannelModeController 120
+
+static void WriteBigEndian16(unsigned char* data, unsigned int value)
+{
+    data[0] = (unsigned char)(value >> 8);
+    data[1] = (unsigned char)value;
+}
+
+static void WriteBigEndian32(unsigned char* data, unsigned int value)
+{
+    data[0] = (unsigned char)(value >> 24);
+    data[1] = (unsigned char)(value >> 16);
+    data[2] = (unsigned char)(value >> 8);
+    data[3] = (unsigned char)value;
+}
+
+static unsigned int ReadBigEndian16(const unsigned char* data)
+{
+    return (data[0] << 8) | data[1];
+}
+
+static unsigned int ReadBigEndian32(const unsigned char* data)
+{
+    return ((unsigned int)data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+}
+
+static unsigned int GetVarLenSize(unsigned int value)
+{
+    unsigned int size = 1;
+    while (value >= 0x80 && size < 4)
+    {
+        value >>= 7;
+        size++;
+    }
+
+    return size;
+}
+
+// values are limited to 28 bits like SMF delta times
+static unsigned int WriteVarLen(unsigned char* data, unsigned int value)
+{
+    unsigned int size = GetVarLenSize(value);
+    for (unsigned int i = 0; i < size; i++)
+    {
+        unsigned int shift = (size - 1 - i) * 7;
+        data[i] = (unsigned char)((value >> shift) & 0x7F) | (i < size - 1 ? 0x80 : 0);
+    }
+
+    return size;
+}
+
+static bool ReadVarLen(const unsigned char* data, unsigned int size, unsigned int& pos, unsigned int& value)
+{
+    value = 0;
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        if (pos >= size)
+        {
+            return false;
+        }
+
+        unsigned char c = data[pos++];
+        value = (value << 7) | (c & 0x7F);
+        if ((c & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*****************************************************
+    WinRTMidiRtpJournal
+*****************************************************/
+
+WinRTMidiRtpJournal::WinRTMidiRtpJournal()
+{
+    Reset();
+}
+
+void WinRTMidiRtpJournal::Reset()
+{
+    mState.Reset();
+    memset(mChannelSeq, 0, sizeof(mChannelSeq));
+    memset(mControllerSeq, 0, sizeof(mControllerSeq));
+    mCheckpoint = 0;
+}
+
+void WinRTMidiRtpJournal::Update(const unsigned char* message, unsigned int nBytes, unsigned int seq)
+{
+    if (nBytes == 0 || message[0] < 0x80)
+    {
+        return;
+    }
+
+    mState.Update(message, nBytes);
+
+    unsigned char status = message[0];
+    if (status == 0xFF)
+    {
+        // system reset changes every channel
+        for (unsigned int channel = 0; channel < 16; channel++)
+        {
+            mChannelSeq[channel] = seq;
+            std::fill(mControllerSeq[channel], mControllerSeq[channel] + 128, seq);
+        }
+        return;
+    }
+
+    unsigned int channel = status & 0x0F;
+    switch (status & 0xF0)
+    {
+    case 0x80:
+    case 0x90:
+    case 0xC0:
+    case 0xE0:
+        mChannelSeq[channel] = seq;
+        break;
+    case 0xB0:
+        if (nBytes > 1)
+        {
+            mChannelSeq[channel] = seq;
+            if ((message[1] & 0x7F) == 121)
+            {
+                // reset all controllers
+                std::fill(mControllerSeq[channel], mControllerSeq[channel] + 128, seq);
+            }
+            else
+            {
+                mControllerSeq[channel][message[1] & 0x7F] = seq;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void WinRTMidiRtpJournal::SetCheckpoint(unsigned int seq)
+{
+    if (seq > mCheckpoint)
+    {
+        mCheckpoint = seq;
+    }
+}
+
+unsigned int WinRTMidiRtpJournal::Write(unsigned char* data, unsigned int size)
+{
+    if (size < 1)
+    {
+        return 0;
+    }
+
+    mState.GetSnapshot(mSnapshot);
+
+    unsigned int pos = 1;
+    unsigned char channels = 0;
+    for (unsigned int channel = 0; channel < 16; channel++)
+    {
+        if (mChannelSeq[channel] <= mCheckpoint)
+        {
+            continue;
+        }
+
+        if (pos + kJournalChannelSize > size)
+        {
+            return 0;
+        }
+
+        unsigned char* chapter = data + pos;
+        chapter[0] = (unsigned char)channel;
+        chapter[1] = mSnapshot.programs[channel];
+        chapter[2] = mSnapshot.pitchBend[channel] & 0x7F;
+        chapter[3] = (mSnapshot.pitchBend[channel] >> 7) & 0x7F;
+        for (unsigned int i = 0; i < 16; i++)
+        {
+            chapter[4 + i] = (unsigned char)(mSnapshot.activeNotes[channel][i >> 2] >> ((i & 3) * 8));
+        }
+
+        unsigned char controllers = 0;
+        pos += kJournalChannelSize;
+        for (unsigned int controller = 0; controller < kFirstChannelModeController; controller++)
+        {
+            if (mControllerSeq[channel][controller] <= mCheckpoint)
+            {
+                continue;
+            }
+
+            if (pos + 2 > size)
+            {
+                return 0;
+            }
+
+            data[pos++] = (unsigned char)controller;
+            data[pos++] = mSnapshot.controllers[channel][controller];
+            controllers++;
+        }
+
+        chapter[20] = controllers;
+        channels++;
+    }
+
+    if (channels == 0)
+    {
+        return 0;
+    }
+
+    data[0] = channels;
+    return pos;
+}
+
+void WinRTMidiRtpJournal::Recover(const unsigned char* journal, unsigned int size, const WinRTMidiChannelStateSnapshot& state, const WinRTMidiChannelState::MessageFunc& func)
+{
+    if (size < 1)
+    {
+        return;
+    }
+
+    unsigned int channels = journal[0];
+    unsigned int pos = 1;
+    for (unsigned int i = 0; i < channels; i++)
+    {
+        if (pos + kJournalChannelSize > size)
+        {
+            return;
+        }
+
+        const unsigned char* chapter = journal + pos;
+        unsigned char channel = chapter[0] & 0x0F;
+        unsigned int controllers = chapter[20];
+        pos += kJournalChannelSize;
+        if (pos + controllers * 2 > size)
+        {
+            return;
+        }
+
+        // controllers first so a released sustain pedal is applied before the note offs
+        for (unsigned int c = 0; c < controllers; c++)
+        {
+            unsigned char controller = journal[pos + c * 2] & 0x7F;
+            unsigned char value = journal[pos + c * 2 + 1] & 0x7F;
+            if (controller < kFirstChannelModeController && state.controllers[channel][controller] != value)
+            {
+                unsigned char message[3] = { (unsigned char)(0xB0 | channel), controller, value };
+                func(message, 3);
+            }
+        }
+        pos += controllers * 2;
+
+        if (state.programs[channel] != chapter[1])
+        {
+            unsigned char message[2] = { (unsigned char)(0xC0 | channel), (unsigned char)(chapter[1] & 0x7F) };
+            func(message, 2);
+        }
+
+        unsigned short pitchBend = (chapter[2] & 0x7F) | ((chapter[3] & 0x7F) << 7);
+        if (state.pitchBend[channel] != pitchBend)
+        {
+            unsigned char message[3] = { (unsigned char)(0xE0 | channel), (unsigned char)(chapter[2] & 0x7F), (unsigned char)(chapter[3] & 0x7F) };
+            func(message, 3);
+        }
+
+        for (unsigned int note = 0; note < 128; note++)
+        {
+            bool receiverOn = (state.activeNotes[channel][note >> 5] & (1u << (note & 31))) != 0;
+            bool senderOn = (chapter[4 + (note >> 3)] & (1u << (note & 7))) != 0;
+            if (receiverOn && !senderOn)
+            {
+                unsigned char message[3] = { (unsigned char)(0x80 | channel), (unsigned char)note, 64 };
+                func(message, 3);
+            }
+        }
+    }
+}
+
+/*****************************************************
+    WinRTMidiRtpPacket
+*****************************************************/
+
+WinRTMidiRtpPacket::WinRTMidiRtpPacket()
+    : mSize(kRtpHeaderSize + kRtpCommandHeaderSize)
+    , mTimestamp(0)
+    , mSequence(0)
+{
+}
+
+void WinRTMidiRtpPacket::Begin(unsigned short sequence, unsigned int timestamp, unsigned int ssrc)
+{
+    mData[0] = 0x80; // version 2, no padding, extension or CSRC
+    mData[1] = kRtpPayloadType;
+    WriteBigEndian16(mData + 2, sequence);
+    WriteBigEndian32(mData + 4, timestamp);
+    WriteBigEndian32(mData + 8, ssrc);
+    mSize = kRtpHeaderSize + kRtpCommandHeaderSize;
+    mTimestamp = timestamp;
+    mSequence = sequence;
+}
+
+unsigned int WinRTMidiRtpPacket::Add(unsigned int delta, const unsigned char* message, unsigned int nBytes)
+{
+    unsigned int used = mSize - kRtpHeaderSize - kRtpCommandHeaderSize;
+    unsigned int deltaSize = GetVarLenSize(delta);
+
+    // kRtpMaxCommandSize needs at most 2 bytes for the length
+    if (used + deltaSize + 2 >= kRtpMaxCommandSize || nBytes == 0)
+    {
+        return 0;
+    }
+
+    unsigned int length = std::min(nBytes, kRtpMaxCommandSize - used - deltaSize - 2);
+
+    // only messages too large for an empty packet are split
+    if (length < nBytes && nBytes <= kRtpMaxUnsplitSize)
+    {
+        return 0;
+    }
+
+    mSize += WriteVarLen(mData + mSize, delta);
+    mSize += WriteVarLen(mData + mSize, length);
+    memcpy(mData + mSize, message, length);
+    mSize += length;
+    return length;
+}
+
+unsigned int WinRTMidiRtpPacket::Finish(WinRTMidiRtpJournal* journal)
+{
+    unsigned int length = mSize - kRtpHeaderSize - kRtpCommandHeaderSize;
+    unsigned char flags = kRtpFlagLongHeader | kRtpFlagFirstDelta;
+
+    if (journal)
+    {
+        unsigned int journalSize = journal->Write(mData + mSize, kRtpMaxPacketSize - mSize);
+        if (journalSize > 0)
+        {
+            flags |= kRtpFlagJournal;
+            mSize += journalSize;
+        }
+    }
+
+    mData[kRtpHeaderSize] = flags | (unsigned char)((length >> 8) & 0x0F);
+    mData[kRtpHeaderSize + 1] = (unsigned char)length;
+    return mSize;
+}
+
+bool WinRTMidiRtpPacket::Parse(const unsigned char* data, unsigned int size, WinRTMidiRtpPacketInfo& info)
+{
+    if (size < kRtpHeaderSize + 1 || data[0] != 0x80 || (data[1] & 0x7F) != kRtpPayloadType)
+    {
+        return false;
+    }
+
+    info.sequence = (unsigned short)ReadBigEndian16(data + 2);
+    info.timestamp = ReadBigEndian32(data + 4);
+    info.ssrc = ReadBigEndian32(data + 8);
+
+    unsigned char flags = data[kRtpHeaderSize];
+    unsigned int pos = kRtpHeaderSize + 1;
+    unsigned int length = flags & 0x0F;
+    if (flags & kRtpFlagLongHeader)
+    {
+        if (size < kRtpHeaderSize + 2)
+        {
+            return false;
+        }
+
+        length = (length << 8) | data[pos++];
+    }
+
+    // every command must carry a delta time
+    if (pos + length > size || (length > 0 && (flags & kRtpFlagFirstDelta) == 0))
+    {
+        return false;
+    }
+
+    info.commands = data + pos;
+    info.commandSize = length;
+    info.journal = nullptr;
+    info.journalSize = 0;
+
+    pos += length;
+    if (flags & kRtpFlagJournal)
+    {
+        if (pos >= size)
+        {
+            return false;
+        }
+
+        info.journal = data + pos;
+        info.journalSize = size - pos;
+    }
+
+    return true;
+}
+
+bool WinRTMidiRtpPacket::ForEachCommand(const unsigned char* commands, unsigned int size, const CommandFunc& func)
+{
+    unsigned int pos = 0;
+    while (pos < size)
+    {
+        unsigned int delta;
+        unsigned int length;
+        if (!ReadVarLen(commands, size, pos, delta) || !ReadVarLen(commands, size, pos, length))
+        {
+            return false;
+        }
+
+        if (length == 0 || length > size - pos)
+        {
+            return false;
+        }
+
+        func(delta, commands + pos, length);
+        pos += length;
+    }
+
+    return true;
+}
+
+void WinRTMidiRtpPacket::WriteFeedback(unsigned char* data, unsigned int ssrc, unsigned short sequence)
+{
+    // same layout as the receiver feedback of the AppleMIDI session protocol
+    data[0] = 0xFF;
+    data[1] = 0xFF;
+    data[2] = 'R';
+    data[3] = 'S';
+    WriteBigEndian32(data + 4, ssrc);
+    WriteBigEndian16(data + 8, sequence);
+    data[10] = 0;
+    data[11] = 0;
+}
+
+bool WinRTMidiRtpPacket::ParseFeedback(const unsigned char* data, unsigned int size, unsigned int& ssrc, unsigned short& sequence)
+{
+    if (size < kRtpFeedbackSize || data[0] != 0xFF || data[1] != 0xFF || data[2] != 'R' || data[3] != 'S')
+    {
+        return false;
+    }
+
+    ssrc = ReadBigEndian32(data + 4);
+    sequence = (unsigned short)ReadBigEndian16(data + 8);
+    return true;
+}
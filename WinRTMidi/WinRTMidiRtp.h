@@ -0,0 +1,123 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiChannelState.h"
+#include <functional>
+
+namespace WinRT
+{
+    #define kRtpHeaderSize 12
+    #define kRtpMaxPacketSize 1400          // stays below the Ethernet MTU
+    #define kRtpMaxCommandSize 512          // the rest of a packet is left for the journal
+    #define kRtpMaxUnsplitSize (kRtpMaxCommandSize - 8)
+    #define kRtpPayloadType 97
+    #define kRtpClockRate 10000             // timestamps and delta times are in 100 microsecond units
+    #define kRtpFeedbackSize 12
+
+    struct WinRTMidiRtpPacketInfo
+    {
+        unsigned short sequence;
+        unsigned int timestamp;
+        unsigned int ssrc;
+        const unsigned char* commands;
+        unsigned int commandSize;
+        const unsigned char* journal;       // nullptr if the packet has no journal
+        unsigned int journalSize;
+    };
+
+    /**********************************************************************************
+    Sender side recovery journal. Records the channel state changed by the
+    packets that the receiver has not confirmed yet (see SetCheckpoint). A
+    receiver that detects a lost packet uses the journal of the next packet to
+    repair its state instead of waiting for a retransmission.
+
+    The journal is a simplified form of the RFC 6295 channel chapters: for each
+    changed channel it holds the program, the pitch bend, the active notes and
+    the controllers changed since the checkpoint.
+    **********************************************************************************/
+    class WinRTMidiRtpJournal
+    {
+    public:
+        WinRTMidiRtpJournal();
+
+        void Reset();
+
+        // records the state changed by a message sent in the packet with the extended sequence number seq
+        void Update(const unsigned char* message, unsigned int nBytes, unsigned int seq);
+
+        // the receiver has received all packets up to seq. Older changes are dropped from the journal
+        void SetCheckpoint(unsigned int seq);
+
+        // returns the size of the journal or 0 if nothing changed since the checkpoint or it does not fit
+        unsigned int Write(unsigned char* data, unsigned int size);
+
+        // Calls func with the messages that repair state, the state of a receiver that lost packets,
+        // using the journal of the packet following the lost ones. Notes turned on in lost packets are
+        // not replayed as they would sound late; notes turned off are released.
+        static void Recover(const unsigned char* journal, unsigned int size, const WinRTMidiChannelStateSnapshot& state, const WinRTMidiChannelState::MessageFunc& func);
+
+    private:
+        WinRTMidiChannelState mState;
+        WinRTMidiChannelStateSnapshot mSnapshot;
+        unsigned int mChannelSeq[16];
+        unsigned int mControllerSeq[16][128];
+        unsigned int mCheckpoint;
+    };
+
+    /**********************************************************************************
+    Builds and parses RTP MIDI packets: a 12 byte RTP header, a MIDI command
+    section with a long header and a delta time before every command, and an
+    optional journal. Unlike RFC 6295 each command is prefixed with its length
+    so messages can be split across packets without parsing them.
+    **********************************************************************************/
+    class WinRTMidiRtpPacket
+    {
+    public:
+        typedef std::function<void(unsigned int delta, const unsigned char* message, unsigned int nBytes)> CommandFunc;
+
+        WinRTMidiRtpPacket();
+
+        void Begin(unsigned short sequence, unsigned int timestamp, unsigned int ssrc);
+
+        // Adds a message delta clock units after the packet timestamp. Returns the number of bytes
+        // added: 0 if the message does not fit, less than nBytes if a message larger than
+        // kRtpMaxUnsplitSize was split.
+        unsigned int Add(unsigned int delta, const unsigned char* message, unsigned int nBytes);
+
+        // completes the packet and returns its size. journal may be nullptr
+        unsigned int Finish(WinRTMidiRtpJournal* journal);
+
+        bool IsEmpty() const { return mSize == kRtpHeaderSize + 2; };
+        unsigned int GetTimestamp() const { return mTimestamp; };
+        unsigned short GetSequence() const { return mSequence; };
+        const unsigned char* GetData() const { return mData; };
+
+        // returns false if data is not a valid RTP MIDI packet
+        static bool Parse(const unsigned char* data, unsigned int size, WinRTMidiRtpPacketInfo& info);
+
+        // returns false if the command section is malformed
+        static bool ForEachCommand(const unsigned char* commands, unsigned int size, const CommandFunc& func);
+
+        // receiver feedback: the receiver has received all packets of ssrc up to sequence
+        static void WriteFeedback(unsigned char* data, unsigned int ssrc, unsigned short sequence);
+        static bool ParseFeedback(const unsigned char* data, unsigned int size, unsigned int& ssrc, unsigned short& sequence);
+
+    private:
+        unsigned char mData[kRtpMaxPacketSize];
+        unsigned int mSize;
+        unsigned int mTimestamp;
+        unsigned short mSequence;
+    };
+};
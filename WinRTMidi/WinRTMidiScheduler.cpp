@@ -0,0 +1,327 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+
+#include "WinRTMidiScheduler.h"
+#include "WinRTMidiTime.h"
+#include <algorithm>
+
+using namespace WinRT;
+
+// orders the pending events as a min heap on tick, then scheduling order
+static bool IsLater(const WinRTMidiScheduledEvent& a, const WinRTMidiScheduledEvent& b)
+{
+    if (a.tick != b.tick)
+    {
+        return a.tick > b.tick;
+    }
+
+    return a.sequence > b.sequence;
+}
+
+WinRTMidiScheduler::WinRTMidiScheduler(const std::vector<WinRTMidiOutPort^>& ports, unsigned int ppq, double bpm)
+    : mPorts(ports)
+    , mTempoMap(ppq, bpm)
+    , mSequence(0)
+    , mStartTime(0.0)
+    , mPosition(0.0)
+    , mEventsSent(0)
+    , mTotalLateness(0)
+    , mMaxLateness(0)
+    , mPlaying(false)
+{
+    // the thread only allocates if more than kSchedulerBatchSize events are due at once
+    mBatch.reserve(kSchedulerBatchSize);
+}
+
+WinRTMidiScheduler::~WinRTMidiScheduler()
+{
+    Stop();
+}
+
+WinRTMidiErrorType WinRTMidiScheduler::Start()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mThread.joinable())
+    {
+        return WINRT_NO_ERROR;
+    }
+
+    {
+        std::lock_guard<std::mutex> stateLock(mStateMutex);
+        Rebase(mPosition);
+        mPlaying = true;
+    }
+
+    mTimer.Reset();
+    mThread = std::thread(&WinRTMidiScheduler::Run, this);
+    SetThreadPriority(mThread.native_handle(), THREAD_PRIORITY_TIME_CRITICAL);
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiScheduler::Stop()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (!mThread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> stateLock(mStateMutex);
+        mPosition = GetPositionTicks();
+        mPlaying = false;
+    }
+
+    mTimer.Cancel();
+    mThread.join();
+    AllNotesOff();
+}
+
+void WinRTMidiScheduler::Seek(unsigned long long tick)
+{
+    bool playing;
+
+    {
+        std::lock_guard<std::mutex> lock(mStateMutex);
+        auto end = std::remove_if(mEvents.begin(), mEvents.end(), [tick](const WinRTMidiScheduledEvent& event) {
+            return event.tick < tick;
+        });
+        mEvents.erase(end, mEvents.end());
+        std::make_heap(mEvents.begin(), mEvents.end(), IsLater);
+
+        mPosition = (double)tick;
+        playing = mPlaying.load();
+        if (playing)
+        {
+            Rebase(mPosition);
+        }
+    }
+
+    if (playing)
+    {
+        mTimer.Cancel();
+        AllNotesOff();
+    }
+}
+
+WinRTMidiErrorType WinRTMidiScheduler::Schedule(unsigned int port, unsigned long long tick, const unsigned char* message, unsigned int nBytes)
+{
+    if (message == nullptr || nBytes == 0 || port >= mPorts.size())
+    {
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    bool wake;
+
+    {
+        std::lock_guard<std::mutex> lock(mStateMutex);
+        mEvents.emplace_back();
+        WinRTMidiScheduledEvent& event = mEvents.back();
+        event.tick = tick;
+        event.sequence = mSequence++;
+        event.port = port;
+        event.nBytes = nBytes;
+        if (nBytes > kMidiInlineBytes)
+        {
+            event.heapData.assign(message, message + nBytes);
+        }
+        else
+        {
+            memcpy(event.inlineData, message, nBytes);
+        }
+
+        std::push_heap(mEvents.begin(), mEvents.end(), IsLater);
+
+        // the thread only needs a new deadline if this is now the earliest event
+        wake = mPlaying && mEvents.front().sequence == mSequence - 1;
+    }
+
+    if (wake)
+    {
+        mTimer.Cancel();
+    }
+
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiScheduler::Clear()
+{
+    std::lock_guard<std::mutex> lock(mStateMutex);
+    mEvents.clear();
+}
+
+WinRTMidiErrorType WinRTMidiScheduler::SetTempo(unsigned long long tick, double bpm)
+{
+    if (!(bpm >= kMinSchedulerTempo && bpm <= kMaxSchedulerTempo))
+    {
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    bool playing;
+
+    {
+        std::lock_guard<std::mutex> lock(mStateMutex);
+        double position = GetPositionTicks();
+        mTempoMap.SetTempo(tick, bpm);
+        playing = mPlaying.load();
+        if (playing)
+        {
+            Rebase(position);
+        }
+    }
+
+    if (playing)
+    {
+        mTimer.Cancel();
+    }
+
+    return WINRT_NO_ERROR;
+}
+
+WinRTMidiErrorType WinRTMidiScheduler::RemoveTempo(unsigned long long tick)
+{
+    bool playing;
+
+    {
+        std::lock_guard<std::mutex> lock(mStateMutex);
+        double position = GetPositionTicks();
+        if (!mTempoMap.RemoveTempo(tick))
+        {
+            return WINRT_INVALID_PARAMETER_ERROR;
+        }
+
+        playing = mPlaying.load();
+        if (playing)
+        {
+            Rebase(position);
+        }
+    }
+
+    if (playing)
+    {
+        mTimer.Cancel();
+    }
+
+    return WINRT_NO_ERROR;
+}
+
+double WinRTMidiScheduler::GetPosition()
+{
+    std::lock_guard<std::mutex> lock(mStateMutex);
+    return GetPositionTicks();
+}
+
+double WinRTMidiScheduler::GetTempo()
+{
+    std::lock_guard<std::mutex> lock(mStateMutex);
+    return mTempoMap.GetTempo(GetPositionTicks());
+}
+
+void WinRTMidiScheduler::GetStats(WinRTMidiSchedulerStats& stats)
+{
+    std::lock_guard<std::mutex> lock(mStateMutex);
+    stats.eventsSent = mEventsSent;
+    stats.eventsPending = mEvents.size();
+    stats.averageLateness = mEventsSent > 0 ? mTotalLateness * .001 / mEventsSent : 0.0;
+    stats.maxLateness = mMaxLateness * .001;
+}
+
+double WinRTMidiScheduler::GetPositionTicks()
+{
+    if (mPlaying)
+    {
+        return mTempoMap.TimeToTick(std::max(0.0, GetTimeMicroseconds() - mStartTime));
+    }
+
+    return mPosition;
+}
+
+long long WinRTMidiScheduler::GetEventTime(const WinRTMidiScheduledEvent& event)
+{
+    return (long long)(mStartTime + mTempoMap.TickToTime((double)event.tick));
+}
+
+void WinRTMidiScheduler::Rebase(double position)
+{
+    // moves tick 0 so position plays right now with the current tempo map
+    mStartTime = GetTimeMicroseconds() - mTempoMap.TickToTime(position);
+}
+
+void WinRTMidiScheduler::Run()
+{
+    while (mPlaying)
+    {
+        long long deadline;
+
+        {
+            std::lock_guard<std::mutex> lock(mStateMutex);
+            deadline = GetTimeMicroseconds() + kSchedulerIdleWait;
+            if (!mEvents.empty())
+            {
+                deadline = std::min(deadline, GetEventTime(mEvents.front()));
+            }
+        }
+
+        if (!mTimer.WaitUntil(deadline))
+        {
+            // woken by an edit or by Stop()
+            mTimer.Reset();
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mStateMutex);
+            long long now = GetTimeMicroseconds();
+            while (!mEvents.empty())
+            {
+                long long time = GetEventTime(mEvents.front());
+                if (time > now)
+                {
+                    break;
+                }
+
+                long long lateness = now - time;
+                mTotalLateness += lateness;
+                mMaxLateness = std::max(mMaxLateness, lateness);
+                mEventsSent++;
+
+                std::pop_heap(mEvents.begin(), mEvents.end(), IsLater);
+                mBatch.push_back(std::move(mEvents.back()));
+                mEvents.pop_back();
+            }
+        }
+
+        for (const auto& event : mBatch)
+        {
+            mPorts[event.port]->Send(event.GetData(), event.nBytes);
+        }
+
+        mBatch.clear();
+    }
+}
+
+void WinRTMidiScheduler::AllNotesOff()
+{
+    for (auto port : mPorts)
+    {
+        for (unsigned char channel = 0; channel < 16; channel++)
+        {
+            unsigned char sustainOff[3] = { (unsigned char)(0xB0 | channel), 64, 0 };
+            unsigned char allNotesOff[3] = { (unsigned char)(0xB0 | channel), 123, 0 };
+            port->Send(sustainOff, 3);
+            port->Send(allNotesOff, 3);
+        }
+    }
+}
@@ -0,0 +1,121 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiImpl.h"
+#include "WinRTMidiMessage.h"
+#include "WinRTMidiTempoMap.h"
+#include "WinRTMidiTimer.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WinRT
+{
+    #define kSchedulerIdleWait 100000       // microseconds the thread sleeps with nothing scheduled
+    #define kSchedulerBatchSize 256         // events released at once before the batch grows
+
+    // MIDI message waiting in the scheduler. Messages larger than kMidiInlineBytes
+    // are copied to heapData.
+    struct WinRTMidiScheduledEvent
+    {
+        unsigned long long tick;
+        unsigned long long sequence;        // keeps events at the same tick in scheduling order
+        unsigned int port;
+        unsigned int nBytes;
+        unsigned char inlineData[kMidiInlineBytes];
+        std::vector<unsigned char> heapData;
+
+        const unsigned char* GetData() const {
+            return nBytes > kMidiInlineBytes ? heapData.data() : inlineData;
+        };
+    };
+
+    /**********************************************************************************
+    Sends MIDI messages scheduled at positions in ticks to one or more midi out
+    ports. Events for port n are sent to ports[n]. Ticks are
+    converted to time with an editable tempo map, so tempo changes apply to the
+    events already scheduled: pending events are kept in a min heap ordered by
+    tick, and only the time of the earliest one is computed when the thread
+    goes to sleep.
+
+    Events are sent from a time critical thread that waits on a high resolution
+    timer. Scheduling an earlier event, editing the tempo map or seeking wakes
+    the thread so it recomputes its deadline. Events scheduled before the
+    current position are sent immediately.
+
+    Stop() and seeking while playing silence all channels of all ports
+    (sustain off and all notes off).
+    **********************************************************************************/
+    class WinRTMidiScheduler
+    {
+    public:
+        WinRTMidiScheduler(const std::vector<WinRTMidiOutPort^>& ports, unsigned int ppq, double bpm);
+        ~WinRTMidiScheduler();
+
+        WinRTMidiErrorType Start();
+        void Stop();
+
+        // drops the pending events before tick
+        void Seek(unsigned long long tick);
+
+        WinRTMidiErrorType Schedule(unsigned int port, unsigned long long tick, const unsigned char* message, unsigned int nBytes);
+        void Clear();
+
+        WinRTMidiErrorType SetTempo(unsigned long long tick, double bpm);
+        WinRTMidiErrorType RemoveTempo(unsigned long long tick);
+
+        // ticks from tick 0
+        double GetPosition();
+
+        // beats per minute at the current position
+        double GetTempo();
+
+        void GetStats(WinRTMidiSchedulerStats& stats);
+        bool IsPlaying() { return mPlaying.load(); };
+
+    private:
+        void Run();
+        void AllNotesOff();
+
+        // the following are called with mStateMutex held
+        double GetPositionTicks();
+        long long GetEventTime(const WinRTMidiScheduledEvent& event);
+        void Rebase(double position);
+
+        std::vector<WinRTMidiOutPort^> mPorts;
+
+        // guards the tempo map, the pending events and the time base
+        std::mutex mStateMutex;
+        WinRTMidiTempoMap mTempoMap;
+        std::vector<WinRTMidiScheduledEvent> mEvents;
+        unsigned long long mSequence;
+        double mStartTime;                  // microseconds (see GetTimeMicroseconds) of tick 0
+        double mPosition;                   // ticks, valid while stopped
+        unsigned long long mEventsSent;
+        long long mTotalLateness;           // microseconds
+        long long mMaxLateness;             // microseconds
+
+        // events taken from mEvents by the thread and sent without the lock
+        std::vector<WinRTMidiScheduledEvent> mBatch;
+
+        // guards starting and stopping the thread
+        std::mutex mMutex;
+        WinRTMidiTimer mTimer;
+        std::thread mThread;
+        std::atomic<bool> mPlaying;
+    };
+};
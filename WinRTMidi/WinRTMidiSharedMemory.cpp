@@ -0,0 +1,231 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiSharedMemory.h"
+
+#ifdef _WIN32
+#include "WinRTMidiFile.h"
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace WinRT;
+
+WinRTMidiSharedMemory::WinRTMidiSharedMemory()
+    : mData(nullptr)
+    , mSize(0)
+#ifdef _WIN32
+    , mMapping(NULL)
+#else
+    , mFd(-1)
+    , mOwner(false)
+#endif
+{
+}
+
+WinRTMidiSharedMemory::~WinRTMidiSharedMemory()
+{
+    Close();
+}
+
+#ifdef _WIN32
+
+static std::wstring GetMappingName(const std::string& name)
+{
+    return L"Local\\WinRTMidi." + Utf8ToWString(name.c_str());
+}
+
+WinRTMidiErrorType WinRTMidiSharedMemory::Create(const std::string& name, size_t size)
+{
+    unsigned long long size64 = size;
+    mMapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)(size64 >> 32), (DWORD)size64, GetMappingName(name).c_str());
+    if (mMapping == NULL)
+    {
+        return WINRT_MEMORY_ERROR;
+    }
+
+    // another process already owns the name
+    if (GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        Close();
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    mData = MapViewOfFile(mMapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (mData == nullptr)
+    {
+        Close();
+        return WINRT_MEMORY_ERROR;
+    }
+
+    // paging file backed mappings are zero filled
+    mSize = size;
+    return WINRT_NO_ERROR;
+}
+
+WinRTMidiErrorType WinRTMidiSharedMemory::Open(const std::string& name, size_t size)
+{
+    mMapping = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, GetMappingName(name).c_str());
+    if (mMapping == NULL)
+    {
+        return WINRT_OPEN_PORT_ERROR;
+    }
+
+    mData = MapViewOfFile(mMapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if (mData == nullptr || VirtualQuery(mData, &info, sizeof(info)) == 0 || info.RegionSize < size)
+    {
+        Close();
+        return WINRT_OPEN_PORT_ERROR;
+    }
+
+    mSize = size;
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiSharedMemory::Close()
+{
+    if (mData)
+    {
+        UnmapViewOfFile(mData);
+        mData = nullptr;
+    }
+
+    if (mMapping)
+    {
+        CloseHandle(mMapping);
+        mMapping = NULL;
+    }
+
+    mSize = 0;
+}
+
+#else
+
+// The creator holds an exclusive lock until it closes the object. The lock is released
+// when a process ends, so an object that can be locked was left behind by a crash
+static bool IsStaleObject(const std::string& objectName)
+{
+    int fd = shm_open(objectName.c_str(), O_RDWR, 0);
+    if (fd < 0)
+    {
+        // removed in the meantime
+        return errno == ENOENT;
+    }
+
+    bool stale = flock(fd, LOCK_EX | LOCK_NB) == 0;
+    close(fd);
+    return stale;
+}
+
+WinRTMidiErrorType WinRTMidiSharedMemory::Create(const std::string& name, size_t size)
+{
+    std::string objectName = "/WinRTMidi." + name;
+    int fd = shm_open(objectName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 && errno == EEXIST && IsStaleObject(objectName))
+    {
+        shm_unlink(objectName.c_str());
+        fd = shm_open(objectName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+
+    if (fd < 0)
+    {
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    // without flock support the object is never treated as stale
+    flock(fd, LOCK_EX | LOCK_NB);
+
+    // a new object is zero filled
+    if (ftruncate(fd, (off_t)size) != 0)
+    {
+        close(fd);
+        shm_unlink(objectName.c_str());
+        return WINRT_MEMORY_ERROR;
+    }
+
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED)
+    {
+        close(fd);
+        shm_unlink(objectName.c_str());
+        return WINRT_MEMORY_ERROR;
+    }
+
+    mData = data;
+    mSize = size;
+    mName = objectName;
+    mFd = fd;
+    mOwner = true;
+    return WINRT_NO_ERROR;
+}
+
+WinRTMidiErrorType WinRTMidiSharedMemory::Open(const std::string& name, size_t size)
+{
+    std::string objectName = "/WinRTMidi." + name;
+    int fd = shm_open(objectName.c_str(), O_RDWR, 0);
+    if (fd < 0)
+    {
+        return WINRT_OPEN_PORT_ERROR;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < size)
+    {
+        close(fd);
+        return WINRT_OPEN_PORT_ERROR;
+    }
+
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return WINRT_OPEN_PORT_ERROR;
+    }
+
+    mData = data;
+    mSize = size;
+    mName = objectName;
+    mOwner = false;
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiSharedMemory::Close()
+{
+    if (mData)
+    {
+        munmap(mData, mSize);
+        mData = nullptr;
+    }
+
+    if (mOwner)
+    {
+        shm_unlink(mName.c_str());
+        mOwner = false;
+    }
+
+    // releases the lock after the name is gone
+    if (mFd >= 0)
+    {
+        close(mFd);
+        mFd = -1;
+    }
+
+    mSize = 0;
+}
+
+#endif
@@ -0,0 +1,62 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include <cstddef>
+#include <string>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+namespace WinRT
+{
+    /**********************************************************************************
+    Named shared memory block. On Windows this is a paging file backed file
+    mapping in the session namespace, elsewhere a POSIX shared memory object.
+    The creator owns the name: a POSIX object is unlinked when its creator
+    closes it. The creator also holds a lock on the object while it is open,
+    so an object left behind by a creator that crashed is detected by Create()
+    and replaced.
+    **********************************************************************************/
+    class WinRTMidiSharedMemory
+    {
+    public:
+        WinRTMidiSharedMemory();
+        ~WinRTMidiSharedMemory();
+
+        // creates a zero filled block. name may only contain characters valid in a file name
+        WinRTMidiErrorType Create(const std::string& name, size_t size);
+
+        // opens a block created by another process. Fails if it is smaller than size
+        WinRTMidiErrorType Open(const std::string& name, size_t size);
+
+        void Close();
+
+        void* GetData() { return mData; };
+        size_t GetSize() { return mSize; };
+
+    private:
+        void* mData;
+        size_t mSize;
+
+#ifdef _WIN32
+        HANDLE mMapping;
+#else
+        std::string mName;
+        int mFd;                    // kept open by the creator to hold the lock
+        bool mOwner;
+#endif
+    };
+};
@@ -0,0 +1,287 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiSharedRing.h"
+#include <cstring>
+
+using namespace WinRT;
+
+WinRTMidiSharedRing::WinRTMidiSharedRing()
+    : mHeader(nullptr)
+    , mData(nullptr)
+    , mCapacity(0)
+{
+}
+
+static uint32_t GetRingCapacity(unsigned int capacity)
+{
+    uint32_t size = 1024;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    return size;
+}
+
+size_t WinRTMidiSharedRing::GetMemorySize(unsigned int capacity)
+{
+    return sizeof(WinRTMidiSharedRingHeader) + GetRingCapacity(capacity);
+}
+
+bool WinRTMidiSharedRing::Initialize(void* memory, size_t size, WinRTMidiSharedRingType type)
+{
+    if (memory == nullptr || size <= sizeof(WinRTMidiSharedRingHeader))
+    {
+        return false;
+    }
+
+    // the largest power of 2 that fits
+    uint32_t capacity = GetRingCapacity(0);
+    while (sizeof(WinRTMidiSharedRingHeader) + (size_t)capacity * 2 <= size)
+    {
+        capacity <<= 1;
+    }
+
+    if (sizeof(WinRTMidiSharedRingHeader) + capacity > size)
+    {
+        return false;
+    }
+
+    mHeader = (WinRTMidiSharedRingHeader*)memory;
+    mData = (unsigned char*)memory + sizeof(WinRTMidiSharedRingHeader);
+    mCapacity = capacity;
+
+    mHeader->type = type;
+    mHeader->capacity = capacity;
+    mHeader->version = kSharedRingVersion;
+    mHeader->writePos.store(0, std::memory_order_relaxed);
+    mHeader->readPos.store(0, std::memory_order_relaxed);
+
+    // the magic number is written last: the ring can be attached to from now on
+    std::atomic_thread_fence(std::memory_order_release);
+    mHeader->magic = kSharedRingMagic;
+    return true;
+}
+
+bool WinRTMidiSharedRing::Attach(void* memory, size_t size, WinRTMidiSharedRingType type)
+{
+    WinRTMidiSharedRingHeader* header = (WinRTMidiSharedRingHeader*)memory;
+    if (memory == nullptr || size < sizeof(WinRTMidiSharedRingHeader) || header->magic != kSharedRingMagic)
+    {
+        return false;
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->version != kSharedRingVersion || header->type != (uint32_t)type ||
+        (header->capacity & (header->capacity - 1)) != 0 || sizeof(WinRTMidiSharedRingHeader) + header->capacity > size)
+    {
+        return false;
+    }
+
+    mHeader = header;
+    mData = (unsigned char*)memory + sizeof(WinRTMidiSharedRingHeader);
+    mCapacity = header->capacity;
+    return true;
+}
+
+/*****************************************************
+    WinRTMidiBroadcastRing
+*****************************************************/
+
+bool WinRTMidiBroadcastRing::Write(long long time, const unsigned char* message, unsigned int nBytes)
+{
+    if (nBytes == 0 || nBytes > GetMaxMessageSize())
+    {
+        return false;
+    }
+
+    uint32_t size = GetRecordSize(nBytes);
+    uint64_t pos = mHeader->writePos.load(std::memory_order_relaxed);
+    uint32_t offset = (uint32_t)(pos & (mCapacity - 1));
+
+    if (offset + size > mCapacity)
+    {
+        GetRecord(pos)->length.store(kSharedRingPadding, std::memory_order_relaxed);
+        pos += mCapacity - offset;
+    }
+
+    WinRTMidiSharedRecord* record = GetRecord(pos);
+    record->time = time;
+    memcpy((unsigned char*)(record + 1), message, nBytes);
+    record->length.store(nBytes, std::memory_order_relaxed);
+
+    // publishes the record (and the padding) to the readers
+    mHeader->writePos.store(pos + size, std::memory_order_release);
+    return true;
+}
+
+void WinRTMidiBroadcastRing::InitReader(Reader& reader)
+{
+    reader.pos = mHeader->writePos.load(std::memory_order_acquire);
+    reader.lost = 0;
+}
+
+const unsigned char* WinRTMidiBroadcastRing::Read(Reader& reader, long long& time, unsigned int& nBytes)
+{
+    for (;;)
+    {
+        uint64_t writePos = mHeader->writePos.load(std::memory_order_acquire);
+        if (writePos == reader.pos)
+        {
+            return nullptr;
+        }
+
+        // a reader must stay a maximum record size ahead of the writer, so the
+        // record it returns is not being overwritten
+        if (writePos - reader.pos > mCapacity - GetRecordSize(GetMaxMessageSize()))
+        {
+            // overrun: the records at the reader position have been or are being overwritten
+            reader.lost++;
+            reader.pos = writePos;
+            return nullptr;
+        }
+
+        WinRTMidiSharedRecord* record = GetRecord(reader.pos);
+        uint32_t length = record->length.load(std::memory_order_relaxed);
+        if (length == kSharedRingPadding)
+        {
+            reader.pos += mCapacity - (uint32_t)(reader.pos & (mCapacity - 1));
+            continue;
+        }
+
+        if (length == 0 || length > GetMaxMessageSize())
+        {
+            // torn read while being overrun
+            reader.lost++;
+            reader.pos = writePos;
+            return nullptr;
+        }
+
+        time = record->time;
+        nBytes = length;
+        reader.pos += GetRecordSize(length);
+        return (const unsigned char*)(record + 1);
+    }
+}
+
+bool WinRTMidiBroadcastRing::Read(Reader& reader, long long& time, unsigned char* buffer, unsigned int& nBytes)
+{
+    const unsigned char* message = Read(reader, time, nBytes);
+    if (message == nullptr)
+    {
+        return false;
+    }
+
+    uint64_t recordPos = reader.pos - GetRecordSize(nBytes);
+    memcpy(buffer, message, nBytes);
+
+    // the copy is complete before the write position is checked again. If the writer has moved
+    // past the limit, it may have overwritten the record during the copy
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t writePos = mHeader->writePos.load(std::memory_order_relaxed);
+    if (writePos - recordPos > mCapacity - GetRecordSize(GetMaxMessageSize()))
+    {
+        reader.lost++;
+        reader.pos = writePos;
+        return false;
+    }
+
+    return true;
+}
+
+/*****************************************************
+    WinRTMidiMpscRing
+*****************************************************/
+
+bool WinRTMidiMpscRing::Write(long long time, const unsigned char* message, unsigned int nBytes)
+{
+    if (nBytes == 0 || nBytes > GetMaxMessageSize())
+    {
+        return false;
+    }
+
+    uint32_t size = GetRecordSize(nBytes);
+    uint64_t pos = mHeader->writePos.load(std::memory_order_relaxed);
+    uint32_t padding;
+
+    // reserve the record and the padding in front of it, if any
+    for (;;)
+    {
+        uint32_t offset = (uint32_t)(pos & (mCapacity - 1));
+        padding = offset + size > mCapacity ? mCapacity - offset : 0;
+
+        uint64_t readPos = mHeader->readPos.load(std::memory_order_acquire);
+        if (pos + padding + size - readPos > mCapacity)
+        {
+            return false;
+        }
+
+        if (mHeader->writePos.compare_exchange_weak(pos, pos + padding + size, std::memory_order_relaxed))
+        {
+            break;
+        }
+    }
+
+    if (padding > 0)
+    {
+        GetRecord(pos)->length.store(kSharedRingPadding, std::memory_order_release);
+        pos += padding;
+    }
+
+    WinRTMidiSharedRecord* record = GetRecord(pos);
+    record->time = time;
+    memcpy((unsigned char*)(record + 1), message, nBytes);
+    record->length.store(nBytes, std::memory_order_release);
+    return true;
+}
+
+void WinRTMidiMpscRing::Clear(uint64_t pos, uint32_t size)
+{
+    // the whole record is cleared so a later record header at any offset starts as 0
+    memset(mData + (pos & (mCapacity - 1)), 0, size);
+    mHeader->readPos.store(pos + size, std::memory_order_release);
+}
+
+const unsigned char* WinRTMidiMpscRing::Peek(long long& time, unsigned int& nBytes)
+{
+    for (;;)
+    {
+        uint64_t pos = mHeader->readPos.load(std::memory_order_relaxed);
+        WinRTMidiSharedRecord* record = GetRecord(pos);
+        uint32_t length = record->length.load(std::memory_order_acquire);
+        if (length == 0)
+        {
+            return nullptr;
+        }
+
+        if (length == kSharedRingPadding)
+        {
+            Clear(pos, mCapacity - (uint32_t)(pos & (mCapacity - 1)));
+            continue;
+        }
+
+        time = record->time;
+        nBytes = length;
+        mPendingSize = GetRecordSize(length);
+        return (const unsigned char*)(record + 1);
+    }
+}
+
+void WinRTMidiMpscRing::Consume()
+{
+    if (mPendingSize > 0)
+    {
+        Clear(mHeader->readPos.load(std::memory_order_relaxed), mPendingSize);
+        mPendingSize = 0;
+    }
+}
@@ -0,0 +1,137 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace WinRT
+{
+    #define kSharedRingMagic 0x52535257     // 'WRSR'
+    #define kSharedRingVersion 1
+    #define kSharedRingPadding 0xFFFFFFFFu
+
+    enum WinRTMidiSharedRingType { SharedRingBroadcast = 1, SharedRingMpsc = 2 };
+
+    // The rings only contain offsets, so they can be mapped at different addresses in each process
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "shared rings need address free atomics");
+
+    struct WinRTMidiSharedRingHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t type;
+        uint32_t capacity;                      // data bytes, a power of 2
+        alignas(64) std::atomic<uint64_t> writePos;
+        alignas(64) std::atomic<uint64_t> readPos;  // only used by the MPSC ring
+    };
+
+    // records are 8 byte aligned and never wrap: a padding record fills the end of the ring instead
+    struct WinRTMidiSharedRecord
+    {
+        std::atomic<uint32_t> length;           // 0 while a MPSC record is being written
+        uint32_t reserved;
+        int64_t time;                           // microseconds
+    };
+
+    /**********************************************************************************
+    Byte rings of MIDI messages for shared memory. A ring is a header followed
+    by the data, and only uses offsets and lock-free atomics, so processes can
+    map it at different addresses. Neither ring waits: readers poll.
+    **********************************************************************************/
+    class WinRTMidiSharedRing
+    {
+    public:
+        WinRTMidiSharedRing();
+
+        // memory needed for a ring of capacity data bytes (rounded up to a power of 2)
+        static size_t GetMemorySize(unsigned int capacity);
+
+        // initializes a ring in zero filled memory
+        bool Initialize(void* memory, size_t size, WinRTMidiSharedRingType type);
+
+        // attaches to a ring initialized by another process
+        bool Attach(void* memory, size_t size, WinRTMidiSharedRingType type);
+
+        // largest message that can be written
+        unsigned int GetMaxMessageSize() { return mCapacity / 4; };
+
+    protected:
+        static uint32_t GetRecordSize(unsigned int nBytes) {
+            return (uint32_t)((sizeof(WinRTMidiSharedRecord) + nBytes + 7) & ~(size_t)7);
+        };
+
+        WinRTMidiSharedRecord* GetRecord(uint64_t pos) {
+            return (WinRTMidiSharedRecord*)(mData + (pos & (mCapacity - 1)));
+        };
+
+        WinRTMidiSharedRingHeader* mHeader;
+        unsigned char* mData;
+        uint32_t mCapacity;
+    };
+
+    /**********************************************************************************
+    Single writer, multiple reader ring. Every reader keeps its own position
+    and reads messages in place. The writer never waits for readers: a reader
+    that falls more than the ring size behind skips to the newest message and
+    counts the messages it lost. A message read in place stays intact only
+    until the writer has written another ring size of data, so a reader that
+    passes messages on to code it does not control copies them instead.
+    **********************************************************************************/
+    class WinRTMidiBroadcastRing : public WinRTMidiSharedRing
+    {
+    public:
+        struct Reader
+        {
+            uint64_t pos;
+            unsigned long long lost;    // number of times the reader was overrun
+        };
+
+        bool Write(long long time, const unsigned char* message, unsigned int nBytes);
+
+        // a new reader starts at the next message written
+        void InitReader(Reader& reader);
+
+        // returns nullptr if there is no new message
+        const unsigned char* Read(Reader& reader, long long& time, unsigned int& nBytes);
+
+        // copies the next message to buffer, which holds GetMaxMessageSize() bytes. Returns false if there
+        // is no new message or it was overwritten while it was copied, which counts as lost
+        bool Read(Reader& reader, long long& time, unsigned char* buffer, unsigned int& nBytes);
+    };
+
+    /**********************************************************************************
+    Multiple producer, single consumer ring. Producers reserve space with a
+    compare and swap on the write position and publish a record by storing
+    its length last. The consumer reads the oldest record in place, then
+    clears it and advances the read position, which frees the space.
+    **********************************************************************************/
+    class WinRTMidiMpscRing : public WinRTMidiSharedRing
+    {
+    public:
+        WinRTMidiMpscRing() : mPendingSize(0) {};
+
+        // returns false if the ring is full
+        bool Write(long long time, const unsigned char* message, unsigned int nBytes);
+
+        // consumer only. Returns the oldest message or nullptr, Consume() releases it
+        const unsigned char* Peek(long long& time, unsigned int& nBytes);
+        void Consume();
+
+    private:
+        void Clear(uint64_t pos, uint32_t size);
+
+        uint32_t mPendingSize;
+    };
+};
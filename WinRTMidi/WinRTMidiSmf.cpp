@@ -0,0 +1,320 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiSmf.h"
+#include <algorithm>
+#include <cstring>
+#include <queue>
+
+using namespace WinRT;
+
+#define kDefaultTempo 500000
+
+static unsigned int ReadBigEndian(const unsigned char* data, unsigned int nBytes)
+{
+    unsigned int value = 0;
+    for (unsigned int i = 0; i < nBytes; i++)
+    {
+        value = (value << 8) | data[i];
+    }
+
+    return value;
+}
+
+static bool ReadVariableLength(const unsigned char*& pos, const unsigned char* end, unsigned int& value)
+{
+    value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        if (pos >= end)
+        {
+            return false;
+        }
+
+        unsigned char b = *pos++;
+        value = (value << 7) | (b & 0x7F);
+        if ((b & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+WinRTMidiSmfTimeline::WinRTMidiSmfTimeline()
+    : mData(nullptr)
+    , mMaxSysExLength(0)
+    , mDivision(0)
+    , mMicrosecondsPerTick(0.0)
+    , mTempoTick(0)
+    , mTempoTime(0)
+    , mTempo(kDefaultTempo)
+{
+}
+
+WinRTMidiErrorType WinRTMidiSmfTimeline::Build(const unsigned char* data, size_t size)
+{
+    const unsigned char* end = data + size;
+
+    if (size < 14 || memcmp(data, "MThd", 4) != 0)
+    {
+        return WINRT_FILE_ERROR;
+    }
+
+    unsigned int headerLength = ReadBigEndian(data + 4, 4);
+    unsigned int numTracks = ReadBigEndian(data + 10, 2);
+    unsigned int division = ReadBigEndian(data + 12, 2);
+    if (headerLength < 6 || division == 0 || headerLength > size - 8)
+    {
+        return WINRT_FILE_ERROR;
+    }
+
+    mData = data;
+    mEvents.clear();
+    mSysEx.clear();
+    mTempoMap.clear();
+    mMaxSysExLength = 0;
+    mTempoTick = 0;
+    mTempoTime = 0;
+    mTempo = kDefaultTempo;
+    mTempoMap.push_back({ 0, 0, kDefaultTempo });
+
+    if (division & 0x8000)
+    {
+        // SMPTE frames per second and ticks per frame
+        int fps = -(signed char)(division >> 8);
+        double framesPerSecond = fps == 29 ? 29.97 : fps;
+        mMicrosecondsPerTick = 1000000.0 / (framesPerSecond * (division & 0xFF));
+        mDivision = 0;
+    }
+    else
+    {
+        mDivision = division;
+    }
+
+    // locate the track chunks
+    std::vector<TrackCursor> tracks;
+    const unsigned char* pos = data + 8 + headerLength;
+    while (tracks.size() < numTracks && end - pos >= 8)
+    {
+        size_t length = ReadBigEndian(pos + 4, 4);
+        const unsigned char* chunkEnd = (size_t)(end - pos - 8) < length ? end : pos + 8 + length;
+        if (memcmp(pos, "MTrk", 4) == 0)
+        {
+            TrackCursor track = { pos + 8, chunkEnd, 0, 0, 0 };
+            tracks.push_back(track);
+        }
+
+        // unknown chunks are skipped
+        pos = chunkEnd;
+    }
+
+    // k-way merge of the tracks ordered by tick, then by track number
+    auto later = [&tracks](unsigned int a, unsigned int b)
+    {
+        return tracks[a].tick != tracks[b].tick ? tracks[a].tick > tracks[b].tick : a > b;
+    };
+    std::priority_queue<unsigned int, std::vector<unsigned int>, decltype(later)> heap(later);
+
+    for (unsigned int i = 0; i < tracks.size(); i++)
+    {
+        unsigned int delta;
+        if (ReadVariableLength(tracks[i].pos, tracks[i].end, delta))
+        {
+            tracks[i].tick = delta;
+            heap.push(i);
+        }
+    }
+
+    while (!heap.empty())
+    {
+        unsigned int index = heap.top();
+        heap.pop();
+
+        TrackCursor& track = tracks[index];
+        unsigned int delta;
+        if (ParseEvent(track) && ReadVariableLength(track.pos, track.end, delta))
+        {
+            track.tick += delta;
+            heap.push(index);
+        }
+    }
+
+    return WINRT_NO_ERROR;
+}
+
+// returns false at the end of the track or if the track is corrupt
+bool WinRTMidiSmfTimeline::ParseEvent(TrackCursor& track)
+{
+    if (track.pos >= track.end)
+    {
+        return false;
+    }
+
+    unsigned char b = *track.pos;
+    unsigned int length;
+
+    if (b == 0xFF)
+    {
+        if (track.end - track.pos < 2)
+        {
+            return false;
+        }
+
+        unsigned char type = track.pos[1];
+        track.pos += 2;
+        if (!ReadVariableLength(track.pos, track.end, length) || length > (size_t)(track.end - track.pos))
+        {
+            return false;
+        }
+
+        const unsigned char* meta = track.pos;
+        track.pos += length;
+        track.runningStatus = 0;
+
+        switch (type)
+        {
+        case 0x2F:
+            return false;
+        case 0x51:
+            if (length >= 3)
+            {
+                SetTempo(track.tick, ReadBigEndian(meta, 3));
+            }
+            break;
+        case 0x21:
+            if (length >= 1)
+            {
+                track.port = meta[0];
+            }
+            break;
+        }
+
+        return true;
+    }
+
+    if (b == 0xF0 || b == 0xF7)
+    {
+        track.pos++;
+        if (!ReadVariableLength(track.pos, track.end, length) || length > (size_t)(track.end - track.pos))
+        {
+            return false;
+        }
+
+        WinRTMidiTimelineSysEx sysex = { (size_t)(track.pos - mData), length, b == 0xF0 };
+        WinRTMidiTimelineEvent event = { TickToTime(track.tick), (unsigned int)mSysEx.size(), track.port, kTimelineSysEx };
+        mSysEx.push_back(sysex);
+        mEvents.push_back(event);
+        mMaxSysExLength = std::max(mMaxSysExLength, length + 1);
+
+        track.pos += length;
+        track.runningStatus = 0;
+        return true;
+    }
+
+    unsigned char status;
+    if (b & 0x80)
+    {
+        // system common and realtime messages are not allowed in a track
+        if (b > 0xEF)
+        {
+            return false;
+        }
+
+        status = b;
+        track.runningStatus = b;
+        track.pos++;
+    }
+    else
+    {
+        status = track.runningStatus;
+        if (status == 0)
+        {
+            return false;
+        }
+    }
+
+    unsigned int nData = (status & 0xE0) == 0xC0 ? 1 : 2;
+    if ((size_t)(track.end - track.pos) < nData)
+    {
+        return false;
+    }
+
+    unsigned int message = status | (track.pos[0] << 8);
+    if (nData == 2)
+    {
+        message |= track.pos[1] << 16;
+    }
+
+    track.pos += nData;
+
+    WinRTMidiTimelineEvent event = { TickToTime(track.tick), message, track.port, (unsigned short)(nData + 1) };
+    mEvents.push_back(event);
+    return true;
+}
+
+long long WinRTMidiSmfTimeline::TickToTime(unsigned long long tick)
+{
+    if (mDivision == 0)
+    {
+        return (long long)(tick * mMicrosecondsPerTick);
+    }
+
+    return mTempoTime + (long long)((tick - mTempoTick) * mTempo / mDivision);
+}
+
+void WinRTMidiSmfTimeline::SetTempo(unsigned long long tick, unsigned int tempo)
+{
+    if (tempo == 0)
+    {
+        return;
+    }
+
+    mTempoTime = TickToTime(tick);
+    mTempoTick = tick;
+    mTempo = tempo;
+
+    if (mTempoMap.back().tick == tick)
+    {
+        mTempoMap.back().tempo = tempo;
+    }
+    else
+    {
+        mTempoMap.push_back({ tick, mTempoTime, tempo });
+    }
+}
+
+size_t WinRTMidiSmfTimeline::FindEvent(long long time)
+{
+    auto it = std::lower_bound(mEvents.begin(), mEvents.end(), time, [](const WinRTMidiTimelineEvent& event, long long t)
+    {
+        return event.time < t;
+    });
+
+    return it - mEvents.begin();
+}
+
+unsigned int WinRTMidiSmfTimeline::GetTempo(long long time)
+{
+    auto it = std::upper_bound(mTempoMap.begin(), mTempoMap.end(), time, [](long long t, const WinRTMidiTempoPoint& point)
+    {
+        return t < point.time;
+    });
+
+    return (it == mTempoMap.begin() ? it : it - 1)->tempo;
+}
+
+long long WinRTMidiSmfTimeline::GetDuration()
+{
+    return mEvents.empty() ? 0 : mEvents.back().time;
+}
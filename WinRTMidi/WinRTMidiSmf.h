@@ -0,0 +1,102 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include <cstddef>
+#include <vector>
+
+namespace WinRT
+{
+    #define kTimelineSysEx 0xFFFF
+
+    // 16 byte event of the merged timeline
+    struct WinRTMidiTimelineEvent
+    {
+        long long time;             // microseconds from the start of the file
+        unsigned int message;       // packed short message (status | data1 << 8 | data2 << 16) or SysEx index
+        unsigned short port;        // SMF port (meta event 0x21) of the track
+        unsigned short length;      // number of bytes of a short message or kTimelineSysEx
+    };
+
+    // SysEx data is not copied; it is referenced by its offset in the file
+    struct WinRTMidiTimelineSysEx
+    {
+        size_t offset;
+        unsigned int length;
+        bool addStatus;             // F0 event: the 0xF0 status byte is not stored in the file
+    };
+
+    struct WinRTMidiTempoPoint
+    {
+        unsigned long long tick;
+        long long time;             // microseconds
+        unsigned int tempo;         // microseconds per quarter note
+    };
+
+    /**********************************************************************************
+    Parses a Standard MIDI File (format 0, 1 or 2) in a single pass and merges all
+    tracks into one event timeline sorted by absolute time. Tracks are merged
+    with a k-way merge on their tick positions, so tempo changes are applied
+    in order while the timeline is being built. Meta events other than tempo,
+    port and end of track are dropped.
+    **********************************************************************************/
+    class WinRTMidiSmfTimeline
+    {
+    public:
+        WinRTMidiSmfTimeline();
+
+        // data must stay valid as long as SysEx events are accessed
+        WinRTMidiErrorType Build(const unsigned char* data, size_t size);
+
+        const std::vector<WinRTMidiTimelineEvent>& GetEvents() { return mEvents; };
+        const WinRTMidiTimelineSysEx& GetSysEx(unsigned int index) { return mSysEx[index]; };
+        const unsigned char* GetData() { return mData; };
+        unsigned int GetMaxSysExLength() { return mMaxSysExLength; };
+
+        // index of the first event at or after time
+        size_t FindEvent(long long time);
+
+        // tempo in microseconds per quarter note at time
+        unsigned int GetTempo(long long time);
+
+        long long GetDuration();
+
+    private:
+        struct TrackCursor
+        {
+            const unsigned char* pos;
+            const unsigned char* end;
+            unsigned long long tick;
+            unsigned short port;
+            unsigned char runningStatus;
+        };
+
+        bool ParseEvent(TrackCursor& track);
+        long long TickToTime(unsigned long long tick);
+        void SetTempo(unsigned long long tick, unsigned int tempo);
+
+        std::vector<WinRTMidiTimelineEvent> mEvents;
+        std::vector<WinRTMidiTimelineSysEx> mSysEx;
+        std::vector<WinRTMidiTempoPoint> mTempoMap;
+        const unsigned char* mData;
+        unsigned int mMaxSysExLength;
+
+        // timing state while building
+        unsigned int mDivision;
+        double mMicrosecondsPerTick;    // SMPTE time division only
+        unsigned long long mTempoTick;
+        long long mTempoTime;
+        unsigned int mTempo;
+    };
+};
@@ -0,0 +1,170 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiSysEx.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define WINRT_MIDI_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace WinRT;
+
+unsigned int WinRT::PackSysExScalar(const unsigned char* data, unsigned int nBytes, unsigned char* packed)
+{
+    unsigned char* out = packed;
+    while (nBytes > 0)
+    {
+        unsigned int count = nBytes < 7 ? nBytes : 7;
+        unsigned char highBits = 0;
+        for (unsigned int i = 0; i < count; i++)
+        {
+            highBits |= (data[i] >> 7) << i;
+            out[i + 1] = data[i] & 0x7F;
+        }
+
+        out[0] = highBits;
+        out += count + 1;
+        data += count;
+        nBytes -= count;
+    }
+
+    return (unsigned int)(out - packed);
+}
+
+unsigned int WinRT::UnpackSysExScalar(const unsigned char* packed, unsigned int nBytes, unsigned char* data)
+{
+    unsigned char* out = data;
+    while (nBytes > 1)
+    {
+        unsigned int count = nBytes - 1 < 7 ? nBytes - 1 : 7;
+        unsigned char highBits = packed[0];
+        for (unsigned int i = 0; i < count; i++)
+        {
+            out[i] = (packed[i + 1] & 0x7F) | (((highBits >> i) & 1) << 7);
+        }
+
+        out += count;
+        packed += count + 1;
+        nBytes -= count + 1;
+    }
+
+    return (unsigned int)(out - data);
+}
+
+unsigned char WinRT::RolandChecksumScalar(const unsigned char* data, unsigned int nBytes)
+{
+    unsigned int sum = 0;
+    for (unsigned int i = 0; i < nBytes; i++)
+    {
+        sum += data[i];
+    }
+
+    return (unsigned char)((128 - (sum & 0x7F)) & 0x7F);
+}
+
+#ifdef WINRT_MIDI_SSE2
+
+unsigned int WinRT::PackSysEx(const unsigned char* data, unsigned int nBytes, unsigned char* packed)
+{
+    const __m128i lowBits = _mm_set1_epi8(0x7F);
+    unsigned char* out = packed;
+
+    // two groups of 7 per iteration. 16 bytes are loaded, so 16 must be readable
+    while (nBytes >= 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)data);
+        unsigned int highBits = (unsigned int)_mm_movemask_epi8(v);
+        v = _mm_and_si128(v, lowBits);
+
+        // data[0 - 6] to out[1 - 7] and data[7 - 13] to out[9 - 15]. The header bytes are written afterwards
+        _mm_storel_epi64((__m128i*)out, _mm_slli_si128(v, 1));
+        _mm_storel_epi64((__m128i*)(out + 8), _mm_srli_si128(v, 6));
+        out[0] = (unsigned char)(highBits & 0x7F);
+        out[8] = (unsigned char)((highBits >> 7) & 0x7F);
+
+        out += 16;
+        data += 14;
+        nBytes -= 14;
+    }
+
+    return (unsigned int)(out - packed) + PackSysExScalar(data, nBytes, out);
+}
+
+unsigned int WinRT::UnpackSysEx(const unsigned char* packed, unsigned int nBytes, unsigned char* data)
+{
+    const __m128i lowBits = _mm_set1_epi8(0x7F);
+    const __m128i highBit = _mm_set1_epi8((char)0x80);
+    const __m128i bitMasks = _mm_set_epi8(64, 32, 16, 8, 4, 2, 1, 0, 64, 32, 16, 8, 4, 2, 1, 0);
+    unsigned char* out = data;
+
+    // two groups of 8 per iteration. The 15th byte written is overwritten by the
+    // next group, so at least one more group with data must follow
+    while (nBytes >= 18)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)packed);
+        __m128i headers = _mm_set_epi64x((long long)(packed[8] * 0x0101010101010101ull), (long long)(packed[0] * 0x0101010101010101ull));
+        __m128i set = _mm_cmpeq_epi8(_mm_and_si128(headers, bitMasks), bitMasks);
+        v = _mm_or_si128(_mm_and_si128(v, lowBits), _mm_and_si128(set, highBit));
+
+        // drop the header lanes 0 and 8
+        v = _mm_srli_si128(v, 1);
+        _mm_storel_epi64((__m128i*)out, v);
+        _mm_storel_epi64((__m128i*)(out + 7), _mm_srli_si128(v, 8));
+
+        out += 14;
+        packed += 16;
+        nBytes -= 16;
+    }
+
+    return (unsigned int)(out - data) + UnpackSysExScalar(packed, nBytes, out);
+}
+
+unsigned char WinRT::RolandChecksum(const unsigned char* data, unsigned int nBytes)
+{
+    __m128i sums = _mm_setzero_si128();
+    const __m128i zero = _mm_setzero_si128();
+    unsigned int i = 0;
+
+    // _mm_sad_epu8 adds 8 bytes into each 64 bit lane
+    for (; i + 16 <= nBytes; i += 16)
+    {
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(_mm_loadu_si128((const __m128i*)(data + i)), zero));
+    }
+
+    unsigned int sum = (unsigned int)_mm_cvtsi128_si32(sums) + (unsigned int)_mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+    for (; i < nBytes; i++)
+    {
+        sum += data[i];
+    }
+
+    return (unsigned char)((128 - (sum & 0x7F)) & 0x7F);
+}
+
+#else
+
+unsigned int WinRT::PackSysEx(const unsigned char* data, unsigned int nBytes, unsigned char* packed)
+{
+    return PackSysExScalar(data, nBytes, packed);
+}
+
+unsigned int WinRT::UnpackSysEx(const unsigned char* packed, unsigned int nBytes, unsigned char* data)
+{
+    return UnpackSysExScalar(packed, nBytes, data);
+}
+
+unsigned char WinRT::RolandChecksum(const unsigned char* data, unsigned int nBytes)
+{
+    return RolandChecksumScalar(data, nBytes);
+}
+
+#endif
@@ -0,0 +1,46 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+
+namespace WinRT
+{
+    /**********************************************************************************
+    SysEx data encoding helpers.
+
+    8 bit data is packed into 7 bit SysEx bytes in groups of 7: each group
+    starts with a byte holding the high bits (bit n is the high bit of data
+    byte n), followed by the low 7 bits of the data bytes. The last group may
+    be shorter. The SSE2 versions process two groups per iteration and fall
+    back to the scalar versions for the remainder.
+    **********************************************************************************/
+    inline unsigned int SysExPackedSize(unsigned int nBytes)
+    {
+        return nBytes + (nBytes + 6) / 7;
+    }
+
+    inline unsigned int SysExUnpackedSize(unsigned int nBytes)
+    {
+        return nBytes - (nBytes + 7) / 8;
+    }
+
+    unsigned int PackSysExScalar(const unsigned char* data, unsigned int nBytes, unsigned char* packed);
+    unsigned int UnpackSysExScalar(const unsigned char* packed, unsigned int nBytes, unsigned char* data);
+    unsigned char RolandChecksumScalar(const unsigned char* data, unsigned int nBytes);
+
+    // use the SSE2 kernels where available
+    unsigned int PackSysEx(const unsigned char* data, unsigned int nBytes, unsigned char* packed);
+    unsigned int UnpackSysEx(const unsigned char* packed, unsigned int nBytes, unsigned char* data);
+    unsigned char RolandChecksum(const unsigned char* data, unsigned int nBytes);
+};
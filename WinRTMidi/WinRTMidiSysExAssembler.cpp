@@ -0,0 +1,224 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiSysExAssembler.h"
+#include <cstring>
+
+using namespace WinRT;
+
+// each buffer starts with a header holding its size class. 16 bytes keep the data aligned
+#define kSysExHeaderSize 16
+
+WinRTMidiSysExAssembler::WinRTMidiSysExAssembler()
+    : mCallback(nullptr)
+    , mMaxSize(kDefaultSysExMaxSize)
+    , mBuffer(nullptr)
+    , mLength(0)
+    , mSizeClass(0)
+    , mOverflow(false)
+    , mDelivered(0)
+    , mBytesDelivered(0)
+    , mDropped(0)
+    , mLastMessageTime(0)
+    , mFirstMessage(true)
+{
+    for (auto& pool : mPools)
+    {
+        pool.reset(new WinRTMidiQueue<unsigned char*>(kSysExPoolDepth));
+    }
+}
+
+WinRTMidiSysExAssembler::~WinRTMidiSysExAssembler()
+{
+    Abort();
+
+    unsigned char* buffer;
+    for (auto& pool : mPools)
+    {
+        while (pool->Pop(buffer))
+        {
+            delete[] buffer;
+        }
+    }
+}
+
+void WinRTMidiSysExAssembler::Configure(WinRTMidiSysExCallback callback, unsigned int maxSize)
+{
+    mCallback = callback;
+    mMaxSize = maxSize > 0 ? maxSize : kDefaultSysExMaxSize;
+    if (mMaxSize > (kSysExMinBufferSize << (kSysExSizeClasses - 1)))
+    {
+        mMaxSize = kSysExMinBufferSize << (kSysExSizeClasses - 1);
+    }
+}
+
+unsigned char* WinRTMidiSysExAssembler::Acquire(unsigned int sizeClass)
+{
+    unsigned char* buffer;
+    if (!mPools[sizeClass]->Pop(buffer))
+    {
+        buffer = new unsigned char[kSysExHeaderSize + (kSysExMinBufferSize << sizeClass)];
+        buffer[0] = (unsigned char)sizeClass;
+    }
+
+    return buffer + kSysExHeaderSize;
+}
+
+void WinRTMidiSysExAssembler::Release(const unsigned char* data)
+{
+    unsigned char* buffer = const_cast<unsigned char*>(data) - kSysExHeaderSize;
+    if (!mPools[buffer[0]]->Push(buffer))
+    {
+        delete[] buffer;
+    }
+}
+
+void WinRTMidiSysExAssembler::Abort()
+{
+    if (mBuffer != nullptr)
+    {
+        Release(mBuffer);
+        mBuffer = nullptr;
+    }
+    mLength = 0;
+    mOverflow = false;
+}
+
+bool WinRTMidiSysExAssembler::Append(const unsigned char* data, unsigned int nBytes)
+{
+    if (mLength + nBytes > mMaxSize)
+    {
+        return false;
+    }
+
+    if (mLength + nBytes > (kSysExMinBufferSize << mSizeClass))
+    {
+        // move the message to a size class that fits it
+        unsigned int sizeClass = mSizeClass;
+        while (mLength + nBytes > (kSysExMinBufferSize << sizeClass))
+        {
+            sizeClass++;
+        }
+
+        unsigned char* buffer = Acquire(sizeClass);
+        memcpy(buffer, mBuffer, mLength);
+        Release(mBuffer);
+        mBuffer = buffer;
+        mSizeClass = sizeClass;
+    }
+
+    memcpy(mBuffer + mLength, data, nBytes);
+    mLength += nBytes;
+    return true;
+}
+
+void WinRTMidiSysExAssembler::OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes)
+{
+    if (nBytes == 0 || mCallback == nullptr)
+    {
+        return;
+    }
+
+    unsigned char status = message[0];
+    if (status == 0xF0)
+    {
+        // a new message replaces an unterminated one
+        if (mBuffer != nullptr || mOverflow)
+        {
+            mDropped++;
+        }
+
+        Abort();
+        mSizeClass = 0;
+        mBuffer = Acquire(0);
+    }
+    else if (status >= 0xF8)
+    {
+        return;
+    }
+    else if (status >= 0x80 && status != 0xF7)
+    {
+        // any other status byte ends the message without F7
+        if (mBuffer != nullptr || mOverflow)
+        {
+            mDropped++;
+            Abort();
+        }
+        return;
+    }
+
+    if (mBuffer == nullptr && !mOverflow)
+    {
+        // continuation without a start
+        return;
+    }
+
+    // append the fragment up to F7, without realtime bytes
+    bool complete = false;
+    unsigned int start = 0;
+    for (unsigned int i = 0; i < nBytes && !complete; i++)
+    {
+        unsigned char byte = message[i];
+        if (byte == 0xF7 || byte >= 0xF8)
+        {
+            unsigned int end = byte == 0xF7 ? i + 1 : i;
+            if (!mOverflow && !Append(message + start, end - start))
+            {
+                mOverflow = true;
+            }
+            start = i + 1;
+            complete = byte == 0xF7;
+        }
+    }
+
+    if (!complete)
+    {
+        if (!mOverflow && !Append(message + start, nBytes - start))
+        {
+            mOverflow = true;
+        }
+        return;
+    }
+
+    if (mOverflow)
+    {
+        mDropped++;
+        Abort();
+        return;
+    }
+
+    // timestamps are relative to the previous completed message
+    if (mFirstMessage)
+    {
+        mFirstMessage = false;
+        mLastMessageTime = time;
+    }
+
+    double timestamp = (time - mLastMessageTime) * .0001;
+    mLastMessageTime = time;
+
+    // the client owns the buffer until it releases it
+    unsigned char* buffer = mBuffer;
+    unsigned int length = mLength;
+    mBuffer = nullptr;
+    mLength = 0;
+    mDelivered++;
+    mBytesDelivered += length;
+    mCallback(port, timestamp, buffer, length);
+}
+
+void WinRTMidiSysExAssembler::GetStats(WinRTMidiSysExStats& stats)
+{
+    stats.messagesDelivered = mDelivered;
+    stats.bytesDelivered = mBytesDelivered;
+    stats.messagesDropped = mDropped;
+}
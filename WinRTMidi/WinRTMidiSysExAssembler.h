@@ -0,0 +1,77 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiInSubscriber.h"
+#include "WinRTMidiQueue.h"
+#include <atomic>
+#include <memory>
+
+namespace WinRT
+{
+    #define kSysExMinBufferSize 256u
+    #define kSysExSizeClasses 17                // 256 bytes to 16 MB
+    #define kSysExPoolDepth 8                   // free buffers kept per size class
+    #define kDefaultSysExMaxSize (64 * 1024)
+
+    /**********************************************************************************
+    Reassembles SysEx messages that arrive in several fragments and delivers
+    each complete message once.
+
+    Messages are assembled in pooled buffers of power of 2 size classes. A
+    message that outgrows its buffer is moved to the next class. The client
+    owns a delivered buffer until it calls Release(), which returns it to the
+    free list of its class (a lock-free queue), so a steady stream of dumps
+    does not allocate. Messages larger than the maximum size are dropped.
+    Realtime bytes inside a message are skipped.
+    **********************************************************************************/
+    class WinRTMidiSysExAssembler : public WinRTMidiInListener
+    {
+    public:
+        WinRTMidiSysExAssembler();
+        virtual ~WinRTMidiSysExAssembler();
+
+        // only call while the assembler is not receiving messages
+        void Configure(WinRTMidiSysExCallback callback, unsigned int maxSize);
+
+        virtual void OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes) override;
+
+        // returns a buffer passed to the callback to the pool
+        void Release(const unsigned char* data);
+
+        // may be called from any thread
+        void GetStats(WinRTMidiSysExStats& stats);
+
+    private:
+        unsigned char* Acquire(unsigned int sizeClass);
+        bool Append(const unsigned char* data, unsigned int nBytes);
+        void Abort();
+
+        WinRTMidiSysExCallback mCallback;
+        unsigned int mMaxSize;
+        std::unique_ptr<WinRTMidiQueue<unsigned char*>> mPools[kSysExSizeClasses];
+
+        // message being assembled
+        unsigned char* mBuffer;
+        unsigned int mLength;
+        unsigned int mSizeClass;
+        bool mOverflow;
+
+        std::atomic<unsigned long long> mDelivered;
+        std::atomic<unsigned long long> mBytesDelivered;
+        std::atomic<unsigned long long> mDropped;
+        long long mLastMessageTime;
+        bool mFirstMessage;
+    };
+};
@@ -0,0 +1,210 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiSysExStream.h"
+#include "WinRTMidiTime.h"
+
+using namespace WinRT;
+using namespace Windows::Storage::Streams;
+
+WinRTMidiSysExStream::WinRTMidiSysExStream(WinRTMidiOutPort^ port, const WinRTMidiSysExStreamConfig& config, unsigned long long totalBytes, WinRTMidiSysExProgressCallback callback)
+    : mPort(port)
+    , mConfig(config)
+    , mCallback(callback)
+    , mTotalBytes(totalBytes)
+    , mReadyHead(0)
+    , mReadyCount(0)
+    , mFill(-1)
+    , mFillLength(0)
+    , mRunning(false)
+    , mError(WINRT_NO_ERROR)
+    , mBytesSent(0)
+{
+    if (mConfig.chunkSize == 0)
+    {
+        mConfig.chunkSize = kDefaultSysExChunkSize;
+    }
+
+    if (mConfig.bufferCount == 0)
+    {
+        mConfig.bufferCount = kDefaultSysExBufferCount;
+    }
+
+    mChunks.resize(mConfig.bufferCount);
+    mReady.resize(mConfig.bufferCount);
+    mFree.reserve(mConfig.bufferCount);
+    for (unsigned int i = 0; i < mConfig.bufferCount; i++)
+    {
+        mChunks[i].buffer = ref new Buffer(mConfig.chunkSize);
+        mChunks[i].data = WinRTMidiOutPort::getIBufferDataPtr(mChunks[i].buffer);
+        mFree.push_back(i);
+    }
+}
+
+WinRTMidiSysExStream::~WinRTMidiSysExStream()
+{
+    Stop();
+}
+
+WinRTMidiErrorType WinRTMidiSysExStream::Start()
+{
+    if (!(mConfig.bytesPerMillisecond >= 0.0) || !(mConfig.chunkGap >= 0.0))
+    {
+        return WINRT_INVALID_PARAMETER_ERROR;
+    }
+
+    mTimer.Reset();
+    mRunning = true;
+    mThread = std::thread(&WinRTMidiSysExStream::Run, this);
+    return WINRT_NO_ERROR;
+}
+
+void WinRTMidiSysExStream::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mRunning)
+        {
+            return;
+        }
+        mRunning = false;
+    }
+
+    mCondition.notify_all();
+    mTimer.Cancel();
+    mThread.join();
+}
+
+// called with mMutex locked
+void WinRTMidiSysExStream::QueueFillBuffer()
+{
+    mChunks[mFill].buffer->Length = mFillLength;
+    mReady[(mReadyHead + mReadyCount) % mConfig.bufferCount] = (unsigned int)mFill;
+    mReadyCount++;
+    mFill = -1;
+    mFillLength = 0;
+    mCondition.notify_all();
+}
+
+WinRTMidiErrorType WinRTMidiSysExStream::Write(const unsigned char* data, unsigned int nBytes)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while (nBytes > 0)
+    {
+        if (mFill < 0)
+        {
+            // flow control: wait for the sender thread to return a buffer
+            mCondition.wait(lock, [this] { return !mFree.empty() || mError != WINRT_NO_ERROR || !mRunning; });
+            if (mError != WINRT_NO_ERROR || !mRunning)
+            {
+                break;
+            }
+
+            mFill = (int)mFree.back();
+            mFree.pop_back();
+            mFillLength = 0;
+        }
+
+        unsigned int count = mConfig.chunkSize - mFillLength;
+        if (count > nBytes)
+        {
+            count = nBytes;
+        }
+
+        memcpy(mChunks[mFill].data + mFillLength, data, count);
+        mFillLength += count;
+        data += count;
+        nBytes -= count;
+
+        if (mFillLength == mConfig.chunkSize)
+        {
+            QueueFillBuffer();
+        }
+    }
+
+    return mError;
+}
+
+WinRTMidiErrorType WinRTMidiSysExStream::End()
+{
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mFill >= 0 && mFillLength > 0)
+        {
+            QueueFillBuffer();
+        }
+
+        mCondition.wait(lock, [this] { return mReadyCount == 0 || !mRunning; });
+    }
+
+    // the thread finishes the chunk it is sending before it stops
+    Stop();
+    return mError;
+}
+
+void WinRTMidiSysExStream::Run()
+{
+    long long nextSendTime = GetTimeMicroseconds();
+
+    while (true)
+    {
+        unsigned int index;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this] { return mReadyCount > 0 || !mRunning; });
+            if (mReadyCount == 0)
+            {
+                break;
+            }
+
+            index = mReady[mReadyHead];
+        }
+
+        if (!mTimer.WaitUntil(nextSendTime))
+        {
+            break;
+        }
+
+        IBuffer^ buffer = mChunks[index].buffer;
+        unsigned int length = buffer->Length;
+        bool sent = mPort->SendRawBuffer(buffer);
+
+        // the next chunk may be sent once this one has been transmitted at the configured rate
+        double interval = mConfig.chunkGap * 1000.0;
+        if (mConfig.bytesPerMillisecond > 0.0)
+        {
+            interval += length * 1000.0 / mConfig.bytesPerMillisecond;
+        }
+        nextSendTime = GetTimeMicroseconds() + (long long)interval;
+
+        unsigned long long bytesSent;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mReadyHead = (mReadyHead + 1) % mConfig.bufferCount;
+            mReadyCount--;
+            mFree.push_back(index);
+            mBytesSent += length;
+            bytesSent = mBytesSent;
+            if (!sent)
+            {
+                mError = WINRT_PORT_CLOSED_ERROR;
+            }
+        }
+        mCondition.notify_all();
+
+        if (mCallback)
+        {
+            mCallback((WinRTMidiSysExStreamPtr)this, bytesSent, mTotalBytes);
+        }
+    }
+}
@@ -0,0 +1,84 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiImpl.h"
+#include "WinRTMidiTimer.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WinRT
+{
+    #define kDefaultSysExChunkSize 256
+    #define kDefaultSysExBufferCount 4
+
+    /**********************************************************************************
+    Streams a large SysEx message to a midi out port in bounded chunks.
+
+    Write() copies the data into a fixed pool of IBuffers allocated when the
+    stream is created; it blocks while all buffers are waiting to be sent.
+    A sender thread sends the full buffers, paced by the configured data rate
+    and gap between chunks, returns them to the pool and reports progress.
+    End() sends the last partial chunk and waits until all data is sent.
+    **********************************************************************************/
+    class WinRTMidiSysExStream
+    {
+    public:
+        WinRTMidiSysExStream(WinRTMidiOutPort^ port, const WinRTMidiSysExStreamConfig& config, unsigned long long totalBytes, WinRTMidiSysExProgressCallback callback);
+        ~WinRTMidiSysExStream();
+
+        WinRTMidiErrorType Start();
+
+        WinRTMidiErrorType Write(const unsigned char* data, unsigned int nBytes);
+
+        // sends the remaining data and stops the sender thread
+        WinRTMidiErrorType End();
+
+    private:
+        void Run();
+        void Stop();
+        void QueueFillBuffer();
+
+        struct Chunk
+        {
+            Windows::Storage::Streams::IBuffer^ buffer;
+            byte* data;
+        };
+
+        WinRTMidiOutPort^ mPort;
+        WinRTMidiSysExStreamConfig mConfig;
+        WinRTMidiSysExProgressCallback mCallback;
+        unsigned long long mTotalBytes;
+
+        // all containers are sized in the constructor
+        std::vector<Chunk> mChunks;
+        std::vector<unsigned int> mFree;
+        std::vector<unsigned int> mReady;   // ring of chunk indices
+        unsigned int mReadyHead;
+        unsigned int mReadyCount;
+        int mFill;                          // chunk being filled by Write(), -1 if none
+        unsigned int mFillLength;
+
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        bool mRunning;
+        WinRTMidiErrorType mError;
+        unsigned long long mBytesSent;
+
+        std::thread mThread;
+        WinRTMidiTimer mTimer;
+    };
+};
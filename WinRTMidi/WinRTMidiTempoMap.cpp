@@ -0,0 +1,116 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiTempoMap.h"
+#include <algorithm>
+
+using namespace WinRT;
+
+static double MicrosecondsPerTick(unsigned int ppq, double bpm)
+{
+    return 60000000.0 / (bpm * ppq);
+}
+
+WinRTMidiTempoMap::WinRTMidiTempoMap(unsigned int ppq, double bpm)
+    : mCursor(0)
+    , mPpq(ppq)
+{
+    mSegments.push_back({ 0, MicrosecondsPerTick(ppq, bpm), 0.0 });
+}
+
+void WinRTMidiTempoMap::SetTempo(unsigned long long tick, double bpm)
+{
+    auto it = std::lower_bound(mSegments.begin(), mSegments.end(), tick, [](const Segment& segment, unsigned long long t)
+    {
+        return segment.tick < t;
+    });
+
+    if (it == mSegments.end() || it->tick != tick)
+    {
+        it = mSegments.insert(it, { tick, 0.0, 0.0 });
+    }
+
+    it->microsecondsPerTick = MicrosecondsPerTick(mPpq, bpm);
+    UpdateTimes(it - mSegments.begin());
+}
+
+bool WinRTMidiTempoMap::RemoveTempo(unsigned long long tick)
+{
+    for (size_t i = 1; i < mSegments.size(); i++)
+    {
+        if (mSegments[i].tick == tick)
+        {
+            mSegments.erase(mSegments.begin() + i);
+            UpdateTimes(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void WinRTMidiTempoMap::UpdateTimes(size_t index)
+{
+    // segments before index keep their start times
+    for (size_t i = std::max<size_t>(index, 1); i < mSegments.size(); i++)
+    {
+        const Segment& previous = mSegments[i - 1];
+        mSegments[i].time = previous.time + (mSegments[i].tick - previous.tick) * previous.microsecondsPerTick;
+    }
+
+    mCursor = 0;
+}
+
+size_t WinRTMidiTempoMap::FindSegment(double tick)
+{
+    size_t count = mSegments.size();
+    if (tick < mSegments[mCursor].tick)
+    {
+        // rewind: binary search for the last segment starting at or before tick
+        auto it = std::upper_bound(mSegments.begin(), mSegments.end(), tick, [](double t, const Segment& segment)
+        {
+            return t < segment.tick;
+        });
+
+        mCursor = it == mSegments.begin() ? 0 : (it - mSegments.begin()) - 1;
+        return mCursor;
+    }
+
+    while (mCursor + 1 < count && tick >= mSegments[mCursor + 1].tick)
+    {
+        mCursor++;
+    }
+
+    return mCursor;
+}
+
+double WinRTMidiTempoMap::TickToTime(double tick)
+{
+    const Segment& segment = mSegments[FindSegment(tick)];
+    return segment.time + (tick - segment.tick) * segment.microsecondsPerTick;
+}
+
+double WinRTMidiTempoMap::TimeToTick(double time)
+{
+    auto it = std::upper_bound(mSegments.begin(), mSegments.end(), time, [](double t, const Segment& segment)
+    {
+        return t < segment.time;
+    });
+
+    const Segment& segment = it == mSegments.begin() ? mSegments.front() : *(it - 1);
+    return segment.tick + (time - segment.time) / segment.microsecondsPerTick;
+}
+
+double WinRTMidiTempoMap::GetTempo(double tick)
+{
+    return 60000000.0 / (mSegments[FindSegment(tick)].microsecondsPerTick * mPpq);
+}
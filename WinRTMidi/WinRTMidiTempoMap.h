@@ -0,0 +1,67 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace WinRT
+{
+    #define kMinSchedulerTempo 1.0
+    #define kMaxSchedulerTempo 1000.0
+
+    /**********************************************************************************
+    Editable tempo map converting positions in ticks (ppq per quarter note) to
+    microseconds from tick 0 and back. Each tempo change starts a segment that
+    caches its start time, so a conversion is one multiply-add once the segment
+    is found. Lookups start at the segment of the previous lookup because
+    positions mostly increase; editing a tempo only recomputes the start times
+    of the segments that follow it.
+
+    Not thread safe.
+    **********************************************************************************/
+    class WinRTMidiTempoMap
+    {
+    public:
+        WinRTMidiTempoMap(unsigned int ppq, double bpm);
+
+        // adds a tempo change at tick or replaces the one already there
+        void SetTempo(unsigned long long tick, double bpm);
+
+        // returns false if there is no tempo change at tick. The tempo at tick 0 cannot be removed
+        bool RemoveTempo(unsigned long long tick);
+
+        double TickToTime(double tick);
+        double TimeToTick(double time);
+
+        // beats per minute at tick
+        double GetTempo(double tick);
+
+        unsigned int GetPpq() const { return mPpq; };
+
+    private:
+        struct Segment
+        {
+            unsigned long long tick;
+            double microsecondsPerTick;
+            double time;                // microseconds from tick 0
+        };
+
+        size_t FindSegment(double tick);
+        void UpdateTimes(size_t index);
+
+        std::vector<Segment> mSegments;
+        size_t mCursor;
+        unsigned int mPpq;
+    };
+};
@@ -0,0 +1,56 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <chrono>
+#endif
+
+namespace WinRT
+{
+#ifdef _WIN32
+    // returns the frequency of the performance counter in counts per second
+    inline long long GetPerformanceFrequency()
+    {
+        static long long frequency = 0;
+        if (frequency == 0)
+        {
+            LARGE_INTEGER f;
+            QueryPerformanceFrequency(&f);
+            frequency = f.QuadPart;
+        }
+
+        return frequency;
+    }
+
+    // returns the current value of the performance counter in microseconds
+    inline long long GetTimeMicroseconds()
+    {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        long long frequency = GetPerformanceFrequency();
+
+        // split the conversion to avoid overflowing the multiplication
+        return (counter.QuadPart / frequency) * 1000000 + (counter.QuadPart % frequency) * 1000000 / frequency;
+    }
+#else
+    // returns the current value of the monotonic clock in microseconds
+    inline long long GetTimeMicroseconds()
+    {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+    }
+#endif
+};
@@ -0,0 +1,168 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiTimer.h"
+#include "WinRTMidiTime.h"
+
+#ifdef _WIN32
+// needed for timeBeginPeriod when high resolution timers are not available
+#pragma comment(lib, "winmm.lib")
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+using namespace WinRT;
+
+#define kHighResolutionSpinTime 200     // microseconds
+#define kLowResolutionSpinTime 2000     // microseconds
+
+#ifdef _WIN32
+
+WinRTMidiTimer::WinRTMidiTimer()
+    : mCancelled(false)
+    , mHighResolution(true)
+{
+    // high resolution waitable timers are available on Windows 10 1803 and later
+    mTimer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (mTimer == NULL)
+    {
+        mHighResolution = false;
+        mTimer = CreateWaitableTimerExW(NULL, NULL, 0, TIMER_ALL_ACCESS);
+        timeBeginPeriod(1);
+    }
+
+    mSpinTime = mHighResolution ? kHighResolutionSpinTime : kLowResolutionSpinTime;
+    mCancelEvent = CreateEventEx(NULL, NULL, CREATE_EVENT_MANUAL_RESET, EVENT_ALL_ACCESS);
+}
+
+WinRTMidiTimer::~WinRTMidiTimer()
+{
+    if (!mHighResolution)
+    {
+        timeEndPeriod(1);
+    }
+
+    CloseHandle(mTimer);
+    CloseHandle(mCancelEvent);
+}
+
+bool WinRTMidiTimer::WaitUntil(long long time)
+{
+    for (;;)
+    {
+        if (mCancelled)
+        {
+            return false;
+        }
+
+        long long remaining = time - GetTimeMicroseconds();
+        if (remaining <= 0)
+        {
+            return true;
+        }
+
+        if (remaining > mSpinTime)
+        {
+            // relative due time in 100ns units
+            LARGE_INTEGER dueTime;
+            dueTime.QuadPart = -(remaining - mSpinTime) * 10;
+            SetWaitableTimer(mTimer, &dueTime, 0, NULL, NULL, FALSE);
+
+            HANDLE handles[2] = { mCancelEvent, mTimer };
+            if (WaitForMultipleObjectsEx(2, handles, FALSE, INFINITE, FALSE) == WAIT_OBJECT_0)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            YieldProcessor();
+        }
+    }
+}
+
+void WinRTMidiTimer::Cancel()
+{
+    mCancelled = true;
+    SetEvent(mCancelEvent);
+}
+
+void WinRTMidiTimer::Reset()
+{
+    mCancelled = false;
+    ResetEvent(mCancelEvent);
+}
+
+#else
+
+WinRTMidiTimer::WinRTMidiTimer()
+    : mCancelled(false)
+    , mSpinTime(kHighResolutionSpinTime)
+    , mHighResolution(true)
+{
+}
+
+WinRTMidiTimer::~WinRTMidiTimer()
+{
+}
+
+bool WinRTMidiTimer::WaitUntil(long long time)
+{
+    for (;;)
+    {
+        if (mCancelled)
+        {
+            return false;
+        }
+
+        long long remaining = time - GetTimeMicroseconds();
+        if (remaining <= 0)
+        {
+            return true;
+        }
+
+        if (remaining > mSpinTime)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            if (mCancelCondition.wait_for(lock, std::chrono::microseconds(remaining - mSpinTime), [this] { return mCancelled.load(); }))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void WinRTMidiTimer::Cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCancelled = true;
+    }
+
+    mCancelCondition.notify_all();
+}
+
+void WinRTMidiTimer::Reset()
+{
+    mCancelled = false;
+}
+
+#endif
@@ -0,0 +1,57 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include <atomic>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace WinRT
+{
+    /**********************************************************************************
+    Waits until an absolute performance counter time with sub-millisecond accuracy.
+    The bulk of the wait is done on a waitable timer (high resolution if the OS
+    supports it); the last part is spent spinning. Cancel() wakes a waiting
+    thread immediately. Other platforms wait on a condition variable, which is
+    used by the standalone tests.
+    **********************************************************************************/
+    class WinRTMidiTimer
+    {
+    public:
+        WinRTMidiTimer();
+        ~WinRTMidiTimer();
+
+        // time is in microseconds (see GetTimeMicroseconds). Returns false if the wait was cancelled
+        bool WaitUntil(long long time);
+
+        void Cancel();
+        void Reset();
+
+    private:
+#ifdef _WIN32
+        HANDLE mTimer;
+        HANDLE mCancelEvent;
+#else
+        std::mutex mMutex;
+        std::condition_variable mCancelCondition;
+#endif
+        std::atomic<bool> mCancelled;
+        long long mSpinTime;
+        bool mHighResolution;
+    };
+};
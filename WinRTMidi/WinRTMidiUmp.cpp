@@ -0,0 +1,310 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiUmp.h"
+
+using namespace WinRT;
+
+#define kUmpInitialWords 64
+
+unsigned int WinRT::MidiToUmpBatch(const unsigned int* __restrict messages, unsigned int count, unsigned int group, WinRTMidiUmpProtocol protocol, unsigned int* __restrict ump)
+{
+    group &= 0x0F;
+
+    if (protocol == WINRT_UMP_MIDI1)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            ump[i] = Midi1ToUmp32(messages[i], group);
+        }
+
+        return count;
+    }
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        Midi1ToUmp64(messages[i], group, ump + i * 2);
+    }
+
+    return count * 2;
+}
+
+unsigned int WinRT::UmpToMidiBatch(const unsigned int* __restrict ump, unsigned int count, WinRTMidiUmpProtocol protocol, unsigned int* __restrict messages)
+{
+    if (protocol == WINRT_UMP_MIDI1)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            messages[i] = Ump32ToMidi1(ump[i]);
+        }
+    }
+    else
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            messages[i] = Ump64ToMidi1(ump + i * 2);
+        }
+    }
+
+    return count;
+}
+
+unsigned int WinRT::MidiToUmp(const unsigned char* message, unsigned int nBytes, unsigned int group, WinRTMidiUmpProtocol protocol, bool* sysExOpen, unsigned int* words)
+{
+    if (nBytes == 0)
+    {
+        return 0;
+    }
+
+    group &= 0x0F;
+    unsigned char status = message[0];
+    bool continuation = *sysExOpen && (status < 0x80 || status == 0xF7);
+    if (status < 0x80 && !continuation)
+    {
+        // data bytes without a SysEx in progress
+        return 0;
+    }
+
+    if (status < 0xF8 && status != 0xF0 && !continuation)
+    {
+        // any status byte except realtime ends an unterminated SysEx
+        *sysExOpen = false;
+    }
+
+    unsigned int data1 = nBytes > 1 ? message[1] : 0;
+    unsigned int data2 = nBytes > 2 ? message[2] : 0;
+
+    if (status < 0xF0 && !continuation)
+    {
+        unsigned int packed = status | (data1 << 8) | (data2 << 16);
+        if (protocol == WINRT_UMP_MIDI1)
+        {
+            words[0] = Midi1ToUmp32(packed, group);
+            return 1;
+        }
+
+        Midi1ToUmp64(packed, group, words);
+        return 2;
+    }
+
+    if (status != 0xF0 && !continuation)
+    {
+        // system common and realtime messages (message type 1)
+        words[0] = 0x10000000 | (group << 24) | (status << 16) | (data1 << 8) | data2;
+        return 1;
+    }
+
+    // SysEx7 packets of up to 6 data bytes without the F0 and F7 bytes.
+    // A fragment continues the SysEx of the previous call
+    bool start = !continuation;
+    const unsigned char* data = status < 0x80 ? message : message + 1;
+    unsigned int length = status < 0x80 ? nBytes : nBytes - 1;
+    bool end = status == 0xF7 || (length > 0 && data[length - 1] == 0xF7);
+    if (length > 0 && data[length - 1] == 0xF7)
+    {
+        length--;
+    }
+
+    *sysExOpen = !end;
+
+    unsigned int nWords = 0;
+    unsigned int offset = 0;
+    do
+    {
+        unsigned int n = length - offset < 6 ? length - offset : 6;
+        bool first = start && offset == 0;
+        bool last = end && offset + n == length;
+        unsigned int packetStatus = first ? (last ? 0x0 : 0x1) : (last ? 0x3 : 0x2);
+
+        unsigned char bytes[6] = { 0 };
+        for (unsigned int i = 0; i < n; i++)
+        {
+            bytes[i] = data[offset + i];
+        }
+
+        words[nWords++] = 0x30000000 | (group << 24) | (packetStatus << 20) | (n << 16) | (bytes[0] << 8) | bytes[1];
+        words[nWords++] = (bytes[2] << 24) | (bytes[3] << 16) | (bytes[4] << 8) | bytes[5];
+        offset += n;
+    } while (offset < length);
+
+    return nWords;
+}
+
+/*****************************************************
+    WinRTMidiUmpDecoder
+*****************************************************/
+
+bool WinRTMidiUmpDecoder::Decode(const unsigned int* words, unsigned int nWords, MessageFunc func, void* context)
+{
+    unsigned int i = 0;
+    while (i < nWords)
+    {
+        unsigned int word0 = words[i];
+        unsigned int size = UmpPacketWords(word0);
+        if (i + size > nWords)
+        {
+            return false;
+        }
+
+        unsigned char status = (word0 >> 16) & 0xFF;
+        unsigned char message[3] = { status, (unsigned char)((word0 >> 8) & 0x7F), (unsigned char)(word0 & 0x7F) };
+
+        switch (word0 >> 28)
+        {
+        case 0x1:
+            switch (status)
+            {
+            case 0xF1:
+            case 0xF3:
+                func(context, message, 2);
+                break;
+            case 0xF2:
+                func(context, message, 3);
+                break;
+            default:
+                func(context, message, 1);
+                break;
+            }
+            break;
+
+        case 0x2:
+        {
+            unsigned int type = status >> 4;
+            func(context, message, type == 0xC || type == 0xD ? 2 : 3);
+            break;
+        }
+
+        case 0x3:
+            DecodeSysEx7(words + i, func, context);
+            break;
+
+        case 0x4:
+        {
+            unsigned int type = status >> 4;
+            unsigned char channel = status & 0x0F;
+            if (type >= 0x8 && type <= 0xE)
+            {
+                unsigned int packed = Ump64ToMidi1(words + i);
+                unsigned char bytes[3] = { (unsigned char)packed, (unsigned char)(packed >> 8), (unsigned char)(packed >> 16) };
+                if (type == 0xC && (word0 & 0x01))
+                {
+                    // bank select before the program change
+                    unsigned char msb[3] = { (unsigned char)(0xB0 | channel), 0, (unsigned char)((words[i + 1] >> 8) & 0x7F) };
+                    unsigned char lsb[3] = { (unsigned char)(0xB0 | channel), 32, (unsigned char)(words[i + 1] & 0x7F) };
+                    func(context, msb, 3);
+                    func(context, lsb, 3);
+                }
+                func(context, bytes, type == 0xC || type == 0xD ? 2 : 3);
+            }
+            else if (type == 0x2 || type == 0x3)
+            {
+                // registered (RPN) and assignable (NRPN) controllers
+                unsigned char cc = (unsigned char)(0xB0 | channel);
+                unsigned int value = words[i + 1] >> 18;
+                unsigned char select = type == 0x2 ? 101 : 99;
+                unsigned char sequence[4][3] = {
+                    { cc, select, (unsigned char)((word0 >> 8) & 0x7F) },
+                    { cc, (unsigned char)(select - 1), (unsigned char)(word0 & 0x7F) },
+                    { cc, 6, (unsigned char)(value >> 7) },
+                    { cc, 38, (unsigned char)(value & 0x7F) }
+                };
+                for (auto& m : sequence)
+                {
+                    func(context, m, 3);
+                }
+            }
+            break;
+        }
+
+        default:
+            break;
+        }
+
+        i += size;
+    }
+
+    return true;
+}
+
+void WinRTMidiUmpDecoder::DecodeSysEx7(const unsigned int* words, MessageFunc func, void* context)
+{
+    unsigned int packetStatus = (words[0] >> 20) & 0x0F;
+    unsigned int n = (words[0] >> 16) & 0x0F;
+    unsigned char bytes[6] = {
+        (unsigned char)((words[0] >> 8) & 0x7F), (unsigned char)(words[0] & 0x7F),
+        (unsigned char)((words[1] >> 24) & 0x7F), (unsigned char)((words[1] >> 16) & 0x7F),
+        (unsigned char)((words[1] >> 8) & 0x7F), (unsigned char)(words[1] & 0x7F)
+    };
+
+    if (n > 6)
+    {
+        n = 6;
+    }
+
+    if (packetStatus == 0x0 || packetStatus == 0x1)
+    {
+        mSysEx.clear();
+        mSysEx.push_back(0xF0);
+    }
+    else if (mSysEx.empty())
+    {
+        // continuation without a start packet
+        return;
+    }
+
+    mSysEx.insert(mSysEx.end(), bytes, bytes + n);
+
+    if (packetStatus == 0x0 || packetStatus == 0x3)
+    {
+        mSysEx.push_back(0xF7);
+        func(context, mSysEx.data(), (unsigned int)mSysEx.size());
+        mSysEx.clear();
+    }
+}
+
+/*****************************************************
+    WinRTMidiUmpListener
+*****************************************************/
+
+WinRTMidiUmpListener::WinRTMidiUmpListener(WinRTMidiUmpCallback callback, WinRTMidiUmpProtocol protocol, unsigned int group)
+    : mCallback(callback)
+    , mProtocol(protocol)
+    , mGroup(group & 0x0F)
+    , mWords(kUmpInitialWords)
+    , mLastMessageTime(0)
+    , mFirstMessage(true)
+    , mSysExOpen(false)
+{
+}
+
+void WinRTMidiUmpListener::OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes)
+{
+    if (mFirstMessage)
+    {
+        mFirstMessage = false;
+        mLastMessageTime = time;
+    }
+
+    double timestamp = (time - mLastMessageTime) * .0001;
+    mLastMessageTime = time;
+
+    if (mWords.size() < UmpWordsForMidiMessage(nBytes))
+    {
+        mWords.resize(UmpWordsForMidiMessage(nBytes));
+    }
+
+    unsigned int nWords = MidiToUmp(message, nBytes, mGroup, mProtocol, &mSysExOpen, mWords.data());
+    if (nWords > 0)
+    {
+        mCallback(port, timestamp, mWords.data(), nWords);
+    }
+}
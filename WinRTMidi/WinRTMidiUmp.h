@@ -0,0 +1,160 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiInListener.h"
+#include <vector>
+
+namespace WinRT
+{
+    // maximum number of UMP words for a MIDI 1.0 message of nBytes
+    #define UmpWordsForMidiMessage(nBytes) (((nBytes) / 6 + 1) * 2)
+
+    /**********************************************************************************
+    Conversion between MIDI 1.0 byte streams and Universal MIDI Packets (UMP).
+
+    Channel voice messages are converted with branch-free inline functions on
+    packed 32 bit MIDI 1.0 messages (status | data1 << 8 | data2 << 16) so the
+    batch loops below compile to vectorized code. Values are scaled with the
+    min-center-max algorithm of the MIDI 2.0 specification (7 to 16 and 7 to
+    32 bits, 14 to 32 bits for pitch bend); downscaling drops the low bits.
+    **********************************************************************************/
+
+    inline unsigned int UmpPacketWords(unsigned int word0)
+    {
+        static const unsigned char kWords[16] = { 1, 1, 1, 2, 2, 4, 1, 1, 2, 2, 2, 3, 3, 4, 4, 4 };
+        return kWords[word0 >> 28];
+    }
+
+    inline unsigned int ScaleUp7To16(unsigned int value)
+    {
+        unsigned int repeat = value & 0x3F;
+        return (value << 9) | ((0u - (value > 0x40)) & ((repeat << 3) | (repeat >> 3)));
+    }
+
+    inline unsigned int ScaleUp7To32(unsigned int value)
+    {
+        unsigned int repeat = value & 0x3F;
+        unsigned int bits = (repeat << 19) | (repeat << 13) | (repeat << 7) | (repeat << 1) | (repeat >> 5);
+        return (value << 25) | ((0u - (value > 0x40)) & bits);
+    }
+
+    inline unsigned int ScaleUp14To32(unsigned int value)
+    {
+        unsigned int repeat = value & 0x1FFF;
+        return (value << 18) | ((0u - (value > 0x2000)) & ((repeat << 5) | (repeat >> 8)));
+    }
+
+    // MIDI 1.0 channel voice message to a MIDI 1.0 protocol UMP (message type 2)
+    inline unsigned int Midi1ToUmp32(unsigned int message, unsigned int group)
+    {
+        return 0x20000000 | (group << 24) | ((message & 0xFF) << 16) | (message & 0xFF00) | ((message >> 16) & 0xFF);
+    }
+
+    // MIDI 1.0 protocol UMP (message type 2) to a MIDI 1.0 channel voice message
+    inline unsigned int Ump32ToMidi1(unsigned int word)
+    {
+        return ((word >> 16) & 0xFF) | (word & 0xFF00) | ((word & 0xFF) << 16);
+    }
+
+    // MIDI 1.0 channel voice message to a MIDI 2.0 channel voice UMP (message type 4)
+    inline void Midi1ToUmp64(unsigned int message, unsigned int group, unsigned int* words)
+    {
+        unsigned int status = message & 0xFF;
+        unsigned int data1 = (message >> 8) & 0x7F;
+        unsigned int data2 = (message >> 16) & 0x7F;
+        unsigned int type = status >> 4;
+
+        // a note on with velocity 0 is a note off with the default velocity
+        unsigned int noteOff = (type == 0x9) & (data2 == 0);
+        status ^= noteOff << 4;
+
+        unsigned int velocity = noteOff ? 0x8000 : ScaleUp7To16(data2);
+        unsigned int value = ScaleUp7To32(type == 0xD ? data1 : data2);
+        unsigned int bend = ScaleUp14To32(data1 | (data2 << 7));
+        unsigned int index = type < 0xC ? data1 : 0;
+
+        words[0] = 0x40000000 | (group << 24) | (status << 16) | (index << 8);
+        words[1] = type <= 0x9 ? velocity << 16 : type == 0xC ? data1 << 24 : type == 0xE ? bend : value;
+    }
+
+    // MIDI 2.0 channel voice UMP (message type 4) to a MIDI 1.0 channel voice message.
+    // Only valid for the status types 0x8 to 0xE
+    inline unsigned int Ump64ToMidi1(const unsigned int* words)
+    {
+        unsigned int status = (words[0] >> 16) & 0xFF;
+        unsigned int type = status >> 4;
+        unsigned int index = (words[0] >> 8) & 0x7F;
+        unsigned int value = words[1] >> 25;
+        unsigned int bend = words[1] >> 18;
+
+        // a note on must not turn into a note off
+        value |= (type == 0x9) & (value == 0);
+
+        unsigned int data1 = type < 0xC ? index : type == 0xC ? (words[1] >> 24) & 0x7F : type == 0xD ? value : bend & 0x7F;
+        unsigned int data2 = type < 0xC ? value : type == 0xE ? bend >> 7 : 0;
+        return status | (data1 << 8) | (data2 << 16);
+    }
+
+    // Batch conversion of packed MIDI 1.0 channel voice messages. Returns the number of UMP words written
+    // (count for WINRT_UMP_MIDI1, 2 * count for WINRT_UMP_MIDI2)
+    unsigned int MidiToUmpBatch(const unsigned int* messages, unsigned int count, unsigned int group, WinRTMidiUmpProtocol protocol, unsigned int* ump);
+
+    // Batch conversion of channel voice UMPs of one protocol. Returns the number of messages written
+    unsigned int UmpToMidiBatch(const unsigned int* ump, unsigned int count, WinRTMidiUmpProtocol protocol, unsigned int* messages);
+
+    // Converts a MIDI 1.0 message (channel voice, system or SysEx) to UMP. A SysEx can arrive
+    // in fragments; sysExOpen is set while the end of a SysEx has not been seen and must be kept
+    // by the caller between calls. words must hold UmpWordsForMidiMessage(nBytes) words.
+    // Returns the number of words written
+    unsigned int MidiToUmp(const unsigned char* message, unsigned int nBytes, unsigned int group, WinRTMidiUmpProtocol protocol, bool* sysExOpen, unsigned int* words);
+
+    /**********************************************************************************
+    Converts a UMP stream to MIDI 1.0 messages. SysEx7 packets are collected
+    until the SysEx is complete. MIDI 2.0 RPN and NRPN messages are sent as
+    MIDI 1.0 controller sequences; packets without a MIDI 1.0 equivalent are
+    skipped.
+    **********************************************************************************/
+    class WinRTMidiUmpDecoder
+    {
+    public:
+        typedef void (*MessageFunc)(void* context, const unsigned char* message, unsigned int nBytes);
+
+        // returns false if the last packet is incomplete
+        bool Decode(const unsigned int* words, unsigned int nWords, MessageFunc func, void* context);
+
+    private:
+        void DecodeSysEx7(const unsigned int* words, MessageFunc func, void* context);
+
+        std::vector<unsigned char> mSysEx;
+    };
+
+    // Delivers the messages of a midi in port as UMP
+    class WinRTMidiUmpListener : public WinRTMidiInListener
+    {
+    public:
+        WinRTMidiUmpListener(WinRTMidiUmpCallback callback, WinRTMidiUmpProtocol protocol, unsigned int group);
+
+        virtual void OnMidiInMessage(WinRTMidiInPortPtr port, long long time, const unsigned char* message, unsigned int nBytes) override;
+
+    private:
+        WinRTMidiUmpCallback mCallback;
+        WinRTMidiUmpProtocol mProtocol;
+        unsigned int mGroup;
+        std::vector<unsigned int> mWords;
+        long long mLastMessageTime;
+        bool mFirstMessage;
+        bool mSysExOpen;
+    };
+};
@@ -0,0 +1,64 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#include "WinRTMidiVirtualPort.h"
+#include "WinRTMidiFile.h"
+#include "WinRTMidiTime.h"
+#include <algorithm>
+
+using namespace WinRT;
+
+WinRTMidiVirtualPort::WinRTMidiVirtualPort(const std::string& name)
+    : WinRTMidiMessageWorker(kVirtualPortQueueCapacity)
+    , mName(name)
+{
+    std::wstring id = std::wstring(kVirtualPortIdPrefix) + Utf8ToWString(name.c_str());
+    mId = ref new Platform::String(id.c_str());
+}
+
+WinRTMidiVirtualPort::~WinRTMidiVirtualPort()
+{
+    Stop();
+}
+
+void WinRTMidiVirtualPort::AddInPort(WinRTMidiInPort^ port)
+{
+    std::lock_guard<std::mutex> lock(mPortMutex);
+    mInPorts.push_back(port);
+}
+
+void WinRTMidiVirtualPort::RemoveInPort(WinRTMidiInPort^ port)
+{
+    std::lock_guard<std::mutex> lock(mPortMutex);
+    mInPorts.erase(std::remove(mInPorts.begin(), mInPorts.end(), port), mInPorts.end());
+}
+
+bool WinRTMidiVirtualPort::Send(const unsigned char* message, unsigned int nBytes)
+{
+    // the in ports expect 100ns units
+    return Enqueue(nullptr, nullptr, GetTimeMicroseconds() * 10, 0.0, message, nBytes);
+}
+
+void WinRTMidiVirtualPort::Process(const WinRTMidiQueuedMessage& message)
+{
+    {
+        std::lock_guard<std::mutex> lock(mPortMutex);
+        mDeliveryPorts.assign(mInPorts.begin(), mInPorts.end());
+    }
+
+    for (auto port : mDeliveryPorts)
+    {
+        port->ReceiveMessage(message.time, message.GetData(), message.nBytes);
+    }
+
+    mDeliveryPorts.clear();
+}
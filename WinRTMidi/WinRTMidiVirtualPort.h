@@ -0,0 +1,65 @@
+// ******************************************************************
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE CODE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE CODE OR THE USE OR OTHER DEALINGS IN THE CODE.
+// ******************************************************************
+
+#pragma once
+
+#include "WinRTMidi.h"
+#include "WinRTMidiImpl.h"
+#include "WinRTMidiMessageWorker.h"
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace WinRT
+{
+    #define kVirtualPortIdPrefix L"virtual:"
+    #define kVirtualPortQueueCapacity 4096
+
+    /**********************************************************************************
+    In memory MIDI port pair without a device driver. Messages sent by the out
+    ports opened on the pair are pushed to a lock-free queue; the pair's worker
+    thread passes them to every in port opened on the pair as if a device had
+    received them. Senders never block: a message is dropped when the queue is
+    full.
+
+    The pair is listed by both port watchers with the id "virtual:<name>", so
+    other code can open more in and out ports on it by index.
+    **********************************************************************************/
+    class WinRTMidiVirtualPort : public WinRTMidiMessageWorker
+    {
+    public:
+        WinRTMidiVirtualPort(const std::string& name);
+        virtual ~WinRTMidiVirtualPort();
+
+        const std::string& GetName() { return mName; };
+        Platform::String^ GetId() { return mId; };
+
+        void AddInPort(WinRTMidiInPort^ port);
+        void RemoveInPort(WinRTMidiInPort^ port);
+
+        // called by the out ports of the pair. Returns false if the queue is full
+        bool Send(const unsigned char* message, unsigned int nBytes);
+
+    protected:
+        virtual void Process(const WinRTMidiQueuedMessage& message) override;
+
+    private:
+        std::string mName;
+        Platform::String^ mId;
+
+        std::mutex mPortMutex;
+        std::vector<WinRTMidiInPort^> mInPorts;
+
+        // copy of mInPorts used by the worker thread so callbacks run without the lock
+        std::vector<WinRTMidiInPort^> mDeliveryPorts;
+    };
+};